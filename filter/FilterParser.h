@@ -35,6 +35,7 @@ class FilterParser {
 		void cleanup();
 
 		inline expression * get_root() { return root; }
+		inline const expression * get_root() const { return root; }
 		FilterParser& operator=(FilterParser& p);
 
 		const std::wstring& get_error() { return errmsg; }
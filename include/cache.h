@@ -4,9 +4,11 @@
 #include <memory>
 #include <mutex>
 #include <sqlite3.h>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "configcontainer.h"
+#include "reloadstats.h"
 
 namespace newsboat {
 
@@ -76,6 +78,22 @@ public:
 	void fetch_descriptions(RssFeed* feed);
 	std::string fetch_description(const RssItem& item);
 
+	/// \brief Returns, for each of the \a feedurls, the GUIDs of its items
+	/// that aren't deleted and for which the SQL \a condition holds.
+	///
+	/// \a condition is usually a filter expression translated by SqlFilter.
+	std::unordered_map<std::string, std::unordered_set<std::string>>
+	fetch_matching_guids(const std::string& condition,
+		const std::vector<std::string>& feedurls);
+
+	/// \brief Records timings of the latest reload of feed \a rssurl and
+	/// folds them into the feed's rolling average.
+	void update_reload_stats(const std::string& rssurl,
+		const ReloadTimings& timings);
+
+	/// \brief Returns reload statistics of all feeds, slowest first.
+	std::vector<FeedReloadStats> fetch_reload_stats();
+
 private:
 	SchemaVersion get_schema_version();
 	void populate_tables();
@@ -90,10 +108,10 @@ private:
 	template<typename... Args>
 	std::string prepare_query(const std::string& format,
 		const std::string& arg,
-		Args... args);
+		const Args& ... args);
 	template<typename T, typename... Args>
 	std::string prepare_query(const std::string& format, const T& arg,
-		Args... args);
+		const Args& ... args);
 
 	void run_sql(const std::string& query,
 		int (*callback)(void*, int, char**, char**) = nullptr,
@@ -9,6 +9,7 @@
 #include "feedcontainer.h"
 #include "filtercontainer.h"
 #include "fslock.h"
+#include "matcherprofiler.h"
 #include "opml.h"
 #include "queuemanager.h"
 #include "regexmanager.h"
@@ -21,6 +22,7 @@ namespace newsboat {
 
 class CliArgsParser;
 class ConfigPaths;
+class IpcClient;
 class View;
 
 class CurlHandle;
@@ -111,11 +113,23 @@ public:
 		return colorman;
 	}
 
+	/// \brief Formats reload timings of a feed as a line of
+	/// tab-separated values, as printed by `-x print-reload-stats`.
+	static std::string format_reload_stats(const FeedReloadStats& stats);
+
+	/// \brief Formats the profile of a filter expression as a line of
+	/// tab-separated values, as printed by `-x print-filter-stats`.
+	static std::string format_filter_stats(const ExpressionProfile& profile);
+
 private:
 	void import_opml(const std::string& opmlFile, const std::string& urlFile);
 	void export_opml();
 	void rec_find_rss_outlines(xmlNode* node, std::string tag);
 	int execute_commands(const std::vector<std::string>& cmds);
+	int execute_commands_via_daemon(IpcClient& client,
+		const std::vector<std::string>& cmds);
+	void print_reload_stats();
+	void print_filter_stats();
 
 	void import_read_information(const std::string& readinfofile);
 	void export_read_information(const std::string& readinfofile);
@@ -135,6 +149,7 @@ private:
 	RemoteApi* api;
 
 	std::unique_ptr<FsLock> fslock;
+	std::string daemon_socket;
 
 	ConfigPaths& configpaths;
 
@@ -0,0 +1,63 @@
+#ifndef NEWSBOAT_DAEMON_H_
+#define NEWSBOAT_DAEMON_H_
+
+#include <string>
+
+#include "ipc.h"
+
+namespace newsboat {
+
+class Cache;
+class Controller;
+
+/// \brief Headless mode: keeps feeds in memory, reloads them on schedule,
+/// and answers requests that come over a Unix socket.
+///
+/// Requests are single lines; the first word is the command, the rest of
+/// the line is its argument:
+///
+/// - `feeds`: one line per feed: unread count, total count, URL, title;
+/// - `items <url>`: one line per article of the feed: 1 if unread (0
+///   otherwise), publication timestamp, GUID, title, link;
+/// - `unread`: total number of unread articles;
+/// - `mark-read <guid>`: marks an article read;
+/// - `mark-feed-read <url>`: marks all articles of a feed read;
+/// - `reload [<url>]`: reloads one feed, or starts reloading all of them;
+/// - `reload-stats`: same data as `-x print-reload-stats`;
+/// - `filter-stats`: same data as `-x print-filter-stats`;
+/// - `stop`: shuts the daemon down.
+///
+/// Fields are separated by tabs. See IpcResponse for the reply format.
+class Daemon {
+public:
+	Daemon(Controller* c, Cache* cache, const std::string& socket_path);
+
+	/// \brief Serves requests until the daemon is stopped via `stop`
+	/// request, SIGINT or SIGTERM.
+	///
+	/// Returns the exit code for the program.
+	int run();
+
+	IpcResponse handle_request(const std::string& request);
+
+private:
+	void serve(int client_fd);
+
+	IpcResponse list_feeds();
+	IpcResponse list_items(const std::string& rssurl);
+	IpcResponse unread_count();
+	IpcResponse mark_read(const std::string& guid);
+	IpcResponse mark_feed_read(const std::string& rssurl);
+	IpcResponse reload(const std::string& rssurl);
+	IpcResponse reload_stats();
+	IpcResponse filter_stats();
+
+	Controller* ctrl;
+	Cache* rsscache;
+	const std::string socket_path;
+	bool stop_requested;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_DAEMON_H_ */
@@ -0,0 +1,53 @@
+#ifndef NEWSBOAT_DATEPARSER_H_
+#define NEWSBOAT_DATEPARSER_H_
+
+#include <ctime>
+#include <string>
+
+namespace newsboat {
+
+/// \brief Parses the dates found in feeds.
+///
+/// The common RFC 822 and ISO 8601 (W3CDTF) layouts are parsed directly,
+/// without allocating. Anything else goes through curl_getdate(), like it
+/// always did. The last few dates are remembered, since feeds tend to
+/// repeat the same timestamps; use one DateParser per feed.
+class DateParser {
+public:
+	DateParser();
+
+	/// \brief Returns \a date as seconds since the epoch, or -1 if it
+	/// couldn't be parsed.
+	time_t parse(const std::string& date);
+
+	/// \brief Parses dates like "Sun, 06 Nov 1994 08:49:37 GMT".
+	///
+	/// The weekday and seconds are optional; the zone may be a numeric
+	/// offset, GMT, UT, UTC, Z or one of the US zones. Returns false,
+	/// leaving \a result alone, if \a date is laid out differently.
+	/// Accepted dates give the same result as curl_getdate().
+	static bool parse_rfc822(const char* date, time_t& result);
+
+	/// \brief Parses dates like "1994-11-06T08:49:37.25+01:00".
+	///
+	/// The month, day and time may be left out; so may the zone, in
+	/// which case the date is in UTC. Returns false, leaving \a result
+	/// alone, if \a date is laid out differently.
+	static bool parse_iso8601(const char* date, time_t& result);
+
+private:
+	static const size_t MEMO_SIZE = 8;
+
+	struct MemoEntry {
+		std::string date;
+		time_t time;
+	};
+
+	MemoEntry memo[MEMO_SIZE];
+	size_t memo_used;
+	size_t memo_next;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_DATEPARSER_H_ */
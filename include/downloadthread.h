@@ -1,6 +1,8 @@
 #ifndef NEWSBOAT_DOWNLOADTHREAD_H_
 #define NEWSBOAT_DOWNLOADTHREAD_H_
 
+#include <future>
+#include <memory>
 #include <thread>
 
 #include "reloader.h"
@@ -9,13 +11,17 @@ namespace newsboat {
 
 class DownloadThread {
 public:
-	DownloadThread(Reloader& r, const std::vector<int>& idxs = {});
+	/// If \a started isn't nullptr, it is told whether the thread got the
+	/// reload mutex, i.e. whether it is going to reload anything.
+	DownloadThread(Reloader& r, const std::vector<int>& idxs = {},
+		std::shared_ptr<std::promise<bool>> started = nullptr);
 	virtual ~DownloadThread();
 	void operator()();
 
 private:
 	Reloader& reloader;
 	std::vector<int> indexes;
+	std::shared_ptr<std::promise<bool>> started;
 };
 
 } // namespace newsboat
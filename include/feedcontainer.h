@@ -4,17 +4,20 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "configcontainer.h"
 
 namespace newsboat {
 
+class ItemColumns;
 class RssFeed;
 
 class FeedContainer {
 public:
 	FeedContainer() = default;
+	~FeedContainer();
 
 	void sort_feeds(const FeedSortStrategy& sort_strategy);
 	std::shared_ptr<RssFeed> get_feed(const unsigned int pos);
@@ -31,19 +34,54 @@ public:
 
 	std::shared_ptr<RssFeed> get_feed_by_url(const std::string& feedurl);
 	void populate_query_feeds();
+
+	/// \brief Returns a columnar snapshot of the items of all feeds that
+	/// aren't query feeds, brought up to date with them.
+	///
+	/// Snapshots that were handed out are never modified, so they can be
+	/// read without holding any lock.
+	std::shared_ptr<const ItemColumns> get_item_columns();
 	unsigned int get_pos_of_next_unread(unsigned int pos);
 	unsigned int feeds_size();
 	void reset_feeds_status();
 	void set_feeds(const std::vector<std::shared_ptr<RssFeed>> new_feeds);
 	std::vector<std::shared_ptr<RssFeed>> get_all_feeds() const;
 	unsigned int unread_feed_count() const;
+
+	/// \brief Returns the number of distinct GUIDs among the unread items
+	/// of all feeds that aren't hidden.
+	///
+	/// Hidden feeds can't be viewed. The only way to read their articles is
+	/// via a query feed; items that aren't in query feeds are completely
+	/// inaccessible. Thus, we skip hidden feeds altogether to avoid
+	/// counting items that can't be accessed.
 	unsigned int unread_item_count() const;
 
+	/// \brief Counts an unread item with \a guid in, or out. Called by the
+	/// UnreadCounter of feeds in this container, see RssFeed::set_container().
+	void unread_item_changed(const std::string& guid, bool unread);
+
 	void replace_feed(unsigned int pos, std::shared_ptr<RssFeed> feed);
 
+	/// \brief Returns the feeds that replace_feed() put in place since the
+	/// last call, latest version of each.
+	///
+	/// Query feeds use them to re-evaluate only what a reload changed.
+	std::vector<std::shared_ptr<RssFeed>> take_replaced_feeds();
+
 private:
+	/// Expects `feeds_mutex` to be held.
+	void update_item_columns();
+
 	std::vector<std::shared_ptr<RssFeed>> feeds;
+	std::unordered_map<std::string, std::shared_ptr<RssFeed>> replaced_feeds;
 	mutable std::mutex feeds_mutex;
+	std::shared_ptr<ItemColumns> item_columns;
+
+	/// For each GUID, the number of unread items with it in feeds that
+	/// aren't hidden
+	std::unordered_map<std::string, unsigned int> unread_guids;
+	mutable std::mutex unread_guids_mutex;
 };
 } // namespace newsboat
 
@@ -4,6 +4,8 @@
 #include "3rd-party/optional.hpp"
 
 #include "configcontainer.h"
+#include "fmtstrformatter.h"
+#include "formattedlinecache.h"
 #include "history.h"
 #include "listformaction.h"
 #include "matcher.h"
@@ -48,6 +50,10 @@ public:
 
 	void mark_pos_if_visible(unsigned int pos);
 
+	/// \brief Returns positions (in FeedContainer) of the feeds that are
+	/// currently shown on screen.
+	std::vector<unsigned int> get_positions_on_screen();
+
 private:
 	void register_format_styles();
 
@@ -73,7 +79,7 @@ private:
 
 	std::string get_title(std::shared_ptr<RssFeed> feed);
 
-	std::string format_line(const std::string& feedlist_format,
+	std::string format_line(const FmtStrTemplate& feedlist_format,
 		std::shared_ptr<RssFeed> feed,
 		unsigned int pos,
 		unsigned int width);
@@ -97,6 +103,9 @@ private:
 	nonstd::optional<FeedSortStrategy> old_sort_strategy;
 
 	Cache* cache;
+
+	FormattedLineCache line_cache;
+	std::unique_ptr<FmtStrTemplate> feedlist_template;
 };
 
 } // namespace newsboat
@@ -0,0 +1,86 @@
+#ifndef NEWSBOAT_FETCHCOALESCER_H_
+#define NEWSBOAT_FETCHCOALESCER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace newsboat {
+
+class ConfigContainer;
+
+/// \brief Makes feeds that wrap the same upstream document share a single
+/// download during a reload.
+///
+/// For example, `http://example.com/feed.xml` and
+/// `filter:~/bin/fix.sh:http://example.com/feed.xml` point to the same
+/// document; with the coalescer, it's downloaded once and each feed
+/// processes its own copy of the body.
+class FetchCoalescer {
+public:
+	FetchCoalescer();
+
+	/// \brief Starts a new reload of feeds with given \a rssurls.
+	///
+	/// Only upstream URLs that are used by more than one of these feeds are
+	/// shared; everything else is downloaded as usual. Drops all bodies
+	/// kept since the previous call, and resets the counter of saved
+	/// transfers.
+	void reset(const std::vector<std::string>& rssurls);
+
+	/// \brief Drops all bodies and stops sharing any URLs.
+	void clear();
+
+	/// \brief Returns true if \a url is used by more than one feed in the
+	/// current reload.
+	bool is_shared(const std::string& url) const;
+
+	/// \brief Returns the body of \a url.
+	///
+	/// The first caller runs \a download; the rest of the callers asking
+	/// for the same URL during this reload wait for it to finish and get
+	/// the same buffer. If the first download throws or returns an empty
+	/// body, the waiting callers run their own \a download instead.
+	std::shared_ptr<const std::string> fetch(const std::string& url,
+		const std::function<std::string()>& download);
+
+	/// \brief Downloads \a url for fetch(), making up to `download-retries`
+	/// attempts like a feed's own download would.
+	///
+	/// Returns an empty string if none of them succeeded, so that a failed
+	/// or truncated body is never handed to other feeds.
+	static std::string download(const std::string& url, ConfigContainer* cfg);
+
+	/// \brief Number of downloads avoided since the last reset().
+	unsigned int saved_transfers() const;
+
+	/// \brief Returns the HTTP(S) URL that the feed with \a rssurl is
+	/// fetched from, or an empty string if it isn't fetched over HTTP.
+	static std::string upstream_url(const std::string& rssurl);
+
+	/// \brief Brings \a url into a form in which equivalent URLs compare
+	/// equal: scheme and host are lowercased, default ports and fragments
+	/// are removed.
+	static std::string normalize_url(const std::string& url);
+
+private:
+	struct Entry {
+		bool done = false;
+		std::shared_ptr<const std::string> body;
+	};
+
+	mutable std::mutex mtx;
+	std::condition_variable download_finished;
+	std::set<std::string> shared_urls;
+	std::map<std::string, std::shared_ptr<Entry>> entries;
+	unsigned int saved;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_FETCHCOALESCER_H_ */
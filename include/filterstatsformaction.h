@@ -0,0 +1,40 @@
+#ifndef NEWSBOAT_FILTERSTATSFORMACTION_H_
+#define NEWSBOAT_FILTERSTATSFORMACTION_H_
+
+#include <vector>
+
+#include "formaction.h"
+#include "listwidget.h"
+#include "matcherprofiler.h"
+
+namespace newsboat {
+
+class FilterStatsFormAction : public FormAction {
+public:
+	FilterStatsFormAction(View*, std::string formstr, ConfigContainer* cfg);
+	~FilterStatsFormAction() override;
+	void prepare() override;
+	void init() override;
+	KeyMapHintEntry* get_keymap_hint() override;
+	void set_stats(const std::vector<ExpressionProfile>& s)
+	{
+		stats = s;
+		do_redraw = true;
+	}
+	std::string id() const override
+	{
+		return "filterstats";
+	}
+	std::string title() override;
+
+private:
+	bool process_operation(Operation op,
+		bool automatic = false,
+		std::vector<std::string>* args = nullptr) override;
+	std::vector<ExpressionProfile> stats;
+	ListWidget stats_list;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_FILTERSTATSFORMACTION_H_ */
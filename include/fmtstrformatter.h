@@ -6,12 +6,43 @@
 
 namespace newsboat {
 
+/// \brief A format string that is parsed only once, to format many lines
+/// with.
+class FmtStrTemplate {
+public:
+	explicit FmtStrTemplate(const std::string& format);
+	~FmtStrTemplate();
+
+	FmtStrTemplate(const FmtStrTemplate&) = delete;
+	FmtStrTemplate& operator=(const FmtStrTemplate&) = delete;
+
+	const std::string& get_format() const
+	{
+		return format;
+	}
+
+	/// \brief Checks if the format refers to \a key, i.e. if its value has
+	/// to be registered at all.
+	bool uses(char key) const
+	{
+		return keys.find(key) != std::string::npos;
+	}
+
+private:
+	friend class FmtStrFormatter;
+
+	void* rs_template = nullptr;
+	const std::string format;
+	std::string keys;
+};
+
 class FmtStrFormatter {
 public:
 	FmtStrFormatter();
 	~FmtStrFormatter();
 	void register_fmt(char f, const std::string& value);
 	std::string do_format(const std::string& fmt, unsigned int width = 0);
+	std::string do_format(const FmtStrTemplate& tmpl, unsigned int width = 0);
 
 private:
 	void* rs_fmt = nullptr;
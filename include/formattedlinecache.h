@@ -0,0 +1,84 @@
+#ifndef NEWSBOAT_FORMATTEDLINECACHE_H_
+#define NEWSBOAT_FORMATTEDLINECACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace newsboat {
+
+/// \brief How well a FormattedLineCache has worked so far.
+struct FormattedLineCacheStats {
+	std::uint64_t hits = 0;
+	std::uint64_t misses = 0;
+
+	/// Time spent formatting lines that weren't cached, in milliseconds.
+	double formatting_time = 0;
+
+	/// Time that formatting the lines that were cached would have taken,
+	/// estimated from the lines that weren't, in milliseconds.
+	double saved_time = 0;
+
+	double hit_rate() const;
+};
+
+/// \brief Remembers how list entries, like articles or feeds, were
+/// formatted, so that entries which didn't change aren't formatted again.
+class FormattedLineCache {
+public:
+	/// \brief Everything besides the format that an entry's line depends
+	/// on.
+	struct Stamp {
+		/// Version of the entry, e.g. RssItem::version().
+		std::uint64_t version;
+
+		/// Anything else the line shows that doesn't change the entry's
+		/// version, e.g. the version of an article's feed.
+		std::uint64_t context;
+
+		unsigned int position;
+		unsigned int width;
+
+		bool operator==(const Stamp& other) const;
+	};
+
+	/// \brief Creates a cache that is logged as \a name.
+	explicit FormattedLineCache(const std::string& name);
+
+	/// \brief Drops all lines if \a format, which stands for everything
+	/// that all lines depend on, isn't what it was last time.
+	void set_format(const std::string& format);
+
+	/// \brief Returns the line of \a entry, which is formatted by
+	/// \a format_line unless it's known for \a stamp already.
+	std::string get(const void* entry,
+		const Stamp& stamp,
+		const std::function<std::string()>& format_line);
+
+	FormattedLineCacheStats get_stats() const;
+
+	/// \brief Writes the hit rate and the time saved to the log.
+	void log_stats() const;
+
+private:
+	struct Line {
+		Stamp stamp;
+		std::string text;
+	};
+
+	const std::string name;
+
+	mutable std::mutex mtx;
+	std::string format;
+	std::unordered_map<const void*, Line> lines;
+
+	std::uint64_t hits;
+	std::uint64_t misses;
+	std::uint64_t formatting_nanoseconds;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_FORMATTEDLINECACHE_H_ */
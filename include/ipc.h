@@ -0,0 +1,68 @@
+#ifndef NEWSBOAT_IPC_H_
+#define NEWSBOAT_IPC_H_
+
+#include <string>
+#include <vector>
+
+namespace newsboat {
+
+/// \brief Reply to a single request made over the daemon's socket.
+///
+/// On the wire, a request is a single line. The reply starts with a status
+/// line, either "OK <number of lines>" followed by that many data lines, or
+/// "ERR <message>".
+struct IpcResponse {
+	bool ok = true;
+	std::string error;
+	std::vector<std::string> lines;
+};
+
+namespace ipc {
+
+/// \brief Turns \a response into the form it takes on the wire.
+std::string format_response(const IpcResponse& response);
+
+/// \brief Replaces characters that would break the line-based protocol
+/// (newlines and tabs) with spaces.
+std::string sanitize_field(const std::string& field);
+
+/// \brief Reads bytes from \a fd until a newline; the newline itself is
+/// not stored in \a line.
+///
+/// Returns false on EOF or error.
+bool read_line(int fd, std::string& line);
+
+/// \brief Writes all of \a data to \a fd. Returns false on error.
+bool write_all(int fd, const std::string& data);
+
+/// \brief Creates a Unix socket bound to \a path and listening for
+/// connections.
+///
+/// Returns a file descriptor, or -1 on error (errno is set).
+int listen_on(const std::string& path);
+
+} // namespace ipc
+
+/// \brief Client side of the daemon protocol.
+class IpcClient {
+public:
+	explicit IpcClient(const std::string& socket_path);
+	~IpcClient();
+
+	/// \brief Connects to the daemon. Returns false if no daemon listens
+	/// on the socket.
+	bool connect();
+
+	/// \brief Sends \a request and waits for the reply.
+	///
+	/// If the connection breaks, the returned reply is an error.
+	IpcResponse request(const std::string& request);
+
+private:
+	std::string socket_path;
+	int fd;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_IPC_H_ */
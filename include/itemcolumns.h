@@ -0,0 +1,104 @@
+#ifndef NEWSBOAT_ITEMCOLUMNS_H_
+#define NEWSBOAT_ITEMCOLUMNS_H_
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "3rd-party/optional.hpp"
+#include "FilterParser.h"
+
+namespace newsboat {
+
+class Matcher;
+class RssFeed;
+class RssItem;
+
+/// \brief A snapshot of the item attributes that filter expressions read
+/// most often, stored column by column.
+///
+/// Matching an expression against the snapshot runs a few tight loops over
+/// contiguous arrays rather than following a pointer to every item.
+/// Attributes with few distinct values (`unread`, `flags`, `author`, and
+/// all attributes of the feed) are stored as IDs, so each comparison is
+/// only evaluated once per distinct value and then looked up for each row.
+class ItemColumns {
+public:
+	/// \brief Takes a snapshot of the items of those \a feeds that aren't
+	/// query feeds, in order.
+	explicit ItemColumns(const std::vector<std::shared_ptr<RssFeed>>& feeds);
+
+	/// \brief Brings the snapshot up to date with the items of \a feeds.
+	///
+	/// Only rows whose items changed since (see RssItem::version()) are read
+	/// again, unless items were added or removed.
+	void update(const std::vector<std::shared_ptr<RssFeed>>& feeds);
+
+	size_t size() const
+	{
+		return items.size();
+	}
+
+	RssItem* item(size_t row) const
+	{
+		return items[row];
+	}
+
+	/// \brief Checks if \a row is a snapshot of \a item as it is now.
+	bool describes(size_t row, const RssItem& item) const;
+
+	/// \brief Returns the number of distinct flags, authors and feeds
+	/// that rows can refer to.
+	///
+	/// Values that no row refers to any more are only dropped once they
+	/// outnumber the ones in use.
+	size_t interned_value_count() const;
+
+	/// \brief Returns a byte for each row, which is 1 if the item matches
+	/// \a m and isn't deleted, and 0 otherwise.
+	///
+	/// `age` is computed relative to \a now. Returns nullopt if \a m reads
+	/// attributes that aren't in the snapshot, or if matching would throw,
+	/// in which case items have to be matched one by one.
+	nonstd::optional<std::vector<uint8_t>> evaluate(const Matcher& m,
+		time_t now) const;
+
+private:
+	void load_row(size_t row, RssItem* item);
+	uint32_t intern(std::unordered_map<std::string, uint32_t>& index,
+		std::vector<std::string>& values, const std::string& value);
+	uint32_t intern_feed(const std::shared_ptr<RssFeed>& feed);
+	void drop_unused_values();
+
+	bool evaluate_r(const Matcher& m, const expression* e, time_t now,
+		std::vector<uint8_t>& rows) const;
+	bool evaluate_age(const expression* e, time_t now,
+		std::vector<uint8_t>& rows) const;
+	bool evaluate_feed_attribute(const Matcher& m, const expression* e,
+		std::vector<uint8_t>& rows) const;
+
+	std::vector<RssItem*> items;
+	std::vector<uint64_t> versions;
+	std::vector<uint8_t> unread;
+	std::vector<uint8_t> deleted;
+	std::vector<time_t> pubdates;
+	std::vector<uint32_t> flag_ids;
+	std::vector<uint32_t> author_ids;
+	std::vector<uint32_t> feed_ids;
+
+	std::vector<std::string> flag_values;
+	std::unordered_map<std::string, uint32_t> flag_index;
+	std::vector<std::string> author_values;
+	std::unordered_map<std::string, uint32_t> author_index;
+	/// Feeds aren't kept alive by the snapshot, and rows of items without a
+	/// feed refer to a null entry
+	std::vector<std::weak_ptr<RssFeed>> feed_values;
+	std::unordered_map<const RssFeed*, uint32_t> feed_index;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_ITEMCOLUMNS_H_ */
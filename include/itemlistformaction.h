@@ -5,6 +5,7 @@
 
 #include "3rd-party/optional.hpp"
 
+#include "fmtstrformatter.h"
 #include "history.h"
 #include "listformaction.h"
 #include "listformatter.h"
@@ -51,6 +52,10 @@ public:
 	{
 		pos = p;
 	}
+	unsigned int get_pos() const
+	{
+		return pos;
+	}
 	std::string get_guid();
 	KeyMapHintEntry* get_keymap_hint() override;
 
@@ -70,6 +75,10 @@ public:
 	{
 		show_searchresult = b;
 	}
+	bool get_show_searchresult() const
+	{
+		return show_searchresult;
+	}
 	void set_searchphrase(const std::string& s)
 	{
 		search_phrase = s;
@@ -89,6 +98,10 @@ private:
 		const std::string& url);
 	int get_pos(unsigned int idx);
 
+	/// Returns the lines of visible_items [begin, end), formatting the ones
+	/// that aren't in formatted_lines yet.
+	std::string format_lines(std::uint32_t begin, std::uint32_t end);
+
 	void save_article(const std::string& filename,
 		std::shared_ptr<RssItem> item);
 
@@ -121,7 +134,7 @@ private:
 
 	std::string item2formatted_line(const ItemPtrPosPair& item,
 		const unsigned int width,
-		const std::string& itemlist_format,
+		const FmtStrTemplate& itemlist_format,
 		const std::string& datetime_format);
 
 	unsigned int pos;
@@ -148,7 +161,10 @@ private:
 	InvalidationMode invalidation_mode;
 	std::vector<unsigned int> invalidated_itempos;
 
-	ListFormatter listfmt;
+	/// Formatted lines of visible_items, filled in as they are scrolled
+	/// into view.
+	std::vector<nonstd::optional<std::string>> formatted_lines;
+	std::unique_ptr<FmtStrTemplate> itemlist_template;
 	Cache* rsscache;
 	FilterContainer& filters;
 
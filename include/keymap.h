@@ -39,6 +39,7 @@ enum Operation {
 	OP_HARDQUIT,
 	OP_RELOAD,
 	OP_RELOADALL,
+	OP_CANCELRELOAD,
 	OP_MARKFEEDREAD,
 	OP_MARKALLFEEDSREAD,
 	OP_MARKALLABOVEASREAD,
@@ -0,0 +1,71 @@
+#ifndef NEWSBOAT_KNOWNITEMS_H_
+#define NEWSBOAT_KNOWNITEMS_H_
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rsspp {
+class Item;
+}
+
+namespace newsboat {
+
+/// \brief Remembers which items each feed contained when it was last
+/// reloaded, so that the next reload can stop parsing once it reaches items
+/// that haven't changed since.
+///
+/// This relies on the feed listing its items newest first. Every once in a
+/// while, and whenever a feed turns out not to be ordered that way, a full
+/// pass is requested instead.
+class KnownItems {
+public:
+	/// Number of consecutive unchanged items after which parsing stops.
+	static const unsigned int RUN_LENGTH = 5;
+
+	/// Time between reloads that parse the whole feed, in seconds.
+	static const time_t FULL_PASS_INTERVAL = 24 * 60 * 60;
+
+	/// \brief Returns true if a reload of \a rssurl at time \a now may stop
+	/// at known items; false if it should parse the whole feed.
+	bool allows_early_stop(const std::string& rssurl, time_t now) const;
+
+	/// \brief Returns true if an item with \a guid and \a fingerprint was
+	/// seen in \a rssurl before.
+	bool is_known(const std::string& rssurl,
+		const std::string& guid,
+		std::uint64_t fingerprint) const;
+
+	/// \brief Records the items that a reload of \a rssurl parsed.
+	///
+	/// \a items are (GUID, fingerprint) pairs. After a full pass they
+	/// replace everything known about the feed; otherwise they're merged
+	/// into it. \a ordered tells if the items were listed newest first.
+	void update(const std::string& rssurl,
+		const std::vector<std::pair<std::string, std::uint64_t>>& items,
+		bool full_pass,
+		bool ordered,
+		time_t now);
+
+	/// \brief Hash of all the fields of \a item that end up in the cache.
+	static std::uint64_t fingerprint(const rsspp::Item& item);
+
+private:
+	struct FeedState {
+		std::unordered_map<std::string, std::uint64_t> items;
+		time_t last_full_pass = 0;
+		bool ordered = false;
+	};
+
+	mutable std::mutex mtx;
+	std::map<std::string, FeedState> feeds;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_KNOWNITEMS_H_ */
@@ -2,6 +2,7 @@
 #define NEWSBOAT_LISTWIDGET_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -17,6 +18,20 @@ public:
 	void stfl_replace_list(std::uint32_t number_of_lines, std::string stfl);
 	void stfl_replace_lines(const ListFormatter& listfmt);
 
+	/// \brief Replaces the list with \a number_of_lines lines, of which only
+	/// the ones on screen plus a margin above and below are sent to STFL.
+	///
+	/// \a render_lines has to return the lines [begin, end) the way
+	/// ListFormatter::format_list() does. It's called again whenever the
+	/// list scrolls past the lines that were rendered. Positions and scroll
+	/// offsets still refer to the whole list.
+	void stfl_replace_lines(std::uint32_t number_of_lines,
+		std::function<std::string(std::uint32_t, std::uint32_t)> render_lines);
+
+	/// \brief Renders the lines that came into view without the position
+	/// changing, e.g. because the widget got taller.
+	void render_visible_lines();
+
 	bool move_up(bool wrap_scroll);
 	bool move_down(bool wrap_scroll);
 	void move_to_first();
@@ -29,16 +44,26 @@ public:
 
 	std::uint32_t get_width();
 	std::uint32_t get_height();
-private:
 	std::uint32_t get_scroll_offset();
+private:
 	void set_scroll_offset(std::uint32_t pos);
 
-	void update_scroll_offset(std::uint32_t pos);
+	std::uint32_t scroll_offset_for(std::uint32_t pos);
+
+	bool is_rendered(std::uint32_t offset, std::uint32_t pos);
+	void render_window(std::uint32_t offset, std::uint32_t pos);
+	std::string window_index(std::uint32_t line) const;
 
 	const std::string list_name;
 	Stfl::Form& form;
 	std::uint32_t num_lines;
 	std::uint32_t num_context_lines;
+
+	std::function<std::string(std::uint32_t, std::uint32_t)> render_lines;
+	/// Lines [window_start, window_end) are the ones STFL knows about;
+	/// STFL's position and offset are relative to window_start.
+	std::uint32_t window_start;
+	std::uint32_t window_end;
 };
 
 } // namespace newsboat
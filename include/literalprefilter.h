@@ -0,0 +1,68 @@
+#ifndef NEWSBOAT_LITERALPREFILTER_H_
+#define NEWSBOAT_LITERALPREFILTER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace newsboat {
+
+/// \brief Finds out which of a set of regular expressions can't possibly
+/// match a text, by looking for literals the matches would have to contain.
+///
+/// All literals are searched for at once, in a single scan over the text
+/// (with an Aho-Corasick automaton), so the cost doesn't grow with the
+/// number of expressions. Matching is ASCII case-insensitive, which makes
+/// the prefilter suitable for expressions compiled with and without
+/// REG_ICASE.
+class LiteralPrefilter {
+public:
+	/// \brief Builds the automaton for \a literals, one per expression.
+	///
+	/// An empty literal stands for an expression that has to be tried on
+	/// every text.
+	explicit LiteralPrefilter(const std::vector<std::string>& literals);
+
+	/// \brief Sets \a candidates[i] to 1 if the text might match expression
+	/// \a i, i.e. it contains literal \a i, and to 0 otherwise.
+	void find(const char* text, size_t length,
+		std::vector<char>& candidates) const;
+
+	/// \brief Checks if the text contains \a literal, which is lowercase,
+	/// ignoring ASCII case.
+	///
+	/// Unlike find(), this skips through the text with memchr(), which is
+	/// faster for a single literal and long texts.
+	static bool contains(const char* text, size_t length,
+		const std::string& literal);
+
+	/// \brief Returns literals that every match of the POSIX extended
+	/// regular expression \a pattern contains, in the order they appear in
+	/// the pattern.
+	///
+	/// The literals are lowercase. Letters that case-insensitive matching
+	/// might map to non-ASCII characters (like "k", which matches the Kelvin
+	/// sign) are never part of them.
+	static std::vector<std::string> required_literals(
+		const std::string& pattern);
+
+	/// \brief Returns the longest of required_literals(), or an empty string
+	/// if there are none.
+	static std::string required_literal(const std::string& pattern);
+
+private:
+	std::array<uint8_t, 256> classes;
+	size_t class_count;
+	/// Transition table of the automaton: `state * class_count + class`
+	std::vector<uint32_t> transitions;
+	/// Literals that end in each state
+	std::vector<std::vector<size_t>> outputs;
+	std::vector<size_t> always;
+	size_t literal_count;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_LITERALPREFILTER_H_ */
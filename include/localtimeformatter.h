@@ -0,0 +1,63 @@
+#ifndef NEWSBOAT_LOCALTIMEFORMATTER_H_
+#define NEWSBOAT_LOCALTIMEFORMATTER_H_
+
+#include <ctime>
+#include <string>
+#include <unordered_map>
+
+namespace newsboat {
+
+/// \brief Formats timestamps in the local time zone, giving the same
+/// results as strftime() with localtime_r().
+///
+/// Local days during which the UTC offset doesn't change are converted
+/// only once; the time of day is then added onto the local midnight.
+/// Formatted strings are remembered per format and per minute or day, if
+/// the format doesn't show anything smaller than that. Nothing is
+/// locked, so each thread needs a LocalTimeFormatter of its own, like the
+/// one utils::mt_strf_localtime() uses. Changes to the TZ environment
+/// variable are noticed on the next call.
+class LocalTimeFormatter {
+public:
+	LocalTimeFormatter();
+
+	std::string format(const std::string& format, time_t t);
+
+	/// \brief Returns the number of seconds during which \a format's
+	/// output stays the same: 1, 60, or 86400 for a whole day.
+	static unsigned int resolution(const std::string& format);
+
+private:
+	/// A local day with one UTC offset, [start, end) in UTC.
+	struct Day {
+		time_t start;
+		time_t end;
+		struct tm midnight;
+	};
+
+	struct Memo {
+		unsigned int resolution;
+		std::unordered_map<time_t, std::string> strings;
+	};
+
+	void check_timezone();
+	void clear();
+	const Day* find_day(time_t t);
+	static std::string strftime_tm(const std::string& format,
+		const struct tm& tm);
+
+	static const size_t DAY_SLOTS = 64;
+
+	bool tz_known;
+	bool tz_set;
+	std::string tz;
+
+	Day days[DAY_SLOTS];
+	long last_offset;
+
+	std::unordered_map<std::string, Memo> memos;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_LOCALTIMEFORMATTER_H_ */
@@ -24,7 +24,7 @@ void set_user_error_logfile(const std::string& logfile);
 void set_loglevel(Level l);
 
 template<typename... Args>
-void log(Level l, const std::string& format, Args... args)
+void log(Level l, const std::string& format, const Args& ... args)
 {
 	if (l == Level::USERERROR
 		|| static_cast<uint64_t>(l) <= rs_get_loglevel()) {
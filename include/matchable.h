@@ -7,6 +7,39 @@
 
 namespace newsboat {
 
+/// \brief Attributes known to the filter language.
+///
+/// Matcher looks attribute names up once, when it compiles an expression,
+/// so that items can be asked for values by ID rather than by name.
+enum class MatchAttribute {
+	UNKNOWN,
+
+	// RssItem
+	TITLE,
+	LINK,
+	AUTHOR,
+	CONTENT,
+	DATE,
+	GUID,
+	UNREAD,
+	ENCLOSURE_URL,
+	ENCLOSURE_TYPE,
+	FLAGS,
+	AGE,
+	ARTICLEINDEX,
+
+	// RssFeed
+	FEEDTITLE,
+	DESCRIPTION,
+	FEEDLINK,
+	FEEDDATE,
+	RSSURL,
+	UNREAD_COUNT,
+	TOTAL_COUNT,
+	TAGS,
+	FEEDINDEX,
+};
+
 class Matchable {
 public:
 	Matchable() = default;
@@ -14,9 +47,29 @@ public:
 	virtual nonstd::optional<std::string> attribute_value(const std::string& attr)
 	const =
 		0;
+
+	/// \brief Returns the value of \a attr if it is stored as a string, so
+	/// that it needn't be copied.
+	///
+	/// Returns nullptr if it isn't, in which case Matcher calls
+	/// attribute_value() instead.
+	virtual const std::string* attribute_ref(MatchAttribute /* attr */) const
+	{
+		return nullptr;
+	}
+
+	/// \brief Stores the value of a numeric attribute in \a value without
+	/// formatting it as a string.
+	///
+	/// Returns false if \a attr isn't numeric, in which case Matcher calls
+	/// attribute_value() instead.
+	virtual bool attribute_number(MatchAttribute /* attr */,
+		int& /* value */) const
+	{
+		return false;
+	}
 };
 
 } // namespace newsboat
 
 #endif /* NEWSBOAT_MATCHABLE_H_ */
-
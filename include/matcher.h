@@ -1,21 +1,66 @@
 #ifndef NEWSBOAT_MATCHER_H_
 #define NEWSBOAT_MATCHER_H_
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "FilterParser.h"
+#include "matchable.h"
+#include "matcherprofiler.h"
+#include "workerpool.h"
 
 namespace newsboat {
 
-class Matchable;
-
 class Matcher {
 public:
 	Matcher();
 	explicit Matcher(const std::string& expr);
 	bool parse(const std::string& expr);
-	bool matches(Matchable* item);
+	bool matches(Matchable* item) const;
+
+	/// \brief Returns the indices of the items in [0, count) that match, in
+	/// ascending order.
+	///
+	/// The items are sharded across the threads of \a pool. \a item_at
+	/// returns the item with the given index, or nullptr if it should be
+	/// skipped; it is called from several threads at once, and so are the
+	/// items' attribute getters.
+	std::vector<size_t> matching_indices(size_t count,
+		const std::function<Matchable*(size_t)>& item_at,
+		const WorkerPool& pool = WorkerPool()) const;
 	std::string get_parse_error();
 	std::string get_expression();
 
+	/// \brief Returns the parsed expression, or nullptr if there is none.
+	const expression* get_syntax_tree() const;
+
+	/// \brief Returns the attributes that the expression reads, possibly
+	/// more than once.
+	std::vector<MatchAttribute> get_attributes() const;
+
+	/// \brief Whether the expression only reads attributes of an RssItem
+	/// that change its RssItem::version(), i.e. neither `age` nor anything
+	/// of the item's feed.
+	bool reads_only_versioned_attributes() const;
+
+	/// \brief Evaluates the comparison \a e, which is a node of
+	/// get_syntax_tree(), on its own.
+	///
+	/// Throws MatcherException like matches() does.
+	bool matches_comparison(const expression* e, Matchable* item) const;
+
+	/// \brief Adds \a evaluations of the expression that weren't done by
+	/// this Matcher (e.g. by SQLite) to its profile.
+	///
+	/// See MatcherProfiler.
+	void add_to_profile(std::uint64_t evaluations, std::uint64_t matches,
+		std::chrono::steady_clock::duration time,
+		std::uint64_t description_fetches = 0) const;
+
 	/// Convert numerical prefix of the string to an `int`.
 	///
 	/// Return 0 if there is no numeric prefix. On underflow, return `int`'s
@@ -24,16 +69,65 @@ public:
 	static int string_to_num(const std::string& number);
 
 private:
-	bool matches_r(expression* e, Matchable* item);
+	/// \brief A node of the compiled expression.
+	///
+	/// Attribute names are resolved and literals parsed when the
+	/// expression is compiled, rather than for every item.
+	struct PlanNode {
+		int op;
+		MatchAttribute attribute;
+		std::string name;
+		std::string literal;
+
+		/// Literal of `<`, `>`, `<=` and `>=`; lower bound of `between`.
+		int number;
+		/// Upper bound of `between`.
+		int upper;
+		/// False if `between` didn't get two bounds.
+		bool has_range;
+
+		/// Compiled literal of `=~` and `!~`, or the reason it couldn't be
+		/// compiled.
+		///
+		/// regexec() locks the regex it is given, so threads that match
+		/// concurrently each use a copy of the plan with regexes of their
+		/// own (see thread_plan()).
+		std::shared_ptr<regex_t> regex;
+		std::string regex_error;
+
+		/// Literals that all values matching `regex` contain, which are
+		/// much faster to look for than running the regex.
+		std::vector<std::string> required_literals;
+
+		/// Operands of `and` and `or`, as indices into the plan.
+		size_t left;
+		size_t right;
+
+		/// The node of the syntax tree this was compiled from.
+		const expression* source;
+	};
+
+	void compile();
+	size_t compile_r(expression* e);
+	static void compile_regex(PlanNode& node);
+	std::vector<PlanNode> thread_plan() const;
+
+	bool evaluate(const std::vector<PlanNode>& nodes, size_t node,
+		Matchable* item) const;
+	const std::string& string_value(const PlanNode& node, Matchable* item,
+		std::string& storage) const;
+	int number_value(const PlanNode& node, Matchable* item) const;
 
-	bool matchop_lt(expression* e, Matchable* item);
-	bool matchop_gt(expression* e, Matchable* item);
-	bool matchop_rxeq(expression* e, Matchable* item);
-	bool matchop_cont(expression* e, Matchable* item);
-	bool matchop_eq(expression* e, Matchable* item);
-	bool matchop_between(expression* e, Matchable* item);
+	bool matchop_lt(const PlanNode& node, Matchable* item) const;
+	bool matchop_gt(const PlanNode& node, Matchable* item) const;
+	bool matchop_rxeq(const PlanNode& node, Matchable* item) const;
+	bool matchop_cont(const PlanNode& node, Matchable* item) const;
+	bool matchop_eq(const PlanNode& node, Matchable* item) const;
+	bool matchop_between(const PlanNode& node, Matchable* item) const;
 
 	FilterParser p;
+	std::vector<PlanNode> plan;
+	std::shared_ptr<MatcherProfiler::Counters> counters;
 	std::string errmsg;
 	std::string exp;
 };
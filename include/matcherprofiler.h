@@ -0,0 +1,99 @@
+#ifndef NEWSBOAT_MATCHERPROFILER_H_
+#define NEWSBOAT_MATCHERPROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace newsboat {
+
+/// \brief What evaluating a filter expression has cost so far.
+struct ExpressionProfile {
+	std::string expression;
+
+	/// Names of the attributes the expression reads, sorted.
+	std::vector<std::string> attributes;
+
+	std::uint64_t evaluations = 0;
+	std::uint64_t matches = 0;
+
+	/// Total time spent evaluating the expression, in milliseconds.
+	double time = 0;
+
+	/// How many times evaluating the expression had to fetch an item's
+	/// description from the cache.
+	std::uint64_t description_fetches = 0;
+};
+
+/// \brief Collects the cost of every filter expression that is evaluated,
+/// be it a query feed, an ignore rule, a highlight rule or a filter.
+///
+/// Matchers with the same expression share a single profile, so it adds
+/// up across e.g. all updates of a query feed.
+class MatcherProfiler {
+public:
+	/// \brief Running totals of a single expression, updated by all
+	/// Matchers of the expression, from any thread.
+	class Counters {
+	public:
+		explicit Counters(std::vector<std::string> attributes);
+
+		void add(std::uint64_t evaluations, std::uint64_t matches,
+			std::uint64_t nanoseconds, std::uint64_t description_fetches);
+
+	private:
+		friend class MatcherProfiler;
+
+		const std::vector<std::string> attributes;
+		std::atomic<std::uint64_t> evaluations;
+		std::atomic<std::uint64_t> matches;
+		std::atomic<std::uint64_t> nanoseconds;
+		std::atomic<std::uint64_t> description_fetches;
+	};
+
+	static MatcherProfiler& get_instance();
+
+	/// \brief Returns the counters of \a expression, which reads
+	/// \a attributes.
+	std::shared_ptr<Counters> counters(const std::string& expression,
+		const std::vector<std::string>& attributes);
+
+	/// \brief Returns the profiles of all expressions that were evaluated
+	/// at least once, most time-consuming first.
+	std::vector<ExpressionProfile> get_profiles() const;
+
+	/// \brief Writes the most time-consuming expressions to the log.
+	void log_summary() const;
+
+	/// \brief Checks if the calling thread should time the evaluation it is
+	/// about to do.
+	///
+	/// Reading the clock takes about as long as evaluating a simple
+	/// expression, so single evaluations are only timed once in SAMPLE_RATE
+	/// times, and that time is counted SAMPLE_RATE times.
+	static bool sample();
+
+	static const unsigned int SAMPLE_RATE = 8;
+
+	/// \brief Notes that the calling thread fetched a description from the
+	/// cache.
+	static void description_fetched();
+
+	/// \brief Returns how many descriptions the calling thread has fetched
+	/// so far.
+	static std::uint64_t description_fetch_count();
+
+private:
+	MatcherProfiler() = default;
+
+	mutable std::mutex mtx;
+	std::unordered_map<std::string, std::shared_ptr<Counters>> expressions;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_MATCHERPROFILER_H_ */
@@ -1,20 +1,25 @@
 #ifndef NEWSBOAT_REGEXMANAGER_H_
 #define NEWSBOAT_REGEXMANAGER_H_
 
+#include <cstdint>
 #include <memory>
 #include <regex>
 #include <regex.h>
 #include <string>
 #include <sys/types.h>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "configparser.h"
+#include "literalprefilter.h"
 #include "matcher.h"
 #include "regexowner.h"
 
 namespace newsboat {
 
+class RssItem;
+
 class RegexManager : public ConfigActionHandler {
 public:
 	RegexManager();
@@ -24,6 +29,14 @@ public:
 	void quote_and_highlight(std::string& str, const std::string& location);
 	void remove_last_regex(const std::string& location);
 	int article_matches(Matchable* item);
+
+	/// \brief Like article_matches(), but remembers the result for each item
+	/// until the item or the `highlight-article` rules change.
+	///
+	/// Results aren't remembered if a rule reads an attribute that can
+	/// change without the item changing, like `age` or the feed's
+	/// attributes.
+	int article_matches(RssItem* item);
 	std::map<size_t, std::string> extract_style_tags(std::string& str);
 	void insert_style_tags(std::string& str, std::map<size_t, std::string>& tags);
 	void merge_style_tag(std::map<size_t, std::string>& tags,
@@ -35,12 +48,27 @@ private:
 	typedef std::vector<std::pair<std::shared_ptr<Regex>, std::string>>
 		RegexStyleVector;
 	std::map<std::string, RegexStyleVector> locations;
+	/// Literal that each regex in `locations` requires a line to contain
+	std::map<std::string, std::vector<std::string>> required_literals;
+	/// Built on first use, and dropped whenever a location's regexes change
+	std::map<std::string, std::unique_ptr<LiteralPrefilter>> prefilters;
 	std::vector<std::string> cheat_store_for_dump_config;
 	std::vector<std::pair<std::shared_ptr<Matcher>, int>> matchers;
 
+	struct ArticleMatch {
+		uint64_t version;
+		int result;
+	};
+	/// Emptied whenever `matchers` changes, and once it grows too large
+	std::unordered_map<const RssItem*, ArticleMatch> article_match_cache;
+	bool matchers_cacheable;
+
 	void handle_highlight_action(const std::vector<std::string>& params);
 	void handle_highlight_article_action(
 		const std::vector<std::string>& params);
+	void add_regex(const std::string& location, std::shared_ptr<Regex> regex,
+		const std::string& colorstr, const std::string& literal);
+	const LiteralPrefilter& get_prefilter(const std::string& location);
 };
 
 } // namespace newsboat
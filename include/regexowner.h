@@ -21,6 +21,8 @@ public:
 		int regcomp_flags, std::string& error);
 	std::vector<std::pair<int, int>> matches(std::string input, int max_matches,
 			int flags) const;
+	std::vector<std::pair<int, int>> matches(const char* input, int max_matches,
+			int flags) const;
 
 private:
 	regex_t regex;
@@ -1,10 +1,19 @@
 #ifndef NEWSBOAT_RELOADER_H_
 #define NEWSBOAT_RELOADER_H_
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <vector>
 
 #include "configcontainer.h"
+#include "fetchcoalescer.h"
+#include "knownitems.h"
+#include "reloadqueue.h"
+
+namespace rsspp {
+struct TransferStats;
+}
 
 namespace newsboat {
 
@@ -23,8 +32,10 @@ public:
 	/// \brief Starts a thread that will reload feeds with specified
 	/// indexes.
 	///
-	/// If \a indexes is empty, all feeds will be reloaded.
-	void start_reload_all_thread(const std::vector<int>& indexes = {});
+	/// If \a indexes is empty, all feeds will be reloaded. Returns false if
+	/// the thread won't reload anything because another reload is already
+	/// in progress.
+	bool start_reload_all_thread(const std::vector<int>& indexes = {});
 
 	void unlock_reload_mutex()
 	{
@@ -62,14 +73,27 @@ public:
 	void reload_indexes(const std::vector<int>& indexes,
 		bool unattended = false);
 
-	/// \brief Reloads feeds occupying positions from \a start to \a end in
-	/// feedlist.
+	/// \brief Reloads feeds from the reload queue until it runs dry or the
+	/// reload is cancelled.
 	///
-	/// Only updates status bar if \a unattended is false.
-	void reload_range(unsigned int start,
-		unsigned int end,
-		unsigned int size,
-		bool unattended = false);
+	/// \a size is the total amount of feeds, used in status messages. Only
+	/// updates status bar if \a unattended is false.
+	void reload_queued(unsigned int size, bool unattended = false);
+
+	/// \brief Moves feeds at \a positions into the \a priority class of
+	/// the reload queue.
+	///
+	/// Replaces the set of feeds given in the previous call with the same
+	/// \a priority. Only OPEN_FEED and VISIBLE classes can be assigned
+	/// this way. Takes effect immediately if a reload is in progress.
+	void prioritize(ReloadPriority priority,
+		const std::vector<unsigned int>& positions);
+
+	/// \brief Stops the reload started by reload_all().
+	///
+	/// Feeds that are being downloaded at the moment are finished; the
+	/// rest are skipped. Returns false if there was nothing to cancel.
+	bool cancel_reload_all();
 
 private:
 	/// \brief Notify in various ways that there are new unread feeds or
@@ -86,10 +110,25 @@ private:
 	void notify_reload_finished(unsigned int unread_feeds_before,
 		unsigned int unread_articles_before);
 
+	/// \brief Stores the timing breakdown of a reload of \a rssurl in the
+	/// cache.
+	///
+	/// \a fetch_and_parse is the time it took RssParser to produce a feed;
+	/// \a persist is the time spent writing it to the cache and reading it
+	/// back.
+	void record_reload_stats(const std::string& rssurl,
+		const rsspp::TransferStats& transfer,
+		std::chrono::steady_clock::duration fetch_and_parse,
+		std::chrono::steady_clock::duration persist);
+
 	Controller* ctrl;
 	Cache* rsscache;
 	ConfigContainer* cfg;
 	std::mutex reload_mutex;
+	ReloadQueue reload_queue;
+	FetchCoalescer fetch_coalescer;
+	KnownItems known_items;
+	std::atomic<unsigned int> materialized_items;
 
 	std::string prepare_message(unsigned int pos, unsigned int max);
 
@@ -0,0 +1,100 @@
+#ifndef NEWSBOAT_RELOADQUEUE_H_
+#define NEWSBOAT_RELOADQUEUE_H_
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "3rd-party/optional.hpp"
+
+namespace newsboat {
+
+/// \brief Priority classes for feeds waiting to be reloaded, most urgent
+/// first.
+enum class ReloadPriority {
+	/// The feed whose articles the user is currently reading.
+	OPEN_FEED = 0,
+	/// Feeds currently shown on screen in the feed list.
+	VISIBLE,
+	/// Feeds that published something recently.
+	RECENT_ACTIVITY,
+	/// Everything else.
+	OTHER,
+};
+
+/// \brief Thread-safe queue of feeds waiting to be reloaded.
+///
+/// Feeds are identified by their position in FeedContainer. Each feed has
+/// a base priority that is assigned when it's queued; the UI can boost
+/// feeds into the OPEN_FEED and VISIBLE classes at any time, even while
+/// the reload is in progress. Within the same class, feeds are handed out
+/// in the order in which they were queued.
+class ReloadQueue {
+public:
+	ReloadQueue();
+
+	/// \brief Replaces the contents of the queue with \a feeds, which are
+	/// (position, base priority) pairs.
+	///
+	/// Clears the "cancelled" flag.
+	void reset(const std::vector<std::pair<unsigned int, ReloadPriority>>&
+		feeds);
+
+	/// \brief Makes \a positions the set of feeds boosted into \a priority.
+	///
+	/// This replaces the set given in the previous call for the same \a
+	/// priority: feeds that are no longer in it fall back to their base
+	/// priority. The sets are kept across calls to reset(), so boosts
+	/// given before a reload starts still apply to it.
+	void set_boosted(ReloadPriority priority,
+		const std::vector<unsigned int>& positions);
+
+	/// \brief Takes the most urgent feed off the queue.
+	///
+	/// Returns nothing if the queue is empty.
+	nonstd::optional<unsigned int> pop();
+
+	/// \brief Removes the feed at \a pos from the queue.
+	///
+	/// Returns true if the feed was queued.
+	bool remove(unsigned int pos);
+
+	/// \brief Drops all queued feeds and marks the queue as cancelled.
+	///
+	/// Returns positions of the dropped feeds. Feeds that were already
+	/// popped are not affected.
+	std::vector<unsigned int> cancel();
+
+	bool cancelled() const;
+
+	std::size_t size() const;
+
+private:
+	struct Entry {
+		ReloadPriority base;
+		ReloadPriority effective;
+		unsigned int seq;
+	};
+
+	/// (priority, sequence number, position); sorted by urgency.
+	using Key = std::tuple<ReloadPriority, unsigned int, unsigned int>;
+
+	ReloadPriority effective_priority(unsigned int pos,
+		ReloadPriority base) const;
+	void update_priority(unsigned int pos);
+
+	mutable std::mutex mtx;
+	std::map<unsigned int, Entry> entries;
+	std::set<Key> order;
+	std::array<std::set<unsigned int>, 2> boosted;
+	bool is_cancelled;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_RELOADQUEUE_H_ */
@@ -0,0 +1,46 @@
+#ifndef NEWSBOAT_RELOADSTATS_H_
+#define NEWSBOAT_RELOADSTATS_H_
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+namespace newsboat {
+
+/// \brief Breakdown of the time spent on reloading a single feed.
+///
+/// Unlike curl's cumulative `CURLINFO_*_TIME` values, every field here is the
+/// duration of a single phase, in milliseconds.
+struct ReloadTimings {
+	double namelookup = 0;
+	double connect = 0;
+	double tls = 0;
+	double firstbyte = 0;
+	double transfer = 0;
+	double parse = 0;
+	double persist = 0;
+	std::uint64_t size = 0;
+
+	double total() const
+	{
+		return namelookup + connect + tls + firstbyte + transfer + parse +
+			persist;
+	}
+};
+
+/// \brief Reload timings of a feed, as stored in the cache.
+struct FeedReloadStats {
+	std::string rssurl;
+	unsigned int reload_count = 0;
+	time_t last_reload = 0;
+
+	/// Timings of the most recent reload.
+	ReloadTimings last;
+
+	/// Rolling average over the last few reloads.
+	ReloadTimings average;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_RELOADSTATS_H_ */
@@ -0,0 +1,40 @@
+#ifndef NEWSBOAT_RELOADSTATSFORMACTION_H_
+#define NEWSBOAT_RELOADSTATSFORMACTION_H_
+
+#include <vector>
+
+#include "formaction.h"
+#include "listwidget.h"
+#include "reloadstats.h"
+
+namespace newsboat {
+
+class ReloadStatsFormAction : public FormAction {
+public:
+	ReloadStatsFormAction(View*, std::string formstr, ConfigContainer* cfg);
+	~ReloadStatsFormAction() override;
+	void prepare() override;
+	void init() override;
+	KeyMapHintEntry* get_keymap_hint() override;
+	void set_stats(const std::vector<FeedReloadStats>& s)
+	{
+		stats = s;
+		do_redraw = true;
+	}
+	std::string id() const override
+	{
+		return "reloadstats";
+	}
+	std::string title() override;
+
+private:
+	bool process_operation(Operation op,
+		bool automatic = false,
+		std::vector<std::string>* args = nullptr) override;
+	std::vector<FeedReloadStats> stats;
+	ListWidget stats_list;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_RELOADSTATSFORMACTION_H_ */
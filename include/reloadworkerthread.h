@@ -0,0 +1,23 @@
+#ifndef NEWSBOAT_RELOADWORKERTHREAD_H_
+#define NEWSBOAT_RELOADWORKERTHREAD_H_
+
+#include <thread>
+
+#include "reloader.h"
+
+namespace newsboat {
+
+class ReloadWorkerThread {
+public:
+	ReloadWorkerThread(Reloader& r, unsigned int size, bool unattended);
+	void operator()();
+
+private:
+	Reloader& reloader;
+	unsigned int size;
+	bool unattended;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_RELOADWORKERTHREAD_H_ */
@@ -1,6 +1,9 @@
 #ifndef NEWSBOAT_RSSFEED_H_
 #define NEWSBOAT_RSSFEED_H_
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -16,6 +19,9 @@ namespace newsboat {
 enum class DlStatus { SUCCESS, TO_BE_DOWNLOADED, DURING_DOWNLOAD, DL_ERROR };
 
 class Cache;
+class FeedContainer;
+class ItemColumns;
+class Matcher;
 
 class RssFeed : public Matchable {
 public:
@@ -31,6 +37,7 @@ public:
 	{
 		title_ = t;
 		utils::trim(title_);
+		changed();
 	}
 
 	std::string description() const
@@ -40,6 +47,7 @@ public:
 	void set_description(const std::string& d)
 	{
 		description_ = d;
+		changed();
 	}
 
 	const std::string& link() const
@@ -49,6 +57,7 @@ public:
 	void set_link(const std::string& l)
 	{
 		link_ = l;
+		changed();
 	}
 
 	std::string pubDate() const
@@ -68,12 +77,14 @@ public:
 	}
 	void add_item(std::shared_ptr<RssItem> item)
 	{
+		item->add_unread_counter(unread_counter);
 		items_.push_back(item);
 		items_guid_map[item->guid()] = item;
 	}
 	void add_items(const std::vector<std::shared_ptr<RssItem>>& items)
 	{
 		for (const auto& item : items) {
+			item->add_unread_counter(unread_counter);
 			items_.push_back(item);
 			items_guid_map[item->guid()] = item;
 		}
@@ -88,12 +99,14 @@ public:
 		std::vector<std::shared_ptr<RssItem>>::iterator end)
 	{
 		for (auto it = begin; it != end; ++it) {
+			(*it)->remove_unread_counter(unread_counter);
 			items_guid_map.erase((*it)->guid());
 		}
 		items_.erase(begin, end);
 	}
 	void erase_item(std::vector<std::shared_ptr<RssItem>>::iterator pos)
 	{
+		(*pos)->remove_unread_counter(unread_counter);
 		items_guid_map.erase((*pos)->guid());
 		items_.erase(pos);
 	}
@@ -110,12 +123,25 @@ public:
 	}
 	void set_rssurl(const std::string& u);
 
-	unsigned int unread_item_count() const;
+	/// \brief Number of unread items, which is kept up to date as items
+	/// are added, removed, and marked read or unread.
+	///
+	/// Items must be added and removed through the methods of this class
+	/// for that to work, not through items().
+	unsigned int unread_item_count() const
+	{
+		return unread_counter->get();
+	}
 	unsigned int total_item_count() const
 	{
 		return items_.size();
 	}
 
+	/// \brief Makes the feed count its unread items towards \a container's
+	/// FeedContainer::unread_item_count() while it isn't hidden, or
+	/// towards nobody's if \a container is nullptr.
+	void set_container(FeedContainer* container);
+
 	void set_tags(const std::vector<std::string>& tags);
 	bool matches_tag(const std::string& tag);
 	std::string get_tags() const;
@@ -123,12 +149,49 @@ public:
 
 	nonstd::optional<std::string> attribute_value(const std::string& attr) const
 	override;
-
-	void update_items(std::vector<std::shared_ptr<RssFeed>> feeds);
+	const std::string* attribute_ref(MatchAttribute attr) const override;
+	bool attribute_number(MatchAttribute attr, int& value) const override;
+
+	/// \brief Fills a query feed with the items of \a feeds that match its
+	/// query.
+	///
+	/// If \a columns is a snapshot of exactly those items (see
+	/// FeedContainer::get_item_columns()), the query is evaluated on that
+	/// where possible.
+	void update_items(std::vector<std::shared_ptr<RssFeed>> feeds,
+		const ItemColumns* columns = nullptr);
+
+	/// \brief Brings a query feed up to date after a reload replaced the
+	/// feeds in \a replaced.
+	///
+	/// Only the items of \a replaced, and those items of \a feeds whose
+	/// RssItem::version() changed since the last update, are matched
+	/// against the query. Items that came from earlier versions of the
+	/// replaced feeds or that changed are dropped, and matches are inserted
+	/// where \a sort_strategy puts them. The rest of the query feed is left
+	/// alone, so it must have been populated by update_items() before, and
+	/// can_update_incrementally() must hold.
+	void update_items(const std::vector<std::shared_ptr<RssFeed>>& feeds,
+		const std::vector<std::shared_ptr<RssFeed>>& replaced,
+		const ArticleSortStrategy& sort_strategy);
+
+	/// \brief Whether the query only reads attributes that change an item's
+	/// version, so that a query feed can be updated incrementally.
+	///
+	/// Queries on e.g. `age` or the feed's title can change their result
+	/// without any item changing.
+	bool can_update_incrementally() const;
+
+	/// \brief Whether update_items() has populated this query feed.
+	bool is_query_populated() const
+	{
+		return query_populated;
+	}
 
 	void set_query(const std::string& s)
 	{
 		query = s;
+		query_populated = false;
 	}
 
 	bool is_query_feed() const
@@ -186,11 +249,23 @@ public:
 	{
 		std::lock_guard<std::mutex> guard(status_mutex_);
 		status_ = DlStatus::TO_BE_DOWNLOADED;
+		changed();
 	}
 	void set_status(DlStatus st)
 	{
 		std::lock_guard<std::mutex> guard(status_mutex_);
 		status_ = st;
+		changed();
+	}
+
+	/// \brief Returns a number that changes whenever the feed's title,
+	/// description, link, URL, tags or download status does.
+	///
+	/// Versions are unique across all feeds, so a version also tells feeds
+	/// apart.
+	uint64_t version() const
+	{
+		return version_;
 	}
 
 	void unload();
@@ -202,6 +277,35 @@ public:
 	mutable std::mutex item_mutex;
 
 private:
+	void changed();
+
+	/// \brief Makes the unread counter pass changes on to \a container.
+	///
+	/// Expects `item_mutex` to be held.
+	void set_counted_container(FeedContainer* container);
+
+	using ItemComparator = std::function<bool(const std::shared_ptr<RssItem>&,
+			const std::shared_ptr<RssItem>&)>;
+
+	/// Returns an empty function for random order.
+	static ItemComparator item_comparator(const ArticleSortStrategy&
+		sort_strategy);
+
+	/// \brief Appends the items of \a feeds that match \a m.
+	///
+	/// The items of all feeds are matched in one go, so that the work can
+	/// be spread across cores even if the feeds are small. Expressions
+	/// that read item contents are evaluated by the cache if possible, and
+	/// others on \a columns if it is up to date.
+	///
+	/// If \a is_candidate is given, only the items it accepts are matched.
+	void append_matching_items(const std::vector<std::shared_ptr<RssFeed>>&
+		feeds,
+		const Matcher& m,
+		const ItemColumns* columns = nullptr,
+		const std::function<bool(const RssFeed&, const RssItem&)>& is_candidate =
+			nullptr);
+
 	std::string title_;
 	std::string description_;
 	std::string link_;
@@ -212,6 +316,9 @@ private:
 		items_guid_map;
 	std::vector<std::string> tags_;
 	std::string query;
+	bool query_populated;
+	/// RssItem::latest_version() when the query was last matched
+	uint64_t matched_version;
 
 	Cache* ch;
 
@@ -223,6 +330,10 @@ private:
 
 	DlStatus status_;
 	std::mutex status_mutex_;
+	std::atomic<uint64_t> version_;
+
+	std::shared_ptr<UnreadCounter> unread_counter;
+	FeedContainer* container;
 };
 
 } // namespace newsboat
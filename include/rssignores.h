@@ -1,9 +1,15 @@
 #ifndef NEWSBOAT_RSSIGNORES_H_
 #define NEWSBOAT_RSSIGNORES_H_
 
+#include <ctime>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "3rd-party/optional.hpp"
+
 #include "configactionhandler.h"
 #include "matcher.h"
 #include "rssitem.h"
@@ -20,13 +26,46 @@ public:
 		const std::vector<std::string>& params) override;
 	void dump_config(std::vector<std::string>& config_output) override;
 	bool matches(RssItem* item);
+
+	/// \brief Returns the indices of the \a items that match an ignore
+	/// rule, in ascending order.
+	///
+	/// Items are matched on several threads. A rule that can't be
+	/// evaluated (e.g. because of an invalid regex) ignores nothing.
+	std::vector<size_t> matching_indices(
+		const std::vector<std::shared_ptr<RssItem>>& items);
+
+	/// \brief Returns an SQL condition that holds for the items of feed
+	/// \a feedurl that an ignore rule matches.
+	///
+	/// Returns nullopt if a rule for the feed can't be translated to SQL
+	/// (see SqlFilter), in which case the items have to be matched with
+	/// matching_indices().
+	nonstd::optional<std::string> sql_condition(const std::string& feedurl,
+		time_t now);
 	bool matches_lastmodified(const std::string& url);
 	bool matches_resetunread(const std::string& url);
+	bool matches_stopatknown(const std::string& url);
 
 private:
+	/// Indices of the `ignore-article` rules that apply to feed \a feedurl,
+	/// in the order they were configured.
+	std::vector<size_t> rules_for(const std::string& feedurl) const;
+
 	std::vector<FeedUrlExprPair> ignores;
+	/// Indices into `ignores`, by feed URL, so that items aren't tested
+	/// against the rules of other feeds.
+	std::unordered_map<std::string, std::vector<size_t>> ignores_by_feed;
+	/// Indices into `ignores` of rules with a URL of "*".
+	std::vector<size_t> wildcard_ignores;
+
+	// The vectors keep the configured order for dump_config()
 	std::vector<std::string> ignores_lastmodified;
+	std::unordered_set<std::string> ignores_lastmodified_set;
 	std::vector<std::string> resetflag;
+	std::unordered_set<std::string> resetflag_set;
+	std::vector<std::string> stopatknown;
+	std::unordered_set<std::string> stopatknown_set;
 };
 
 } // namespace newsboat
@@ -1,12 +1,17 @@
 #ifndef NEWSBOAT_RSSITEM_H_
 #define NEWSBOAT_RSSITEM_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "matchable.h"
 #include "matcher.h"
+#include "unreadcounter.h"
 
 namespace newsboat {
 
@@ -18,31 +23,31 @@ public:
 	explicit RssItem(Cache* c);
 	~RssItem() override;
 
-	std::string title() const
+	const std::string& title() const
 	{
 		return title_;
 	}
-	void set_title(const std::string& t);
+	void set_title(std::string t);
 
 	/// \brief Feed's canonical URL. Empty if feed was never fetched.
 	const std::string& link() const
 	{
 		return link_;
 	}
-	void set_link(const std::string& l);
+	void set_link(std::string l);
 
-	std::string author() const
+	const std::string& author() const
 	{
 		return author_;
 	}
-	void set_author(const std::string& a);
+	void set_author(std::string a);
 
 	std::string description() const
 	{
 		std::lock_guard<std::mutex> guard(description_mutex);
 		return description_.value_or("");
 	}
-	void set_description(const std::string& d);
+	void set_description(std::string d);
 
 	unsigned int size() const
 	{
@@ -68,7 +73,7 @@ public:
 	{
 		return guid_;
 	}
-	void set_guid(const std::string& g);
+	void set_guid(std::string g);
 
 	bool unread() const
 	{
@@ -78,13 +83,19 @@ public:
 	void set_unread_nowrite(bool u);
 	void set_unread_nowrite_notify(bool u, bool notify);
 
+	/// \brief Makes \a counter count this item while it's unread, until
+	/// remove_unread_counter() is called with the same counter.
+	void add_unread_counter(const std::shared_ptr<UnreadCounter>& counter);
+	void remove_unread_counter(const std::shared_ptr<UnreadCounter>& counter);
+
 	void set_cache(Cache* c)
 	{
 		ch = c;
 	}
-	void set_feedurl(const std::string& f)
+	void set_feedurl(std::string f)
 	{
-		feedurl_ = f;
+		feedurl_ = std::move(f);
+		changed();
 	}
 
 	const std::string& feedurl() const
@@ -101,8 +112,8 @@ public:
 		return enclosure_type_;
 	}
 
-	void set_enclosure_url(const std::string& url);
-	void set_enclosure_type(const std::string& type);
+	void set_enclosure_url(std::string url);
+	void set_enclosure_type(std::string type);
 
 	bool enqueued()
 	{
@@ -127,6 +138,8 @@ public:
 
 	nonstd::optional<std::string> attribute_value(const std::string& attr) const
 	override;
+	const std::string* attribute_ref(MatchAttribute attr) const override;
+	bool attribute_number(MatchAttribute attr, int& value) const override;
 
 	void set_feedptr(std::shared_ptr<RssFeed> ptr);
 	void set_feedptr(const std::weak_ptr<RssFeed>& ptr);
@@ -142,20 +155,25 @@ public:
 	void set_deleted(bool b)
 	{
 		deleted_ = b;
+		changed();
 	}
 
 	void set_index(unsigned int i)
 	{
-		idx = i;
+		// Called for every item on each full redraw of the item list
+		if (idx != i) {
+			idx = i;
+			changed();
+		}
 	}
 	unsigned int get_index()
 	{
 		return idx;
 	}
 
-	void set_base(const std::string& b)
+	void set_base(std::string b)
 	{
-		base = b;
+		base = std::move(b);
 	}
 	const std::string& get_base()
 	{
@@ -171,6 +189,21 @@ public:
 		return override_unread_;
 	}
 
+	/// \brief Returns a number that changes whenever an attribute that
+	/// filter expressions read from the item itself does, or the item is
+	/// deleted, or it is moved to another feed, or its size or feed URL
+	/// changes.
+	///
+	/// Versions are unique across all items, so a version also tells items
+	/// apart.
+	uint64_t version() const
+	{
+		return version_;
+	}
+
+	/// \brief Returns the highest version() that any item has had so far.
+	static uint64_t latest_version();
+
 	void unload()
 	{
 		std::lock_guard<std::mutex> guard(description_mutex);
@@ -178,6 +211,11 @@ public:
 	}
 
 private:
+	void changed();
+
+	/// Sets unread_ and updates the counters that count this item.
+	void store_unread(bool u);
+
 	std::string title_;
 	std::string link_;
 	std::string author_;
@@ -197,9 +235,15 @@ private:
 	bool enqueued_;
 	bool deleted_;
 	bool override_unread_;
+	std::atomic<uint64_t> version_;
 
 	mutable std::mutex description_mutex;
 	nonstd::optional<std::string> description_;
+
+	/// Guards changes of unread_, so that counters are updated in the same
+	/// order as the flag.
+	std::mutex unread_mutex;
+	std::vector<std::shared_ptr<UnreadCounter>> unread_counters;
 };
 
 } // namespace newsboat
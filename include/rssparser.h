@@ -1,11 +1,16 @@
 #ifndef NEWSBOAT_RSSPARSER_H_
 #define NEWSBOAT_RSSPARSER_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "dateparser.h"
 #include "remoteapi.h"
 #include "rss/feed.h"
+#include "rss/parser.h"
 
 namespace rsspp {
 class Item;
@@ -16,6 +21,8 @@ namespace newsboat {
 class Cache;
 class ConfigContainer;
 class CurlHandle;
+class FetchCoalescer;
+class KnownItems;
 class RssFeed;
 class RssIgnores;
 class RssItem;
@@ -36,6 +43,37 @@ public:
 		easyhandle = h;
 	}
 
+	/// \brief Share downloads of HTTP URLs that \a coalescer marks as
+	/// shared with other parsers using the same coalescer.
+	void set_fetch_coalescer(FetchCoalescer* coalescer)
+	{
+		fetch_coalescer = coalescer;
+	}
+
+	/// \brief Stop parsing the feed once a run of items that \a known
+	/// remembers from the last reload is reached.
+	///
+	/// \a known is also updated with the items that were parsed.
+	void set_known_items(KnownItems* known)
+	{
+		known_items = known;
+	}
+
+	/// \brief Number of items that the last call to parse() turned into
+	/// RssItem objects.
+	unsigned int get_materialized_items() const
+	{
+		return materialized_items;
+	}
+
+	/// \brief Network timings of the last HTTP download made by parse().
+	///
+	/// All fields are zero if the feed wasn't fetched over HTTP.
+	const rsspp::TransferStats& get_transfer_stats() const
+	{
+		return transfer_stats;
+	}
+
 private:
 	void replace_newline_characters(std::string& str);
 	std::string render_xhtml_title(const std::string& title,
@@ -45,31 +83,39 @@ private:
 
 	void retrieve_uri(const std::string& uri);
 	void download_http(const std::string& uri);
+	void download_shared(const std::string& uri);
+	bool is_shared_fetch(const std::string& uri) const;
+	std::string retrieve_shared(const std::string& uri);
 	void get_execplugin(const std::string& plugin);
 	void download_filterplugin(const std::string& filter,
 		const std::string& uri);
 	void parse_file(const std::string& file);
 
+	rsspp::StreamParser::ItemHandler make_item_handler();
+	void update_known_items(std::shared_ptr<RssFeed> feed,
+		const std::vector<std::pair<std::string, std::uint64_t>>& items,
+		time_t now);
+
 	void fill_feed_fields(std::shared_ptr<RssFeed> feed);
 	void fill_feed_items(std::shared_ptr<RssFeed> feed);
 
 	void set_item_title(std::shared_ptr<RssFeed> feed,
 		std::shared_ptr<RssItem> x,
-		const rsspp::Item& item);
+		rsspp::Item& item);
 	void set_item_author(std::shared_ptr<RssItem> x,
-		const rsspp::Item& item);
+		rsspp::Item& item);
 	void set_item_content(std::shared_ptr<RssItem> x,
-		const rsspp::Item& item);
+		rsspp::Item& item);
 	void set_item_enclosure(std::shared_ptr<RssItem> x,
-		const rsspp::Item& item);
+		rsspp::Item& item);
 	std::string get_guid(const rsspp::Item& item) const;
 
 	void add_item_to_feed(std::shared_ptr<RssFeed> feed,
 		std::shared_ptr<RssItem> item);
 
-	void handle_content_encoded(std::shared_ptr<RssItem> x,
-		const rsspp::Item& item) const;
-	void handle_itunes_summary(std::shared_ptr<RssItem> x,
+	void handle_content_encoded(std::string& description,
+		rsspp::Item& item) const;
+	void handle_itunes_summary(std::string& description,
 		const rsspp::Item& item);
 	bool is_html_type(const std::string& type);
 	void fetch_ttrss(const std::string& feed_id);
@@ -82,6 +128,8 @@ private:
 	ConfigContainer* cfgcont;
 	RssIgnores* ign;
 	rsspp::Feed f;
+	rsspp::TransferStats transfer_stats;
+	DateParser date_parser;
 	RemoteApi* api;
 	bool is_ttrss;
 	bool is_newsblur;
@@ -89,6 +137,11 @@ private:
 	bool is_miniflux;
 
 	CurlHandle* easyhandle;
+	FetchCoalescer* fetch_coalescer;
+	KnownItems* known_items;
+	bool early_stop_allowed;
+	bool stopped_early;
+	unsigned int materialized_items;
 };
 
 } // namespace newsboat
@@ -0,0 +1,39 @@
+#ifndef NEWSBOAT_SQLFILTER_H_
+#define NEWSBOAT_SQLFILTER_H_
+
+#include <ctime>
+#include <sqlite3.h>
+#include <string>
+
+#include "3rd-party/optional.hpp"
+
+namespace newsboat {
+
+class Matcher;
+
+/// \brief Translates filter expressions into conditions on the `rss_item`
+/// table.
+///
+/// Only expressions over item attributes that are stored in the cache can be
+/// translated. A translated condition holds for exactly those rows whose
+/// items Matcher would match.
+class SqlFilter {
+public:
+	/// \brief Returns an SQL condition equivalent to \a m, or nullopt if
+	/// \a m can only be evaluated in memory.
+	///
+	/// `age` is computed relative to \a now.
+	static nonstd::optional<std::string> translate(const Matcher& m,
+		time_t now);
+
+	/// \brief Checks if \a m reads item contents, which Matcher usually has
+	/// to fetch from the cache one item at a time.
+	static bool reads_content(const Matcher& m);
+
+	/// \brief Registers the REGEXP function that translated conditions use.
+	static void register_functions(sqlite3* db);
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_SQLFILTER_H_ */
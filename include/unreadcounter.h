@@ -0,0 +1,47 @@
+#ifndef NEWSBOAT_UNREADCOUNTER_H_
+#define NEWSBOAT_UNREADCOUNTER_H_
+
+#include <atomic>
+#include <string>
+
+namespace newsboat {
+
+class FeedContainer;
+
+/// \brief Number of unread items in a feed.
+///
+/// Items update the counters they were added to (see
+/// RssItem::add_unread_counter()) whenever they're marked read or unread,
+/// so nothing has to be counted when the number is asked for. A counter
+/// can also pass the changes on to a FeedContainer, which counts unread
+/// GUIDs across all of its feeds.
+class UnreadCounter {
+public:
+	UnreadCounter();
+
+	unsigned int get() const
+	{
+		return count;
+	}
+
+	/// \brief Passes changes on to \a container from now on, or to nobody
+	/// if it's nullptr.
+	void set_container(FeedContainer* container);
+	FeedContainer* get_container() const
+	{
+		return container;
+	}
+
+	/// \brief Called by an item with \a guid when it's marked read or
+	/// unread, or when it's added to or removed from the count while
+	/// being unread.
+	void item_changed(const std::string& guid, bool unread);
+
+private:
+	std::atomic<unsigned int> count;
+	std::atomic<FeedContainer*> container;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_UNREADCOUNTER_H_ */
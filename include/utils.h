@@ -53,6 +53,10 @@ std::string convert_text(const std::string& text,
 /// nl_langinfo(CODESET)).
 std::string utf8_to_locale(const std::string& text);
 
+/// Checks if the locale's encoding is UTF-8, i.e. if utf8_to_locale() leaves
+/// text unchanged.
+bool locale_is_utf8();
+
 std::string get_command_output(const std::string& cmd);
 void extract_filter(const std::string& line,
 	std::string& filter,
@@ -168,7 +172,8 @@ std::string program_version();
 /// Newsboat's major version number.
 unsigned int newsboat_version_major();
 
-/// Threadsafe combination of strftime() and localtime()
+/// Threadsafe combination of strftime() and localtime(), see
+/// LocalTimeFormatter.
 std::string mt_strf_localtime(const std::string& format, time_t t);
 }
 
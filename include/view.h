@@ -15,6 +15,7 @@
 #include "dirbrowserformaction.h"
 #include "feedlistformaction.h"
 #include "filebrowserformaction.h"
+#include "formattedlinecache.h"
 #include "htmlrenderer.h"
 #include "keymap.h"
 #include "regexmanager.h"
@@ -52,6 +53,13 @@ public:
 	{
 		return keys;
 	}
+
+	/// \brief Returns the lines of articles formatted by any item list, so
+	/// that they are still known after switching feeds.
+	FormattedLineCache& get_article_line_cache()
+	{
+		return article_line_cache;
+	}
 	void set_tags(const std::vector<std::string>& t);
 	void push_empty_formaction();
 	void pop_current_formaction();
@@ -75,6 +83,8 @@ public:
 	void push_searchresult(std::shared_ptr<RssFeed> feed,
 		const std::string& phrase = "");
 	void view_dialogs();
+	void view_reload_stats();
+	void view_filter_stats();
 
 	std::string run_filebrowser(const std::string& default_filename = "",
 		const std::string& dir = "");
@@ -106,6 +116,12 @@ public:
 
 	void prepare_query_feed(std::shared_ptr<RssFeed> feed);
 
+	/// \brief Like prepare_query_feed(), but only matches the items of the
+	/// feeds in \a replaced, and items that changed since, if \a feed was
+	/// populated before and its query allows that.
+	void update_query_feed(std::shared_ptr<RssFeed> feed,
+		const std::vector<std::shared_ptr<RssFeed>>& replaced);
+
 	void force_redraw();
 
 	void notify_itemlist_change(std::shared_ptr<RssFeed> feed);
@@ -146,6 +162,10 @@ protected:
 	void cancel_input(std::shared_ptr<FormAction> fa);
 	void delete_word(std::shared_ptr<FormAction> fa);
 
+	/// \brief Tells the Reloader which feeds the user is looking at, so
+	/// that those are reloaded first.
+	void update_reload_priorities();
+
 	Controller* ctrl;
 
 	ConfigContainer* cfg;
@@ -160,6 +180,8 @@ protected:
 
 	RegexManager& rxman;
 
+	FormattedLineCache article_line_cache;
+
 	std::map<std::string, TextStyle> text_styles;
 
 	bool is_inside_qna;
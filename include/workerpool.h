@@ -0,0 +1,46 @@
+#ifndef NEWSBOAT_WORKERPOOL_H_
+#define NEWSBOAT_WORKERPOOL_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace newsboat {
+
+/// \brief Splits a range of indices into shards and processes them on
+/// several threads at once.
+///
+/// Used to match filter expressions against many items: the work for each
+/// item is small and independent, so it's simply divided up front.
+class WorkerPool {
+public:
+	/// \brief Uses up to \a workers threads, or one per core if \a workers
+	/// is 0.
+	explicit WorkerPool(unsigned int workers = 0);
+
+	/// \brief Returns the number of shards that run() splits \a count
+	/// indices into.
+	///
+	/// Ranges too short to be worth starting threads for are a single shard.
+	size_t shard_count(size_t count) const;
+
+	/// \brief Calls \a f(shard, begin, end) for each of the consecutive
+	/// shards of [0, count), and returns once all of them are done.
+	///
+	/// The first shard is processed by the calling thread, the others by
+	/// threads of their own. If \a f throws, the exception thrown for the
+	/// lowest shard is rethrown here, so callers see the same exception a
+	/// sequential loop would have thrown.
+	void run(size_t count,
+		const std::function<void(size_t shard, size_t begin, size_t end)>& f)
+	const;
+
+	/// Ranges are never split into shards smaller than this.
+	static const size_t MIN_SHARD_SIZE = 2048;
+
+private:
+	unsigned int workers;
+};
+
+} // namespace newsboat
+
+#endif /* NEWSBOAT_WORKERPOOL_H_ */
@@ -11,12 +11,8 @@
 
 namespace rsspp {
 
-void AtomParser::parse_feed(Feed& f, xmlNode* rootNode)
+void AtomParser::parse_feed_start(Feed& f, xmlNode* rootNode)
 {
-	if (!rootNode) {
-		throw Exception(_("XML root node is NULL"));
-	}
-
 	switch (f.rss_version) {
 	case Feed::ATOM_0_3:
 		ns = ATOM_0_3_URI;
@@ -34,28 +30,28 @@ void AtomParser::parse_feed(Feed& f, xmlNode* rootNode)
 
 	f.language = get_prop(rootNode, "lang");
 	globalbase = get_prop(rootNode, "base", XML_URI);
+}
 
-	for (xmlNode* node = rootNode->children; node != nullptr;
-		node = node->next) {
-		if (node_is(node, "title", ns)) {
-			f.title = get_content(node);
-			f.title_type = get_prop(node, "type");
-			if (f.title_type == "") {
-				f.title_type = "text";
-			}
-		} else if (node_is(node, "subtitle", ns)) {
-			f.description = get_content(node);
-		} else if (node_is(node, "link", ns)) {
-			std::string rel = get_prop(node, "rel");
-			if (rel == "alternate") {
-				f.link = newsboat::utils::absolute_url(
-						globalbase, get_prop(node, "href"));
-			}
-		} else if (node_is(node, "updated", ns)) {
-			f.pubDate = w3cdtf_to_rfc822(get_content(node));
-		} else if (node_is(node, "entry", ns)) {
-			f.items.push_back(parse_entry(node));
+void AtomParser::parse_feed_element(Feed& f, xmlNode* node)
+{
+	if (node_is(node, "title", ns)) {
+		f.title = get_content(node);
+		f.title_type = get_prop(node, "type");
+		if (f.title_type == "") {
+			f.title_type = "text";
+		}
+	} else if (node_is(node, "subtitle", ns)) {
+		f.description = get_content(node);
+	} else if (node_is(node, "link", ns)) {
+		std::string rel = get_prop(node, "rel");
+		if (rel == "alternate") {
+			f.link = newsboat::utils::absolute_url(
+					globalbase, get_prop(node, "href"));
 		}
+	} else if (node_is(node, "updated", ns)) {
+		f.pubDate = w3cdtf_to_rfc822(get_content(node));
+	} else if (node_is(node, "entry", ns)) {
+		f.items.push_back(parse_entry(node));
 	}
 }
 
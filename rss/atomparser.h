@@ -11,7 +11,8 @@ class Feed;
 class Item;
 
 struct AtomParser : public RssParser {
-	void parse_feed(Feed& f, xmlNode* rootNode) override;
+	void parse_feed_start(Feed& f, xmlNode* rootNode) override;
+	void parse_feed_element(Feed& f, xmlNode* node) override;
 	explicit AtomParser(xmlDocPtr doc)
 		: RssParser(doc)
 		, ns(0)
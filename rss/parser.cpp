@@ -3,6 +3,8 @@
 #include <cinttypes>
 #include <cstring>
 #include <curl/curl.h>
+#include <exception>
+#include <fstream>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 
@@ -13,6 +15,7 @@
 #include "rssparser.h"
 #include "rssparserfactory.h"
 #include "rsspp_uris.h"
+#include "streamparser.h"
 #include "strprintf.h"
 #include "utils.h"
 
@@ -26,6 +29,38 @@ static size_t my_write_data(void* buffer, size_t size, size_t nmemb,
 	return size * nmemb;
 }
 
+namespace {
+
+struct StreamingDownload {
+	rsspp::StreamParser* parser;
+	size_t received;
+	std::exception_ptr error;
+};
+
+} // namespace
+
+static size_t stream_write_data(void* buffer, size_t size, size_t nmemb,
+	void* userp)
+{
+	StreamingDownload* download = static_cast<StreamingDownload*>(userp);
+	const size_t length = size * nmemb;
+	try {
+		download->parser->parse_chunk(
+			static_cast<const char*>(buffer), length);
+	} catch (...) {
+		// Can't throw through libcurl; returning less than `length` aborts
+		// the transfer, and parse_url() rethrows the error.
+		download->error = std::current_exception();
+		return 0;
+	}
+	download->received += length;
+	if (download->parser->stopped()) {
+		// The rest of the feed isn't needed; abort the transfer
+		return 0;
+	}
+	return length;
+}
+
 namespace rsspp {
 
 Parser::Parser(unsigned int timeout,
@@ -42,6 +77,7 @@ Parser::Parser(unsigned int timeout,
 	, verify_ssl(ssl_verify)
 	, doc(0)
 	, lm(0)
+	, parse_while_downloading(false)
 {
 }
 
@@ -108,6 +144,9 @@ Feed Parser::parse_url(const std::string& url,
 	CURL* ehandle)
 {
 	std::string buf;
+	StreamParser stream(url);
+	StreamingDownload streaming{&stream, 0, nullptr};
+	stream.set_item_handler(item_handler);
 	CURLcode ret;
 	curl_slist* custom_headers{};
 
@@ -128,8 +167,15 @@ Feed Parser::parse_url(const std::string& url,
 	}
 	curl_easy_setopt(easyhandle, CURLOPT_URL, url.c_str());
 	curl_easy_setopt(easyhandle, CURLOPT_SSL_VERIFYPEER, verify_ssl);
-	curl_easy_setopt(easyhandle, CURLOPT_WRITEFUNCTION, my_write_data);
-	curl_easy_setopt(easyhandle, CURLOPT_WRITEDATA, &buf);
+	if (parse_while_downloading) {
+		curl_easy_setopt(easyhandle,
+			CURLOPT_WRITEFUNCTION,
+			stream_write_data);
+		curl_easy_setopt(easyhandle, CURLOPT_WRITEDATA, &streaming);
+	} else {
+		curl_easy_setopt(easyhandle, CURLOPT_WRITEFUNCTION, my_write_data);
+		curl_easy_setopt(easyhandle, CURLOPT_WRITEDATA, &buf);
+	}
 	curl_easy_setopt(easyhandle, CURLOPT_NOSIGNAL, 1);
 	curl_easy_setopt(easyhandle, CURLOPT_FOLLOWLOCATION, 1);
 	curl_easy_setopt(easyhandle, CURLOPT_MAXREDIRS, 10);
@@ -208,6 +254,25 @@ Feed Parser::parse_url(const std::string& url,
 	CURLcode infoOk =
 		curl_easy_getinfo(easyhandle, CURLINFO_RESPONSE_CODE, &status);
 
+	transfer_stats = TransferStats();
+	curl_easy_getinfo(easyhandle,
+		CURLINFO_NAMELOOKUP_TIME,
+		&transfer_stats.namelookup);
+	curl_easy_getinfo(easyhandle,
+		CURLINFO_CONNECT_TIME,
+		&transfer_stats.connect);
+	curl_easy_getinfo(easyhandle,
+		CURLINFO_APPCONNECT_TIME,
+		&transfer_stats.appconnect);
+	curl_easy_getinfo(easyhandle,
+		CURLINFO_STARTTRANSFER_TIME,
+		&transfer_stats.starttransfer);
+	curl_easy_getinfo(easyhandle,
+		CURLINFO_TOTAL_TIME,
+		&transfer_stats.total);
+	transfer_stats.size =
+		parse_while_downloading ? streaming.received : buf.length();
+
 	curl_easy_reset(easyhandle);
 	if (cookie_cache != "") {
 		curl_easy_setopt(
@@ -218,7 +283,22 @@ Feed Parser::parse_url(const std::string& url,
 		curl_easy_cleanup(easyhandle);
 	}
 
-	if (ret != 0) {
+	// A parse error aborts the transfer, so it takes precedence over
+	// the resulting curl error
+	if (streaming.error) {
+		std::rethrow_exception(streaming.error);
+	}
+
+	const bool stopped = parse_while_downloading && stream.stopped();
+	if (stopped) {
+		LOG(Level::INFO,
+			"Parser::parse_url: stopped downloading %s after %" PRIu64
+			" bytes, as requested by the item handler",
+			url,
+			static_cast<uint64_t>(streaming.received));
+	}
+
+	if (ret != 0 && !stopped) {
 		LOG(Level::ERROR,
 			"rsspp::Parser::parse_url: curl_easy_perform returned "
 			"err "
@@ -240,6 +320,21 @@ Feed Parser::parse_url(const std::string& url,
 		throw Exception(msg);
 	}
 
+	if (parse_while_downloading) {
+		LOG(Level::INFO,
+			"Parser::parse_url: parsed %" PRIu64 " bytes of %s while "
+			"downloading",
+			static_cast<uint64_t>(streaming.received),
+			url);
+		if (streaming.received == 0) {
+			return Feed();
+		}
+
+		Feed f = stream.finish();
+		LOG(Level::INFO, "Parser::parse_url: encoding = %s", f.encoding);
+		return f;
+	}
+
 	LOG(Level::INFO,
 		"Parser::parse_url: retrieved data for %s: %s",
 		url,
@@ -256,6 +351,19 @@ Feed Parser::parse_url(const std::string& url,
 }
 
 Feed Parser::parse_buffer(const std::string& buffer, const std::string& url)
+{
+	StreamParser parser(url);
+	parser.set_item_handler(item_handler);
+	parser.parse_chunk(buffer.c_str(), buffer.length());
+	Feed f = parser.finish();
+
+	LOG(Level::INFO, "Parser::parse_buffer: encoding = %s", f.encoding);
+
+	return f;
+}
+
+Feed Parser::parse_buffer_dom(const std::string& buffer,
+	const std::string& url)
 {
 	doc = xmlReadMemory(buffer.c_str(),
 			buffer.length(),
@@ -274,26 +382,34 @@ Feed Parser::parse_buffer(const std::string& buffer, const std::string& url)
 		f.encoding = (const char*)doc->encoding;
 	}
 
-	LOG(Level::INFO, "Parser::parse_buffer: encoding = %s", f.encoding);
+	LOG(Level::INFO, "Parser::parse_buffer_dom: encoding = %s", f.encoding);
 
 	return f;
 }
 
 Feed Parser::parse_file(const std::string& filename)
 {
-	doc = xmlReadFile(filename.c_str(),
-			nullptr,
-			XML_PARSE_RECOVER | XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
-	xmlNode* root_element = xmlDocGetRootElement(doc);
-
-	if (root_element == nullptr) {
+	std::ifstream file(filename, std::ios::in | std::ios::binary);
+	if (!file.is_open()) {
 		throw Exception(_("could not parse file"));
 	}
 
-	Feed f = parse_xmlnode(root_element);
+	StreamParser parser(filename);
+	parser.set_item_handler(item_handler);
+	char buf[16384];
+	while (!parser.stopped() &&
+		(file.read(buf, sizeof(buf)) || file.gcount() > 0)) {
+		parser.parse_chunk(buf, file.gcount());
+	}
 
-	if (doc->encoding) {
-		f.encoding = (const char*)doc->encoding;
+	Feed f;
+	try {
+		f = parser.finish();
+	} catch (const Exception&) {
+		if (!parser.found_root()) {
+			throw Exception(_("could not parse file"));
+		}
+		throw;
 	}
 
 	LOG(Level::INFO, "Parser::parse_file: encoding = %s", f.encoding);
@@ -307,67 +423,7 @@ Feed Parser::parse_xmlnode(xmlNode* node)
 
 	if (node) {
 		if (node->name && node->type == XML_ELEMENT_NODE) {
-			if (strcmp((const char*)node->name, "rss") == 0) {
-				const char* version = (const char*)xmlGetProp(
-						node, (const xmlChar*)"version");
-				if (!version) {
-					xmlFree((void*)version);
-					throw Exception(_("no RSS version"));
-				}
-				if (strcmp(version, "0.91") == 0) {
-					f.rss_version = Feed::RSS_0_91;
-				} else if (strcmp(version, "0.92") == 0) {
-					f.rss_version = Feed::RSS_0_92;
-				} else if (strcmp(version, "0.94") == 0) {
-					f.rss_version = Feed::RSS_0_94;
-				} else if (strcmp(version, "2.0") == 0 ||
-					strcmp(version, "2") == 0) {
-					f.rss_version = Feed::RSS_2_0;
-				} else if (strcmp(version, "1.0") == 0) {
-					f.rss_version = Feed::RSS_0_91;
-				} else {
-					xmlFree((void*)version);
-					throw Exception(
-						_("invalid RSS version"));
-				}
-				xmlFree((void*)version);
-			} else if (strcmp((const char*)node->name, "RDF") ==
-				0) {
-				f.rss_version = Feed::RSS_1_0;
-			} else if (strcmp((const char*)node->name, "feed") ==
-				0) {
-				if (node->ns && node->ns->href) {
-					if (strcmp((const char*)node->ns->href,
-							ATOM_0_3_URI) == 0) {
-						f.rss_version = Feed::ATOM_0_3;
-					} else if (strcmp((const char*)node->ns
-							->href,
-							ATOM_1_0_URI) == 0) {
-						f.rss_version = Feed::ATOM_1_0;
-					} else {
-						const char* version = (const char*)xmlGetProp(node, (const xmlChar*)"version");
-						if (!version) {
-							xmlFree((void*)version);
-							throw Exception(_(
-									"invalid Atom "
-									"version"));
-						}
-						if (strcmp(version, "0.3") ==
-							0) {
-							xmlFree((void*)version);
-							f.rss_version =
-								Feed::ATOM_0_3_NONS;
-						} else {
-							xmlFree((void*)version);
-							throw Exception(_(
-									"invalid Atom "
-									"version"));
-						}
-					}
-				} else {
-					throw Exception(_("no Atom version"));
-				}
-			}
+			RssParserFactory::detect_version(f, node);
 
 			std::shared_ptr<RssParser> parser =
 				RssParserFactory::get_object(f, doc);
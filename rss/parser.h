@@ -7,9 +7,24 @@
 
 #include "remoteapi.h"
 #include "feed.h"
+#include "streamparser.h"
 
 namespace rsspp {
 
+/// \brief Timings that libcurl reported for the last transfer.
+///
+/// All times are in seconds, measured from the start of the transfer (i.e.
+/// they are cumulative, as returned by `CURLINFO_*_TIME`). `size` is the
+/// length of the response body after content decoding.
+struct TransferStats {
+	double namelookup = 0;
+	double connect = 0;
+	double appconnect = 0;
+	double starttransfer = 0;
+	double total = 0;
+	size_t size = 0;
+};
+
 class Parser {
 public:
 	Parser(unsigned int timeout = 30,
@@ -25,8 +40,21 @@ public:
 		newsboat::RemoteApi* api = 0,
 		const std::string& cookie_cache = "",
 		CURL* ehandle = 0);
+
+	/// \brief Parses a feed from \a buffer.
+	///
+	/// Uses StreamParser, so the document tree is never built in full.
 	Feed parse_buffer(const std::string& buffer,
 		const std::string& url = "");
+
+	/// \brief Parses a feed from \a buffer by building the whole
+	/// document tree first.
+	///
+	/// Produces the same result as parse_buffer(), but needs several times
+	/// more memory; kept as a reference for tests and benchmarks.
+	Feed parse_buffer_dom(const std::string& buffer,
+		const std::string& url = "");
+
 	Feed parse_file(const std::string& filename);
 	time_t get_last_modified()
 	{
@@ -36,6 +64,27 @@ public:
 	{
 		return et;
 	}
+	const TransferStats& get_transfer_stats() const
+	{
+		return transfer_stats;
+	}
+
+	/// \brief Makes parse_url() pass the body to StreamParser as it
+	/// arrives, instead of buffering it and parsing it afterwards.
+	void set_parse_while_downloading(bool enabled)
+	{
+		parse_while_downloading = enabled;
+	}
+
+	/// \brief Passes every item to \a handler as soon as it's parsed, and
+	/// stops parsing (and downloading) once the handler returns false.
+	///
+	/// The feed returned in that case only contains the items up to and
+	/// including the one that stopped the parser.
+	void set_item_handler(StreamParser::ItemHandler handler)
+	{
+		item_handler = std::move(handler);
+	}
 
 	static void global_init();
 	static void global_cleanup();
@@ -51,6 +100,9 @@ private:
 	xmlDocPtr doc;
 	time_t lm;
 	std::string et;
+	TransferStats transfer_stats;
+	bool parse_while_downloading;
+	StreamParser::ItemHandler item_handler;
 };
 
 } // namespace rsspp
@@ -15,40 +15,26 @@ using namespace newsboat;
 
 namespace rsspp {
 
-void Rss09xParser::parse_feed(Feed& f, xmlNode* rootNode)
+void Rss09xParser::parse_feed_start(Feed&, xmlNode* rootNode)
 {
-	if (!rootNode) {
-		throw Exception(_("XML root node is NULL"));
-	}
-
 	globalbase = get_prop(rootNode, "base", XML_URI);
+}
 
-	xmlNode* channel = rootNode->children;
-	while (channel && strcmp((const char*)channel->name, "channel") != 0) {
-		channel = channel->next;
-	}
-
-	if (!channel) {
-		throw Exception(_("no RSS channel found"));
-	}
-
-	for (xmlNode* node = channel->children; node != nullptr;
-		node = node->next) {
-		if (node_is(node, "title", ns)) {
-			f.title = get_content(node);
-			f.title_type = "text";
-		} else if (node_is(node, "link", ns)) {
-			f.link = utils::absolute_url(
-					globalbase, get_content(node));
-		} else if (node_is(node, "description", ns)) {
-			f.description = get_content(node);
-		} else if (node_is(node, "language", ns)) {
-			f.language = get_content(node);
-		} else if (node_is(node, "managingEditor", ns)) {
-			f.managingeditor = get_content(node);
-		} else if (node_is(node, "item", ns)) {
-			f.items.push_back(parse_item(node));
-		}
+void Rss09xParser::parse_feed_element(Feed& f, xmlNode* node)
+{
+	if (node_is(node, "title", ns)) {
+		f.title = get_content(node);
+		f.title_type = "text";
+	} else if (node_is(node, "link", ns)) {
+		f.link = utils::absolute_url(globalbase, get_content(node));
+	} else if (node_is(node, "description", ns)) {
+		f.description = get_content(node);
+	} else if (node_is(node, "language", ns)) {
+		f.language = get_content(node);
+	} else if (node_is(node, "managingEditor", ns)) {
+		f.managingeditor = get_content(node);
+	} else if (node_is(node, "item", ns)) {
+		f.items.push_back(parse_item(node));
 	}
 }
 
@@ -11,7 +11,12 @@ class Feed;
 class Item;
 
 struct Rss09xParser : public RssParser {
-	void parse_feed(Feed& f, xmlNode* rootNode) override;
+	void parse_feed_start(Feed& f, xmlNode* rootNode) override;
+	void parse_feed_element(Feed& f, xmlNode* node) override;
+	const char* container_name() const override
+	{
+		return "channel";
+	}
 	explicit Rss09xParser(xmlDocPtr doc)
 		: RssParser(doc)
 		, ns(nullptr)
@@ -10,7 +10,7 @@ namespace rsspp {
 class Feed;
 
 struct Rss10Parser : public RssParser {
-	void parse_feed(Feed& f, xmlNode* rootNode) override;
+	void parse_feed_element(Feed& f, xmlNode* node) override;
 	explicit Rss10Parser(xmlDocPtr doc)
 		: RssParser(doc)
 	{
@@ -15,12 +15,8 @@ using namespace newsboat;
 
 namespace rsspp {
 
-void Rss20Parser::parse_feed(Feed& f, xmlNode* rootNode)
+void Rss20Parser::parse_feed_start(Feed& f, xmlNode* rootNode)
 {
-	if (!rootNode) {
-		throw Exception(_("XML root node is NULL"));
-	}
-
 	if (rootNode->ns) {
 		const char* ns = (const char*)rootNode->ns->href;
 		if (strcmp(ns, RSS20USERLAND_URI) == 0) {
@@ -28,7 +24,7 @@ void Rss20Parser::parse_feed(Feed& f, xmlNode* rootNode)
 		}
 	}
 
-	Rss09xParser::parse_feed(f, rootNode);
+	Rss09xParser::parse_feed_start(f, rootNode);
 }
 
 } // namespace rsspp
@@ -14,7 +14,7 @@ struct Rss20Parser : public Rss09xParser {
 		: Rss09xParser(doc)
 	{
 	}
-	void parse_feed(Feed& f, xmlNode* rootNode) override;
+	void parse_feed_start(Feed& f, xmlNode* rootNode) override;
 	~Rss20Parser() override {}
 };
 
@@ -4,12 +4,47 @@
 #include <ctime>
 #include <libxml/tree.h>
 
+#include "config.h"
 #include "exception.h"
-
 #include "utils.h"
 
 namespace rsspp {
 
+void RssParser::parse_feed(Feed& f, xmlNode* rootNode)
+{
+	if (!rootNode) {
+		throw Exception(_("XML root node is NULL"));
+	}
+
+	parse_feed_start(f, rootNode);
+
+	xmlNode* container = rootNode;
+	const char* name = container_name();
+	if (name != nullptr) {
+		container = rootNode->children;
+		while (container &&
+			strcmp((const char*)container->name, name) != 0) {
+			container = container->next;
+		}
+
+		// Only RSS 0.9x and 2.0 wrap their elements in a <channel>
+		if (!container) {
+			throw Exception(_("no RSS channel found"));
+		}
+	}
+
+	for (xmlNode* node = container->children; node != nullptr;
+		node = node->next) {
+		if (node->type == XML_ELEMENT_NODE) {
+			parse_feed_element(f, node);
+		}
+	}
+}
+
+void RssParser::parse_feed_start(Feed&, xmlNode*)
+{
+}
+
 std::string RssParser::get_content(xmlNode* node)
 {
 	std::string retval;
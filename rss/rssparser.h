@@ -9,7 +9,29 @@ namespace rsspp {
 class Feed;
 
 struct RssParser {
-	virtual void parse_feed(Feed& f, xmlNode* rootNode) = 0;
+	/// \brief Fills \a f from the document rooted at \a rootNode.
+	///
+	/// Calls parse_feed_start() with the root, then parse_feed_element()
+	/// with every element in the container.
+	void parse_feed(Feed& f, xmlNode* rootNode);
+
+	/// \brief Reads feed-wide data from the attributes of \a rootNode.
+	///
+	/// The children of the root might not be parsed yet, so they mustn't be
+	/// accessed.
+	virtual void parse_feed_start(Feed& f, xmlNode* rootNode);
+
+	/// \brief Handles a single, fully parsed child element of the
+	/// container (e.g. an item or the feed's title).
+	virtual void parse_feed_element(Feed& f, xmlNode* node) = 0;
+
+	/// \brief Name of the root's child that contains the feed's elements,
+	/// or nullptr if they are children of the root itself.
+	virtual const char* container_name() const
+	{
+		return nullptr;
+	}
+
 	explicit RssParser(xmlDocPtr d)
 		: doc(d)
 	{
@@ -12,6 +12,13 @@ class Feed;
 
 struct RssParserFactory {
 	static std::shared_ptr<RssParser> get_object(Feed& f, xmlDocPtr doc);
+
+	/// \brief Sets `f.rss_version` based on the name, namespace and
+	/// attributes of the root element \a node.
+	///
+	/// Leaves the version as UNKNOWN if the root isn't recognized, and
+	/// throws if it is, but the version is missing or invalid.
+	static void detect_version(Feed& f, xmlNode* node);
 };
 
 } // namespace rsspp
@@ -0,0 +1,233 @@
+#include "streamparser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <libxml/SAX2.h>
+#include <libxml/tree.h>
+
+#include "config.h"
+#include "exception.h"
+#include "rssparser.h"
+#include "rssparserfactory.h"
+
+namespace {
+
+// libxml2 copies every chunk into its input buffer before parsing it, so
+// big documents are fed piece by piece to keep that buffer small.
+const size_t MAX_CHUNK_SIZE = 64 * 1024;
+
+} // namespace
+
+namespace rsspp {
+
+StreamParser::StreamParser(const std::string& u)
+	: url(u)
+	, ctxt(nullptr)
+	, root(nullptr)
+	, container(nullptr)
+	, depth(0)
+	, stop_requested(false)
+{
+	memset(&sax, 0, sizeof(sax));
+	xmlSAXVersion(&sax, 2);
+	sax.startElementNs = &StreamParser::start_element;
+	sax.endElementNs = &StreamParser::end_element;
+}
+
+StreamParser::~StreamParser()
+{
+	if (ctxt) {
+		xmlDocPtr doc = ctxt->myDoc;
+		xmlFreeParserCtxt(ctxt);
+		if (doc) {
+			xmlFreeDoc(doc);
+		}
+	}
+}
+
+void StreamParser::set_item_handler(ItemHandler handler)
+{
+	item_handler = std::move(handler);
+}
+
+void StreamParser::parse_chunk(const char* data, size_t length)
+{
+	if (ctxt == nullptr) {
+		ctxt = xmlCreatePushParserCtxt(&sax,
+				nullptr,
+				nullptr,
+				0,
+				url.empty() ? nullptr : url.c_str());
+		if (ctxt == nullptr) {
+			throw Exception(_("could not parse buffer"));
+		}
+		ctxt->_private = this;
+		xmlCtxtUseOptions(ctxt,
+			XML_PARSE_RECOVER | XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+	}
+
+	while (length > 0 && !stop_requested && !error) {
+		const size_t size = std::min(length, MAX_CHUNK_SIZE);
+		xmlParseChunk(ctxt, data, size, 0);
+		data += size;
+		length -= size;
+	}
+	rethrow_error();
+}
+
+Feed StreamParser::finish()
+{
+	if (ctxt && !stop_requested) {
+		xmlParseChunk(ctxt, nullptr, 0, 1);
+	}
+	rethrow_error();
+
+	if (root == nullptr) {
+		throw Exception(_("could not parse buffer"));
+	}
+
+	// Only RSS 0.9x and 2.0 wrap their elements in a <channel>
+	if (container == nullptr && !stop_requested) {
+		throw Exception(_("no RSS channel found"));
+	}
+
+	if (ctxt->myDoc && ctxt->myDoc->encoding) {
+		feed.encoding = (const char*)ctxt->myDoc->encoding;
+	}
+
+	return std::move(feed);
+}
+
+void StreamParser::start_element(void* ctx,
+	const xmlChar* localname,
+	const xmlChar* prefix,
+	const xmlChar* URI,
+	int nb_namespaces,
+	const xmlChar** namespaces,
+	int nb_attributes,
+	int nb_defaulted,
+	const xmlChar** attributes)
+{
+	xmlSAX2StartElementNs(ctx,
+		localname,
+		prefix,
+		URI,
+		nb_namespaces,
+		namespaces,
+		nb_attributes,
+		nb_defaulted,
+		attributes);
+
+	xmlParserCtxtPtr ctxt = static_cast<xmlParserCtxtPtr>(ctx);
+	StreamParser* self = static_cast<StreamParser*>(ctxt->_private);
+	self->depth++;
+
+	// Exceptions mustn't propagate through libxml2's C code, so we stop
+	// the parser and rethrow once it returns control to us.
+	try {
+		self->handle_start(ctxt->node);
+	} catch (...) {
+		self->abort(std::current_exception());
+	}
+}
+
+void StreamParser::end_element(void* ctx,
+	const xmlChar* localname,
+	const xmlChar* prefix,
+	const xmlChar* URI)
+{
+	xmlParserCtxtPtr ctxt = static_cast<xmlParserCtxtPtr>(ctx);
+	StreamParser* self = static_cast<StreamParser*>(ctxt->_private);
+	xmlNode* node = ctxt->node;
+
+	xmlSAX2EndElementNs(ctx, localname, prefix, URI);
+	self->depth--;
+
+	try {
+		self->handle_end(node);
+	} catch (...) {
+		self->abort(std::current_exception());
+	}
+}
+
+void StreamParser::handle_start(xmlNode* node)
+{
+	if (node == nullptr) {
+		return;
+	}
+
+	if (depth == 1) {
+		root = node;
+		RssParserFactory::detect_version(feed, root);
+		parser = RssParserFactory::get_object(feed, ctxt->myDoc);
+		parser->parse_feed_start(feed, root);
+		if (parser->container_name() == nullptr) {
+			container = root;
+		}
+	} else if (depth == 2 && container == nullptr && parser &&
+		strcmp((const char*)node->name, parser->container_name()) == 0) {
+		container = node;
+	}
+}
+
+void StreamParser::handle_end(xmlNode* node)
+{
+	if (node == nullptr || parser == nullptr) {
+		return;
+	}
+
+	if (container && node->parent == container) {
+		const auto items_before = feed.items.size();
+		parser->parse_feed_element(feed, node);
+		free_children(container);
+
+		if (item_handler && feed.items.size() > items_before &&
+			!item_handler(feed.items.back())) {
+			stop_requested = true;
+			xmlStopParser(ctxt);
+		}
+	} else if (node->parent == root && node != container) {
+		// Elements outside of the RSS channel are ignored; drop them,
+		// along with the whitespace around them.
+		xmlNode* child = root->children;
+		while (child != nullptr) {
+			xmlNode* next = child->next;
+			if (child != container) {
+				xmlUnlinkNode(child);
+				xmlFreeNode(child);
+			}
+			child = next;
+		}
+	}
+}
+
+void StreamParser::abort(std::exception_ptr e)
+{
+	if (!error) {
+		error = e;
+	}
+	xmlStopParser(ctxt);
+}
+
+void StreamParser::rethrow_error()
+{
+	if (error) {
+		std::exception_ptr e = error;
+		error = nullptr;
+		std::rethrow_exception(e);
+	}
+}
+
+void StreamParser::free_children(xmlNode* node)
+{
+	// All of the children are freed, not just the element that was
+	// handled: if a text node were left last, libxml2 would try to append
+	// the following text to it using stale length bookkeeping.
+	while (node->children != nullptr) {
+		xmlNode* child = node->children;
+		xmlUnlinkNode(child);
+		xmlFreeNode(child);
+	}
+}
+
+} // namespace rsspp
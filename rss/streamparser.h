@@ -0,0 +1,98 @@
+#ifndef NEWSBOAT_RSSPP_STREAMPARSER_H_
+#define NEWSBOAT_RSSPP_STREAMPARSER_H_
+
+#include <exception>
+#include <functional>
+#include <libxml/parser.h>
+#include <memory>
+#include <string>
+
+#include "feed.h"
+
+namespace rsspp {
+
+struct RssParser;
+
+/// \brief Incremental feed parser.
+///
+/// The document is fed to libxml2's push parser in chunks, and the usual
+/// SAX2 handlers build the tree. As soon as a child of the feed (or of the
+/// RSS channel) is complete, it's handed over to the format parser and
+/// freed. The tree thus never holds more than one item at a time, and
+/// peak memory doesn't grow with the size of the feed.
+///
+/// The output is the same as that of parsing the whole document into a DOM
+/// and calling RssParser::parse_feed() on it.
+class StreamParser {
+public:
+	/// \brief Called with every item as soon as it's parsed. Parsing
+	/// stops if it returns false.
+	using ItemHandler = std::function<bool(const Item&)>;
+
+	explicit StreamParser(const std::string& url = "");
+	~StreamParser();
+
+	void set_item_handler(ItemHandler handler);
+
+	/// \brief Parses the next \a length bytes of the document.
+	///
+	/// Throws rsspp::Exception if the feed is invalid or unsupported.
+	void parse_chunk(const char* data, size_t length);
+
+	/// \brief Tells the parser that the whole document has been passed to
+	/// parse_chunk(), and returns the feed.
+	///
+	/// Throws rsspp::Exception if no root element was found.
+	Feed finish();
+
+	/// \brief Returns true if the document's root element was seen.
+	bool found_root() const
+	{
+		return root != nullptr;
+	}
+
+	/// \brief Returns true if the item handler asked to stop parsing.
+	bool stopped() const
+	{
+		return stop_requested;
+	}
+
+private:
+	static void start_element(void* ctx,
+		const xmlChar* localname,
+		const xmlChar* prefix,
+		const xmlChar* URI,
+		int nb_namespaces,
+		const xmlChar** namespaces,
+		int nb_attributes,
+		int nb_defaulted,
+		const xmlChar** attributes);
+	static void end_element(void* ctx,
+		const xmlChar* localname,
+		const xmlChar* prefix,
+		const xmlChar* URI);
+
+	void handle_start(xmlNode* node);
+	void handle_end(xmlNode* node);
+	void abort(std::exception_ptr e);
+	void rethrow_error();
+
+	static void free_children(xmlNode* node);
+
+	const std::string url;
+	xmlSAXHandler sax;
+	xmlParserCtxtPtr ctxt;
+	std::shared_ptr<RssParser> parser;
+	ItemHandler item_handler;
+
+	Feed feed;
+	xmlNode* root;
+	xmlNode* container;
+	unsigned int depth;
+	bool stop_requested;
+	std::exception_ptr error;
+};
+
+} // namespace rsspp
+
+#endif /* NEWSBOAT_RSSPP_STREAMPARSER_H_ */
@@ -1,6 +1,6 @@
 use crate::abort_on_panic;
 use libc::{c_char, c_void};
-use libnewsboat::fmtstrformatter::FmtStrFormatter;
+use libnewsboat::fmtstrformatter::{FmtStrFormatter, FormatTemplate};
 use std::ffi::{CStr, CString};
 use std::mem;
 
@@ -72,3 +72,69 @@ pub unsafe extern "C" fn rs_fmtstrformatter_do_format(
         result
     })
 }
+
+#[no_mangle]
+pub unsafe extern "C" fn rs_fmtstrformatter_format_template(
+    fmt: *mut c_void,
+    template: *mut c_void,
+    width: u32,
+) -> *mut c_char {
+    abort_on_panic(|| {
+        let fmt = {
+            assert!(!fmt.is_null());
+            Box::from_raw(fmt as *mut FmtStrFormatter)
+        };
+        let template = {
+            assert!(!template.is_null());
+            Box::from_raw(template as *mut FormatTemplate)
+        };
+        let result = fmt.format_template(&template, width);
+        let result = CString::new(result).unwrap().into_raw();
+
+        // Do not deallocate the objects - C still has pointers to them
+        mem::forget(fmt);
+        mem::forget(template);
+
+        result
+    })
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn rs_fmtstrtemplate_new(format: *const c_char) -> *mut c_void {
+    abort_on_panic(|| {
+        let format = {
+            assert!(!format.is_null());
+            CStr::from_ptr(format)
+        }
+        .to_str()
+        .expect("format contained invalid UTF-8");
+        Box::into_raw(Box::new(FormatTemplate::new(format))) as *mut c_void
+    })
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn rs_fmtstrtemplate_free(template: *mut c_void) {
+    abort_on_panic(|| {
+        if template.is_null() {
+            return;
+        }
+        Box::from_raw(template as *mut FormatTemplate);
+    })
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn rs_fmtstrtemplate_keys(template: *mut c_void) -> *mut c_char {
+    abort_on_panic(|| {
+        let template = {
+            assert!(!template.is_null());
+            Box::from_raw(template as *mut FormatTemplate)
+        };
+        let keys: String = template.keys().iter().collect();
+        let result = CString::new(keys).unwrap().into_raw();
+
+        // Do not deallocate the object - C still has a pointer to it
+        mem::forget(template);
+
+        result
+    })
+}
@@ -58,6 +58,82 @@ pub struct FmtStrFormatter {
     fmts: BTreeMap<char, String>,
 }
 
+/// A format string that was parsed once, so that it can be used to format many lines.
+///
+/// The template also knows which keys the format string refers to, so values of other keys don't
+/// have to be computed at all:
+/// ```
+/// use libnewsboat::fmtstrformatter::*;
+///
+/// let template = FormatTemplate::new("%t%?a? (%a)?");
+/// assert!(template.uses('t'));
+/// assert!(template.uses('a'));
+/// assert!(!template.uses('L'));
+///
+/// let mut fmt = FmtStrFormatter::new();
+/// fmt.register_fmt('a', "John Doe".to_string());
+/// fmt.register_fmt('t', "How I Spent My Summer".to_string());
+/// assert_eq!(
+///     fmt.format_template(&template, 0),
+///     "How I Spent My Summer (John Doe)"
+/// );
+/// ```
+pub struct FormatTemplate {
+    ops: Vec<Op>,
+    /// Keys referred to by formats and conditionals, sorted and deduplicated.
+    keys: Vec<char>,
+}
+
+/// Like `parser::Specifier`, but owns its text, so that it can outlive the format string.
+enum Op {
+    Spacing(char),
+    Format(char, Padding),
+    Text(String),
+    Conditional(char, Vec<Op>, Option<Vec<Op>>),
+}
+
+fn compile(specifiers: &[Specifier], keys: &mut Vec<char>) -> Vec<Op> {
+    specifiers
+        .iter()
+        .map(|specifier| match *specifier {
+            Specifier::Spacing(c) => Op::Spacing(c),
+            Specifier::Format(c, padding) => {
+                keys.push(c);
+                Op::Format(c, padding)
+            }
+            Specifier::Text(s) => Op::Text(s.to_string()),
+            Specifier::Conditional(cond, ref then, ref els) => {
+                keys.push(cond);
+                let then = compile(then, keys);
+                let els = els.as_ref().map(|els| compile(els, keys));
+                Op::Conditional(cond, then, els)
+            }
+        })
+        .collect()
+}
+
+impl FormatTemplate {
+    /// Parses the format string.
+    pub fn new(format: &str) -> FormatTemplate {
+        let mut keys = Vec::new();
+        let ops = compile(&parse(format), &mut keys);
+        keys.sort_unstable();
+        keys.dedup();
+        FormatTemplate { ops, keys }
+    }
+
+    /// Returns `true` if the format string refers to the key, i.e. if its value is needed to
+    /// format a line.
+    pub fn uses(&self, key: char) -> bool {
+        self.keys.binary_search(&key).is_ok()
+    }
+
+    /// Returns all the keys the format string refers to, sorted.
+    pub fn keys(&self) -> &[char] {
+        &self.keys
+    }
+}
+
 impl FmtStrFormatter {
     /// Construct new `FmtStrFormatter` that contains no keys and no values.
     pub fn new() -> FmtStrFormatter {
@@ -73,11 +149,15 @@ impl FmtStrFormatter {
 
     /// Takes a format string and replaces format specifiers with their values.
     pub fn do_format(&self, format: &str, width: u32) -> String {
-        let ast = parse(format);
-        self.formatting_helper(&ast, width)
+        self.format_template(&FormatTemplate::new(format), width)
     }
 
-    fn format_spacing(&self, c: char, rest: &[Specifier], width: u32, result: &mut LimitedString) {
+    /// Like `do_format`, but with a format string that was parsed already.
+    pub fn format_template(&self, template: &FormatTemplate, width: u32) -> String {
+        self.formatting_helper(&template.ops, width)
+    }
+
+    fn format_spacing(&self, c: char, rest: &[Op], width: u32, result: &mut LimitedString) {
         let rest = self.formatting_helper(rest, 0);
         if width == 0 {
             result.push(c);
@@ -146,8 +226,8 @@ impl FmtStrFormatter {
     fn format_conditional(
         &self,
         cond: char,
-        then: &[Specifier],
-        els: &Option<Vec<Specifier>>,
+        then: &[Op],
+        els: &Option<Vec<Op>>,
         width: u32,
         result: &mut LimitedString,
     ) {
@@ -163,7 +243,7 @@ impl FmtStrFormatter {
         }
     }
 
-    fn formatting_helper(&self, format_ast: &[Specifier], width: u32) -> String {
+    fn formatting_helper(&self, format_ast: &[Op], width: u32) -> String {
         let mut result = LimitedString::new(if width == 0 {
             None
         } else {
@@ -172,18 +252,18 @@ impl FmtStrFormatter {
 
         for (i, specifier) in format_ast.iter().enumerate() {
             match *specifier {
-                Specifier::Spacing(c) => {
+                Op::Spacing(c) => {
                     let rest = &format_ast[i + 1..];
                     self.format_spacing(c, rest, width, &mut result);
                     // format_spacing will also format the rest of the string, so quit the loop
                     break;
                 }
 
-                Specifier::Format(c, ref padding) => {
+                Op::Format(c, ref padding) => {
                     self.format_format(c, &padding, width, &mut result);
                 }
 
-                Specifier::Text(s) => {
+                Op::Text(ref s) => {
                     if width == 0 {
                         result.push_str(s);
                     } else {
@@ -197,7 +277,7 @@ impl FmtStrFormatter {
                     }
                 }
 
-                Specifier::Conditional(cond, ref then, ref els) => {
+                Op::Conditional(cond, ref then, ref els) => {
                     self.format_conditional(cond, &then, &els, width, &mut result)
                 }
             }
@@ -617,6 +697,48 @@ mod tests {
         assert_eq!(fmt.do_format("%x? %y", 0), "What's the ultimate answer? 42");
     }
 
+    #[test]
+    fn t_template_knows_which_keys_the_format_refers_to() {
+        let template = FormatTemplate::new("%a %?b?%c&%-4d?%>x%=5e%%");
+        assert_eq!(template.keys(), &['a', 'b', 'c', 'd', 'e']);
+        assert!(template.uses('a'));
+        assert!(template.uses('e'));
+        assert!(!template.uses('x'));
+        assert!(!template.uses('%'));
+
+        assert!(FormatTemplate::new("").keys().is_empty());
+        assert!(FormatTemplate::new("100%% text").keys().is_empty());
+        assert_eq!(FormatTemplate::new("%t %t %-4t").keys(), &['t']);
+    }
+
+    #[test]
+    fn t_format_template_formats_like_do_format() {
+        let mut fmt = FmtStrFormatter::new();
+        fmt.register_fmt('a', "AAA".to_string());
+        fmt.register_fmt('b', "буква".to_string());
+        fmt.register_fmt('c', " ".to_string());
+
+        let formats = [
+            "",
+            "%",
+            "%%",
+            "<%a> <%5b> | %-5c%%",
+            "asdf | %a | %?c?%a%b&%b%a? | qwert",
+            "%?a?[%-4a]&no?",
+            "%a%> %b",
+            "%=10b|%=0a",
+        ];
+        for format in &formats {
+            let template = FormatTemplate::new(format);
+            for &width in &[0, 5, 20] {
+                assert_eq!(
+                    fmt.format_template(&template, width),
+                    fmt.do_format(format, width)
+                );
+            }
+        }
+    }
+
     proptest::proptest! {
         #[test]
         fn does_not_crash_when_formatting_with_no_formats_registered(ref input in "\\PC*") {
@@ -6,7 +6,7 @@ use std::cmp::Ordering;
 use std::str;
 
 /// Describes how formats should be padded: on the left, on the right, or not at all.
-#[derive(PartialEq, Eq, Debug)]
+#[derive(PartialEq, Eq, Debug, Clone, Copy)]
 pub enum Padding {
     /// Do not pad the value.
     None,
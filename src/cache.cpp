@@ -1,5 +1,6 @@
 #include "cache.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <cstdlib>
@@ -15,9 +16,9 @@
 #include "controller.h"
 #include "dbexception.h"
 #include "logger.h"
-#include "matcherexception.h"
 #include "rssfeed.h"
 #include "scopemeasure.h"
+#include "sqlfilter.h"
 #include "strprintf.h"
 #include "utils.h"
 
@@ -249,6 +250,47 @@ static int search_item_callback(void* myfeed,
 	return 0;
 }
 
+static double to_double(const char* str)
+{
+	return str ? std::strtod(str, nullptr) : 0;
+}
+
+static int reload_stats_callback(void* vp, int argc, char** argv,
+	char** /* azColName */)
+{
+	auto* stats = static_cast<std::vector<FeedReloadStats>*>(vp);
+	assert(argc == 19);
+	assert(argv[0] != nullptr);
+
+	FeedReloadStats s;
+	s.rssurl = argv[0];
+	s.reload_count = argv[1] ? utils::to_u(argv[1]) : 0;
+	s.last_reload = argv[2] ? std::strtoll(argv[2], nullptr, 10) : 0;
+
+	auto fill_timings = [&](ReloadTimings& t, int first_column) {
+		t.namelookup = to_double(argv[first_column]);
+		t.connect = to_double(argv[first_column + 1]);
+		t.tls = to_double(argv[first_column + 2]);
+		t.firstbyte = to_double(argv[first_column + 3]);
+		t.transfer = to_double(argv[first_column + 4]);
+		t.parse = to_double(argv[first_column + 5]);
+		t.persist = to_double(argv[first_column + 6]);
+		t.size = static_cast<std::uint64_t>(to_double(argv[first_column + 7]));
+	};
+	fill_timings(s.last, 3);
+	fill_timings(s.average, 11);
+
+	stats->push_back(s);
+	return 0;
+}
+
+static const std::string reload_stats_columns =
+	"rssurl, reload_count, last_reload, "
+	"last_namelookup, last_connect, last_tls, last_firstbyte, "
+	"last_transfer, last_parse, last_persist, last_size, "
+	"avg_namelookup, avg_connect, avg_tls, avg_firstbyte, "
+	"avg_transfer, avg_parse, avg_persist, avg_size";
+
 static int guid_callback(void* myguids, int argc, char** argv,
 	char** /* azColName */)
 {
@@ -273,6 +315,7 @@ Cache::Cache(const std::string& cachefile, ConfigContainer* c)
 
 	populate_tables();
 	set_pragmas();
+	SqlFilter::register_functions(db);
 
 	clean_old_articles();
 
@@ -380,6 +423,33 @@ static const schema_patches schemaPatches{
 
 			"INSERT INTO metadata VALUES ( 2, 11 );"
 		}
+	},
+	{	{2, 22},
+		{
+			"CREATE TABLE reload_stats ( "
+			" rssurl VARCHAR(1024) PRIMARY KEY NOT NULL, "
+			" reload_count INTEGER NOT NULL DEFAULT 0, "
+			" last_reload INTEGER NOT NULL DEFAULT 0, "
+			" last_namelookup REAL NOT NULL DEFAULT 0, "
+			" last_connect REAL NOT NULL DEFAULT 0, "
+			" last_tls REAL NOT NULL DEFAULT 0, "
+			" last_firstbyte REAL NOT NULL DEFAULT 0, "
+			" last_transfer REAL NOT NULL DEFAULT 0, "
+			" last_parse REAL NOT NULL DEFAULT 0, "
+			" last_persist REAL NOT NULL DEFAULT 0, "
+			" last_size INTEGER NOT NULL DEFAULT 0, "
+			" avg_namelookup REAL NOT NULL DEFAULT 0, "
+			" avg_connect REAL NOT NULL DEFAULT 0, "
+			" avg_tls REAL NOT NULL DEFAULT 0, "
+			" avg_firstbyte REAL NOT NULL DEFAULT 0, "
+			" avg_transfer REAL NOT NULL DEFAULT 0, "
+			" avg_parse REAL NOT NULL DEFAULT 0, "
+			" avg_persist REAL NOT NULL DEFAULT 0, "
+			" avg_size REAL NOT NULL DEFAULT 0 );",
+
+			"UPDATE metadata SET db_schema_version_major = 2, "
+			"db_schema_version_minor = 22;"
+		}
 	}};
 
 void Cache::populate_tables()
@@ -590,7 +660,12 @@ std::shared_ptr<RssFeed> Cache::internalize_rssfeed(std::string rssurl,
 			rssurl);
 	run_sql(query, rssfeed_callback, &feed);
 
-	/* ...and then the associated items */
+	/* ...and then the associated items. Ignore rules are evaluated by
+	 * SQLite if they can be, so that ignored items aren't even loaded. */
+	nonstd::optional<std::string> ignore_condition;
+	if (ign != nullptr) {
+		ignore_condition = ign->sql_condition(rssurl, time(nullptr));
+	}
 	query = prepare_query(
 			"SELECT guid, title, author, url, pubDate, length(content), "
 			"unread, "
@@ -598,8 +673,10 @@ std::shared_ptr<RssFeed> Cache::internalize_rssfeed(std::string rssurl,
 			"FROM rss_item "
 			"WHERE feedurl = '%q' "
 			"AND deleted = 0 "
+			"AND NOT %s "
 			"ORDER BY pubDate DESC, id DESC;",
-			rssurl);
+			rssurl,
+			ignore_condition.value_or("0"));
 	run_sql(query, rssitem_callback, &feed);
 
 	auto feed_weak_ptr = std::weak_ptr<RssFeed>(feed);
@@ -609,25 +686,23 @@ std::shared_ptr<RssFeed> Cache::internalize_rssfeed(std::string rssurl,
 		item->set_feedurl(feed->rssurl());
 	}
 
-	if (ign != nullptr) {
-		auto& items = feed->items();
-		items.erase(
-			std::remove_if(
-				items.begin(),
-				items.end(),
-		[&](std::shared_ptr<RssItem> item) -> bool {
-			try
-			{
-				return ign->matches(item.get());
-			} catch (const MatcherException& ex)
-			{
-				LOG(Level::DEBUG,
-					"oops, Matcher exception: %s",
-					ex.what());
-				return false;
+	if (ign != nullptr && !ignore_condition.has_value()) {
+		const auto& items = feed->items();
+		const auto ignored = ign->matching_indices(items);
+		if (!ignored.empty()) {
+			// Goes through the feed, so that it keeps its unread count
+			std::vector<std::shared_ptr<RssItem>> kept;
+			kept.reserve(items.size() - ignored.size());
+			size_t next_ignored = 0;
+			for (size_t i = 0; i < items.size(); ++i) {
+				if (next_ignored < ignored.size() && ignored[next_ignored] == i) {
+					next_ignored++;
+				} else {
+					kept.push_back(items[i]);
+				}
 			}
-		}),
-		items.end());
+			feed->set_items(kept);
+		}
 	}
 
 	const unsigned int max_items = cfg->get_configvalue_as_int("max-items");
@@ -776,11 +851,17 @@ void Cache::cleanup_cache(std::vector<std::shared_ptr<RssFeed>> feeds)
 		cleanup_rss_items_statement.append(list);
 		cleanup_rss_items_statement.push_back(';');
 
+		std::string cleanup_reload_stats_statement(
+			"DELETE FROM reload_stats WHERE rssurl NOT IN ");
+		cleanup_reload_stats_statement.append(list);
+		cleanup_reload_stats_statement.push_back(';');
+
 		std::string cleanup_read_items_statement(
 			"UPDATE rss_item SET deleted = 1 WHERE unread = 0");
 
 		run_sql(cleanup_rss_feeds_statement);
 		run_sql(cleanup_rss_items_statement);
+		run_sql(cleanup_reload_stats_statement);
 		if (cfg->get_configvalue_as_bool(
 				"delete-read-articles-on-quit")) {
 			run_sql(cleanup_read_items_statement);
@@ -961,14 +1042,14 @@ std::string Cache::prepare_query(const std::string& format)
 template<typename... Args>
 std::string Cache::prepare_query(const std::string& format,
 	const std::string& argument,
-	Args... args)
+	const Args& ... args)
 {
 	return prepare_query(format, argument.c_str(), args...);
 }
 
 template<typename T, typename... Args>
 std::string Cache::prepare_query(const std::string& format, const T& argument,
-	Args... args)
+	const Args& ... args)
 {
 	std::string local_format, remaining_format;
 	std::tie(local_format, remaining_format) =
@@ -1119,6 +1200,120 @@ std::string Cache::fetch_description(const RssItem& item)
 	return description;
 }
 
+std::unordered_map<std::string, std::unordered_set<std::string>>
+Cache::fetch_matching_guids(const std::string& condition,
+	const std::vector<std::string>& feedurls)
+{
+	ScopeMeasure sm("Cache::fetch_matching_guids");
+
+	std::vector<std::string> quoted_feedurls;
+	for (const auto& feedurl : feedurls) {
+		quoted_feedurls.push_back(prepare_query("'%q'", feedurl));
+	}
+
+	const std::string query = prepare_query(
+			"SELECT feedurl, guid FROM rss_item "
+			"WHERE deleted = 0 AND feedurl IN (%s) AND %s;",
+			utils::join(quoted_feedurls, ", "),
+			condition);
+
+	std::unordered_map<std::string, std::unordered_set<std::string>> guids;
+	auto store_guid = [](void* g, int, char** argv, char**) -> int {
+		auto& guids = *static_cast<std::unordered_map<std::string,
+			 std::unordered_set<std::string>>*>(g);
+		guids[argv[0]].emplace(argv[1]);
+		return 0;
+	};
+
+	// Like fetch_description(), whose per-item queries this replaces, this
+	// runs a single read without taking the cache lock, so callers may hold
+	// feeds' item locks
+	run_sql(query, store_guid, &guids);
+	return guids;
+}
+
+void Cache::update_reload_stats(const std::string& rssurl,
+	const ReloadTimings& timings)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+
+	std::vector<FeedReloadStats> existing;
+	run_sql(prepare_query("SELECT %s FROM reload_stats WHERE rssurl = '%q';",
+			reload_stats_columns,
+			rssurl),
+		reload_stats_callback,
+		&existing);
+
+	FeedReloadStats stats;
+	if (!existing.empty()) {
+		stats = existing.front();
+	}
+	stats.rssurl = rssurl;
+	stats.reload_count++;
+	stats.last_reload = time(nullptr);
+	stats.last = timings;
+
+	// For the first few reloads this is a plain cumulative average; after
+	// that, it turns into an exponential moving average that mostly reflects
+	// the last RELOAD_STATS_WINDOW reloads.
+	const unsigned int RELOAD_STATS_WINDOW = 10;
+	const double n = std::min(stats.reload_count, RELOAD_STATS_WINDOW);
+	auto roll = [n](double average, double value) {
+		return average + (value - average) / n;
+	};
+	ReloadTimings& avg = stats.average;
+	avg.namelookup = roll(avg.namelookup, timings.namelookup);
+	avg.connect = roll(avg.connect, timings.connect);
+	avg.tls = roll(avg.tls, timings.tls);
+	avg.firstbyte = roll(avg.firstbyte, timings.firstbyte);
+	avg.transfer = roll(avg.transfer, timings.transfer);
+	avg.parse = roll(avg.parse, timings.parse);
+	avg.persist = roll(avg.persist, timings.persist);
+	avg.size = static_cast<std::uint64_t>(roll(avg.size, timings.size));
+
+	const std::string query = prepare_query(
+			"INSERT OR REPLACE INTO reload_stats (%s) "
+			"VALUES ('%q', %u, %lld, "
+			"%f, %f, %f, %f, %f, %f, %f, %llu, "
+			"%f, %f, %f, %f, %f, %f, %f, %llu);",
+			reload_stats_columns,
+			stats.rssurl,
+			stats.reload_count,
+			static_cast<long long>(stats.last_reload),
+			stats.last.namelookup,
+			stats.last.connect,
+			stats.last.tls,
+			stats.last.firstbyte,
+			stats.last.transfer,
+			stats.last.parse,
+			stats.last.persist,
+			static_cast<unsigned long long>(stats.last.size),
+			avg.namelookup,
+			avg.connect,
+			avg.tls,
+			avg.firstbyte,
+			avg.transfer,
+			avg.parse,
+			avg.persist,
+			static_cast<unsigned long long>(avg.size));
+	run_sql(query);
+}
+
+std::vector<FeedReloadStats> Cache::fetch_reload_stats()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+
+	std::vector<FeedReloadStats> stats;
+	run_sql(prepare_query("SELECT %s FROM reload_stats "
+			"ORDER BY (avg_namelookup + avg_connect + avg_tls "
+			"+ avg_firstbyte + avg_transfer + avg_parse + avg_persist) "
+			"DESC;",
+			reload_stats_columns),
+		reload_stats_callback,
+		&stats);
+	return stats;
+}
+
 SchemaVersion Cache::get_schema_version()
 {
 	sqlite3_stmt* stmt{};
@@ -165,6 +165,7 @@ ConfigContainer::ConfigContainer()
 		ConfigData("false", ConfigDataType::BOOL)},
 	{"opml-url", ConfigData("", ConfigDataType::STR, true)},
 	{"pager", ConfigData("internal", ConfigDataType::PATH)},
+	{"parse-while-downloading", ConfigData("yes", ConfigDataType::BOOL)},
 	{"player", ConfigData("", ConfigDataType::PATH)},
 	{
 		"podcast-auto-enqueue",
@@ -297,6 +298,12 @@ ConfigContainer::ConfigContainer()
 		ConfigData(_("%N %V - Article '%T' (%u unread, %t "
 				"total)"),
 			ConfigDataType::STR)},
+	{
+		"filterstats-title-format",
+		ConfigData(_("%N %V - Filter Statistics"), ConfigDataType::STR)},
+	{
+		"reloadstats-title-format",
+		ConfigData(_("%N %V - Reload Statistics"), ConfigDataType::STR)},
 	{
 		"searchresult-title-format",
 		ConfigData(_("%N %V - Search results (%u unread, %t total)"
@@ -1,7 +1,9 @@
 #include "controller.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
+#include <cinttypes>
 #include <cstdlib>
 #include <ctime>
 #include <curl/curl.h>
@@ -30,6 +32,7 @@
 #include "configexception.h"
 #include "configparser.h"
 #include "configpaths.h"
+#include "daemon.h"
 #include "dbexception.h"
 #include "downloadthread.h"
 #include "exception.h"
@@ -39,8 +42,10 @@
 #include "globals.h"
 #include "inoreaderapi.h"
 #include "inoreaderurlreader.h"
+#include "ipc.h"
 #include "itemrenderer.h"
 #include "logger.h"
+#include "matcherprofiler.h"
 #include "minifluxapi.h"
 #include "minifluxurlreader.h"
 #include "newsblurapi.h"
@@ -62,6 +67,14 @@
 #include "utils.h"
 #include "view.h"
 
+namespace {
+
+const char* const FILTER_STATS_HEADER =
+	"# time_ms\tevaluations\tmatches\tdescription_fetches\tattributes"
+	"\texpression";
+
+} // namespace
+
 namespace newsboat {
 
 void sighup_action(int /* sig */)
@@ -89,6 +102,8 @@ Controller::Controller(ConfigPaths& configpaths)
 
 Controller::~Controller()
 {
+	MatcherProfiler::get_instance().log_summary();
+
 	delete rsscache;
 	delete urlcfg;
 	delete api;
@@ -142,6 +157,19 @@ int Controller::run(const CliArgsParser& args)
 
 	LOG(Level::INFO, "nl_langinfo(CODESET): %s", nl_langinfo(CODESET));
 
+	// The daemon holds the lock, so commands have to be passed to it
+	// rather than executed here.
+	daemon_socket = configpaths.cache_file() + ".sock";
+	if (args.cmds_to_execute().has_value()) {
+		const auto& cmds = args.cmds_to_execute().value();
+		if (std::find(cmds.begin(), cmds.end(), "daemon") == cmds.end()) {
+			IpcClient client(daemon_socket);
+			if (client.connect()) {
+				return execute_commands_via_daemon(client, cmds);
+			}
+		}
+	}
+
 	if (!args.do_export()) {
 		if (!args.silent())
 			std::cout << strprintf::fmt(_("Starting %s %s..."),
@@ -180,6 +208,7 @@ int Controller::run(const CliArgsParser& args)
 	cfgparser.register_handler("ignore-article", ign);
 	cfgparser.register_handler("always-download", ign);
 	cfgparser.register_handler("reset-unread-on-update", ign);
+	cfgparser.register_handler("stop-at-known-articles", ign);
 
 	cfgparser.register_handler("define-filter", filters);
 	cfgparser.register_handler("highlight", rxman);
@@ -494,8 +523,7 @@ int Controller::run(const CliArgsParser& args)
 	v->set_cache(rsscache);
 
 	if (args.cmds_to_execute().has_value()) {
-		execute_commands(args.cmds_to_execute().value());
-		return EXIT_SUCCESS;
+		return execute_commands(args.cmds_to_execute().value());
 	}
 
 	// if the user wants to refresh on startup via configuration file, then
@@ -787,6 +815,18 @@ int Controller::execute_commands(const std::vector<std::string>& cmds)
 			std::cout << strprintf::fmt(_("%u unread articles"),
 					feedcontainer.unread_item_count())
 				<< std::endl;
+		} else if (cmd == "print-reload-stats") {
+			print_reload_stats();
+		} else if (cmd == "print-filter-stats") {
+			print_filter_stats();
+		} else if (cmd == "daemon") {
+			Daemon daemon(this, rsscache, daemon_socket);
+			return daemon.run();
+		} else if (cmd == "stop-daemon") {
+			std::cerr << strprintf::fmt(_("%s: no daemon is running"),
+					"newsboat")
+				<< std::endl;
+			return EXIT_FAILURE;
 		} else {
 			std::cerr
 					<< strprintf::fmt(_("%s: %s: unknown command"),
@@ -799,6 +839,113 @@ int Controller::execute_commands(const std::vector<std::string>& cmds)
 	return EXIT_SUCCESS;
 }
 
+void Controller::print_reload_stats()
+{
+	std::cout << "# rssurl\treloads\tlast_reload\ttotal_ms\tnamelookup_ms"
+		"\tconnect_ms\ttls_ms\tfirstbyte_ms\ttransfer_ms\tparse_ms"
+		"\tpersist_ms\tsize_bytes" << std::endl;
+	for (const auto& stats : rsscache->fetch_reload_stats()) {
+		std::cout << format_reload_stats(stats) << std::endl;
+	}
+}
+
+std::string Controller::format_reload_stats(const FeedReloadStats& stats)
+{
+	const ReloadTimings& avg = stats.average;
+	return strprintf::fmt(
+			"%s\t%u\t%s\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%" PRIu64,
+			stats.rssurl,
+			stats.reload_count,
+			std::to_string(stats.last_reload),
+			avg.total(),
+			avg.namelookup,
+			avg.connect,
+			avg.tls,
+			avg.firstbyte,
+			avg.transfer,
+			avg.parse,
+			avg.persist,
+			avg.size);
+}
+
+void Controller::print_filter_stats()
+{
+	std::cout << FILTER_STATS_HEADER << std::endl;
+	for (const auto& profile : MatcherProfiler::get_instance().get_profiles()) {
+		std::cout << format_filter_stats(profile) << std::endl;
+	}
+}
+
+std::string Controller::format_filter_stats(const ExpressionProfile& profile)
+{
+	return strprintf::fmt("%.3f\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%s\t%s",
+			profile.time,
+			profile.evaluations,
+			profile.matches,
+			profile.description_fetches,
+			utils::join(profile.attributes, ","),
+			ipc::sanitize_field(profile.expression));
+}
+
+int Controller::execute_commands_via_daemon(IpcClient& client,
+	const std::vector<std::string>& cmds)
+{
+	for (const auto& cmd : cmds) {
+		LOG(Level::DEBUG,
+			"Controller::execute_commands_via_daemon: executing `%s'",
+			cmd);
+		IpcResponse response;
+		if (cmd == "reload") {
+			response = client.request("reload");
+		} else if (cmd == "print-unread") {
+			response = client.request("unread");
+			if (response.ok && response.lines.size() == 1) {
+				std::cout << strprintf::fmt(_("%u unread articles"),
+						utils::to_u(response.lines[0]))
+					<< std::endl;
+			}
+		} else if (cmd == "print-reload-stats") {
+			response = client.request("reload-stats");
+			if (response.ok) {
+				std::cout << "# rssurl\treloads\tlast_reload\ttotal_ms"
+					"\tnamelookup_ms\tconnect_ms\ttls_ms\tfirstbyte_ms"
+					"\ttransfer_ms\tparse_ms\tpersist_ms\tsize_bytes"
+					<< std::endl;
+				for (const auto& line : response.lines) {
+					std::cout << line << std::endl;
+				}
+			}
+		} else if (cmd == "print-filter-stats") {
+			response = client.request("filter-stats");
+			if (response.ok) {
+				std::cout << FILTER_STATS_HEADER << std::endl;
+				for (const auto& line : response.lines) {
+					std::cout << line << std::endl;
+				}
+			}
+		} else if (cmd == "stop-daemon") {
+			response = client.request("stop");
+		} else {
+			std::cerr
+					<< strprintf::fmt(_("%s: %s: unknown command"),
+							"newsboat",
+							cmd)
+						<< std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (!response.ok) {
+			std::cerr << strprintf::fmt(_("%s: %s: daemon replied: %s"),
+					"newsboat",
+					cmd,
+					response.error)
+				<< std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+
 std::string Controller::write_temporary_item(std::shared_ptr<RssItem> item)
 {
 	char filename[_POSIX_PATH_MAX];
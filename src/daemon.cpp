@@ -0,0 +1,291 @@
+#include "daemon.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "cache.h"
+#include "config.h"
+#include "controller.h"
+#include "dbexception.h"
+#include "feedcontainer.h"
+#include "logger.h"
+#include "matcherprofiler.h"
+#include "reloader.h"
+#include "rssfeed.h"
+#include "strprintf.h"
+
+namespace newsboat {
+
+static volatile sig_atomic_t stop_signal_received = 0;
+
+static void stop_signal_action(int /* sig */)
+{
+	stop_signal_received = 1;
+}
+
+static IpcResponse error_response(const std::string& message)
+{
+	IpcResponse response;
+	response.ok = false;
+	response.error = message;
+	return response;
+}
+
+Daemon::Daemon(Controller* c, Cache* cache, const std::string& path)
+	: ctrl(c)
+	, rsscache(cache)
+	, socket_path(path)
+	, stop_requested(false)
+{
+}
+
+int Daemon::run()
+{
+	// We're holding the lock file, so a socket left at this path belongs
+	// to a daemon that didn't exit cleanly.
+	::unlink(socket_path.c_str());
+
+	const int listen_fd = ipc::listen_on(socket_path);
+	if (listen_fd < 0) {
+		std::cerr << strprintf::fmt(_("Error: couldn't listen on `%s': %s"),
+				socket_path,
+				strerror(errno))
+			<< std::endl;
+		return EXIT_FAILURE;
+	}
+	LOG(Level::INFO, "Daemon::run: listening on %s", socket_path);
+
+	stop_signal_received = 0;
+	::signal(SIGINT, stop_signal_action);
+	::signal(SIGTERM, stop_signal_action);
+
+	ctrl->get_reloader()->spawn_reloadthread();
+
+	while (!stop_requested && !stop_signal_received) {
+		pollfd pfd;
+		pfd.fd = listen_fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		// Wake up every now and then to check if we were told to stop.
+		if (::poll(&pfd, 1, 1000) <= 0) {
+			continue;
+		}
+
+		const int client_fd = ::accept(listen_fd, nullptr, nullptr);
+		if (client_fd < 0) {
+			LOG(Level::ERROR,
+				"Daemon::run: accept failed: %s",
+				strerror(errno));
+			continue;
+		}
+		serve(client_fd);
+		::close(client_fd);
+	}
+
+	LOG(Level::INFO, "Daemon::run: shutting down");
+	::close(listen_fd);
+	::unlink(socket_path.c_str());
+
+	// Don't pull the cache from under a reload that is still running.
+	Reloader* reloader = ctrl->get_reloader();
+	reloader->cancel_reload_all();
+	while (!reloader->trylock_reload_mutex()) {
+		::sleep(1);
+	}
+	reloader->unlock_reload_mutex();
+
+	return EXIT_SUCCESS;
+}
+
+void Daemon::serve(int client_fd)
+{
+	// Requests are served one at a time, so don't let a client that went
+	// silent block everyone else.
+	timeval timeout;
+	timeout.tv_sec = 10;
+	timeout.tv_usec = 0;
+	::setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+		sizeof(timeout));
+
+	std::string request;
+	while (!stop_requested && ipc::read_line(client_fd, request)) {
+		if (request.empty()) {
+			continue;
+		}
+		const IpcResponse response = handle_request(request);
+		if (!ipc::write_all(client_fd, ipc::format_response(response))) {
+			LOG(Level::ERROR,
+				"Daemon::serve: failed to send reply: %s",
+				strerror(errno));
+			break;
+		}
+	}
+}
+
+IpcResponse Daemon::handle_request(const std::string& request)
+{
+	LOG(Level::DEBUG, "Daemon::handle_request: `%s'", request);
+
+	const auto space = request.find(' ');
+	const std::string cmd = request.substr(0, space);
+	const std::string arg =
+		(space == std::string::npos) ? "" : request.substr(space + 1);
+
+	if (cmd == "feeds") {
+		return list_feeds();
+	} else if (cmd == "items") {
+		return list_items(arg);
+	} else if (cmd == "unread") {
+		return unread_count();
+	} else if (cmd == "mark-read") {
+		return mark_read(arg);
+	} else if (cmd == "mark-feed-read") {
+		return mark_feed_read(arg);
+	} else if (cmd == "reload") {
+		return reload(arg);
+	} else if (cmd == "reload-stats") {
+		return reload_stats();
+	} else if (cmd == "filter-stats") {
+		return filter_stats();
+	} else if (cmd == "stop") {
+		stop_requested = true;
+		return IpcResponse();
+	}
+	return error_response(strprintf::fmt(_("unknown command: %s"), cmd));
+}
+
+IpcResponse Daemon::list_feeds()
+{
+	IpcResponse response;
+	for (const auto& feed : ctrl->get_feedcontainer()->get_all_feeds()) {
+		if (feed->is_query_feed()) {
+			continue;
+		}
+		response.lines.push_back(strprintf::fmt("%u\t%u\t%s\t%s",
+				feed->unread_item_count(),
+				feed->total_item_count(),
+				ipc::sanitize_field(feed->rssurl()),
+				ipc::sanitize_field(feed->title())));
+	}
+	return response;
+}
+
+IpcResponse Daemon::list_items(const std::string& rssurl)
+{
+	const auto feed = ctrl->get_feedcontainer()->get_feed_by_url(rssurl);
+	if (feed == nullptr || feed->is_query_feed()) {
+		return error_response(strprintf::fmt(_("no such feed: %s"), rssurl));
+	}
+
+	IpcResponse response;
+	std::lock_guard<std::mutex> lock(feed->item_mutex);
+	for (const auto& item : feed->items()) {
+		if (item->deleted()) {
+			continue;
+		}
+		response.lines.push_back(strprintf::fmt("%u\t%s\t%s\t%s\t%s",
+				item->unread() ? 1u : 0u,
+				std::to_string(item->pubDate_timestamp()),
+				ipc::sanitize_field(item->guid()),
+				ipc::sanitize_field(item->title()),
+				ipc::sanitize_field(item->link())));
+	}
+	return response;
+}
+
+IpcResponse Daemon::unread_count()
+{
+	IpcResponse response;
+	response.lines.push_back(
+		std::to_string(ctrl->get_feedcontainer()->unread_item_count()));
+	return response;
+}
+
+IpcResponse Daemon::mark_read(const std::string& guid)
+{
+	std::shared_ptr<RssItem> item;
+	for (const auto& feed : ctrl->get_feedcontainer()->get_all_feeds()) {
+		if (feed->is_query_feed()) {
+			continue;
+		}
+		std::lock_guard<std::mutex> lock(feed->item_mutex);
+		for (const auto& i : feed->items()) {
+			if (i->guid() == guid) {
+				item = i;
+				break;
+			}
+		}
+		if (item) {
+			break;
+		}
+	}
+	if (item == nullptr) {
+		return error_response(strprintf::fmt(_("no such article: %s"), guid));
+	}
+
+	try {
+		item->set_unread(false);
+	} catch (const DbException& e) {
+		return error_response(e.what());
+	}
+	ctrl->mark_article_read(guid, true);
+	return IpcResponse();
+}
+
+IpcResponse Daemon::mark_feed_read(const std::string& rssurl)
+{
+	const auto feed = ctrl->get_feedcontainer()->get_feed_by_url(rssurl);
+	if (feed == nullptr || feed->is_query_feed()) {
+		return error_response(strprintf::fmt(_("no such feed: %s"), rssurl));
+	}
+	ctrl->mark_all_read(rssurl);
+	return IpcResponse();
+}
+
+IpcResponse Daemon::reload(const std::string& rssurl)
+{
+	Reloader* reloader = ctrl->get_reloader();
+
+	if (rssurl.empty()) {
+		if (!reloader->start_reload_all_thread()) {
+			return error_response(_("a reload is already in progress"));
+		}
+		return IpcResponse();
+	}
+
+	const auto feeds = ctrl->get_feedcontainer()->get_all_feeds();
+	for (unsigned int pos = 0; pos < feeds.size(); ++pos) {
+		if (feeds[pos]->rssurl() == rssurl && !feeds[pos]->is_query_feed()) {
+			reloader->reload(pos, 0, true);
+			return IpcResponse();
+		}
+	}
+	return error_response(strprintf::fmt(_("no such feed: %s"), rssurl));
+}
+
+IpcResponse Daemon::reload_stats()
+{
+	IpcResponse response;
+	for (const auto& stats : rsscache->fetch_reload_stats()) {
+		response.lines.push_back(Controller::format_reload_stats(stats));
+	}
+	return response;
+}
+
+IpcResponse Daemon::filter_stats()
+{
+	IpcResponse response;
+	for (const auto& profile : MatcherProfiler::get_instance().get_profiles()) {
+		response.lines.push_back(Controller::format_filter_stats(profile));
+	}
+	return response;
+}
+
+} // namespace newsboat
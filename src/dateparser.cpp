@@ -0,0 +1,378 @@
+#include "dateparser.h"
+
+#include <curl/curl.h>
+
+#include "logger.h"
+#include "rss/rssparser.h"
+
+namespace {
+
+const char* const WEEKDAYS[] = {
+	"sun", "mon", "tue", "wed", "thu", "fri", "sat"
+};
+
+const char* const MONTHS[] = {
+	"jan", "feb", "mar", "apr", "may", "jun",
+	"jul", "aug", "sep", "oct", "nov", "dec"
+};
+
+struct NamedZone {
+	const char* name;
+	int offset; // in seconds east of UTC
+};
+
+// The zones curl_getdate() knows that feeds actually use; dates in other
+// zones take the slow path.
+const NamedZone ZONES[] = {
+	{"gmt", 0},
+	{"ut", 0},
+	{"utc", 0},
+	{"z", 0},
+	{"est", -5 * 3600},
+	{"edt", -4 * 3600},
+	{"cst", -6 * 3600},
+	{"cdt", -5 * 3600},
+	{"mst", -7 * 3600},
+	{"mdt", -6 * 3600},
+	{"pst", -8 * 3600},
+	{"pdt", -7 * 3600},
+};
+
+bool is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+bool is_alpha(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool is_blank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+char to_lower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+void skip_blanks(const char*& p)
+{
+	while (is_blank(*p)) {
+		++p;
+	}
+}
+
+/// Reads exactly \a count digits.
+bool read_digits(const char*& p, unsigned int count, int& value)
+{
+	value = 0;
+	for (unsigned int i = 0; i < count; ++i) {
+		if (!is_digit(p[i])) {
+			return false;
+		}
+		value = value * 10 + (p[i] - '0');
+	}
+	p += count;
+	return true;
+}
+
+size_t word_length(const char* p)
+{
+	size_t length = 0;
+	while (is_alpha(p[length])) {
+		++length;
+	}
+	return length;
+}
+
+/// Case-insensitively compares the word of \a length letters at \a p to
+/// the lowercase \a name.
+bool word_is(const char* p, size_t length, const char* name)
+{
+	size_t i = 0;
+	while (i < length && name[i] == to_lower(p[i])) {
+		++i;
+	}
+	return i == length && name[i] == '\0';
+}
+
+/// Reads a word and returns its index in \a names, or -1.
+int read_name(const char*& p, const char* const* names, int count)
+{
+	const size_t length = word_length(p);
+	for (int i = 0; i < count; ++i) {
+		if (word_is(p, length, names[i])) {
+			p += length;
+			return i;
+		}
+	}
+	return -1;
+}
+
+bool read_zone(const char*& p, int& offset)
+{
+	const size_t length = word_length(p);
+	for (const auto& zone : ZONES) {
+		if (word_is(p, length, zone.name)) {
+			offset = zone.offset;
+			p += length;
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Reads "+hhmm" into \a offset, in seconds. ISO 8601 also allows "+hh:mm"
+/// and "+hh".
+bool read_offset(const char*& p, bool iso, int& offset)
+{
+	if (*p != '+' && *p != '-') {
+		return false;
+	}
+	const int sign = (*p == '-') ? -1 : 1;
+	const char* q = p + 1;
+
+	int hours = 0;
+	int minutes = 0;
+	if (!read_digits(q, 2, hours)) {
+		return false;
+	}
+	if (iso && *q == ':') {
+		++q;
+		if (!read_digits(q, 2, minutes)) {
+			return false;
+		}
+	} else if (is_digit(*q)) {
+		if (!read_digits(q, 2, minutes)) {
+			return false;
+		}
+	} else if (!iso) {
+		return false;
+	}
+	if (minutes > 59 || hours > 14 || (hours == 14 && minutes > 0)) {
+		return false;
+	}
+
+	offset = sign * (hours * 3600 + minutes * 60);
+	p = q;
+	return true;
+}
+
+/// Days since 1970-01-01 in the proleptic Gregorian calendar. Days past the
+/// end of the month carry over into the next one, like mktime() does.
+long days_from_civil(int year, int month, int day)
+{
+	year -= month <= 2;
+	const long era = year / 400;
+	const long year_of_era = year - era * 400;
+	const long day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 +
+		day - 1;
+	const long day_of_era = year_of_era * 365 + year_of_era / 4 -
+		year_of_era / 100 + day_of_year;
+	return era * 146097 + day_of_era - 719468;
+}
+
+bool make_time(int year, int month, int day, int hour, int minute,
+	int second, int offset, time_t& result)
+{
+	if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 ||
+		hour > 23 || minute > 59 || second > 60) {
+		return false;
+	}
+	// Leave dates that don't fit into a 32-bit time_t to curl_getdate()
+	if (sizeof(time_t) < 8 && year >= 2038) {
+		return false;
+	}
+
+	result = static_cast<time_t>(days_from_civil(year, month, day)) * 86400 +
+		hour * 3600 + minute * 60 + second - offset;
+	return true;
+}
+
+bool at_end(const char* p)
+{
+	skip_blanks(p);
+	return *p == '\0';
+}
+
+} // namespace
+
+namespace newsboat {
+
+const size_t DateParser::MEMO_SIZE;
+
+DateParser::DateParser()
+	: memo_used(0)
+	, memo_next(0)
+{
+}
+
+time_t DateParser::parse(const std::string& date)
+{
+	for (size_t i = 0; i < memo_used; ++i) {
+		if (memo[i].date == date) {
+			return memo[i].time;
+		}
+	}
+
+	time_t t = -1;
+	if (!parse_rfc822(date.c_str(), t) && !parse_iso8601(date.c_str(), t)) {
+		t = curl_getdate(date.c_str(), nullptr);
+		if (t == -1) {
+			LOG(Level::INFO,
+				"DateParser::parse: encountered t == -1, trying "
+				"out W3CDTF parser...");
+			t = curl_getdate(
+					rsspp::RssParser::w3cdtf_to_rfc822(date).c_str(),
+					nullptr);
+		}
+	}
+
+	// Assigning to an existing string reuses its buffer
+	memo[memo_next].date = date;
+	memo[memo_next].time = t;
+	memo_next = (memo_next + 1) % MEMO_SIZE;
+	if (memo_used < MEMO_SIZE) {
+		memo_used++;
+	}
+
+	return t;
+}
+
+bool DateParser::parse_rfc822(const char* date, time_t& result)
+{
+	const char* p = date;
+	skip_blanks(p);
+
+	if (is_alpha(*p)) {
+		if (read_name(p, WEEKDAYS, 7) == -1 || *p != ',') {
+			return false;
+		}
+		++p;
+		skip_blanks(p);
+	}
+
+	int day = 0;
+	if (!read_digits(p, 2, day) && !read_digits(p, 1, day)) {
+		return false;
+	}
+	if (*p++ != ' ') {
+		return false;
+	}
+
+	const int month = read_name(p, MONTHS, 12) + 1;
+	if (month == 0 || *p++ != ' ') {
+		return false;
+	}
+
+	int year = 0;
+	int hour = 0;
+	int minute = 0;
+	int second = 0;
+	if (!read_digits(p, 4, year) || *p++ != ' ' ||
+		!read_digits(p, 2, hour) || *p++ != ':' ||
+		!read_digits(p, 2, minute)) {
+		return false;
+	}
+	if (*p == ':') {
+		++p;
+		if (!read_digits(p, 2, second)) {
+			return false;
+		}
+	}
+
+	// No zone means GMT
+	int offset = 0;
+	if (!at_end(p)) {
+		if (*p++ != ' ') {
+			return false;
+		}
+		if (is_alpha(*p)) {
+			if (!read_zone(p, offset)) {
+				return false;
+			}
+		} else if (!read_offset(p, false, offset)) {
+			return false;
+		}
+		if (!at_end(p)) {
+			return false;
+		}
+	}
+
+	return make_time(year, month, day, hour, minute, second, offset, result);
+}
+
+bool DateParser::parse_iso8601(const char* date, time_t& result)
+{
+	const char* p = date;
+	skip_blanks(p);
+
+	int year = 0;
+	int month = 1;
+	int day = 1;
+	int hour = 0;
+	int minute = 0;
+	int second = 0;
+	int offset = 0;
+
+	if (!read_digits(p, 4, year)) {
+		return false;
+	}
+	if (*p == '-') {
+		++p;
+		if (!read_digits(p, 2, month)) {
+			return false;
+		}
+		if (*p == '-') {
+			++p;
+			if (!read_digits(p, 2, day)) {
+				return false;
+			}
+		}
+	}
+
+	if (*p == 'T') {
+		++p;
+		if (!read_digits(p, 2, hour)) {
+			return false;
+		}
+		if (*p == ':') {
+			++p;
+			if (!read_digits(p, 2, minute)) {
+				return false;
+			}
+			if (*p == ':') {
+				++p;
+				if (!read_digits(p, 2, second)) {
+					return false;
+				}
+				// Fractions of a second are dropped
+				if (*p == '.' && is_digit(p[1])) {
+					++p;
+					while (is_digit(*p)) {
+						++p;
+					}
+				}
+			}
+		}
+
+		if (*p == 'Z') {
+			++p;
+		} else if (*p == '+' || *p == '-') {
+			if (!read_offset(p, true, offset)) {
+				return false;
+			}
+		}
+	}
+
+	if (!at_end(p)) {
+		return false;
+	}
+
+	return make_time(year, month, day, hour, minute, second, offset, result);
+}
+
+} // namespace newsboat
@@ -4,8 +4,9 @@
 
 namespace newsboat {
 
-DownloadThread::DownloadThread(Reloader& r, const std::vector<int>& idxs)
-	: reloader(r), indexes(idxs) {}
+DownloadThread::DownloadThread(Reloader& r, const std::vector<int>& idxs,
+	std::shared_ptr<std::promise<bool>> s)
+	: reloader(r), indexes(idxs), started(s) {}
 
 DownloadThread::~DownloadThread() {}
 
@@ -19,7 +20,11 @@ void DownloadThread::operator()()
 	LOG(Level::DEBUG,
 		"DownloadThread::run: inside DownloadThread, reloading all "
 		"feeds...");
-	if (reloader.trylock_reload_mutex()) {
+	const bool locked = reloader.trylock_reload_mutex();
+	if (started) {
+		started->set_value(locked);
+	}
+	if (locked) {
 		if (indexes.size() == 0) {
 			reloader.reload_all();
 		} else {
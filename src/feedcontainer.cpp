@@ -1,9 +1,9 @@
 #include "feedcontainer.h"
 
 #include <algorithm> // stable_sort
-#include <numeric>   // accumulate
 #include <unordered_set>
 
+#include "itemcolumns.h"
 #include "rssfeed.h"
 #include "utils.h"
 
@@ -132,22 +132,51 @@ void FeedContainer::mark_all_feeds_read()
 	}
 }
 
+FeedContainer::~FeedContainer()
+{
+	for (const auto& feed : feeds) {
+		feed->set_container(nullptr);
+	}
+}
+
 void FeedContainer::add_feed(const std::shared_ptr<RssFeed> feed)
 {
 	std::lock_guard<std::mutex> feedslock(feeds_mutex);
+	feed->set_container(this);
 	feeds.push_back(feed);
 }
 
 void FeedContainer::populate_query_feeds()
 {
 	std::lock_guard<std::mutex> feedslock(feeds_mutex);
+	update_item_columns();
 	for (const auto& feed : feeds) {
 		if (feed->is_query_feed()) {
-			feed->update_items(feeds);
+			feed->update_items(feeds, item_columns.get());
 		}
 	}
 }
 
+std::shared_ptr<const ItemColumns> FeedContainer::get_item_columns()
+{
+	std::lock_guard<std::mutex> feedslock(feeds_mutex);
+	update_item_columns();
+	return item_columns;
+}
+
+void FeedContainer::update_item_columns()
+{
+	if (item_columns == nullptr) {
+		item_columns = std::make_shared<ItemColumns>(feeds);
+		return;
+	}
+	// Someone is still reading the current snapshot, so update a copy
+	if (item_columns.use_count() > 1) {
+		item_columns = std::make_shared<ItemColumns>(*item_columns);
+	}
+	item_columns->update(feeds);
+}
+
 unsigned int FeedContainer::get_feed_count_per_tag(const std::string& tag)
 {
 	unsigned int count = 0;
@@ -233,6 +262,16 @@ void FeedContainer::set_feeds(
 	const std::vector<std::shared_ptr<RssFeed>> new_feeds)
 {
 	std::lock_guard<std::mutex> feedslock(feeds_mutex);
+	const std::unordered_set<std::shared_ptr<RssFeed>> kept(new_feeds.begin(),
+			new_feeds.end());
+	for (const auto& feed : feeds) {
+		if (kept.count(feed) == 0) {
+			feed->set_container(nullptr);
+		}
+	}
+	for (const auto& feed : new_feeds) {
+		feed->set_container(this);
+	}
 	feeds = new_feeds;
 }
 
@@ -254,33 +293,22 @@ unsigned int FeedContainer::unread_feed_count() const
 
 unsigned int FeedContainer::unread_item_count() const
 {
-	std::lock_guard<std::mutex> feedslock(feeds_mutex);
-
-	using guid_set = std::unordered_set<std::string>;
-	const auto unread_guids =
-		std::accumulate(feeds.begin(),
-			feeds.end(),
-			guid_set(),
-	[](guid_set guids, const std::shared_ptr<RssFeed> feed) {
-		// Hidden feeds can't be viewed. The only way to read their articles is
-		// via a query feed; items that aren't in query feeds are completely
-		// inaccessible. Thus, we skip hidden feeds altogether to avoid
-		// counting items that can't be accessed.
-		if (feed->hidden()) {
-			return guids;
-		}
-
-		std::lock_guard<std::mutex> itemslock(feed->item_mutex);
-		for (const auto& item : feed->items()) {
-			if (item->unread()) {
-				guids.insert(item->guid());
-			}
-		}
+	std::lock_guard<std::mutex> guidslock(unread_guids_mutex);
+	return unread_guids.size();
+}
 
-		return guids;
-	});
+void FeedContainer::unread_item_changed(const std::string& guid, bool unread)
+{
+	std::lock_guard<std::mutex> guidslock(unread_guids_mutex);
+	if (unread) {
+		unread_guids[guid]++;
+		return;
+	}
 
-	return unread_guids.size();
+	const auto it = unread_guids.find(guid);
+	if (it != unread_guids.end() && --it->second == 0) {
+		unread_guids.erase(it);
+	}
 }
 
 void FeedContainer::replace_feed(unsigned int pos,
@@ -288,7 +316,24 @@ void FeedContainer::replace_feed(unsigned int pos,
 {
 	std::lock_guard<std::mutex> feedslock(feeds_mutex);
 	assert(pos < feeds.size());
+	if (feeds[pos] != feed) {
+		feeds[pos]->set_container(nullptr);
+		feed->set_container(this);
+	}
 	feeds[pos] = feed;
+	replaced_feeds[feed->rssurl()] = feed;
+}
+
+std::vector<std::shared_ptr<RssFeed>> FeedContainer::take_replaced_feeds()
+{
+	std::lock_guard<std::mutex> feedslock(feeds_mutex);
+	std::vector<std::shared_ptr<RssFeed>> result;
+	result.reserve(replaced_feeds.size());
+	for (const auto& entry : replaced_feeds) {
+		result.push_back(entry.second);
+	}
+	replaced_feeds.clear();
+	return result;
 }
 
 } // namespace newsboat
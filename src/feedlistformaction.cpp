@@ -36,6 +36,7 @@ FeedListFormAction::FeedListFormAction(View* vv,
 	, rxman(r)
 	, filters(f)
 	, cache(cc)
+	, line_cache("feedlist")
 {
 	valid_cmds.push_back("tag");
 	valid_cmds.push_back("goto");
@@ -63,7 +64,10 @@ void FeedListFormAction::init()
 	v->get_ctrl()->get_reloader()->spawn_reloadthread();
 }
 
-FeedListFormAction::~FeedListFormAction() {}
+FeedListFormAction::~FeedListFormAction()
+{
+	line_cache.log_stats();
+}
 
 void FeedListFormAction::prepare()
 {
@@ -575,11 +579,15 @@ void FeedListFormAction::set_feedlist(
 	std::string feedlist_format = cfg->get_configvalue("feedlist-format");
 
 	ListFormatter listfmt(&rxman, "feedlist");
+	line_cache.set_format(feedlist_format);
+	if (!feedlist_template || feedlist_template->get_format() != feedlist_format) {
+		feedlist_template.reset(new FmtStrTemplate(feedlist_format));
+	}
 
 	update_visible_feeds(feeds);
 
 	for (const auto& feed : visible_feeds) {
-		listfmt.add_line(format_line(feedlist_format,
+		listfmt.add_line(format_line(*feedlist_template,
 				feed.first,
 				feed.second,
 				width));
@@ -866,6 +874,18 @@ void FeedListFormAction::mark_pos_if_visible(unsigned int pos)
 	}
 }
 
+std::vector<unsigned int> FeedListFormAction::get_positions_on_screen()
+{
+	std::vector<unsigned int> positions;
+	const std::size_t first = list.get_scroll_offset();
+	const std::size_t last =
+		std::min<std::size_t>(first + list.get_height(), visible_feeds.size());
+	for (std::size_t i = first; i < last; ++i) {
+		positions.push_back(visible_feeds[i].second);
+	}
+	return positions;
+}
+
 void FeedListFormAction::save_filterpos()
 {
 	const unsigned int i = list.get_position();
@@ -1009,31 +1029,61 @@ std::string FeedListFormAction::get_title(std::shared_ptr<RssFeed> feed)
 	return title;
 }
 
-std::string FeedListFormAction::format_line(const std::string& feedlist_format,
+std::string FeedListFormAction::format_line(const FmtStrTemplate&
+	feedlist_format,
 	std::shared_ptr<RssFeed> feed,
 	unsigned int pos,
 	unsigned int width)
 {
-	FmtStrFormatter fmt;
-	unsigned int unread_count = feed->unread_item_count();
-
-	fmt.register_fmt('i', strprintf::fmt("%u", pos + 1));
-	fmt.register_fmt('u',
-		strprintf::fmt("(%u/%u)",
-			unread_count,
-			static_cast<unsigned int>(feed->total_item_count())));
-	fmt.register_fmt('U', std::to_string(unread_count));
-	fmt.register_fmt('c', std::to_string(feed->total_item_count()));
-	fmt.register_fmt('n', unread_count > 0 ? "N" : " ");
-	fmt.register_fmt('S', feed->get_status());
-	fmt.register_fmt('t', get_title(feed));
-	fmt.register_fmt('T', feed->get_firsttag());
-	fmt.register_fmt('l', utils::censor_url(feed->link()));
-	fmt.register_fmt('L', utils::censor_url(feed->rssurl()));
-	fmt.register_fmt('d', utils::utf8_to_locale(feed->description()));
-
-	auto formattedLine = fmt.do_format(feedlist_format, width);
-	formattedLine = utils::quote_for_stfl(formattedLine);
+	const unsigned int unread_count = feed->unread_item_count();
+	const unsigned int total_count = feed->total_item_count();
+
+	FormattedLineCache::Stamp stamp;
+	stamp.version = feed->version();
+	stamp.context = (static_cast<uint64_t>(unread_count) << 32) | total_count;
+	stamp.position = pos;
+	stamp.width = width;
+
+	auto formattedLine = line_cache.get(feed.get(), stamp, [&]() {
+		// Only compute the values that the format refers to
+		FmtStrFormatter fmt;
+		if (feedlist_format.uses('i')) {
+			fmt.register_fmt('i', strprintf::fmt("%u", pos + 1));
+		}
+		if (feedlist_format.uses('u')) {
+			fmt.register_fmt('u',
+				strprintf::fmt("(%u/%u)", unread_count, total_count));
+		}
+		if (feedlist_format.uses('U')) {
+			fmt.register_fmt('U', std::to_string(unread_count));
+		}
+		if (feedlist_format.uses('c')) {
+			fmt.register_fmt('c', std::to_string(total_count));
+		}
+		if (feedlist_format.uses('n')) {
+			fmt.register_fmt('n', unread_count > 0 ? "N" : " ");
+		}
+		if (feedlist_format.uses('S')) {
+			fmt.register_fmt('S', feed->get_status());
+		}
+		if (feedlist_format.uses('t')) {
+			fmt.register_fmt('t', get_title(feed));
+		}
+		if (feedlist_format.uses('T')) {
+			fmt.register_fmt('T', feed->get_firsttag());
+		}
+		if (feedlist_format.uses('l')) {
+			fmt.register_fmt('l', utils::censor_url(feed->link()));
+		}
+		if (feedlist_format.uses('L')) {
+			fmt.register_fmt('L', utils::censor_url(feed->rssurl()));
+		}
+		if (feedlist_format.uses('d')) {
+			fmt.register_fmt('d', utils::utf8_to_locale(feed->description()));
+		}
+
+		return utils::quote_for_stfl(fmt.do_format(feedlist_format, width));
+	});
 	if (unread_count > 0) {
 		formattedLine = strprintf::fmt("<unread>%s</>", formattedLine);
 	}
@@ -0,0 +1,205 @@
+#include "fetchcoalescer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <curl/curl.h>
+
+#include "configcontainer.h"
+#include "curlhandle.h"
+#include "logger.h"
+#include "utils.h"
+
+namespace {
+
+size_t append_to_string(char* data, size_t size, size_t nmemb, void* body)
+{
+	static_cast<std::string*>(body)->append(data, size * nmemb);
+	return size * nmemb;
+}
+
+} // namespace
+
+namespace newsboat {
+
+FetchCoalescer::FetchCoalescer()
+	: saved(0)
+{
+}
+
+void FetchCoalescer::reset(const std::vector<std::string>& rssurls)
+{
+	std::map<std::string, unsigned int> users;
+	for (const auto& rssurl : rssurls) {
+		const std::string url = upstream_url(rssurl);
+		if (!url.empty()) {
+			users[normalize_url(url)]++;
+		}
+	}
+
+	std::lock_guard<std::mutex> guard(mtx);
+	shared_urls.clear();
+	entries.clear();
+	saved = 0;
+	for (const auto& user : users) {
+		if (user.second > 1) {
+			LOG(Level::DEBUG,
+				"FetchCoalescer::reset: %s is used by %u feeds",
+				user.first,
+				user.second);
+			shared_urls.insert(user.first);
+		}
+	}
+}
+
+void FetchCoalescer::clear()
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	shared_urls.clear();
+	entries.clear();
+}
+
+bool FetchCoalescer::is_shared(const std::string& url) const
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	return shared_urls.count(normalize_url(url)) > 0;
+}
+
+std::shared_ptr<const std::string> FetchCoalescer::fetch(
+	const std::string& url,
+	const std::function<std::string()>& download)
+{
+	const std::string key = normalize_url(url);
+
+	std::unique_lock<std::mutex> lock(mtx);
+	auto it = entries.find(key);
+	if (it != entries.end()) {
+		const std::shared_ptr<Entry> entry = it->second;
+		download_finished.wait(lock, [&entry]() {
+			return entry->done;
+		});
+		if (entry->body != nullptr) {
+			saved++;
+			LOG(Level::DEBUG,
+				"FetchCoalescer::fetch: reusing the body of %s",
+				url);
+			return entry->body;
+		}
+		// The download failed or came back empty; let this caller try on
+		// its own.
+		lock.unlock();
+		return std::make_shared<const std::string>(download());
+	}
+
+	const auto entry = std::make_shared<Entry>();
+	entries[key] = entry;
+	lock.unlock();
+
+	std::shared_ptr<const std::string> body;
+	try {
+		body = std::make_shared<const std::string>(download());
+	} catch (...) {
+		lock.lock();
+		entry->done = true;
+		download_finished.notify_all();
+		throw;
+	}
+
+	lock.lock();
+	if (!body->empty()) {
+		entry->body = body;
+	}
+	entry->done = true;
+	download_finished.notify_all();
+	return body;
+}
+
+std::string FetchCoalescer::download(const std::string& url,
+	ConfigContainer* cfg)
+{
+	const unsigned int retrycount =
+		cfg->get_configvalue_as_int("download-retries");
+	for (unsigned int i = 0; i < retrycount; i++) {
+		CurlHandle handle;
+		std::string body;
+		utils::set_common_curl_options(handle.ptr(), cfg);
+		curl_easy_setopt(handle.ptr(), CURLOPT_URL, url.c_str());
+		curl_easy_setopt(handle.ptr(), CURLOPT_WRITEFUNCTION, append_to_string);
+		curl_easy_setopt(handle.ptr(), CURLOPT_WRITEDATA, &body);
+
+		// Unlike utils::retrieve_url(), this looks at the result, as the
+		// body of an interrupted transfer isn't empty
+		const CURLcode result = curl_easy_perform(handle.ptr());
+		if (result == CURLE_OK && !body.empty()) {
+			return body;
+		}
+		LOG(Level::ERROR,
+			"FetchCoalescer::download: attempt %u of %u to download %s "
+			"failed: %s",
+			i + 1,
+			retrycount,
+			url,
+			result == CURLE_OK ? "empty response" : curl_easy_strerror(result));
+	}
+	return "";
+}
+
+unsigned int FetchCoalescer::saved_transfers() const
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	return saved;
+}
+
+std::string FetchCoalescer::upstream_url(const std::string& rssurl)
+{
+	if (utils::is_http_url(rssurl)) {
+		return rssurl;
+	}
+	if (utils::is_filter_url(rssurl)) {
+		std::string filter, url;
+		utils::extract_filter(rssurl, filter, url);
+		if (utils::is_http_url(url)) {
+			return url;
+		}
+	}
+	return "";
+}
+
+std::string FetchCoalescer::normalize_url(const std::string& url)
+{
+	std::string result = url;
+
+	const auto fragment = result.find('#');
+	if (fragment != std::string::npos) {
+		result.erase(fragment);
+	}
+
+	const auto scheme_end = result.find("://");
+	if (scheme_end == std::string::npos) {
+		return result;
+	}
+	const auto host_start = scheme_end + 3;
+	auto host_end = result.find_first_of("/?", host_start);
+	if (host_end == std::string::npos) {
+		host_end = result.length();
+	}
+
+	std::transform(result.begin(), result.begin() + host_end, result.begin(),
+		::tolower);
+
+	const std::string scheme = result.substr(0, scheme_end);
+	const std::string default_port = (scheme == "https") ? ":443" : ":80";
+	if (host_end - host_start > default_port.length() &&
+		result.compare(host_end - default_port.length(),
+			default_port.length(), default_port) == 0) {
+		result.erase(host_end - default_port.length(), default_port.length());
+		host_end -= default_port.length();
+	}
+
+	if (host_end == result.length()) {
+		result.push_back('/');
+	}
+
+	return result;
+}
+
+} // namespace newsboat
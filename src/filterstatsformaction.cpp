@@ -0,0 +1,125 @@
+#include "filterstatsformaction.h"
+
+#include <string>
+
+#include "config.h"
+#include "fmtstrformatter.h"
+#include "listformatter.h"
+#include "strprintf.h"
+#include "utils.h"
+#include "view.h"
+
+namespace newsboat {
+
+/*
+ * The FilterStatsFormAction lists the filter expressions (query feeds,
+ * ignore and highlight rules, filters) that took the longest to evaluate,
+ * along with how often they were evaluated and matched. The list is sorted
+ * by MatcherProfiler, most expensive expression first.
+ */
+
+FilterStatsFormAction::FilterStatsFormAction(View* vv,
+	std::string formstr,
+	ConfigContainer* cfg)
+	: FormAction(vv, formstr, cfg)
+	, stats_list("dialogs", FormAction::f,
+		  cfg->get_configvalue_as_int("scrolloff"))
+{
+}
+
+FilterStatsFormAction::~FilterStatsFormAction() {}
+
+void FilterStatsFormAction::init()
+{
+	set_keymap_hints();
+
+	f.run(-3); // compute all widget dimensions
+
+	const unsigned int width = stats_list.get_width();
+	FmtStrFormatter fmt;
+	fmt.register_fmt('N', PROGRAM_NAME);
+	fmt.register_fmt('V', utils::program_version());
+	f.set("head",
+		fmt.do_format(
+			cfg->get_configvalue("filterstats-title-format"), width));
+	do_redraw = true;
+}
+
+void FilterStatsFormAction::prepare()
+{
+	if (!do_redraw) {
+		return;
+	}
+
+	ListFormatter listfmt;
+	listfmt.add_line(utils::quote_for_stfl(strprintf::fmt(
+				"%10s %11s %9s %7s  %-20s %s",
+				_("ms"),
+				_("evaluated"),
+				_("matched"),
+				_("fetched"),
+				_("Attributes"),
+				_("Expression"))));
+	for (const auto& s : stats) {
+		listfmt.add_line(utils::quote_for_stfl(strprintf::fmt(
+					"%10.1f %11s %9s %7s  %-20s %s",
+					s.time,
+					std::to_string(s.evaluations),
+					std::to_string(s.matches),
+					std::to_string(s.description_fetches),
+					utils::join(s.attributes, ","),
+					s.expression)));
+	}
+	stats_list.stfl_replace_lines(listfmt);
+
+	do_redraw = false;
+}
+
+KeyMapHintEntry* FilterStatsFormAction::get_keymap_hint()
+{
+	static KeyMapHintEntry hints[] = {{OP_QUIT, _("Close")},
+		{OP_NIL, nullptr}
+	};
+	return hints;
+}
+
+bool FilterStatsFormAction::process_operation(Operation op,
+	bool /* automatic */,
+	std::vector<std::string>* /* args */)
+{
+	switch (op) {
+	case OP_PREV:
+	case OP_SK_UP:
+		stats_list.move_up(cfg->get_configvalue_as_bool("wrap-scroll"));
+		break;
+	case OP_NEXT:
+	case OP_SK_DOWN:
+		stats_list.move_down(cfg->get_configvalue_as_bool("wrap-scroll"));
+		break;
+	case OP_SK_HOME:
+		stats_list.move_to_first();
+		break;
+	case OP_SK_END:
+		stats_list.move_to_last();
+		break;
+	case OP_SK_PGUP:
+		stats_list.move_page_up(cfg->get_configvalue_as_bool("wrap-scroll"));
+		break;
+	case OP_SK_PGDOWN:
+		stats_list.move_page_down(cfg->get_configvalue_as_bool("wrap-scroll"));
+		break;
+	case OP_QUIT:
+		v->pop_current_formaction();
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+std::string FilterStatsFormAction::title()
+{
+	return _("Filter Statistics");
+}
+
+} // namespace newsboat
@@ -21,10 +21,33 @@ extern "C" {
 		void* fmt,
 		const char* format,
 		std::uint32_t width);
+
+	char* rs_fmtstrformatter_format_template(
+		void* fmt,
+		void* tmpl,
+		std::uint32_t width);
+
+	void* rs_fmtstrtemplate_new(const char* format);
+
+	void rs_fmtstrtemplate_free(void* tmpl);
+
+	char* rs_fmtstrtemplate_keys(void* tmpl);
 }
 
 namespace newsboat {
 
+FmtStrTemplate::FmtStrTemplate(const std::string& format)
+	: format(format)
+{
+	rs_template = rs_fmtstrtemplate_new(format.c_str());
+	keys = RustString(rs_fmtstrtemplate_keys(rs_template));
+}
+
+FmtStrTemplate::~FmtStrTemplate()
+{
+	rs_fmtstrtemplate_free(rs_template);
+}
+
 FmtStrFormatter::FmtStrFormatter()
 {
 	rs_fmt = rs_fmtstrformatter_new();
@@ -46,4 +69,11 @@ std::string FmtStrFormatter::do_format(const std::string& fmt,
 	return RustString(rs_fmtstrformatter_do_format(rs_fmt, fmt.c_str(), width));
 }
 
+std::string FmtStrFormatter::do_format(const FmtStrTemplate& tmpl,
+	unsigned int width)
+{
+	return RustString(rs_fmtstrformatter_format_template(
+				rs_fmt, tmpl.rs_template, width));
+}
+
 } // namespace newsboat
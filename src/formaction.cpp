@@ -8,6 +8,7 @@
 #include "configexception.h"
 #include "logger.h"
 #include "matcherexception.h"
+#include "reloader.h"
 #include "strprintf.h"
 #include "utils.h"
 #include "view.h"
@@ -48,6 +49,8 @@ FormAction::FormAction(View* vv, std::string formstr, ConfigContainer* cfg)
 	valid_cmds.push_back("dumpconfig");
 	valid_cmds.push_back("dumpform");
 	valid_cmds.push_back("exec");
+	valid_cmds.push_back("reload-stats");
+	valid_cmds.push_back("filter-stats");
 }
 
 void FormAction::set_keymap_hints()
@@ -169,6 +172,13 @@ bool FormAction::process_op(Operation op,
 	case OP_VIEWDIALOGS:
 		v->view_dialogs();
 		break;
+	case OP_CANCELRELOAD:
+		if (v->get_ctrl()->get_reloader()->cancel_reload_all()) {
+			v->set_status(_("Reload cancelled"));
+		} else {
+			v->show_error(_("No reload in progress"));
+		}
+		break;
 	case OP_NEXTDIALOG:
 		v->goto_next_dialog();
 		break;
@@ -335,6 +345,10 @@ void FormAction::handle_cmdline(const std::string& cmdline)
 			}
 		} else if (cmd == "dumpform") {
 			v->dump_current_form();
+		} else if (cmd == "reload-stats") {
+			v->view_reload_stats();
+		} else if (cmd == "filter-stats") {
+			v->view_filter_stats();
 		} else if (cmd == "exec") {
 			if (tokens.size() != 1) {
 				v->show_error(_("usage: exec <operation>"));
@@ -0,0 +1,106 @@
+#include "formattedlinecache.h"
+
+#include <chrono>
+#include <cinttypes>
+
+#include "logger.h"
+
+namespace {
+
+/// Lines of entries that no longer exist are only dropped when the format
+/// changes, so the cache is emptied once it holds this many lines.
+const size_t MAX_LINES = 200000;
+
+} // namespace
+
+namespace newsboat {
+
+double FormattedLineCacheStats::hit_rate() const
+{
+	const std::uint64_t lookups = hits + misses;
+	return lookups > 0 ? static_cast<double>(hits) / lookups : 0;
+}
+
+bool FormattedLineCache::Stamp::operator==(const Stamp& other) const
+{
+	return version == other.version
+		&& context == other.context
+		&& position == other.position
+		&& width == other.width;
+}
+
+FormattedLineCache::FormattedLineCache(const std::string& name)
+	: name(name)
+	, hits(0)
+	, misses(0)
+	, formatting_nanoseconds(0)
+{
+}
+
+void FormattedLineCache::set_format(const std::string& fmt)
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	if (fmt != format) {
+		format = fmt;
+		lines.clear();
+	}
+}
+
+std::string FormattedLineCache::get(const void* entry,
+	const Stamp& stamp,
+	const std::function<std::string()>& format_line)
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	const auto it = lines.find(entry);
+	if (it != lines.end() && it->second.stamp == stamp) {
+		hits++;
+		return it->second.text;
+	}
+	lock.unlock();
+
+	const auto start = std::chrono::steady_clock::now();
+	std::string text = format_line();
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+
+	lock.lock();
+	misses++;
+	formatting_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>
+		(elapsed).count();
+	if (lines.size() >= MAX_LINES) {
+		lines.clear();
+	}
+	lines[entry] = Line{stamp, text};
+	return text;
+}
+
+FormattedLineCacheStats FormattedLineCache::get_stats() const
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	FormattedLineCacheStats stats;
+	stats.hits = hits;
+	stats.misses = misses;
+	stats.formatting_time = formatting_nanoseconds / 1e6;
+	if (misses > 0) {
+		stats.saved_time = stats.formatting_time / misses * hits;
+	}
+	return stats;
+}
+
+void FormattedLineCache::log_stats() const
+{
+	const auto stats = get_stats();
+	if (stats.hits + stats.misses == 0) {
+		return;
+	}
+	LOG(Level::INFO,
+		"FormattedLineCache(%s): %" PRIu64 " hits, %" PRIu64 " misses "
+		"(%.1f%% hit rate), formatting took %.1f ms, about %.1f ms saved",
+		name,
+		stats.hits,
+		stats.misses,
+		stats.hit_rate() * 100,
+		stats.formatting_time,
+		stats.saved_time);
+}
+
+} // namespace newsboat
@@ -0,0 +1,191 @@
+#include "ipc.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "logger.h"
+#include "strprintf.h"
+#include "utils.h"
+
+namespace newsboat {
+
+static bool make_address(const std::string& path, sockaddr_un& addr)
+{
+	if (path.length() >= sizeof(addr.sun_path)) {
+		errno = ENAMETOOLONG;
+		return false;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	return true;
+}
+
+std::string ipc::format_response(const IpcResponse& response)
+{
+	if (!response.ok) {
+		return strprintf::fmt("ERR %s\n", sanitize_field(response.error));
+	}
+
+	std::string result = strprintf::fmt("OK %u\n",
+			static_cast<unsigned int>(response.lines.size()));
+	for (const auto& line : response.lines) {
+		result.append(line);
+		result.push_back('\n');
+	}
+	return result;
+}
+
+std::string ipc::sanitize_field(const std::string& field)
+{
+	std::string result(field);
+	for (auto& c : result) {
+		if (c == '\n' || c == '\r' || c == '\t') {
+			c = ' ';
+		}
+	}
+	return result;
+}
+
+bool ipc::read_line(int fd, std::string& line)
+{
+	line.clear();
+	char c;
+	for (;;) {
+		const ssize_t n = ::read(fd, &c, 1);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		if (c == '\n') {
+			return true;
+		}
+		line.push_back(c);
+	}
+}
+
+bool ipc::write_all(int fd, const std::string& data)
+{
+	size_t written = 0;
+	while (written < data.length()) {
+		const ssize_t n = ::write(fd, data.data() + written,
+				data.length() - written);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		written += n;
+	}
+	return true;
+}
+
+int ipc::listen_on(const std::string& path)
+{
+	sockaddr_un addr;
+	if (!make_address(path, addr)) {
+		return -1;
+	}
+
+	const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return -1;
+	}
+
+	// Only the owner may talk to the daemon.
+	const mode_t old_umask = ::umask(0077);
+	const int rc = ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+	::umask(old_umask);
+
+	if (rc != 0 || ::listen(fd, 8) != 0) {
+		const int saved_errno = errno;
+		::close(fd);
+		errno = saved_errno;
+		return -1;
+	}
+	return fd;
+}
+
+IpcClient::IpcClient(const std::string& path)
+	: socket_path(path)
+	, fd(-1)
+{
+}
+
+IpcClient::~IpcClient()
+{
+	if (fd >= 0) {
+		::close(fd);
+	}
+}
+
+bool IpcClient::connect()
+{
+	sockaddr_un addr;
+	if (!make_address(socket_path, addr)) {
+		return false;
+	}
+
+	fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return false;
+	}
+	if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+		LOG(Level::DEBUG,
+			"IpcClient::connect: can't connect to %s: %s",
+			socket_path,
+			strerror(errno));
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+	LOG(Level::INFO, "IpcClient::connect: connected to %s", socket_path);
+	return true;
+}
+
+IpcResponse IpcClient::request(const std::string& request)
+{
+	IpcResponse response;
+	std::string status;
+	if (fd < 0 || !ipc::write_all(fd, ipc::sanitize_field(request) + "\n") ||
+		!ipc::read_line(fd, status)) {
+		response.ok = false;
+		response.error = _("lost connection to the daemon");
+		return response;
+	}
+
+	if (status.compare(0, 4, "ERR ") == 0) {
+		response.ok = false;
+		response.error = status.substr(4);
+		return response;
+	}
+	if (status.compare(0, 3, "OK ") != 0) {
+		response.ok = false;
+		response.error = strprintf::fmt(
+				_("unexpected reply from the daemon: %s"), status);
+		return response;
+	}
+
+	const unsigned int count = utils::to_u(status.substr(3));
+	for (unsigned int i = 0; i < count; ++i) {
+		std::string line;
+		if (!ipc::read_line(fd, line)) {
+			response.ok = false;
+			response.error = _("lost connection to the daemon");
+			response.lines.clear();
+			return response;
+		}
+		response.lines.push_back(line);
+	}
+	return response;
+}
+
+} // namespace newsboat
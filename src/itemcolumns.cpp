@@ -0,0 +1,381 @@
+#include "itemcolumns.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "matcher.h"
+#include "matcherexception.h"
+#include "rssfeed.h"
+#include "rssitem.h"
+#include "utils.h"
+
+namespace {
+
+/// Hands out the same value for every attribute, so that a comparison can
+/// be evaluated once for each distinct value of a column.
+class ValueMatchable : public newsboat::Matchable {
+public:
+	explicit ValueMatchable(const std::string& v)
+		: value(v)
+	{
+	}
+
+	nonstd::optional<std::string> attribute_value(const std::string&)
+	const override
+	{
+		return value;
+	}
+
+private:
+	const std::string& value;
+};
+
+bool is_feed_attribute(const std::string& name)
+{
+	return name == "feedtitle" || name == "description" ||
+		name == "feedlink" || name == "feeddate" || name == "rssurl" ||
+		name == "unread_count" || name == "total_count" || name == "tags" ||
+		name == "feedindex";
+}
+
+/// Evaluates \a e once for each of \a values. Returns false if that
+/// throws.
+bool compare_values(const newsboat::Matcher& m, const expression* e,
+	const std::vector<std::string>& values, std::vector<uint8_t>& table)
+{
+	table.resize(values.size());
+	try {
+		for (size_t i = 0; i < values.size(); ++i) {
+			ValueMatchable value(values[i]);
+			table[i] = m.matches_comparison(e, &value);
+		}
+	} catch (const newsboat::MatcherException&) {
+		return false;
+	}
+	return true;
+}
+
+template<typename Id>
+void gather(const std::vector<uint8_t>& table, const std::vector<Id>& ids,
+	std::vector<uint8_t>& rows)
+{
+	rows.resize(ids.size());
+	for (size_t i = 0; i < ids.size(); ++i) {
+		rows[i] = table[ids[i]];
+	}
+}
+
+const uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+
+/// Drops the entries of \a values that none of \a ids refer to, once they
+/// outnumber the ones in use, and makes \a ids refer to the entries that
+/// were kept. Returns false if nothing was dropped.
+template<typename Value>
+bool drop_unused(std::vector<uint32_t>& ids, std::vector<Value>& values)
+{
+	std::vector<uint32_t> renumbered(values.size(), UNUSED);
+	uint32_t used = 0;
+	for (const auto id : ids) {
+		if (renumbered[id] == UNUSED) {
+			renumbered[id] = used++;
+		}
+	}
+	if (values.size() <= 2 * static_cast<size_t>(used)) {
+		return false;
+	}
+
+	std::vector<Value> kept(used);
+	for (size_t i = 0; i < values.size(); ++i) {
+		if (renumbered[i] != UNUSED) {
+			kept[renumbered[i]] = std::move(values[i]);
+		}
+	}
+	values = std::move(kept);
+	for (auto& id : ids) {
+		id = renumbered[id];
+	}
+	return true;
+}
+
+void index_values(const std::vector<std::string>& values,
+	std::unordered_map<std::string, uint32_t>& index)
+{
+	index.clear();
+	for (size_t i = 0; i < values.size(); ++i) {
+		index.emplace(values[i], i);
+	}
+}
+
+} // namespace
+
+namespace newsboat {
+
+ItemColumns::ItemColumns(const std::vector<std::shared_ptr<RssFeed>>& feeds)
+{
+	update(feeds);
+}
+
+void ItemColumns::update(const std::vector<std::shared_ptr<RssFeed>>& feeds)
+{
+	size_t row = 0;
+	for (const auto& feed : feeds) {
+		if (feed->is_query_feed()) {
+			continue;
+		}
+		for (const auto& item : feed->items()) {
+			if (row < items.size() && items[row] == item.get()) {
+				if (versions[row] != item->version()) {
+					load_row(row, item.get());
+				}
+			} else {
+				if (row >= items.size()) {
+					items.resize(row + 1);
+					versions.resize(row + 1);
+					unread.resize(row + 1);
+					deleted.resize(row + 1);
+					pubdates.resize(row + 1);
+					flag_ids.resize(row + 1);
+					author_ids.resize(row + 1);
+					feed_ids.resize(row + 1);
+				}
+				load_row(row, item.get());
+			}
+			row++;
+		}
+	}
+
+	items.resize(row);
+	versions.resize(row);
+	unread.resize(row);
+	deleted.resize(row);
+	pubdates.resize(row);
+	flag_ids.resize(row);
+	author_ids.resize(row);
+	feed_ids.resize(row);
+
+	drop_unused_values();
+}
+
+void ItemColumns::drop_unused_values()
+{
+	// Reloads replace feeds and edits change flags, so without this the
+	// tables would keep growing for as long as the program runs
+	if (drop_unused(flag_ids, flag_values)) {
+		index_values(flag_values, flag_index);
+	}
+	if (drop_unused(author_ids, author_values)) {
+		index_values(author_values, author_index);
+	}
+	if (drop_unused(feed_ids, feed_values)) {
+		feed_index.clear();
+		for (size_t i = 0; i < feed_values.size(); ++i) {
+			// Rows of items whose feed is gone are evaluated the same as
+			// those of items without a feed
+			feed_index[feed_values[i].lock().get()] = i;
+		}
+	}
+}
+
+size_t ItemColumns::interned_value_count() const
+{
+	return flag_values.size() + author_values.size() + feed_values.size();
+}
+
+bool ItemColumns::describes(size_t row, const RssItem& item) const
+{
+	return items[row] == &item && versions[row] == item.version();
+}
+
+void ItemColumns::load_row(size_t row, RssItem* item)
+{
+	items[row] = item;
+	versions[row] = item->version();
+	unread[row] = item->unread();
+	deleted[row] = item->deleted();
+	pubdates[row] = item->pubDate_timestamp();
+	flag_ids[row] = intern(flag_index, flag_values, item->flags());
+	author_ids[row] = intern(author_index, author_values, item->author());
+	feed_ids[row] = intern_feed(item->get_feedptr());
+}
+
+uint32_t ItemColumns::intern(std::unordered_map<std::string, uint32_t>& index,
+	std::vector<std::string>& values, const std::string& value)
+{
+	const auto it = index.find(value);
+	if (it != index.end()) {
+		return it->second;
+	}
+	values.push_back(value);
+	index.emplace(value, values.size() - 1);
+	return values.size() - 1;
+}
+
+uint32_t ItemColumns::intern_feed(const std::shared_ptr<RssFeed>& feed)
+{
+	// A feed that has since been destroyed might share its address with
+	// this one, so entries are only reused while their feed is alive
+	const auto it = feed_index.find(feed.get());
+	if (it != feed_index.end() && feed_values[it->second].lock() == feed) {
+		return it->second;
+	}
+	feed_values.push_back(feed);
+	feed_index[feed.get()] = feed_values.size() - 1;
+	return feed_values.size() - 1;
+}
+
+nonstd::optional<std::vector<uint8_t>> ItemColumns::evaluate(
+	const Matcher& m, time_t now) const
+{
+	std::vector<uint8_t> rows;
+	if (!evaluate_r(m, m.get_syntax_tree(), now, rows)) {
+		return nonstd::nullopt;
+	}
+	for (size_t i = 0; i < rows.size(); ++i) {
+		rows[i] &= deleted[i] ^ 1;
+	}
+	return rows;
+}
+
+bool ItemColumns::evaluate_r(const Matcher& m, const expression* e,
+	time_t now, std::vector<uint8_t>& rows) const
+{
+	if (e == nullptr) {
+		return false;
+	}
+
+	if (e->op == LOGOP_AND || e->op == LOGOP_OR) {
+		std::vector<uint8_t> right;
+		if (!evaluate_r(m, e->l, now, rows) ||
+			!evaluate_r(m, e->r, now, right)) {
+			return false;
+		}
+		if (e->op == LOGOP_AND) {
+			for (size_t i = 0; i < rows.size(); ++i) {
+				rows[i] &= right[i];
+			}
+		} else {
+			for (size_t i = 0; i < rows.size(); ++i) {
+				rows[i] |= right[i];
+			}
+		}
+		return true;
+	}
+
+	std::vector<uint8_t> table;
+	if (e->name == "unread") {
+		if (!compare_values(m, e, {"no", "yes"}, table)) {
+			return false;
+		}
+		gather(table, unread, rows);
+		return true;
+	} else if (e->name == "flags") {
+		if (!compare_values(m, e, flag_values, table)) {
+			return false;
+		}
+		gather(table, flag_ids, rows);
+		return true;
+	} else if (e->name == "author") {
+		// RssItem converts authors to the locale's encoding
+		std::vector<std::string> authors;
+		for (const auto& author : author_values) {
+			authors.push_back(utils::utf8_to_locale(author));
+		}
+		if (!compare_values(m, e, authors, table)) {
+			return false;
+		}
+		gather(table, author_ids, rows);
+		return true;
+	} else if (e->name == "age") {
+		return evaluate_age(e, now, rows);
+	} else if (is_feed_attribute(e->name)) {
+		return evaluate_feed_attribute(m, e, rows);
+	}
+
+	return false;
+}
+
+bool ItemColumns::evaluate_age(const expression* e, time_t now,
+	std::vector<uint8_t>& rows) const
+{
+	// Every comparison boils down to a range of ages
+	int64_t lower = std::numeric_limits<int>::min();
+	int64_t upper = std::numeric_limits<int>::max();
+	const int64_t number = Matcher::string_to_num(e->literal);
+	switch (e->op) {
+	case MATCHOP_LT:
+		upper = number - 1;
+		break;
+	case MATCHOP_GT:
+		lower = number + 1;
+		break;
+	case MATCHOP_LE:
+		upper = number;
+		break;
+	case MATCHOP_GE:
+		lower = number;
+		break;
+	case MATCHOP_BETWEEN: {
+		const std::vector<std::string> lit = utils::tokenize(e->literal, ":");
+		if (lit.size() < 2) {
+			rows.assign(pubdates.size(), 0);
+			return true;
+		}
+		lower = Matcher::string_to_num(lit[0]);
+		upper = Matcher::string_to_num(lit[1]);
+		if (lower > upper) {
+			std::swap(lower, upper);
+		}
+		break;
+	}
+	default:
+		// Comparing ages as strings isn't worth a kernel of its own
+		return false;
+	}
+
+	rows.resize(pubdates.size());
+	for (size_t i = 0; i < pubdates.size(); ++i) {
+		// Same as RssItem::attribute_number(), which clamps to an int
+		const int64_t age = std::max<int64_t>(std::numeric_limits<int>::min(),
+				std::min<int64_t>((now - pubdates[i]) / 86400,
+					std::numeric_limits<int>::max()));
+		rows[i] = (age >= lower) & (age <= upper);
+	}
+	return true;
+}
+
+bool ItemColumns::evaluate_feed_attribute(const Matcher& m,
+	const expression* e, std::vector<uint8_t>& rows) const
+{
+	// Items forward these to their feed, so the comparison can be evaluated
+	// on the feeds themselves
+	std::vector<uint8_t> table(feed_values.size());
+	std::vector<uint8_t> unavailable(feed_values.size());
+	bool any_unavailable = false;
+	try {
+		for (size_t i = 0; i < feed_values.size(); ++i) {
+			const auto feed = feed_values[i].lock();
+			if (feed == nullptr) {
+				unavailable[i] = 1;
+				any_unavailable = true;
+			} else {
+				table[i] = m.matches_comparison(e, feed.get());
+			}
+		}
+	} catch (const MatcherException&) {
+		return false;
+	}
+
+	// Matching items without a feed would throw
+	if (any_unavailable) {
+		for (const auto id : feed_ids) {
+			if (unavailable[id]) {
+				return false;
+			}
+		}
+	}
+
+	gather(table, feed_ids, rows);
+	return true;
+}
+
+} // namespace newsboat
@@ -1,5 +1,6 @@
 #include <itemlistformaction.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <cstdio>
@@ -12,6 +13,7 @@
 #include "controller.h"
 #include "dbexception.h"
 #include "fmtstrformatter.h"
+#include "formattedlinecache.h"
 #include "logger.h"
 #include "matcherexception.h"
 #include "rssfeed.h"
@@ -38,7 +40,6 @@ ItemListFormAction::ItemListFormAction(View* vv,
 	, old_width(0)
 	, old_itempos(-1)
 	, invalidation_mode(InvalidationMode::NONE)
-	, listfmt(&rxman, "articlelist")
 	, rsscache(cc)
 	, filters(f)
 {
@@ -905,13 +906,23 @@ void ItemListFormAction::do_update_visible_items()
 	unsigned int i = 0;
 	for (const auto& item : items) {
 		item->set_index(i + 1);
-		if ((show_read || item->unread()) &&
-			(!apply_filter || matcher.matches(item.get()))) {
+		if (!apply_filter && (show_read || item->unread())) {
 			new_visible_items.push_back(ItemPtrPosPair(item, i));
 		}
 		i++;
 	}
 
+	if (apply_filter) {
+		const auto matching = matcher.matching_indices(items.size(),
+		[&](size_t index) -> Matchable* {
+			const auto& item = items[index];
+			return (show_read || item->unread()) ? item.get() : nullptr;
+		});
+		for (const size_t index : matching) {
+			new_visible_items.push_back(ItemPtrPosPair(items[index], index));
+		}
+	}
+
 	LOG(Level::DEBUG,
 		"ItemListFormAction::do_update_visible_items: size = %" PRIu64,
 		static_cast<uint64_t>(visible_items.size()));
@@ -959,41 +970,30 @@ void ItemListFormAction::prepare()
 	}
 
 	if (invalidation_mode == InvalidationMode::NONE) {
+		list.render_visible_lines();
 		return;
 	}
 
-	auto datetime_format = cfg->get_configvalue("datetime-format");
-	auto itemlist_format =
-		cfg->get_configvalue("articlelist-format");
-
 	switch (invalidation_mode) {
 	case InvalidationMode::COMPLETE:
-		listfmt.clear();
-
-		for (const auto& item : visible_items) {
-			auto line = item2formatted_line(item,
-					width,
-					itemlist_format,
-					datetime_format);
-			listfmt.add_line(line);
-		}
+		formatted_lines.assign(visible_items.size(), nonstd::nullopt);
 		break;
 
 	case InvalidationMode::PARTIAL:
 		for (const auto& itempos : invalidated_itempos) {
-			auto item = visible_items[itempos];
-			auto line = item2formatted_line(item,
-					width,
-					itemlist_format,
-					datetime_format);
-			listfmt.set_line(itempos, line);
+			formatted_lines[itempos] = nonstd::nullopt;
 		}
 		break;
 	case InvalidationMode::NONE:
 		break;
 	}
 
-	list.stfl_replace_lines(listfmt);
+	// Only the lines around the visible ones are formatted; the rest are
+	// formatted when they're scrolled to
+	list.stfl_replace_lines(visible_items.size(),
+	[this](std::uint32_t begin, std::uint32_t end) {
+		return format_lines(begin, end);
+	});
 
 	invalidated_itempos.clear();
 	invalidation_mode = InvalidationMode::NONE;
@@ -1008,38 +1008,67 @@ void ItemListFormAction::prepare()
 
 std::string ItemListFormAction::item2formatted_line(const ItemPtrPosPair& item,
 	const unsigned int width,
-	const std::string& itemlist_format,
+	const FmtStrTemplate& itemlist_format,
 	const std::string& datetime_format)
 {
-	FmtStrFormatter fmt;
-	fmt.register_fmt('i', strprintf::fmt("%u", item.second + 1));
-	fmt.register_fmt('f', gen_flags(item.first));
-	fmt.register_fmt('n', item.first->unread() ? "N" : " ");
-	fmt.register_fmt('d', item.first->deleted() ? "D" : " ");
-	fmt.register_fmt('F', item.first->flags());
-	fmt.register_fmt('D',
-		utils::mt_strf_localtime(
-			datetime_format,
-			item.first->pubDate_timestamp()));
-	if (feed->rssurl() != item.first->feedurl() &&
-		item.first->get_feedptr() != nullptr) {
-		auto feedtitle = item.first->get_feedptr()->title();
-		utils::remove_soft_hyphens(feedtitle);
-		fmt.register_fmt('T', feedtitle);
-	}
-
-	auto itemtitle = utils::utf8_to_locale(item.first->title());
-	utils::remove_soft_hyphens(itemtitle);
-	fmt.register_fmt('t', itemtitle);
-
-	auto itemauthor = utils::utf8_to_locale(item.first->author());
-	utils::remove_soft_hyphens(itemauthor);
-	fmt.register_fmt('a', itemauthor);
-
-	fmt.register_fmt('L', item.first->length());
-
-	auto formattedLine = fmt.do_format(itemlist_format, width);
-	formattedLine = utils::quote_for_stfl(formattedLine);
+	// Items of other feeds show their feed's title
+	std::shared_ptr<RssFeed> other_feed;
+	if (itemlist_format.uses('T') && feed->rssurl() != item.first->feedurl()) {
+		other_feed = item.first->get_feedptr();
+	}
+
+	FormattedLineCache::Stamp stamp;
+	stamp.version = item.first->version();
+	stamp.context = other_feed ? other_feed->version() : 0;
+	stamp.position = item.second;
+	stamp.width = width;
+
+	auto& line_cache = v->get_article_line_cache();
+	auto formattedLine = line_cache.get(item.first.get(), stamp, [&]() {
+		// Only compute the values that the format refers to
+		FmtStrFormatter fmt;
+		if (itemlist_format.uses('i')) {
+			fmt.register_fmt('i', strprintf::fmt("%u", item.second + 1));
+		}
+		if (itemlist_format.uses('f')) {
+			fmt.register_fmt('f', gen_flags(item.first));
+		}
+		if (itemlist_format.uses('n')) {
+			fmt.register_fmt('n', item.first->unread() ? "N" : " ");
+		}
+		if (itemlist_format.uses('d')) {
+			fmt.register_fmt('d', item.first->deleted() ? "D" : " ");
+		}
+		if (itemlist_format.uses('F')) {
+			fmt.register_fmt('F', item.first->flags());
+		}
+		if (itemlist_format.uses('D')) {
+			fmt.register_fmt('D',
+				utils::mt_strf_localtime(
+					datetime_format,
+					item.first->pubDate_timestamp()));
+		}
+		if (other_feed != nullptr) {
+			auto feedtitle = other_feed->title();
+			utils::remove_soft_hyphens(feedtitle);
+			fmt.register_fmt('T', feedtitle);
+		}
+		if (itemlist_format.uses('t')) {
+			auto itemtitle = utils::utf8_to_locale(item.first->title());
+			utils::remove_soft_hyphens(itemtitle);
+			fmt.register_fmt('t', itemtitle);
+		}
+		if (itemlist_format.uses('a')) {
+			auto itemauthor = utils::utf8_to_locale(item.first->author());
+			utils::remove_soft_hyphens(itemauthor);
+			fmt.register_fmt('a', itemauthor);
+		}
+		if (itemlist_format.uses('L')) {
+			fmt.register_fmt('L', item.first->length());
+		}
+
+		return utils::quote_for_stfl(fmt.do_format(itemlist_format, width));
+	});
 
 	const int id = rxman.article_matches(item.first.get());
 	if (id != -1) {
@@ -1053,6 +1082,37 @@ std::string ItemListFormAction::item2formatted_line(const ItemPtrPosPair& item,
 	return formattedLine;
 }
 
+std::string ItemListFormAction::format_lines(std::uint32_t begin,
+	std::uint32_t end)
+{
+	const auto datetime_format = cfg->get_configvalue("datetime-format");
+	const auto itemlist_format = cfg->get_configvalue("articlelist-format");
+	const unsigned int width = list.get_width();
+	v->get_article_line_cache().set_format(
+		itemlist_format + "\n" + datetime_format);
+	if (!itemlist_template || itemlist_template->get_format() != itemlist_format) {
+		itemlist_template.reset(new FmtStrTemplate(itemlist_format));
+	}
+
+	// visible_items might have been updated without prepare() having been
+	// called yet
+	end = std::min<std::uint32_t>(end,
+			std::min(formatted_lines.size(), visible_items.size()));
+
+	ListFormatter listfmt(&rxman, "articlelist");
+	for (std::uint32_t i = begin; i < end; ++i) {
+		auto& line = formatted_lines[i];
+		if (!line) {
+			line = item2formatted_line(visible_items[i],
+					width,
+					*itemlist_template,
+					datetime_format);
+		}
+		listfmt.add_line(*line);
+	}
+	return listfmt.format_list();
+}
+
 void ItemListFormAction::init()
 {
 	list.set_position(0);
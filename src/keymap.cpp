@@ -57,6 +57,13 @@ static const std::vector<OpDesc> opdescs = {
 		KM_FEEDLIST | KM_ARTICLELIST
 	},
 	{OP_RELOADALL, "reload-all", "R", _("Reload all feeds"), KM_FEEDLIST},
+	{
+		OP_CANCELRELOAD,
+		"cancel-reload",
+		"",
+		_("Cancel reloading all feeds"),
+		KM_FEEDLIST | KM_ARTICLELIST | KM_ARTICLE
+	},
 	{
 		OP_MARKFEEDREAD,
 		"mark-feed-read",
@@ -487,6 +494,8 @@ static const std::map<std::string, std::uint32_t> contexts = {
 	{"podboat", KM_PODBOAT},
 	{"dialogs", KM_DIALOGS},
 	{"dirbrowser", KM_DIRBROWSER},
+	{"reloadstats", KM_DIALOGS},
+	{"filterstats", KM_DIALOGS},
 };
 
 KeyMap::KeyMap(unsigned flags)
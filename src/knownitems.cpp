@@ -0,0 +1,95 @@
+#include "knownitems.h"
+
+#include "rss/item.h"
+
+namespace {
+
+const std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+void hash_field(std::uint64_t& hash, const std::string& field)
+{
+	for (const char c : field) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= FNV_PRIME;
+	}
+	// Separator, so that moving text between fields changes the hash
+	hash ^= 0xff;
+	hash *= FNV_PRIME;
+}
+
+} // namespace
+
+namespace newsboat {
+
+const unsigned int KnownItems::RUN_LENGTH;
+const time_t KnownItems::FULL_PASS_INTERVAL;
+
+bool KnownItems::allows_early_stop(const std::string& rssurl,
+	time_t now) const
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	const auto feed = feeds.find(rssurl);
+	if (feed == feeds.end()) {
+		return false;
+	}
+	const FeedState& state = feed->second;
+	return state.ordered &&
+		now - state.last_full_pass < FULL_PASS_INTERVAL;
+}
+
+bool KnownItems::is_known(const std::string& rssurl,
+	const std::string& guid,
+	std::uint64_t fingerprint) const
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	const auto feed = feeds.find(rssurl);
+	if (feed == feeds.end()) {
+		return false;
+	}
+	const auto item = feed->second.items.find(guid);
+	return item != feed->second.items.end() && item->second == fingerprint;
+}
+
+void KnownItems::update(const std::string& rssurl,
+	const std::vector<std::pair<std::string, std::uint64_t>>& items,
+	bool full_pass,
+	bool ordered,
+	time_t now)
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	FeedState& state = feeds[rssurl];
+	if (full_pass) {
+		state.items.clear();
+		state.last_full_pass = now;
+	}
+	for (const auto& item : items) {
+		state.items[item.first] = item.second;
+	}
+	state.ordered = ordered;
+}
+
+std::uint64_t KnownItems::fingerprint(const rsspp::Item& item)
+{
+	std::uint64_t hash = FNV_OFFSET_BASIS;
+	hash_field(hash, item.title);
+	hash_field(hash, item.title_type);
+	hash_field(hash, item.link);
+	hash_field(hash, item.description);
+	hash_field(hash, item.description_type);
+	hash_field(hash, item.author);
+	hash_field(hash, item.author_email);
+	hash_field(hash, item.pubDate);
+	hash_field(hash, item.guid);
+	hash_field(hash, item.enclosure_url);
+	hash_field(hash, item.enclosure_type);
+	hash_field(hash, item.content_encoded);
+	hash_field(hash, item.itunes_summary);
+	hash_field(hash, item.base);
+	for (const auto& label : item.labels) {
+		hash_field(hash, label);
+	}
+	return hash;
+}
+
+} // namespace newsboat
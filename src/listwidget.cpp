@@ -4,6 +4,13 @@
 
 #include "utils.h"
 
+namespace {
+
+/// How many lines above and below the screen are rendered at least.
+const std::uint32_t MIN_WINDOW_MARGIN = 50;
+
+} // namespace
+
 namespace newsboat {
 
 ListWidget::ListWidget(const std::string& list_name, Stfl::Form& form,
@@ -12,6 +19,8 @@ ListWidget::ListWidget(const std::string& list_name, Stfl::Form& form,
 	, form(form)
 	, num_lines(0)
 	, num_context_lines(scrolloff)
+	, window_start(0)
+	, window_end(0)
 {
 }
 
@@ -19,15 +28,51 @@ void ListWidget::stfl_replace_list(std::uint32_t number_of_lines,
 	std::string stfl)
 {
 	num_lines = number_of_lines;
+	render_lines = nullptr;
+	window_start = 0;
+	window_end = number_of_lines;
 	form.modify(list_name, "replace", stfl);
 }
 
 void ListWidget::stfl_replace_lines(const ListFormatter& listfmt)
 {
+	if (window_start != 0) {
+		// All lines get rendered now, so STFL's position and offset have to
+		// become absolute again
+		form.set(list_name + "_pos", std::to_string(get_position()));
+		form.set(list_name + "_offset", std::to_string(get_scroll_offset()));
+		window_start = 0;
+	}
 	num_lines = listfmt.get_lines_count();
+	render_lines = nullptr;
+	window_end = num_lines;
 	form.modify(list_name, "replace_inner", listfmt.format_list());
 }
 
+void ListWidget::stfl_replace_lines(std::uint32_t number_of_lines,
+	std::function<std::string(std::uint32_t, std::uint32_t)> render)
+{
+	const std::uint32_t last_line = (number_of_lines > 0 ? number_of_lines - 1 : 0);
+	const std::uint32_t pos = std::min(get_position(), last_line);
+	const std::uint32_t offset = std::min(get_scroll_offset(), last_line);
+
+	num_lines = number_of_lines;
+	render_lines = std::move(render);
+	render_window(offset, pos);
+}
+
+void ListWidget::render_visible_lines()
+{
+	if (!render_lines) {
+		return;
+	}
+	const std::uint32_t pos = get_position();
+	const std::uint32_t offset = get_scroll_offset();
+	if (!is_rendered(offset, pos)) {
+		render_window(offset, pos);
+	}
+}
+
 bool ListWidget::move_up(bool wrap_scroll)
 {
 	const std::uint32_t curpos = get_position();
@@ -109,15 +154,19 @@ std::uint32_t ListWidget::get_position()
 {
 	const std::string pos = form.get(list_name + "_pos");
 	if (!pos.empty()) {
-		return std::max(0, std::stoi(pos));
+		return window_start + std::max(0, std::stoi(pos));
 	}
-	return 0;
+	return window_start;
 }
 
 void ListWidget::set_position(std::uint32_t pos)
 {
-	form.set(list_name + "_pos", std::to_string(pos));
-	update_scroll_offset(pos);
+	const std::uint32_t offset = scroll_offset_for(pos);
+	if (render_lines && !is_rendered(offset, pos)) {
+		render_window(offset, pos);
+	}
+	form.set(list_name + "_pos", window_index(pos));
+	set_scroll_offset(offset);
 }
 
 std::uint32_t ListWidget::get_width()
@@ -134,22 +183,22 @@ std::uint32_t ListWidget::get_scroll_offset()
 {
 	const std::string offset = form.get(list_name + "_offset");
 	if (!offset.empty()) {
-		return std::max(0, std::stoi(offset));
+		return window_start + std::max(0, std::stoi(offset));
 	}
-	return 0;
+	return window_start;
 }
 
 void ListWidget::set_scroll_offset(std::uint32_t offset)
 {
-	form.set(list_name + "_offset", std::to_string(offset));
+	form.set(list_name + "_offset", window_index(offset));
 }
 
-void ListWidget::update_scroll_offset(std::uint32_t pos)
+std::uint32_t ListWidget::scroll_offset_for(std::uint32_t pos)
 {
 	// In STFL, "offset" is how many items at the beginning of the list are
 	// hidden off-screen. That's how scrolling is implemented: to scroll down,
 	// you increase "offset", hiding items at the top and showing more at the
-	// bottom. By manipulating "offset" here, we can keep the cursor within the
+	// bottom. By choosing "offset" here, we can keep the cursor within the
 	// bounds we set.
 	//
 	// All the lines that are visible because of "scrolloff" setting are called
@@ -164,6 +213,7 @@ void ListWidget::update_scroll_offset(std::uint32_t pos)
 	// we'll have an empty "gap" at the bottom of the list. That's only
 	// acceptable if the list is shorter than the widget's height.
 	const std::uint32_t max_offset = (num_lines >= h ? num_lines - h : 0);
+	std::uint32_t offset = cur_scroll_offset;
 
 	if (2 * num_context_lines < h) {
 		// Check if items at the bottom of the "context" are visible. If not,
@@ -171,9 +221,9 @@ void ListWidget::update_scroll_offset(std::uint32_t pos)
 		if (pos + num_context_lines >= cur_scroll_offset + h) {
 			if (pos + num_context_lines >= h) {
 				const std::uint32_t target_offset = pos + num_context_lines - h + 1;
-				set_scroll_offset(std::min(target_offset, max_offset));
+				offset = std::min(target_offset, max_offset);
 			} else { // "pos" is towards the beginning of the list; don't scroll
-				set_scroll_offset(0);
+				offset = 0;
 			}
 		}
 
@@ -181,19 +231,49 @@ void ListWidget::update_scroll_offset(std::uint32_t pos)
 		// we'll have to scroll up.
 		if (pos < cur_scroll_offset + num_context_lines) {
 			if (pos >= num_context_lines) {
-				set_scroll_offset(pos - num_context_lines);
+				offset = pos - num_context_lines;
 			} else { // "pos" is towards the beginning of the list; don't scroll
-				set_scroll_offset(0);
+				offset = 0;
 			}
 		}
 	} else { // Keep selected item in the middle
 		if (pos > h / 2) {
 			const std::uint32_t target_offset = pos - h / 2;
-			set_scroll_offset(std::min(target_offset, max_offset));
+			offset = std::min(target_offset, max_offset);
 		} else { // "pos" is towards the beginning of the list; don't scroll
-			set_scroll_offset(0);
+			offset = 0;
 		}
 	}
+	return offset;
+}
+
+bool ListWidget::is_rendered(std::uint32_t offset, std::uint32_t pos)
+{
+	const std::uint32_t last_visible = std::min(offset + get_height(), num_lines);
+	return window_start <= std::min(offset, pos)
+		&& std::max(last_visible, pos + 1) <= window_end;
+}
+
+void ListWidget::render_window(std::uint32_t offset, std::uint32_t pos)
+{
+	// Render a screenful of lines around what's visible, so that moving
+	// around doesn't need STFL to be updated on every step
+	const std::uint32_t h = get_height();
+	const std::uint32_t margin = std::max(h, MIN_WINDOW_MARGIN);
+	const std::uint32_t first = std::min(offset, pos);
+	const std::uint32_t last = std::max(offset + h, pos + 1);
+
+	window_end = std::min(last + margin, num_lines);
+	window_start = std::min(first > margin ? first - margin : 0, window_end);
+	form.modify(list_name, "replace_inner",
+		render_lines(window_start, window_end));
+	form.set(list_name + "_pos", window_index(pos));
+	set_scroll_offset(offset);
+}
+
+std::string ListWidget::window_index(std::uint32_t line) const
+{
+	return std::to_string(line > window_start ? line - window_start : 0);
 }
 
 } // namespace newsboat
@@ -0,0 +1,357 @@
+#include "literalprefilter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+namespace {
+
+const uint32_t NO_STATE = UINT32_MAX;
+
+char ascii_tolower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+char ascii_toupper(char c)
+{
+	return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
+/// Checks if the \a literal.size() bytes at \a text are \a literal, which is
+/// lowercase, ignoring ASCII case.
+bool equals_ignoring_case(const char* text, const std::string& literal)
+{
+	for (size_t i = 0; i < literal.size(); ++i) {
+		if (ascii_tolower(text[i]) != literal[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Returns the position of the character in \a literal that is least likely
+/// to occur in text.
+size_t rarest_position(const std::string& literal)
+{
+	// Spaces and letters by their frequency in English text; everything
+	// else, like digits and punctuation, is rarer still
+	static const char* const common = " etaoinsrhldcumfpgwybvkxjqz";
+	const auto commonness = [](char c) -> size_t {
+		const char* found = std::strchr(common, ascii_tolower(c));
+		return (c != '\0' && found != nullptr) ? std::strlen(found) : 0;
+	};
+
+	size_t rarest = 0;
+	for (size_t i = 1; i < literal.size(); ++i) {
+		if (commonness(literal[i]) < commonness(literal[rarest])) {
+			rarest = i;
+		}
+	}
+	return rarest;
+}
+
+/// Checks if \a c may be part of a required literal. Case-insensitive
+/// matching maps "k", "s" and "i" to non-ASCII characters too (the Kelvin
+/// sign, long s, and dotted/dotless i), so those aren't.
+bool is_literal_char(char c)
+{
+	const unsigned char u = static_cast<unsigned char>(c);
+	if (u < 0x20 || u >= 0x80) {
+		return false;
+	}
+	return std::strchr("kKsSiI", c) == nullptr;
+}
+
+/// Returns the position right after the bracket expression starting at
+/// \a pos.
+size_t skip_bracket(const std::string& pattern, size_t pos)
+{
+	size_t i = pos + 1;
+	if (i < pattern.size() && pattern[i] == '^') {
+		i++;
+	}
+	// A ']' right at the start is part of the list
+	if (i < pattern.size() && pattern[i] == ']') {
+		i++;
+	}
+	while (i < pattern.size() && pattern[i] != ']') {
+		if (pattern[i] == '[' && i + 1 < pattern.size() &&
+			std::strchr(":.=", pattern[i + 1]) != nullptr) {
+			// Character class like [:alpha:], which contains a ']'
+			const char terminator[] = {pattern[i + 1], ']', '\0'};
+			const size_t end = pattern.find(terminator, i + 2);
+			if (end == std::string::npos) {
+				return pattern.size();
+			}
+			i = end + 2;
+		} else {
+			i++;
+		}
+	}
+	return std::min(i + 1, pattern.size());
+}
+
+/// Returns the position right after the group starting at \a pos.
+size_t skip_group(const std::string& pattern, size_t pos)
+{
+	unsigned int depth = 0;
+	size_t i = pos;
+	while (i < pattern.size()) {
+		switch (pattern[i]) {
+		case '\\':
+			i += 2;
+			continue;
+		case '[':
+			i = skip_bracket(pattern, i);
+			continue;
+		case '(':
+			depth++;
+			break;
+		case ')':
+			depth--;
+			if (depth == 0) {
+				return i + 1;
+			}
+			break;
+		}
+		i++;
+	}
+	return pattern.size();
+}
+
+} // namespace
+
+namespace newsboat {
+
+LiteralPrefilter::LiteralPrefilter(const std::vector<std::string>& literals)
+	: class_count(1)
+	, literal_count(literals.size())
+{
+	// Bytes that don't occur in any literal share class 0, so that the
+	// transition table stays small
+	classes.fill(0);
+	for (const auto& literal : literals) {
+		for (const char c : literal) {
+			const char lower = ascii_tolower(c);
+			auto& cls = classes[static_cast<unsigned char>(lower)];
+			if (cls == 0) {
+				cls = class_count++;
+				if (lower >= 'a' && lower <= 'z') {
+					classes[static_cast<unsigned char>(lower - 'a' + 'A')] = cls;
+				}
+			}
+		}
+	}
+
+	// Build a trie of all the literals...
+	transitions.assign(class_count, NO_STATE);
+	outputs.resize(1);
+	for (size_t i = 0; i < literals.size(); ++i) {
+		if (literals[i].empty()) {
+			always.push_back(i);
+			continue;
+		}
+		uint32_t state = 0;
+		for (const char c : literals[i]) {
+			const uint8_t cls = classes[static_cast<unsigned char>(c)];
+			uint32_t& next = transitions[state * class_count + cls];
+			if (next == NO_STATE) {
+				next = outputs.size();
+				outputs.emplace_back();
+				transitions.resize(transitions.size() + class_count, NO_STATE);
+			}
+			// `next` might have been invalidated by the resize
+			state = transitions[state * class_count + cls];
+		}
+		outputs[state].push_back(i);
+	}
+
+	// ...and turn it into a DFA by following the failure links breadth-first
+	std::vector<uint32_t> failure(outputs.size(), 0);
+	std::queue<uint32_t> queue;
+	for (size_t cls = 0; cls < class_count; ++cls) {
+		uint32_t& next = transitions[cls];
+		if (next == NO_STATE) {
+			next = 0;
+		} else {
+			queue.push(next);
+		}
+	}
+	while (!queue.empty()) {
+		const uint32_t state = queue.front();
+		queue.pop();
+		const uint32_t fail = failure[state];
+		for (size_t cls = 0; cls < class_count; ++cls) {
+			uint32_t& next = transitions[state * class_count + cls];
+			const uint32_t fallback = transitions[fail * class_count + cls];
+			if (next == NO_STATE) {
+				next = fallback;
+			} else {
+				failure[next] = fallback;
+				outputs[next].insert(outputs[next].end(),
+					outputs[fallback].begin(), outputs[fallback].end());
+				queue.push(next);
+			}
+		}
+	}
+}
+
+void LiteralPrefilter::find(const char* text, size_t length,
+	std::vector<char>& candidates) const
+{
+	candidates.assign(literal_count, 0);
+	for (const auto i : always) {
+		candidates[i] = 1;
+	}
+
+	size_t missing = literal_count - always.size();
+	uint32_t state = 0;
+	for (size_t pos = 0; pos < length && missing > 0; ++pos) {
+		const uint8_t cls = classes[static_cast<unsigned char>(text[pos])];
+		state = transitions[state * class_count + cls];
+		for (const auto i : outputs[state]) {
+			if (!candidates[i]) {
+				candidates[i] = 1;
+				missing--;
+			}
+		}
+	}
+}
+
+bool LiteralPrefilter::contains(const char* text, size_t length,
+	const std::string& literal)
+{
+	if (literal.size() > length) {
+		return false;
+	}
+	if (literal.empty()) {
+		return true;
+	}
+
+	// memchr() is much faster than comparing byte by byte, so jump to the
+	// occurrences of the literal's rarest character and only compare there
+	const size_t anchor = rarest_position(literal);
+	const char lower = ascii_tolower(literal[anchor]);
+	const char upper = ascii_toupper(lower);
+	const char* pos = text + anchor;
+	const char* const last = text + length - (literal.size() - anchor);
+	while (pos <= last) {
+		const size_t remaining = last - pos + 1;
+		const char* hit = static_cast<const char*>(
+				std::memchr(pos, lower, remaining));
+		if (upper != lower) {
+			const char* hit_upper = static_cast<const char*>(
+					std::memchr(pos, upper, hit ? hit - pos : remaining));
+			if (hit_upper != nullptr) {
+				hit = hit_upper;
+			}
+		}
+		if (hit == nullptr) {
+			return false;
+		}
+		if (equals_ignoring_case(hit - anchor, literal)) {
+			return true;
+		}
+		pos = hit + 1;
+	}
+	return false;
+}
+
+std::vector<std::string> LiteralPrefilter::required_literals(
+	const std::string& pattern)
+{
+	std::vector<std::string> literals;
+	std::string run;
+	// Whether the last atom is the last character of `run`, so a quantifier
+	// after it applies to that character
+	bool after_literal = false;
+
+	const auto end_run = [&]() {
+		if (!run.empty()) {
+			literals.push_back(run);
+		}
+		run.clear();
+		after_literal = false;
+	};
+
+	size_t i = 0;
+	while (i < pattern.size()) {
+		const char c = pattern[i];
+		switch (c) {
+		case '|':
+			// Each alternative would need literals of its own
+			return {};
+		case '(':
+			end_run();
+			i = skip_group(pattern, i);
+			continue;
+		case '[':
+			end_run();
+			i = skip_bracket(pattern, i);
+			continue;
+		case '*':
+		case '+':
+		case '?':
+		case '{': {
+			// Quantifiers can be stacked, like in "a+?", so look at all of
+			// them. Only `+` keeps the preceding atom required.
+			bool required = true;
+			while (i < pattern.size() &&
+				std::strchr("*+?{", pattern[i]) != nullptr) {
+				if (pattern[i] == '{') {
+					required = false;
+					const size_t end = pattern.find('}', i);
+					i = (end == std::string::npos) ? pattern.size() : end + 1;
+				} else {
+					required = required && pattern[i] == '+';
+					i++;
+				}
+			}
+			if (after_literal && !required) {
+				run.pop_back();
+			}
+			// Even a required atom might be repeated, so it ends the run
+			end_run();
+			continue;
+		}
+		case '\\':
+			if (i + 1 < pattern.size() &&
+				std::strchr(".[]()*+?{}|^$\\", pattern[i + 1]) != nullptr &&
+				is_literal_char(pattern[i + 1])) {
+				run.push_back(pattern[i + 1]);
+				after_literal = true;
+			} else {
+				// Back-references and GNU extensions like \w and \<
+				end_run();
+			}
+			i += 2;
+			continue;
+		default:
+			if (std::strchr(".^$)", c) == nullptr && is_literal_char(c)) {
+				run.push_back(ascii_tolower(c));
+				after_literal = true;
+			} else {
+				end_run();
+			}
+			break;
+		}
+		i++;
+	}
+	end_run();
+
+	return literals;
+}
+
+std::string LiteralPrefilter::required_literal(const std::string& pattern)
+{
+	std::string longest;
+	for (const auto& literal : required_literals(pattern)) {
+		if (literal.size() > longest.size()) {
+			longest = literal;
+		}
+	}
+	return longest;
+}
+
+} // namespace newsboat
@@ -0,0 +1,206 @@
+#include "localtimeformatter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const time_t SECONDS_PER_DAY = 24 * 60 * 60;
+
+/// Memos are dropped as a whole once they grow this large. Newsboat uses
+/// only a handful of formats, and a memo of a day-resolution format covers
+/// more than ten years with this many strings.
+const size_t MAX_FORMATS = 32;
+const size_t MAX_STRINGS = 4096;
+
+bool same_zone(const struct tm& a, const struct tm& b)
+{
+	if (a.tm_gmtoff != b.tm_gmtoff || a.tm_isdst != b.tm_isdst) {
+		return false;
+	}
+	if (a.tm_zone == nullptr || b.tm_zone == nullptr) {
+		return a.tm_zone == b.tm_zone;
+	}
+	return std::strcmp(a.tm_zone, b.tm_zone) == 0;
+}
+
+size_t slot_index(time_t local_time, size_t slots)
+{
+	time_t day = local_time / SECONDS_PER_DAY;
+	if (local_time % SECONDS_PER_DAY < 0) {
+		day--;
+	}
+	const time_t slot = day % static_cast<time_t>(slots);
+	return static_cast<size_t>(slot < 0 ? slot + slots : slot);
+}
+
+} // namespace
+
+namespace newsboat {
+
+const size_t LocalTimeFormatter::DAY_SLOTS;
+
+LocalTimeFormatter::LocalTimeFormatter()
+	: tz_known(false)
+	, tz_set(false)
+	, last_offset(0)
+{
+	clear();
+}
+
+std::string LocalTimeFormatter::format(const std::string& format, time_t t)
+{
+	check_timezone();
+
+	auto memo = memos.find(format);
+	if (memo == memos.end()) {
+		if (memos.size() >= MAX_FORMATS) {
+			memos.clear();
+		}
+		memo = memos.emplace(format, Memo()).first;
+		memo->second.resolution = resolution(format);
+	}
+
+	const Day* day = find_day(t);
+	if (day == nullptr) {
+		// The UTC offset changes during this day, so nothing is cached
+		struct tm local;
+		if (localtime_r(&t, &local) == nullptr) {
+			return "";
+		}
+		return strftime_tm(format, local);
+	}
+
+	const time_t since_midnight = t - day->start;
+	struct tm local = day->midnight;
+	local.tm_hour = since_midnight / 3600;
+	local.tm_min = since_midnight / 60 % 60;
+	local.tm_sec = since_midnight % 60;
+
+	// Timestamps rarely repeat to the second, so those aren't remembered
+	const unsigned int resolution = memo->second.resolution;
+	if (resolution == 1) {
+		return strftime_tm(format, local);
+	}
+	const time_t key = resolution == 60
+		? t - since_midnight % 60
+		: day->start;
+
+	auto& strings = memo->second.strings;
+	const auto it = strings.find(key);
+	if (it != strings.end()) {
+		return it->second;
+	}
+
+	std::string result = strftime_tm(format, local);
+	if (strings.size() >= MAX_STRINGS) {
+		strings.clear();
+	}
+	strings.emplace(key, result);
+	return result;
+}
+
+unsigned int LocalTimeFormatter::resolution(const std::string& format)
+{
+	const std::string flags = "_-0^#123456789EO";
+	const std::string day_conversions = "aAbBhCdDeFgGjmuUVwWyYxntzZ%";
+	const std::string minute_conversions = "HIklMpPR";
+
+	unsigned int result = SECONDS_PER_DAY;
+	for (size_t i = 0; i < format.size(); ++i) {
+		if (format[i] != '%') {
+			continue;
+		}
+		// Skip flags, field widths and modifiers, e.g. in "%-d" or "%Ey"
+		++i;
+		while (i < format.size() && flags.find(format[i]) != std::string::npos) {
+			++i;
+		}
+		if (i == format.size()) {
+			break;
+		}
+
+		if (minute_conversions.find(format[i]) != std::string::npos) {
+			result = std::min(result, 60u);
+		} else if (day_conversions.find(format[i]) == std::string::npos) {
+			// Seconds, or something we don't know about
+			return 1;
+		}
+	}
+	return result;
+}
+
+void LocalTimeFormatter::check_timezone()
+{
+	const char* value = ::getenv("TZ");
+	const bool set = value != nullptr;
+	if (tz_known && set == tz_set && (!set || tz == value)) {
+		return;
+	}
+
+	// localtime_r() isn't required to look at TZ, unlike localtime()
+	tzset();
+	tz_known = true;
+	tz_set = set;
+	tz = set ? value : "";
+	clear();
+}
+
+void LocalTimeFormatter::clear()
+{
+	for (auto& day : days) {
+		day.start = 0;
+		day.end = 0;
+	}
+	last_offset = 0;
+	memos.clear();
+}
+
+const LocalTimeFormatter::Day* LocalTimeFormatter::find_day(time_t t)
+{
+	Day& guess = days[slot_index(t + last_offset, DAY_SLOTS)];
+	if (guess.start <= t && t < guess.end) {
+		return &guess;
+	}
+
+	struct tm local;
+	if (localtime_r(&t, &local) == nullptr) {
+		return nullptr;
+	}
+	last_offset = local.tm_gmtoff;
+
+	const time_t start = t
+		- (local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec);
+	const time_t end = start + SECONDS_PER_DAY;
+	const time_t last_second = end - 1;
+	struct tm midnight;
+	struct tm before_midnight;
+	if (localtime_r(&start, &midnight) == nullptr
+		|| localtime_r(&last_second, &before_midnight) == nullptr) {
+		return nullptr;
+	}
+	if (midnight.tm_hour != 0 || midnight.tm_min != 0 || midnight.tm_sec != 0
+		|| before_midnight.tm_hour != 23 || before_midnight.tm_min != 59
+		|| before_midnight.tm_sec != 59
+		|| !same_zone(midnight, local) || !same_zone(before_midnight, local)) {
+		return nullptr;
+	}
+
+	Day& day = days[slot_index(t + local.tm_gmtoff, DAY_SLOTS)];
+	day.start = start;
+	day.end = end;
+	day.midnight = midnight;
+	return &day;
+}
+
+std::string LocalTimeFormatter::strftime_tm(const std::string& format,
+	const struct tm& tm)
+{
+	const size_t BUFFER_SIZE = 4096;
+	char buffer[BUFFER_SIZE];
+	const size_t written = strftime(buffer, BUFFER_SIZE, format.c_str(), &tm);
+	return std::string(buffer, written);
+}
+
+} // namespace newsboat
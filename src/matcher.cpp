@@ -1,15 +1,19 @@
 #include "matcher.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cinttypes>
 #include <ctime>
 #include <regex.h>
 #include <sstream>
+#include <utility>
 #include <vector>
 
+#include "literalprefilter.h"
 #include "logger.h"
 #include "matchable.h"
 #include "matcherexception.h"
+#include "matcherprofiler.h"
 #include "scopemeasure.h"
 #include "utils.h"
 
@@ -28,6 +32,68 @@ std::string Matcher::get_expression()
 	return exp;
 }
 
+const expression* Matcher::get_syntax_tree() const
+{
+	return p.get_root();
+}
+
+std::vector<MatchAttribute> Matcher::get_attributes() const
+{
+	std::vector<MatchAttribute> attributes;
+	for (const auto& node : plan) {
+		if (node.op != LOGOP_AND && node.op != LOGOP_OR) {
+			attributes.push_back(node.attribute);
+		}
+	}
+	return attributes;
+}
+
+bool Matcher::reads_only_versioned_attributes() const
+{
+	for (const auto attribute : get_attributes()) {
+		// Attributes of the item that only change through its setters
+		switch (attribute) {
+		case MatchAttribute::TITLE:
+		case MatchAttribute::LINK:
+		case MatchAttribute::AUTHOR:
+		case MatchAttribute::CONTENT:
+		case MatchAttribute::DATE:
+		case MatchAttribute::GUID:
+		case MatchAttribute::UNREAD:
+		case MatchAttribute::ENCLOSURE_URL:
+		case MatchAttribute::ENCLOSURE_TYPE:
+		case MatchAttribute::FLAGS:
+		case MatchAttribute::ARTICLEINDEX:
+			break;
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Matcher::matches_comparison(const expression* e, Matchable* item) const
+{
+	for (size_t i = 0; i < plan.size(); ++i) {
+		if (plan[i].source == e) {
+			return evaluate(plan, i, item);
+		}
+	}
+	assert(false && "expression isn't part of this matcher");
+	return false;
+}
+
+void Matcher::add_to_profile(std::uint64_t evaluations, std::uint64_t matches,
+	std::chrono::steady_clock::duration time,
+	std::uint64_t description_fetches) const
+{
+	if (counters != nullptr) {
+		counters->add(evaluations, matches,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(),
+			description_fetches);
+	}
+}
+
 bool Matcher::parse(const std::string& expr)
 {
 	ScopeMeasure measurer("Matcher::parse");
@@ -42,6 +108,8 @@ bool Matcher::parse(const std::string& expr)
 		errmsg = utils::wstr2str(p.get_error());
 	}
 
+	compile();
+
 	LOG(Level::DEBUG,
 		"Matcher::parse: parsing `%s' succeeded: %d",
 		expr,
@@ -50,7 +118,7 @@ bool Matcher::parse(const std::string& expr)
 	return b;
 }
 
-bool Matcher::matches(Matchable* item)
+bool Matcher::matches(Matchable* item) const
 {
 	/*
 	 * with this method, every class that is derived from Matchable can be
@@ -65,19 +133,131 @@ bool Matcher::matches(Matchable* item)
 	 * The whole matching code is speed-critical, as the matching happens on
 	 * a lot of different occassions, and slow matching can be easily
 	 * measured (and felt by the user) on slow computers with a lot of items
-	 * to match.
+	 * to match. That's why parse() compiles the expression into a plan
+	 * first, and Matchables can hand out some attributes without formatting
+	 * them as strings (see attribute_ref() and attribute_number()).
 	 */
 	bool retval = false;
 	if (item) {
 		ScopeMeasure m1("Matcher::matches");
-		retval = matches_r(p.get_root(), item);
+		const bool timed = counters != nullptr && MatcherProfiler::sample();
+		std::chrono::steady_clock::time_point start;
+		if (timed) {
+			start = std::chrono::steady_clock::now();
+		}
+		const auto fetches = MatcherProfiler::description_fetch_count();
+		// An empty plan shouldn't happen
+		retval = plan.empty() || evaluate(plan, plan.size() - 1, item);
+		const auto time = timed ?
+			(std::chrono::steady_clock::now() - start) *
+			MatcherProfiler::SAMPLE_RATE :
+			std::chrono::steady_clock::duration::zero();
+		add_to_profile(1, retval, time,
+			MatcherProfiler::description_fetch_count() - fetches);
 	}
 	return retval;
 }
 
+std::vector<size_t> Matcher::matching_indices(size_t count,
+	const std::function<Matchable*(size_t)>& item_at,
+	const WorkerPool& pool) const
+{
+	ScopeMeasure sm("Matcher::matching_indices");
+
+	std::vector<std::vector<size_t>> results(pool.shard_count(count));
+	pool.run(count, [&](size_t shard, size_t begin, size_t end) {
+		// The first shard runs on the calling thread, and can use the
+		// plan itself
+		std::vector<PlanNode> own_plan;
+		if (shard > 0) {
+			own_plan = thread_plan();
+		}
+		const auto& nodes = (shard > 0) ? own_plan : plan;
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto fetches = MatcherProfiler::description_fetch_count();
+		std::uint64_t evaluations = 0;
+		auto& result = results[shard];
+		for (size_t i = begin; i < end; ++i) {
+			Matchable* item = item_at(i);
+			if (item == nullptr) {
+				continue;
+			}
+			evaluations++;
+			if (nodes.empty() || evaluate(nodes, nodes.size() - 1, item)) {
+				result.push_back(i);
+			}
+		}
+		add_to_profile(evaluations, result.size(),
+			std::chrono::steady_clock::now() - start,
+			MatcherProfiler::description_fetch_count() - fetches);
+	});
+
+	std::vector<size_t> indices = std::move(results[0]);
+	for (size_t shard = 1; shard < results.size(); ++shard) {
+		indices.insert(indices.end(),
+			results[shard].begin(),
+			results[shard].end());
+	}
+	return indices;
+}
+
+namespace {
+
+const std::pair<const char*, MatchAttribute> ATTRIBUTES[] = {
+	{"title", MatchAttribute::TITLE},
+	{"link", MatchAttribute::LINK},
+	{"author", MatchAttribute::AUTHOR},
+	{"content", MatchAttribute::CONTENT},
+	{"date", MatchAttribute::DATE},
+	{"guid", MatchAttribute::GUID},
+	{"unread", MatchAttribute::UNREAD},
+	{"enclosure_url", MatchAttribute::ENCLOSURE_URL},
+	{"enclosure_type", MatchAttribute::ENCLOSURE_TYPE},
+	{"flags", MatchAttribute::FLAGS},
+	{"age", MatchAttribute::AGE},
+	{"articleindex", MatchAttribute::ARTICLEINDEX},
+	{"feedtitle", MatchAttribute::FEEDTITLE},
+	{"description", MatchAttribute::DESCRIPTION},
+	{"feedlink", MatchAttribute::FEEDLINK},
+	{"feeddate", MatchAttribute::FEEDDATE},
+	{"rssurl", MatchAttribute::RSSURL},
+	{"unread_count", MatchAttribute::UNREAD_COUNT},
+	{"total_count", MatchAttribute::TOTAL_COUNT},
+	{"tags", MatchAttribute::TAGS},
+	{"feedindex", MatchAttribute::FEEDINDEX},
+};
+
+MatchAttribute resolve_attribute(const std::string& name)
+{
+	for (const auto& attribute : ATTRIBUTES) {
+		if (name == attribute.first) {
+			return attribute.second;
+		}
+	}
+	return MatchAttribute::UNKNOWN;
+}
+
+/// Checks if \a word is one of the space-separated words in \a list.
+bool contains_word(const std::string& list, const std::string& word)
+{
+	size_t start = 0;
+	while (start < list.length()) {
+		size_t end = list.find(' ', start);
+		if (end == std::string::npos) {
+			end = list.length();
+		}
+		if (end > start && list.compare(start, end - start, word) == 0) {
+			return true;
+		}
+		start = end + 1;
+	}
+	return false;
+}
+
 std::string get_attr_or_throw(Matchable* item, const std::string& attr_name)
 {
-	const auto attr = item->attribute_value(attr_name);
+	auto attr = item->attribute_value(attr_name);
 
 	if (!attr.has_value()) {
 		LOG(Level::WARN,
@@ -86,69 +266,184 @@ std::string get_attr_or_throw(Matchable* item, const std::string& attr_name)
 		throw MatcherException(MatcherException::Type::ATTRIB_UNAVAIL, attr_name);
 	}
 
-	return attr.value();
+	return std::move(attr.value());
 }
 
-bool Matcher::matchop_lt(expression* e, Matchable* item)
+} // namespace
+
+void Matcher::compile()
+{
+	plan.clear();
+	counters.reset();
+	if (p.get_root()) {
+		compile_r(p.get_root());
+
+		std::vector<std::string> attributes;
+		for (const auto& node : plan) {
+			if (node.op != LOGOP_AND && node.op != LOGOP_OR) {
+				attributes.push_back(node.name);
+			}
+		}
+		counters = MatcherProfiler::get_instance().counters(exp, attributes);
+	}
+}
+
+size_t Matcher::compile_r(expression* e)
 {
-	const int ilit = string_to_num(e->literal);
+	PlanNode node;
+	node.op = e->op;
+	node.attribute = MatchAttribute::UNKNOWN;
+	node.number = 0;
+	node.upper = 0;
+	node.has_range = false;
+	node.left = 0;
+	node.right = 0;
+	node.source = e;
+
+	switch (e->op) {
+	case LOGOP_AND:
+	case LOGOP_OR:
+		node.left = compile_r(e->l);
+		node.right = compile_r(e->r);
+		break;
+
+	case MATCHOP_LT:
+	case MATCHOP_GT:
+	case MATCHOP_LE:
+	case MATCHOP_GE:
+		node.number = string_to_num(e->literal);
+		break;
+
+	case MATCHOP_BETWEEN: {
+		const std::vector<std::string> lit = utils::tokenize(e->literal, ":");
+		if (lit.size() >= 2) {
+			node.has_range = true;
+			node.number = string_to_num(lit[0]);
+			node.upper = string_to_num(lit[1]);
+			if (node.number > node.upper) {
+				std::swap(node.number, node.upper);
+			}
+		}
+		break;
+	}
+	}
+
+	if (e->op != LOGOP_AND && e->op != LOGOP_OR) {
+		node.attribute = resolve_attribute(e->name);
+		node.name = e->name;
+		node.literal = e->literal;
+	}
 
-	const auto attr = get_attr_or_throw(item, e->name);
-	const int iatt = string_to_num(attr);
+	if (e->op == MATCHOP_RXEQ || e->op == MATCHOP_RXNE) {
+		compile_regex(node);
+		// Longest first, since those are least likely to occur
+		node.required_literals = LiteralPrefilter::required_literals(
+				node.literal);
+		std::stable_sort(node.required_literals.begin(),
+			node.required_literals.end(),
+		[](const std::string& a, const std::string& b) {
+			return a.size() > b.size();
+		});
+	}
 
-	return iatt < ilit;
+	plan.push_back(std::move(node));
+	return plan.size() - 1;
 }
 
-bool Matcher::matchop_between(expression* e, Matchable* item)
+void Matcher::compile_regex(PlanNode& node)
 {
-	const auto attr = get_attr_or_throw(item, e->name);
-	const int att = string_to_num(attr);
+	regex_t* regex = new regex_t;
+	const int err = regcomp(regex,
+			node.literal.c_str(),
+			REG_EXTENDED | REG_ICASE | REG_NOSUB);
+	if (err == 0) {
+		node.regex = std::shared_ptr<regex_t>(regex, [](regex_t* r) {
+			regfree(r);
+			delete r;
+		});
+	} else {
+		char buf[1024];
+		regerror(err, regex, buf, sizeof(buf));
+		delete regex;
+		// Like before expressions were compiled, invalid regexes are
+		// only reported once they're used
+		node.regex_error = buf;
+	}
+}
 
-	const std::vector<std::string> lit = utils::tokenize(e->literal, ":");
-	if (lit.size() < 2) {
-		return false;
+std::vector<Matcher::PlanNode> Matcher::thread_plan() const
+{
+	std::vector<PlanNode> nodes = plan;
+	for (auto& node : nodes) {
+		if (node.regex) {
+			compile_regex(node);
+		}
 	}
+	return nodes;
+}
 
-	int i1 = string_to_num(lit[0]);
-	int i2 = string_to_num(lit[1]);
-	if (i1 > i2) {
-		std::swap(i1, i2);
+const std::string& Matcher::string_value(const PlanNode& node,
+	Matchable* item,
+	std::string& storage) const
+{
+	const std::string* value = item->attribute_ref(node.attribute);
+	if (value != nullptr) {
+		return *value;
 	}
 
-	return (att >= i1 && att <= i2);
+	storage = get_attr_or_throw(item, node.name);
+	return storage;
 }
 
-bool Matcher::matchop_gt(expression* e, Matchable* item)
+int Matcher::number_value(const PlanNode& node, Matchable* item) const
 {
-	const auto attr = get_attr_or_throw(item, e->name);
-	const int iatt = string_to_num(attr);
+	int value = 0;
+	if (item->attribute_number(node.attribute, value)) {
+		return value;
+	}
 
-	const int ilit = string_to_num(e->literal);
+	std::string storage;
+	return string_to_num(string_value(node, item, storage));
+}
 
-	return iatt > ilit;
+bool Matcher::matchop_lt(const PlanNode& node, Matchable* item) const
+{
+	return number_value(node, item) < node.number;
 }
 
-bool Matcher::matchop_rxeq(expression* e, Matchable* item)
+bool Matcher::matchop_between(const PlanNode& node, Matchable* item) const
 {
-	const auto attr = get_attr_or_throw(item, e->name);
+	const int att = number_value(node, item);
+
+	if (!node.has_range) {
+		return false;
+	}
+
+	return (att >= node.number && att <= node.upper);
+}
 
-	if (!e->regex) {
-		e->regex = new regex_t;
-		int err;
-		if ((err = regcomp(e->regex,
-						e->literal.c_str(),
-						REG_EXTENDED | REG_ICASE | REG_NOSUB)) != 0) {
-			delete e->regex;
-			e->regex = nullptr;
-			char buf[1024];
-			regerror(err, e->regex, buf, sizeof(buf));
-			throw MatcherException(
-				MatcherException::Type::INVALID_REGEX,
-				e->literal,
-				buf);
+bool Matcher::matchop_gt(const PlanNode& node, Matchable* item) const
+{
+	return number_value(node, item) > node.number;
+}
+
+bool Matcher::matchop_rxeq(const PlanNode& node, Matchable* item) const
+{
+	std::string storage;
+	const auto& attr = string_value(node, item, storage);
+
+	if (!node.regex_error.empty()) {
+		throw MatcherException(
+			MatcherException::Type::INVALID_REGEX,
+			node.literal,
+			node.regex_error);
+	}
+	for (const auto& literal : node.required_literals) {
+		if (!LiteralPrefilter::contains(attr.data(), attr.size(), literal)) {
+			return false;
 		}
 	}
-	if (regexec(e->regex,
+	if (regexec(node.regex.get(),
 			attr.c_str(),
 			0,
 			nullptr,
@@ -158,80 +453,69 @@ bool Matcher::matchop_rxeq(expression* e, Matchable* item)
 	return false;
 }
 
-bool Matcher::matchop_cont(expression* e, Matchable* item)
+bool Matcher::matchop_cont(const PlanNode& node, Matchable* item) const
 {
-	const auto attr = get_attr_or_throw(item, e->name);
-
-	const std::vector<std::string> elements = utils::tokenize(attr, " ");
-	const std::string literal = e->literal;
-	for (const auto& elem : elements) {
-		if (literal == elem) {
-			return true;
-		}
-	}
-	return false;
+	std::string storage;
+	return contains_word(string_value(node, item, storage), node.literal);
 }
 
-bool Matcher::matchop_eq(expression* e, Matchable* item)
+bool Matcher::matchop_eq(const PlanNode& node, Matchable* item) const
 {
-	const auto attr = get_attr_or_throw(item, e->name);
-
-	return (attr == e->literal);
+	std::string storage;
+	return (string_value(node, item, storage) == node.literal);
 }
 
-bool Matcher::matches_r(expression* e, Matchable* item)
+bool Matcher::evaluate(const std::vector<PlanNode>& nodes, size_t index,
+	Matchable* item) const
 {
-	if (e) {
-		switch (e->op) {
-		/* the operator "and" and "or" simply connect two different
-		 * subexpressions */
-		case LOGOP_AND:
-			// short-circuit evaluation in C -> short circuit evaluation in the filter language
-			return matches_r(e->l, item) &&
-				matches_r(e->r, item);
+	const PlanNode& node = nodes[index];
+	switch (node.op) {
+	/* the operator "and" and "or" simply connect two different
+	 * subexpressions */
+	case LOGOP_AND:
+		// short-circuit evaluation in C -> short circuit evaluation in the filter language
+		return evaluate(nodes, node.left, item) &&
+			evaluate(nodes, node.right, item);
 
-		case LOGOP_OR:
-			return matches_r(e->l, item) ||
-				matches_r(e->r, item); // same here
+	case LOGOP_OR:
+		return evaluate(nodes, node.left, item) ||
+			evaluate(nodes, node.right, item); // same here
 
-		/* while the other operator connect an attribute with a value */
-		case MATCHOP_EQ:
-			return matchop_eq(e, item);
+	/* while the other operator connect an attribute with a value */
+	case MATCHOP_EQ:
+		return matchop_eq(node, item);
 
-		case MATCHOP_NE:
-			return !matchop_eq(e, item);
+	case MATCHOP_NE:
+		return !matchop_eq(node, item);
 
-		case MATCHOP_LT:
-			return matchop_lt(e, item);
+	case MATCHOP_LT:
+		return matchop_lt(node, item);
 
-		case MATCHOP_BETWEEN:
-			return matchop_between(e, item);
+	case MATCHOP_BETWEEN:
+		return matchop_between(node, item);
 
-		case MATCHOP_GT:
-			return matchop_gt(e, item);
+	case MATCHOP_GT:
+		return matchop_gt(node, item);
 
-		case MATCHOP_LE:
-			return !matchop_gt(e, item);
+	case MATCHOP_LE:
+		return !matchop_gt(node, item);
 
-		case MATCHOP_GE:
-			return !matchop_lt(e, item);
+	case MATCHOP_GE:
+		return !matchop_lt(node, item);
 
-		case MATCHOP_RXEQ:
-			return matchop_rxeq(e, item);
+	case MATCHOP_RXEQ:
+		return matchop_rxeq(node, item);
 
-		case MATCHOP_RXNE:
-			return !matchop_rxeq(e, item);
+	case MATCHOP_RXNE:
+		return !matchop_rxeq(node, item);
 
-		case MATCHOP_CONTAINS:
-			return matchop_cont(e, item);
+	case MATCHOP_CONTAINS:
+		return matchop_cont(node, item);
 
-		case MATCHOP_CONTAINSNOT:
-			return !matchop_cont(e, item);
-		}
-		return false;
-	} else {
-		return true; // shouldn't happen
+	case MATCHOP_CONTAINSNOT:
+		return !matchop_cont(node, item);
 	}
+	return false;
 }
 
 std::string Matcher::get_parse_error()
@@ -0,0 +1,155 @@
+#include "matcherprofiler.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "logger.h"
+#include "strprintf.h"
+#include "utils.h"
+
+namespace {
+
+thread_local std::uint64_t description_fetches = 0;
+thread_local unsigned int evaluations_until_sample = 0;
+
+/// How many expressions log_summary() lists.
+const size_t SUMMARY_SIZE = 20;
+
+} // namespace
+
+namespace newsboat {
+
+const unsigned int MatcherProfiler::SAMPLE_RATE;
+
+MatcherProfiler::Counters::Counters(std::vector<std::string> attrs)
+	: attributes(std::move(attrs))
+	, evaluations(0)
+	, matches(0)
+	, nanoseconds(0)
+	, description_fetches(0)
+{
+}
+
+void MatcherProfiler::Counters::add(std::uint64_t evals, std::uint64_t hits,
+	std::uint64_t ns, std::uint64_t fetches)
+{
+	evaluations.fetch_add(evals, std::memory_order_relaxed);
+	if (hits > 0) {
+		matches.fetch_add(hits, std::memory_order_relaxed);
+	}
+	if (ns > 0) {
+		nanoseconds.fetch_add(ns, std::memory_order_relaxed);
+	}
+	if (fetches > 0) {
+		description_fetches.fetch_add(fetches, std::memory_order_relaxed);
+	}
+}
+
+MatcherProfiler& MatcherProfiler::get_instance()
+{
+	static MatcherProfiler instance;
+	return instance;
+}
+
+std::shared_ptr<MatcherProfiler::Counters> MatcherProfiler::counters(
+	const std::string& expression,
+	const std::vector<std::string>& attributes)
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	auto& entry = expressions[expression];
+	if (entry == nullptr) {
+		std::vector<std::string> names = attributes;
+		std::sort(names.begin(), names.end());
+		names.erase(std::unique(names.begin(), names.end()), names.end());
+		entry = std::make_shared<Counters>(std::move(names));
+	}
+	return entry;
+}
+
+std::vector<ExpressionProfile> MatcherProfiler::get_profiles() const
+{
+	std::vector<ExpressionProfile> profiles;
+	{
+		std::lock_guard<std::mutex> guard(mtx);
+		for (const auto& entry : expressions) {
+			const Counters& counters = *entry.second;
+			ExpressionProfile profile;
+			profile.evaluations = counters.evaluations.load(
+					std::memory_order_relaxed);
+			if (profile.evaluations == 0) {
+				continue;
+			}
+			profile.expression = entry.first;
+			profile.attributes = counters.attributes;
+			profile.matches = counters.matches.load(std::memory_order_relaxed);
+			profile.time = counters.nanoseconds.load(
+					std::memory_order_relaxed) / 1e6;
+			profile.description_fetches = counters.description_fetches.load(
+					std::memory_order_relaxed);
+			profiles.push_back(std::move(profile));
+		}
+	}
+
+	std::sort(profiles.begin(), profiles.end(),
+	[](const ExpressionProfile& a, const ExpressionProfile& b) {
+		if (a.time != b.time) {
+			return a.time > b.time;
+		}
+		return a.expression < b.expression;
+	});
+	return profiles;
+}
+
+void MatcherProfiler::log_summary() const
+{
+	const auto profiles = get_profiles();
+	if (profiles.empty()) {
+		return;
+	}
+
+	double total = 0;
+	for (const auto& profile : profiles) {
+		total += profile.time;
+	}
+	LOG(Level::INFO,
+		"MatcherProfiler: %" PRIu64 " filter expressions took %.1f ms in "
+		"total, the most expensive ones were:",
+		static_cast<std::uint64_t>(profiles.size()),
+		total);
+
+	const size_t count = std::min(profiles.size(), SUMMARY_SIZE);
+	for (size_t i = 0; i < count; ++i) {
+		const auto& profile = profiles[i];
+		LOG(Level::INFO,
+			"MatcherProfiler: %.1f ms, %" PRIu64 " evaluations, %" PRIu64
+			" matches, %" PRIu64 " description fetches, reads %s: %s",
+			profile.time,
+			profile.evaluations,
+			profile.matches,
+			profile.description_fetches,
+			utils::join(profile.attributes, ","),
+			profile.expression);
+	}
+}
+
+bool MatcherProfiler::sample()
+{
+	if (evaluations_until_sample == 0) {
+		evaluations_until_sample = SAMPLE_RATE - 1;
+		return true;
+	}
+	evaluations_until_sample--;
+	return false;
+}
+
+void MatcherProfiler::description_fetched()
+{
+	description_fetches++;
+}
+
+std::uint64_t MatcherProfiler::description_fetch_count()
+{
+	return description_fetches;
+}
+
+} // namespace newsboat
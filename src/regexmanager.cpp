@@ -2,17 +2,28 @@
 
 #include <cstring>
 #include <iostream>
+#include <iterator>
 #include <stack>
 
 #include "config.h"
 #include "confighandlerexception.h"
 #include "logger.h"
+#include "rssitem.h"
 #include "strprintf.h"
 #include "utils.h"
 
+namespace {
+
+/// Items that are gone keep their results until the rules change, so the
+/// remembered results are dropped once there are this many.
+const size_t MAX_ARTICLE_MATCHES = 200000;
+
+} // namespace
+
 namespace newsboat {
 
 RegexManager::RegexManager()
+	: matchers_cacheable(true)
 {
 	// this creates the entries in the map. we need them there to have the
 	// "all" location work.
@@ -51,6 +62,31 @@ int RegexManager::article_matches(Matchable* item)
 	return -1;
 }
 
+int RegexManager::article_matches(RssItem* item)
+{
+	if (!matchers_cacheable) {
+		return article_matches(static_cast<Matchable*>(item));
+	}
+
+	// Versions are unique across items, so a cached result can't be mistaken
+	// for that of an item that later got the same address
+	const auto it = article_match_cache.find(item);
+	if (it != article_match_cache.end() && it->second.version == item->version()) {
+		return it->second.result;
+	}
+
+	const int result = article_matches(static_cast<Matchable*>(item));
+	if (it != article_match_cache.end()) {
+		it->second = ArticleMatch{item->version(), result};
+		return result;
+	}
+	if (article_match_cache.size() >= MAX_ARTICLE_MATCHES) {
+		article_match_cache.clear();
+	}
+	article_match_cache.emplace(item, ArticleMatch{item->version(), result});
+	return result;
+}
+
 void RegexManager::remove_last_regex(const std::string& location)
 {
 	auto& regexes = locations[location];
@@ -59,6 +95,8 @@ void RegexManager::remove_last_regex(const std::string& location)
 	}
 
 	regexes.pop_back();
+	required_literals[location].pop_back();
+	prefilters.erase(location);
 }
 
 std::map<size_t, std::string> RegexManager::extract_style_tags(std::string& str)
@@ -131,26 +169,16 @@ void RegexManager::merge_style_tag(std::map<size_t, std::string>& tags,
 	}
 
 	// Find the latest tag occurring before `end`.
-	// It is important that looping executes in ascending order of location.
 	std::string latest_tag = "</>";
-	for (const auto& location_tag : tags) {
-		size_t location = location_tag.first;
-		if (location > end) {
-			break;
-		}
-		latest_tag = location_tag.second;
+	auto after_end = tags.upper_bound(end);
+	if (after_end != tags.begin()) {
+		latest_tag = std::prev(after_end)->second;
 	}
 	tags[start] = tag;
 	tags[end] = latest_tag;
 
 	// Remove any old tags between the start and end marker
-	for (auto it = tags.begin(); it != tags.end(); ) {
-		if (it->first > start && it->first < end) {
-			it = tags.erase(it);
-		} else {
-			++it;
-		}
-	}
+	tags.erase(tags.upper_bound(start), tags.lower_bound(end));
 }
 
 void RegexManager::quote_and_highlight(std::string& str,
@@ -160,22 +188,27 @@ void RegexManager::quote_and_highlight(std::string& str,
 
 	auto tag_locations = extract_style_tags(str);
 
+	// Skip regexes whose required literal isn't in the line, which is most
+	// of them for most lines
+	std::vector<char> candidates;
+	get_prefilter(location).find(str.data(), str.length(), candidates);
+
 	for (unsigned int i = 0; i < regexes.size(); ++i) {
 		const auto& regex = regexes[i].first;
-		if (regex == nullptr) {
+		if (regex == nullptr || !candidates[i]) {
 			continue;
 		}
+		const std::string marker = strprintf::fmt("<%u>", i);
 		unsigned int offset = 0;
 		int eflags = 0;
 		while (offset < str.length()) {
-			const auto matches = regex->matches(str.substr(offset), 1, eflags);
+			const auto matches = regex->matches(str.c_str() + offset, 1, eflags);
 			eflags |= REG_NOTBOL; // Don't match beginning-of-line operator (^) in following checks
 			if (matches.empty()) {
 				break;
 			}
 			const auto& match = matches[0];
 			if (match.first != match.second) {
-				const std::string marker = strprintf::fmt("<%u>", i);
 				const int match_start = offset + match.first;
 				const int match_end = offset + match.second;
 				merge_style_tag(tag_locations, marker, match_start, match_end);
@@ -189,6 +222,24 @@ void RegexManager::quote_and_highlight(std::string& str,
 	insert_style_tags(str, tag_locations);
 }
 
+const LiteralPrefilter& RegexManager::get_prefilter(const std::string& location)
+{
+	auto& prefilter = prefilters[location];
+	if (prefilter == nullptr) {
+		prefilter.reset(new LiteralPrefilter(required_literals[location]));
+	}
+	return *prefilter;
+}
+
+void RegexManager::add_regex(const std::string& location,
+	std::shared_ptr<Regex> regex, const std::string& colorstr,
+	const std::string& literal)
+{
+	locations[location].push_back({regex, colorstr});
+	required_literals[location].push_back(literal);
+	prefilters.erase(location);
+}
+
 void RegexManager::handle_highlight_action(const std::vector<std::string>&
 	params)
 {
@@ -212,6 +263,7 @@ void RegexManager::handle_highlight_action(const std::vector<std::string>&
 				params[1],
 				errorMessage));
 	}
+	const std::string literal = LiteralPrefilter::required_literal(params[1]);
 	std::string colorstr;
 	if (params[2] != "default") {
 		colorstr.append("fg=");
@@ -263,7 +315,7 @@ void RegexManager::handle_highlight_action(const std::vector<std::string>&
 			params[1],
 			colorstr,
 			location);
-		locations[location].push_back({std::move(regex), colorstr});
+		add_regex(location, std::move(regex), colorstr, literal);
 	} else {
 		std::shared_ptr<Regex> sharedRegex(std::move(regex));
 		for (auto& location : locations) {
@@ -274,7 +326,7 @@ void RegexManager::handle_highlight_action(const std::vector<std::string>&
 				params[1],
 				colorstr,
 				location.first);
-			location.second.push_back({sharedRegex, colorstr});
+			add_regex(location.first, sharedRegex, colorstr, literal);
 		}
 	}
 	std::string line = "highlight";
@@ -347,10 +399,14 @@ void RegexManager::handle_highlight_article_action(const
 
 	int pos = locations["articlelist"].size();
 
-	locations["articlelist"].push_back({nullptr, colorstr});
+	add_regex("articlelist", nullptr, colorstr, "");
 
 	matchers.push_back(
 		std::pair<std::shared_ptr<Matcher>, int>(m, pos));
+	article_match_cache.clear();
+	if (!m->reads_only_versioned_attributes()) {
+		matchers_cacheable = false;
+	}
 }
 
 std::string RegexManager::get_attrs_stfl_string(const std::string& location,
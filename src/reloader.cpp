@@ -1,18 +1,22 @@
 #include "reloader.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cinttypes>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <ncurses.h>
 #include <thread>
 
+#include "cache.h"
 #include "controller.h"
 #include "curlhandle.h"
 #include "dbexception.h"
 #include "downloadthread.h"
 #include "fmtstrformatter.h"
-#include "reloadrangethread.h"
 #include "reloadthread.h"
+#include "reloadworkerthread.h"
 #include "rss/exception.h"
 #include "rssfeed.h"
 #include "rssparser.h"
@@ -22,10 +26,37 @@
 
 namespace newsboat {
 
+/// Feeds that published an article within this many seconds are reloaded
+/// before the rest.
+static const time_t RECENT_ACTIVITY_WINDOW = 7 * 24 * 60 * 60;
+
+static std::string reversed_domain(const std::string& url)
+{
+	size_t p = url.find("//");
+	p = (p == std::string::npos) ? 0 : p + 2;
+	std::string suff(url.substr(p));
+	p = suff.find('/');
+	std::string domain = suff.substr(0, p);
+	std::reverse(domain.begin(), domain.end());
+	return domain;
+}
+
+static bool has_recent_activity(std::shared_ptr<RssFeed> feed, time_t now)
+{
+	std::lock_guard<std::mutex> lock(feed->item_mutex);
+	for (const auto& item : feed->items()) {
+		if (item->pubDate_timestamp() + RECENT_ACTIVITY_WINDOW >= now) {
+			return true;
+		}
+	}
+	return false;
+}
+
 Reloader::Reloader(Controller* c, Cache* cc, ConfigContainer* cfg)
 	: ctrl(c)
 	, rsscache(cc)
 	, cfg(cfg)
+	, materialized_items(0)
 {
 }
 
@@ -35,11 +66,16 @@ void Reloader::spawn_reloadthread()
 	t.detach();
 }
 
-void Reloader::start_reload_all_thread(const std::vector<int>& indexes)
+bool Reloader::start_reload_all_thread(const std::vector<int>& indexes)
 {
 	LOG(Level::INFO, "starting reload all thread");
-	std::thread t(DownloadThread(*this, indexes));
+	// The mutex has to be locked by the thread that unlocks it, so only
+	// the thread itself can tell if it got to reload
+	auto started = std::make_shared<std::promise<bool>>();
+	std::future<bool> reloading = started->get_future();
+	std::thread t(DownloadThread(*this, indexes, started));
 	t.detach();
+	return reloading.get();
 }
 
 bool Reloader::trylock_reload_mutex()
@@ -58,10 +94,15 @@ void Reloader::reload(unsigned int pos,
 	CurlHandle* easyhandle)
 {
 	LOG(Level::DEBUG, "Reloader::reload: pos = %u max = %u", pos, max);
+	if (reload_queue.remove(pos)) {
+		LOG(Level::DEBUG,
+			"Reloader::reload: took feed #%u out of the reload queue",
+			pos);
+	}
 	std::shared_ptr<RssFeed> oldfeed = ctrl->get_feedcontainer()->get_feed(pos);
 	if (oldfeed) {
 		// Query feed reloading should be handled by the calling functions
-		// (e.g.  Reloader::reload_all() calling View::prepare_query_feed())
+		// (e.g.  Reloader::reload_all() calling View::update_query_feed())
 		if (oldfeed->is_query_feed()) {
 			LOG(Level::DEBUG, "Reloader::reload: skipping query feed");
 			return;
@@ -84,10 +125,19 @@ void Reloader::reload(unsigned int pos,
 			ignore_dl ? ctrl->get_ignores() : nullptr,
 			ctrl->get_api());
 		parser.set_easyhandle(easyhandle);
+		parser.set_fetch_coalescer(&fetch_coalescer);
+		// Remote APIs report read state through items we'd skip
+		if (ctrl->get_api() == nullptr &&
+			ctrl->get_ignores()->matches_stopatknown(oldfeed->rssurl())) {
+			parser.set_known_items(&known_items);
+		}
 		LOG(Level::DEBUG, "Reloader::reload: created parser");
 		try {
 			oldfeed->set_status(DlStatus::DURING_DOWNLOAD);
+			const auto fetch_start = std::chrono::steady_clock::now();
 			std::shared_ptr<RssFeed> newfeed = parser.parse();
+			materialized_items += parser.get_materialized_items();
+			const auto persist_start = std::chrono::steady_clock::now();
 			if (newfeed != nullptr) {
 				ctrl->replace_feed(
 					oldfeed, newfeed, pos, unattended);
@@ -96,6 +146,11 @@ void Reloader::reload(unsigned int pos,
 						"Reloader::reload: feed is empty");
 				}
 			}
+			const auto persist_end = std::chrono::steady_clock::now();
+			record_reload_stats(oldfeed->rssurl(),
+				parser.get_transfer_stats(),
+				persist_start - fetch_start,
+				persist_end - persist_start);
 			oldfeed->set_status(DlStatus::SUCCESS);
 			ctrl->get_view()->set_status("");
 		} catch (const DbException& e) {
@@ -124,6 +179,60 @@ void Reloader::reload(unsigned int pos,
 	}
 }
 
+void Reloader::record_reload_stats(const std::string& rssurl,
+	const rsspp::TransferStats& transfer,
+	std::chrono::steady_clock::duration fetch_and_parse,
+	std::chrono::steady_clock::duration persist)
+{
+	using milliseconds = std::chrono::duration<double, std::milli>;
+
+	// curl reports cumulative times in seconds, counted from the start of
+	// the transfer; turn them into durations of the individual phases.
+	const double namelookup = transfer.namelookup * 1000;
+	const double connect = transfer.connect * 1000;
+	const double appconnect = transfer.appconnect * 1000;
+	const double starttransfer = transfer.starttransfer * 1000;
+	const double total = transfer.total * 1000;
+
+	ReloadTimings timings;
+	timings.namelookup = namelookup;
+	timings.connect = std::max(0.0, connect - namelookup);
+	timings.tls = appconnect > 0 ? std::max(0.0, appconnect - connect) : 0;
+	timings.firstbyte =
+		std::max(0.0, starttransfer - std::max(connect, appconnect));
+	timings.transfer = std::max(0.0, total - starttransfer);
+	timings.size = transfer.size;
+	// RssParser::parse() both downloads and parses the feed, so whatever
+	// wasn't spent on the network was spent on parsing.
+	timings.parse =
+		std::max(0.0, milliseconds(fetch_and_parse).count() - total);
+	timings.persist = milliseconds(persist).count();
+
+	LOG(Level::DEBUG,
+		"Reloader::record_reload_stats: %s: dns = %.1fms connect = %.1fms "
+		"tls = %.1fms firstbyte = %.1fms transfer = %.1fms parse = %.1fms "
+		"persist = %.1fms size = %" PRIu64,
+		rssurl,
+		timings.namelookup,
+		timings.connect,
+		timings.tls,
+		timings.firstbyte,
+		timings.transfer,
+		timings.parse,
+		timings.persist,
+		timings.size);
+
+	try {
+		rsscache->update_reload_stats(rssurl, timings);
+	} catch (const DbException& e) {
+		LOG(Level::ERROR,
+			"Reloader::record_reload_stats: couldn't store stats for "
+			"%s: %s",
+			rssurl,
+			e.what());
+	}
+}
+
 std::string Reloader::prepare_message(unsigned int pos, unsigned int max)
 {
 	if (max > 0) {
@@ -150,40 +259,75 @@ void Reloader::reload_all(bool unattended)
 	const int max_threads = num_feeds;
 	num_threads = std::max(min_threads, std::min(num_threads, max_threads));
 
-	LOG(Level::DEBUG, "Reloader::reload_all: starting with reload all...");
-	if (num_threads == 1) {
-		reload_range(0, num_feeds - 1, num_feeds, unattended);
-	} else {
-		std::vector<std::pair<unsigned int, unsigned int>> partitions =
-				utils::partition_indexes(0, num_feeds - 1, num_threads);
-		std::vector<std::thread> threads;
-		LOG(Level::DEBUG,
-			"Reloader::reload_all: starting reload threads...");
-		for (int i = 0; i < num_threads - 1; i++) {
-			threads.push_back(std::thread(ReloadRangeThread(*this,
-						partitions[i].first,
-						partitions[i].second,
-						num_feeds,
-						unattended)));
-		}
-		LOG(Level::DEBUG,
-			"Reloader::reload_all: starting my own reload...");
-		reload_range(partitions[num_threads - 1].first,
-			partitions[num_threads - 1].second,
-			num_feeds,
-			unattended);
-		LOG(Level::DEBUG,
-			"Reloader::reload_all: joining other threads...");
-		for (size_t i = 0; i < threads.size(); i++) {
-			threads[i].join();
+	// Feeds from the same host are queued next to each other, so that a
+	// thread can reuse its connection. Priorities are applied on top of
+	// that order by the queue itself.
+	const auto feeds = ctrl->get_feedcontainer()->get_all_feeds();
+	std::vector<unsigned int> positions;
+	std::vector<std::string> domains;
+	for (unsigned int i = 0; i < feeds.size(); ++i) {
+		positions.push_back(i);
+		domains.push_back(reversed_domain(feeds[i]->rssurl()));
+	}
+	std::stable_sort(positions.begin(), positions.end(),
+	[&](unsigned int a, unsigned int b) {
+		return domains[a] < domains[b];
+	});
+
+	const time_t now = time(nullptr);
+	std::vector<std::pair<unsigned int, ReloadPriority>> queue;
+	for (const auto pos : positions) {
+		const auto& feed = feeds[pos];
+		if (feed->is_query_feed()) {
+			continue;
 		}
+		queue.emplace_back(pos, has_recent_activity(feed, now)
+			? ReloadPriority::RECENT_ACTIVITY
+			: ReloadPriority::OTHER);
+	}
+	reload_queue.reset(queue);
+
+	std::vector<std::string> rssurls;
+	for (const auto& feed : feeds) {
+		rssurls.push_back(feed->rssurl());
 	}
+	fetch_coalescer.reset(rssurls);
+	materialized_items = 0;
+
+	LOG(Level::DEBUG,
+		"Reloader::reload_all: starting %d reload threads...",
+		num_threads);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < num_threads - 1; i++) {
+		threads.push_back(std::thread(ReloadWorkerThread(*this,
+					num_feeds,
+					unattended)));
+	}
+	reload_queued(num_feeds, unattended);
+	LOG(Level::DEBUG, "Reloader::reload_all: joining other threads...");
+	for (size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+
+	LOG(Level::INFO,
+		"Reloader::reload_all: shared downloads saved %u transfers",
+		fetch_coalescer.saved_transfers());
+	fetch_coalescer.clear();
+	LOG(Level::INFO,
+		"Reloader::reload_all: materialized %u items",
+		materialized_items.load());
 
-	// refresh query feeds (update and sort)
+	if (reload_queue.cancelled()) {
+		LOG(Level::INFO, "Reloader::reload_all: reload was cancelled");
+	}
+
+	// refresh query feeds with the items of the feeds that were replaced,
+	// and those that changed since
 	LOG(Level::DEBUG, "Reloader::reload_all: refresh query feeds");
+	const auto replaced = ctrl->get_feedcontainer()->take_replaced_feeds();
 	for (const auto& feed : ctrl->get_feedcontainer()->get_all_feeds()) {
 		if (feed->is_query_feed()) {
-			ctrl->get_view()->prepare_query_feed(feed);
+			ctrl->get_view()->update_query_feed(feed, replaced);
 			feed->set_status(DlStatus::SUCCESS);
 		}
 	}
@@ -215,43 +359,43 @@ void Reloader::reload_indexes(const std::vector<int>& indexes, bool unattended)
 	}
 }
 
-void Reloader::reload_range(unsigned int start,
-	unsigned int end,
-	unsigned int size,
-	bool unattended)
+void Reloader::reload_queued(unsigned int size, bool unattended)
 {
-	std::vector<unsigned int> v;
-	for (unsigned int i = start; i <= end; ++i) {
-		v.push_back(i);
-	}
-
-	auto extract = [](std::string& s, const std::string& url) {
-		size_t p = url.find("//");
-		p = (p == std::string::npos) ? 0 : p + 2;
-		std::string suff(url.substr(p));
-		p = suff.find('/');
-		s = suff.substr(0, p);
-	};
+	CurlHandle easyhandle;
 
-	const auto feeds = ctrl->get_feedcontainer()->get_all_feeds();
+	while (const auto pos = reload_queue.pop()) {
+		LOG(Level::DEBUG,
+			"Reloader::reload_queued: reloading feed #%u",
+			*pos);
+		reload(*pos, size, unattended, &easyhandle);
+	}
+}
 
-	std::sort(v.begin(), v.end(), [&](unsigned int a, unsigned int b) {
-		std::string domain1, domain2;
-		extract(domain1, feeds[a]->rssurl());
-		extract(domain2, feeds[b]->rssurl());
-		std::reverse(domain1.begin(), domain1.end());
-		std::reverse(domain2.begin(), domain2.end());
-		return domain1 < domain2;
-	});
+void Reloader::prioritize(ReloadPriority priority,
+	const std::vector<unsigned int>& positions)
+{
+	reload_queue.set_boosted(priority, positions);
+}
 
-	CurlHandle easyhandle;
+bool Reloader::cancel_reload_all()
+{
+	const auto dropped = reload_queue.cancel();
+	if (dropped.empty()) {
+		return false;
+	}
 
-	for (const auto& i : v) {
-		LOG(Level::DEBUG,
-			"Reloader::reload_range: reloading feed #%u",
-			i);
-		reload(i, size, unattended, &easyhandle);
+	LOG(Level::INFO,
+		"Reloader::cancel_reload_all: skipping %" PRIu64 " feeds",
+		static_cast<uint64_t>(dropped.size()));
+	// Skipped feeds shouldn't look like they're still waiting for their
+	// turn.
+	for (const auto pos : dropped) {
+		const auto feed = ctrl->get_feedcontainer()->get_feed(pos);
+		if (feed) {
+			feed->set_status(DlStatus::SUCCESS);
+		}
 	}
+	return true;
 }
 
 void Reloader::notify(const std::string& msg)
@@ -0,0 +1,128 @@
+#include "reloadqueue.h"
+
+#include <cassert>
+
+namespace newsboat {
+
+ReloadQueue::ReloadQueue()
+	: is_cancelled(false)
+{
+}
+
+void ReloadQueue::reset(
+	const std::vector<std::pair<unsigned int, ReloadPriority>>& feeds)
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	entries.clear();
+	order.clear();
+	is_cancelled = false;
+
+	unsigned int seq = 0;
+	for (const auto& feed : feeds) {
+		const unsigned int pos = feed.first;
+		const ReloadPriority prio = effective_priority(pos, feed.second);
+		if (entries.emplace(pos, Entry{feed.second, prio, seq}).second) {
+			order.emplace(prio, seq, pos);
+			seq++;
+		}
+	}
+}
+
+void ReloadQueue::set_boosted(ReloadPriority priority,
+	const std::vector<unsigned int>& positions)
+{
+	assert(priority == ReloadPriority::OPEN_FEED ||
+		priority == ReloadPriority::VISIBLE);
+
+	std::lock_guard<std::mutex> guard(mtx);
+	auto& current = boosted[static_cast<std::size_t>(priority)];
+	const std::set<unsigned int> updated(positions.begin(), positions.end());
+	if (updated == current) {
+		return;
+	}
+
+	std::set<unsigned int> affected(current);
+	affected.insert(updated.begin(), updated.end());
+	current = updated;
+	for (const auto pos : affected) {
+		update_priority(pos);
+	}
+}
+
+nonstd::optional<unsigned int> ReloadQueue::pop()
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	if (order.empty()) {
+		return nonstd::nullopt;
+	}
+	const unsigned int pos = std::get<2>(*order.begin());
+	order.erase(order.begin());
+	entries.erase(pos);
+	return pos;
+}
+
+bool ReloadQueue::remove(unsigned int pos)
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	const auto it = entries.find(pos);
+	if (it == entries.end()) {
+		return false;
+	}
+	order.erase(Key(it->second.effective, it->second.seq, pos));
+	entries.erase(it);
+	return true;
+}
+
+std::vector<unsigned int> ReloadQueue::cancel()
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	std::vector<unsigned int> dropped;
+	for (const auto& key : order) {
+		dropped.push_back(std::get<2>(key));
+	}
+	entries.clear();
+	order.clear();
+	is_cancelled = true;
+	return dropped;
+}
+
+bool ReloadQueue::cancelled() const
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	return is_cancelled;
+}
+
+std::size_t ReloadQueue::size() const
+{
+	std::lock_guard<std::mutex> guard(mtx);
+	return entries.size();
+}
+
+ReloadPriority ReloadQueue::effective_priority(unsigned int pos,
+	ReloadPriority base) const
+{
+	for (std::size_t i = 0; i < boosted.size(); i++) {
+		const auto prio = static_cast<ReloadPriority>(i);
+		if (prio < base && boosted[i].count(pos) > 0) {
+			return prio;
+		}
+	}
+	return base;
+}
+
+void ReloadQueue::update_priority(unsigned int pos)
+{
+	const auto it = entries.find(pos);
+	if (it == entries.end()) {
+		return;
+	}
+	Entry& entry = it->second;
+	const ReloadPriority prio = effective_priority(pos, entry.base);
+	if (prio != entry.effective) {
+		order.erase(Key(entry.effective, entry.seq, pos));
+		entry.effective = prio;
+		order.emplace(prio, entry.seq, pos);
+	}
+}
+
+} // namespace newsboat
@@ -0,0 +1,146 @@
+#include "reloadstatsformaction.h"
+
+#include <map>
+#include <string>
+
+#include "config.h"
+#include "controller.h"
+#include "feedcontainer.h"
+#include "fmtstrformatter.h"
+#include "listformatter.h"
+#include "rssfeed.h"
+#include "strprintf.h"
+#include "utils.h"
+#include "view.h"
+
+namespace newsboat {
+
+/*
+ * The ReloadStatsFormAction lists the feeds that took the longest to reload,
+ * along with the time spent in each phase of the reload. The list is sorted
+ * by the cache, slowest feed first.
+ */
+
+ReloadStatsFormAction::ReloadStatsFormAction(View* vv,
+	std::string formstr,
+	ConfigContainer* cfg)
+	: FormAction(vv, formstr, cfg)
+	, stats_list("dialogs", FormAction::f,
+		  cfg->get_configvalue_as_int("scrolloff"))
+{
+}
+
+ReloadStatsFormAction::~ReloadStatsFormAction() {}
+
+void ReloadStatsFormAction::init()
+{
+	set_keymap_hints();
+
+	f.run(-3); // compute all widget dimensions
+
+	const unsigned int width = stats_list.get_width();
+	FmtStrFormatter fmt;
+	fmt.register_fmt('N', PROGRAM_NAME);
+	fmt.register_fmt('V', utils::program_version());
+	f.set("head",
+		fmt.do_format(
+			cfg->get_configvalue("reloadstats-title-format"), width));
+	do_redraw = true;
+}
+
+void ReloadStatsFormAction::prepare()
+{
+	if (!do_redraw) {
+		return;
+	}
+
+	std::map<std::string, std::string> titles;
+	for (const auto& feed : v->get_ctrl()->get_feedcontainer()->get_all_feeds()) {
+		titles[feed->rssurl()] = feed->title();
+	}
+
+	ListFormatter listfmt;
+	listfmt.add_line(utils::quote_for_stfl(strprintf::fmt(
+				"%8s %6s %7s %6s %6s %8s %6s %7s %8s  %s",
+				_("total"),
+				_("dns"),
+				_("connect"),
+				_("tls"),
+				_("ttfb"),
+				_("transfer"),
+				_("parse"),
+				_("persist"),
+				_("KiB"),
+				_("Feed"))));
+	for (const auto& s : stats) {
+		const ReloadTimings& avg = s.average;
+		std::string title = titles[s.rssurl];
+		if (title.empty()) {
+			title = utils::censor_url(s.rssurl);
+		}
+		listfmt.add_line(utils::quote_for_stfl(strprintf::fmt(
+					"%8.0f %6.0f %7.0f %6.0f %6.0f %8.0f %6.0f %7.0f %8.1f  %s",
+					avg.total(),
+					avg.namelookup,
+					avg.connect,
+					avg.tls,
+					avg.firstbyte,
+					avg.transfer,
+					avg.parse,
+					avg.persist,
+					avg.size / 1024.0,
+					title)));
+	}
+	stats_list.stfl_replace_lines(listfmt);
+
+	do_redraw = false;
+}
+
+KeyMapHintEntry* ReloadStatsFormAction::get_keymap_hint()
+{
+	static KeyMapHintEntry hints[] = {{OP_QUIT, _("Close")},
+		{OP_NIL, nullptr}
+	};
+	return hints;
+}
+
+bool ReloadStatsFormAction::process_operation(Operation op,
+	bool /* automatic */,
+	std::vector<std::string>* /* args */)
+{
+	switch (op) {
+	case OP_PREV:
+	case OP_SK_UP:
+		stats_list.move_up(cfg->get_configvalue_as_bool("wrap-scroll"));
+		break;
+	case OP_NEXT:
+	case OP_SK_DOWN:
+		stats_list.move_down(cfg->get_configvalue_as_bool("wrap-scroll"));
+		break;
+	case OP_SK_HOME:
+		stats_list.move_to_first();
+		break;
+	case OP_SK_END:
+		stats_list.move_to_last();
+		break;
+	case OP_SK_PGUP:
+		stats_list.move_page_up(cfg->get_configvalue_as_bool("wrap-scroll"));
+		break;
+	case OP_SK_PGDOWN:
+		stats_list.move_page_down(cfg->get_configvalue_as_bool("wrap-scroll"));
+		break;
+	case OP_QUIT:
+		v->pop_current_formaction();
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+std::string ReloadStatsFormAction::title()
+{
+	return _("Reload Statistics");
+}
+
+} // namespace newsboat
@@ -0,0 +1,19 @@
+#include "reloadworkerthread.h"
+
+namespace newsboat {
+
+ReloadWorkerThread::ReloadWorkerThread(Reloader& r,
+	unsigned int ss,
+	bool u)
+	: reloader(r)
+	, size(ss)
+	, unattended(u)
+{
+}
+
+void ReloadWorkerThread::operator()()
+{
+	reloader.reload_queued(size, unattended);
+}
+
+} // namespace newsboat
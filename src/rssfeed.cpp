@@ -2,16 +2,19 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <chrono>
 #include <cinttypes>
 #include <cstring>
 #include <curl/curl.h>
 #include <functional>
 #include <iostream>
 #include <langinfo.h>
+#include <limits>
 #include <sstream>
 #include <sys/utsname.h>
 #include <string.h>
 #include <time.h>
+#include <unordered_set>
 
 #include "cache.h"
 #include "config.h"
@@ -19,37 +22,49 @@
 #include "confighandlerexception.h"
 #include "dbexception.h"
 #include "htmlrenderer.h"
+#include "itemcolumns.h"
 #include "logger.h"
 #include "scopemeasure.h"
+#include "sqlfilter.h"
 #include "strprintf.h"
 #include "tagsouppullparser.h"
 #include "utils.h"
 
+namespace {
+
+std::atomic<uint64_t> next_version(0);
+
+} // namespace
+
 namespace newsboat {
 
 RssFeed::RssFeed(Cache* c)
 	: pubDate_(0)
+	, query_populated(false)
+	, matched_version(0)
 	, ch(c)
 	, search_feed(false)
 	, is_rtl_(false)
 	, idx(0)
 	, order(0)
 	, status_(DlStatus::SUCCESS)
+	, version_(++next_version)
+	, unread_counter(std::make_shared<UnreadCounter>())
+	, container(nullptr)
 {
 }
 
 RssFeed::~RssFeed()
 {
+	// Items may outlive the feed, e.g. in query feeds
+	for (const auto& item : items_) {
+		item->remove_unread_counter(unread_counter);
+	}
 }
 
-unsigned int RssFeed::unread_item_count() const
+void RssFeed::changed()
 {
-	std::lock_guard<std::mutex> lock(item_mutex);
-	return std::count_if(items_.begin(),
-			items_.end(),
-	[](const std::shared_ptr<RssItem>& item) {
-		return item->unread();
-	});
+	version_ = ++next_version;
 }
 
 bool RssFeed::matches_tag(const std::string& tag)
@@ -84,7 +99,39 @@ std::string RssFeed::get_tags() const
 
 void RssFeed::set_tags(const std::vector<std::string>& tags)
 {
+	std::lock_guard<std::mutex> lock(item_mutex);
+	const bool was_hidden = hidden();
 	tags_ = tags;
+	changed();
+
+	// Hidden feeds don't count towards the container's unread items
+	if (container != nullptr && hidden() != was_hidden) {
+		set_counted_container(hidden() ? nullptr : container);
+	}
+}
+
+void RssFeed::set_container(FeedContainer* c)
+{
+	std::lock_guard<std::mutex> lock(item_mutex);
+	container = c;
+	set_counted_container(hidden() ? nullptr : container);
+}
+
+void RssFeed::set_counted_container(FeedContainer* c)
+{
+	if (unread_counter->get_container() == c) {
+		return;
+	}
+
+	// Items are taken out of the count while the container is switched,
+	// so that each of them is counted by the container it was added to
+	for (const auto& item : items_) {
+		item->remove_unread_counter(unread_counter);
+	}
+	unread_counter->set_container(c);
+	for (const auto& item : items_) {
+		item->add_unread_counter(unread_counter);
+	}
 }
 
 std::string RssFeed::title() const
@@ -160,7 +207,41 @@ nonstd::optional<std::string> RssFeed::attribute_value(const std::string&
 	return nonstd::nullopt;
 }
 
-void RssFeed::update_items(std::vector<std::shared_ptr<RssFeed>> feeds)
+const std::string* RssFeed::attribute_ref(MatchAttribute attr) const
+{
+	switch (attr) {
+	case MatchAttribute::FEEDLINK:
+		return &link_;
+	case MatchAttribute::RSSURL:
+		return &rssurl_;
+	default:
+		return nullptr;
+	}
+}
+
+bool RssFeed::attribute_number(MatchAttribute attr, int& value) const
+{
+	unsigned int number = 0;
+	switch (attr) {
+	case MatchAttribute::UNREAD_COUNT:
+		number = unread_item_count();
+		break;
+	case MatchAttribute::TOTAL_COUNT:
+		number = items_.size();
+		break;
+	case MatchAttribute::FEEDINDEX:
+		number = idx;
+		break;
+	default:
+		return false;
+	}
+	value = static_cast<int>(std::min<unsigned int>(number,
+				std::numeric_limits<int>::max()));
+	return true;
+}
+
+void RssFeed::update_items(std::vector<std::shared_ptr<RssFeed>> feeds,
+	const ItemColumns* columns)
 {
 	std::lock_guard<std::mutex> lock(item_mutex);
 	if (query.empty()) {
@@ -173,34 +254,118 @@ void RssFeed::update_items(std::vector<std::shared_ptr<RssFeed>> feeds)
 
 	Matcher m(query);
 
+	for (const auto& item : items_) {
+		item->remove_unread_counter(unread_counter);
+	}
 	items_.clear();
 	items_guid_map.clear();
 
-	for (const auto& feed : feeds) {
-		if (feed->is_query_feed()) {
-			// don't fetch items from other query feeds!
-			continue;
+	matched_version = RssItem::latest_version();
+	append_matching_items(feeds, m, columns);
+
+	sm.stopover("matching");
+
+	std::sort(items_.begin(), items_.end());
+
+	sm.stopover("sorting");
+
+	query_populated = true;
+}
+
+void RssFeed::update_items(const std::vector<std::shared_ptr<RssFeed>>&
+	feeds,
+	const std::vector<std::shared_ptr<RssFeed>>& replaced,
+	const ArticleSortStrategy& sort_strategy)
+{
+	std::lock_guard<std::mutex> lock(item_mutex);
+	if (query.empty()) {
+		return;
+	}
+
+	LOG(Level::DEBUG,
+		"RssFeed::update_items: query = `%s', %" PRIu64 " replaced feeds",
+		query,
+		static_cast<uint64_t>(replaced.size()));
+
+	ScopeMeasure sm("RssFeed::update_items (incremental)");
+
+	std::unordered_set<std::string> replaced_urls;
+	for (const auto& feed : replaced) {
+		if (!feed->is_query_feed()) {
+			replaced_urls.insert(feed->rssurl());
 		}
-		for (const auto& item : feed->items()) {
-			if (!item->deleted() && m.matches(item.get())) {
-				LOG(Level::DEBUG, "RssFeed::update_items: Matcher matches!");
-				item->set_feedptr(feed);
-				items_.push_back(item);
-				items_guid_map[item->guid()] = item;
-			}
+	}
+
+	// Items that change from here on are looked at by the next update
+	const uint64_t seen_version = matched_version;
+	matched_version = RssItem::latest_version();
+
+	const auto retired = std::stable_partition(items_.begin(), items_.end(),
+	[&](const std::shared_ptr<RssItem>& item) {
+		return replaced_urls.count(item->feedurl()) == 0 &&
+			item->version() <= seen_version;
+	});
+	for (auto it = retired; it != items_.end(); ++it) {
+		(*it)->remove_unread_counter(unread_counter);
+		const auto entry = items_guid_map.find((*it)->guid());
+		if (entry != items_guid_map.end() && entry->second == *it) {
+			items_guid_map.erase(entry);
 		}
 	}
+	items_.erase(retired, items_.end());
+
+	sm.stopover("retiring");
+
+	// An item may change between the two passes, so the kept ones are
+	// skipped explicitly. Items of replaced feeds were all retired.
+	std::unordered_set<const RssItem*> kept_items;
+	for (const auto& item : items_) {
+		kept_items.insert(item.get());
+	}
+	const size_t kept = items_.size();
+	Matcher m(query);
+	const RssFeed* last_feed = nullptr;
+	bool last_feed_replaced = false;
+	append_matching_items(feeds, m, nullptr,
+	[&](const RssFeed& feed, const RssItem& item) {
+		if (&feed != last_feed) {
+			last_feed = &feed;
+			last_feed_replaced = replaced_urls.count(feed.rssurl()) != 0;
+		}
+		return last_feed_replaced ||
+			(item.version() > seen_version && kept_items.count(&item) == 0);
+	});
 
 	sm.stopover("matching");
 
-	std::sort(items_.begin(), items_.end());
+	// The kept items are usually sorted already (prepopulated query feeds
+	// aren't), in which case only the new ones need sorting before the two
+	// runs are merged
+	const auto comparator = item_comparator(sort_strategy);
+	if (comparator) {
+		const auto middle = items_.begin() + kept;
+		if (std::is_sorted(items_.begin(), middle, comparator)) {
+			std::stable_sort(middle, items_.end(), comparator);
+			std::inplace_merge(items_.begin(), middle, items_.end(),
+				comparator);
+		} else {
+			std::stable_sort(items_.begin(), items_.end(), comparator);
+		}
+	}
 
 	sm.stopover("sorting");
 }
 
+bool RssFeed::can_update_incrementally() const
+{
+	Matcher m(query);
+	return m.reads_only_versioned_attributes();
+}
+
 void RssFeed::set_rssurl(const std::string& u)
 {
 	rssurl_ = u;
+	changed();
 	if (utils::is_query_url(u)) {
 		/* Query string looks like this:
 		 *
@@ -246,22 +411,137 @@ void RssFeed::sort(const ArticleSortStrategy& sort_strategy)
 }
 
 void RssFeed::sort_unlocked(const ArticleSortStrategy& sort_strategy)
+{
+	const auto comparator = item_comparator(sort_strategy);
+	if (comparator) {
+		std::stable_sort(items_.begin(), items_.end(), comparator);
+	} else {
+		std::random_shuffle(items_.begin(), items_.end());
+	}
+}
+
+void RssFeed::append_matching_items(const std::vector<std::shared_ptr<RssFeed>>&
+	feeds,
+	const Matcher& m,
+	const ItemColumns* columns,
+	const std::function<bool(const RssFeed&, const RssItem&)>& is_candidate)
+{
+	struct Candidate {
+		const std::shared_ptr<RssFeed>* feed;
+		const std::shared_ptr<RssItem>* item;
+	};
+	std::vector<Candidate> candidates;
+	std::vector<std::string> feedurls;
+	for (const auto& feed : feeds) {
+		if (feed->is_query_feed()) {
+			// don't fetch items from other query feeds!
+			continue;
+		}
+		const size_t before = candidates.size();
+		for (const auto& item : feed->items()) {
+			if (!is_candidate || is_candidate(*feed, *item)) {
+				candidates.push_back({&feed, &item});
+			}
+		}
+		if (candidates.size() != before) {
+			feedurls.push_back(feed->rssurl());
+		}
+	}
+	if (candidates.empty()) {
+		return;
+	}
+
+	std::vector<size_t> matching;
+	bool matched = false;
+
+	// Matcher would fetch item contents from the cache one item at a time,
+	// so expressions that read them are evaluated by SQLite if possible
+	if (ch != nullptr && SqlFilter::reads_content(m)) {
+		const auto start = std::chrono::steady_clock::now();
+		const auto condition = SqlFilter::translate(m, time(nullptr));
+		if (condition.has_value()) {
+			try {
+				const auto guids = ch->fetch_matching_guids(condition.value(),
+						feedurls);
+				for (size_t i = 0; i < candidates.size(); ++i) {
+					const auto& item = *candidates[i].item;
+					const auto feed_guids = guids.find(
+							(*candidates[i].feed)->rssurl());
+					if (!item->deleted() && feed_guids != guids.end() &&
+						feed_guids->second.count(item->guid()) != 0) {
+						matching.push_back(i);
+					}
+				}
+				matched = true;
+				m.add_to_profile(candidates.size(), matching.size(),
+					std::chrono::steady_clock::now() - start);
+			} catch (const DbException& e) {
+				LOG(Level::ERROR,
+					"RssFeed::append_matching_items: couldn't match `%s' in "
+					"the cache, matching in memory instead: %s",
+					query,
+					e.what());
+			}
+		}
+	}
+
+	// Expressions that only read attributes with few distinct values can
+	// be evaluated on the columns, as long as they're up to date
+	if (!matched && columns != nullptr &&
+		columns->size() == candidates.size()) {
+		const auto start = std::chrono::steady_clock::now();
+		bool current = true;
+		for (size_t i = 0; i < candidates.size() && current; ++i) {
+			current = columns->describes(i, **candidates[i].item);
+		}
+		nonstd::optional<std::vector<uint8_t>> rows;
+		if (current) {
+			rows = columns->evaluate(m, time(nullptr));
+		}
+		if (rows.has_value()) {
+			for (size_t i = 0; i < rows->size(); ++i) {
+				if ((*rows)[i]) {
+					matching.push_back(i);
+				}
+			}
+			matched = true;
+			m.add_to_profile(candidates.size(), matching.size(),
+				std::chrono::steady_clock::now() - start);
+		}
+	}
+
+	if (!matched) {
+		matching = m.matching_indices(candidates.size(),
+		[&](size_t i) -> Matchable* {
+			const auto& item = *candidates[i].item;
+			return item->deleted() ? nullptr : item.get();
+		});
+	}
+
+	// Items are shared between query feeds, so their feed pointers are
+	// only updated after matching has finished
+	for (const size_t i : matching) {
+		const auto& item = *candidates[i].item;
+		item->set_feedptr(*candidates[i].feed);
+		item->add_unread_counter(unread_counter);
+		items_.push_back(item);
+		items_guid_map[item->guid()] = item;
+	}
+}
+
+RssFeed::ItemComparator RssFeed::item_comparator(const ArticleSortStrategy&
+	sort_strategy)
 {
 	switch (sort_strategy.sm) {
 	case ArtSortMethod::TITLE:
-		std::stable_sort(items_.begin(),
-			items_.end(),
-			[&](const std::shared_ptr<RssItem>& a,
+		return [sort_strategy](const std::shared_ptr<RssItem>& a,
 		const std::shared_ptr<RssItem>& b) {
 			const auto cmp = utils::strnaturalcmp(utils::utf8_to_locale(a->title()),
 					utils::utf8_to_locale(b->title()));
 			return sort_strategy.sd == SortDirection::DESC ? (cmp > 0) : (cmp < 0);
-		});
-		break;
+		};
 	case ArtSortMethod::FLAGS:
-		std::stable_sort(items_.begin(),
-			items_.end(),
-			[&](const std::shared_ptr<RssItem>& a,
+		return [sort_strategy](const std::shared_ptr<RssItem>& a,
 		const std::shared_ptr<RssItem>& b) {
 			return sort_strategy.sd ==
 				SortDirection::DESC
@@ -269,23 +549,17 @@ void RssFeed::sort_unlocked(const ArticleSortStrategy& sort_strategy)
 						b->flags().c_str()) > 0)
 				: (strcmp(a->flags().c_str(),
 						b->flags().c_str()) < 0);
-		});
-		break;
+		};
 	case ArtSortMethod::AUTHOR:
-		std::stable_sort(items_.begin(),
-			items_.end(),
-			[&](const std::shared_ptr<RssItem>& a,
+		return [sort_strategy](const std::shared_ptr<RssItem>& a,
 		const std::shared_ptr<RssItem>& b) {
 			const auto author_a = utils::utf8_to_locale(a->author());
 			const auto author_b = utils::utf8_to_locale(b->author());
 			const auto cmp = strcmp(author_a.c_str(), author_b.c_str());
 			return sort_strategy.sd == SortDirection::DESC ? (cmp > 0) : (cmp < 0);
-		});
-		break;
+		};
 	case ArtSortMethod::LINK:
-		std::stable_sort(items_.begin(),
-			items_.end(),
-			[&](const std::shared_ptr<RssItem>& a,
+		return [sort_strategy](const std::shared_ptr<RssItem>& a,
 		const std::shared_ptr<RssItem>& b) {
 			return sort_strategy.sd ==
 				SortDirection::DESC
@@ -293,12 +567,9 @@ void RssFeed::sort_unlocked(const ArticleSortStrategy& sort_strategy)
 						b->link().c_str()) > 0)
 				: (strcmp(a->link().c_str(),
 						b->link().c_str()) < 0);
-		});
-		break;
+		};
 	case ArtSortMethod::GUID:
-		std::stable_sort(items_.begin(),
-			items_.end(),
-			[&](const std::shared_ptr<RssItem>& a,
+		return [sort_strategy](const std::shared_ptr<RssItem>& a,
 		const std::shared_ptr<RssItem>& b) {
 			return sort_strategy.sd ==
 				SortDirection::DESC
@@ -306,12 +577,9 @@ void RssFeed::sort_unlocked(const ArticleSortStrategy& sort_strategy)
 						b->guid().c_str()) > 0)
 				: (strcmp(a->guid().c_str(),
 						b->guid().c_str()) < 0);
-		});
-		break;
+		};
 	case ArtSortMethod::DATE:
-		std::stable_sort(items_.begin(),
-			items_.end(),
-			[&](const std::shared_ptr<RssItem>& a,
+		return [sort_strategy](const std::shared_ptr<RssItem>& a,
 		const std::shared_ptr<RssItem>& b) {
 			// date is descending by default
 			return sort_strategy.sd == SortDirection::ASC
@@ -319,12 +587,11 @@ void RssFeed::sort_unlocked(const ArticleSortStrategy& sort_strategy)
 					b->pubDate_timestamp())
 				: (a->pubDate_timestamp() <
 					b->pubDate_timestamp());
-		});
-		break;
+		};
 	case ArtSortMethod::RANDOM:
-		std::random_shuffle(items_.begin(), items_.end());
 		break;
 	}
+	return nullptr;
 }
 
 void RssFeed::purge_deleted_items()
@@ -337,6 +604,7 @@ void RssFeed::purge_deleted_items()
 		std::lock_guard<std::mutex> lock2(items_guid_map_mutex);
 		for (const auto& item : items_) {
 			if (item->deleted()) {
+				item->remove_unread_counter(unread_counter);
 				items_guid_map.erase(item->guid());
 			}
 		}
@@ -6,11 +6,14 @@
 #include <curl/curl.h>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <langinfo.h>
+#include <set>
 #include <sstream>
 #include <sys/utsname.h>
 #include <string.h>
 #include <time.h>
+#include <unordered_set>
 
 #include "cache.h"
 #include "config.h"
@@ -19,7 +22,9 @@
 #include "dbexception.h"
 #include "htmlrenderer.h"
 #include "logger.h"
+#include "matcherexception.h"
 #include "rssfeed.h"
+#include "sqlfilter.h"
 #include "strprintf.h"
 #include "tagsouppullparser.h"
 #include "utils.h"
@@ -42,6 +47,11 @@ void RssIgnores::handle_action(const std::string& action,
 					ignore_expr,
 					m.get_parse_error()));
 		}
+		if (ignore_rssurl == "*") {
+			wildcard_ignores.push_back(ignores.size());
+		} else {
+			ignores_by_feed[ignore_rssurl].push_back(ignores.size());
+		}
 		ignores.push_back(FeedUrlExprPair(ignore_rssurl, new Matcher(ignore_expr)));
 	} else if (action == "always-download") {
 		if (params.empty()) {
@@ -50,6 +60,7 @@ void RssIgnores::handle_action(const std::string& action,
 
 		for (const auto& param : params) {
 			ignores_lastmodified.push_back(param);
+			ignores_lastmodified_set.insert(param);
 		}
 	} else if (action == "reset-unread-on-update") {
 		if (params.empty()) {
@@ -58,6 +69,16 @@ void RssIgnores::handle_action(const std::string& action,
 
 		for (const auto& param : params) {
 			resetflag.push_back(param);
+			resetflag_set.insert(param);
+		}
+	} else if (action == "stop-at-known-articles") {
+		if (params.empty()) {
+			throw ConfigHandlerException(ActionHandlerStatus::TOO_FEW_PARAMS);
+		}
+
+		for (const auto& param : params) {
+			stopatknown.push_back(param);
+			stopatknown_set.insert(param);
 		}
 	} else {
 		throw ConfigHandlerException(
@@ -86,6 +107,10 @@ void RssIgnores::dump_config(std::vector<std::string>& config_output)
 		config_output.push_back(strprintf::fmt(
 				"reset-unread-on-update %s", utils::quote(rf)));
 	}
+	for (const auto& sk : stopatknown) {
+		config_output.push_back(strprintf::fmt(
+				"stop-at-known-articles %s", utils::quote(sk)));
+	}
 }
 
 RssIgnores::~RssIgnores()
@@ -95,42 +120,132 @@ RssIgnores::~RssIgnores()
 	}
 }
 
+std::vector<size_t> RssIgnores::rules_for(const std::string& feedurl) const
+{
+	const auto feed_rules = ignores_by_feed.find(feedurl);
+	if (feed_rules == ignores_by_feed.end()) {
+		return wildcard_ignores;
+	}
+
+	// Rules are applied in the order they were configured
+	std::vector<size_t> rules;
+	rules.reserve(wildcard_ignores.size() + feed_rules->second.size());
+	std::merge(wildcard_ignores.begin(), wildcard_ignores.end(),
+		feed_rules->second.begin(), feed_rules->second.end(),
+		std::back_inserter(rules));
+	return rules;
+}
+
 bool RssIgnores::matches(RssItem* item)
 {
-	for (const auto& ign : ignores) {
-		LOG(Level::DEBUG,
-			"RssIgnores::matches: ign.first = `%s' item->feedurl = `%s'",
-			ign.first,
-			item->feedurl());
-		if (ign.first == "*" || item->feedurl() == ign.first) {
-			if (ign.second->matches(item)) {
-				LOG(Level::DEBUG,
-					"RssIgnores::matches: found match");
-				return true;
-			}
+	// Walks the same rules as rules_for() without building a vector, as
+	// this runs for every parsed item
+	static const std::vector<size_t> no_rules;
+	const auto feed_rules = ignores_by_feed.find(item->feedurl());
+	const auto& own = (feed_rules != ignores_by_feed.end())
+		? feed_rules->second
+		: no_rules;
+
+	auto wildcard = wildcard_ignores.begin();
+	auto feed = own.begin();
+	while (wildcard != wildcard_ignores.end() || feed != own.end()) {
+		size_t rule = 0;
+		if (feed == own.end() ||
+			(wildcard != wildcard_ignores.end() && *wildcard < *feed)) {
+			rule = *wildcard++;
+		} else {
+			rule = *feed++;
+		}
+
+		if (ignores[rule].second->matches(item)) {
+			LOG(Level::DEBUG,
+				"RssIgnores::matches: found match for `%s' in `%s'",
+				ignores[rule].second->get_expression(),
+				item->feedurl());
+			return true;
 		}
 	}
 	return false;
 }
 
+std::vector<size_t> RssIgnores::matching_indices(
+	const std::vector<std::shared_ptr<RssItem>>& items)
+{
+	// Usually all items belong to a single feed
+	std::set<size_t> rules;
+	std::unordered_set<std::string> feedurls;
+	for (const auto& item : items) {
+		if (feedurls.insert(item->feedurl()).second) {
+			const auto feed_rules = rules_for(item->feedurl());
+			rules.insert(feed_rules.begin(), feed_rules.end());
+		}
+	}
+
+	std::vector<char> ignored(items.size(), 0);
+	for (const size_t rule : rules) {
+		const auto& ign = ignores[rule];
+		const bool all_feeds = (ign.first == "*");
+		try {
+			const auto matching = ign.second->matching_indices(items.size(),
+			[&](size_t i) -> Matchable* {
+				RssItem* item = items[i].get();
+				if (ignored[i] || (!all_feeds && item->feedurl() != ign.first)) {
+					return nullptr;
+				}
+				return item;
+			});
+			for (const size_t i : matching) {
+				ignored[i] = 1;
+			}
+		} catch (const MatcherException& ex) {
+			LOG(Level::DEBUG,
+				"RssIgnores::matching_indices: can't evaluate `%s': %s",
+				ign.second->get_expression(),
+				ex.what());
+		}
+	}
+
+	std::vector<size_t> indices;
+	for (size_t i = 0; i < ignored.size(); ++i) {
+		if (ignored[i]) {
+			indices.push_back(i);
+		}
+	}
+	return indices;
+}
+
+nonstd::optional<std::string> RssIgnores::sql_condition(
+	const std::string& feedurl,
+	time_t now)
+{
+	std::vector<std::string> conditions;
+	for (const size_t rule : rules_for(feedurl)) {
+		const auto condition = SqlFilter::translate(*ignores[rule].second, now);
+		if (!condition.has_value()) {
+			return nonstd::nullopt;
+		}
+		conditions.push_back(condition.value());
+	}
+
+	if (conditions.empty()) {
+		return std::string("0");
+	}
+	return "(" + utils::join(conditions, " OR ") + ")";
+}
+
 bool RssIgnores::matches_lastmodified(const std::string& url)
 {
-	return std::find_if(ignores_lastmodified.begin(),
-			ignores_lastmodified.end(),
-	[&](const std::string& u) {
-		return u == url;
-	}) !=
-	ignores_lastmodified.end();
+	return ignores_lastmodified_set.count(url) != 0;
 }
 
 bool RssIgnores::matches_resetunread(const std::string& url)
 {
-	return std::find_if(resetflag.begin(),
-			resetflag.end(),
-	[&](const std::string& u) {
-		return u == url;
-	}) !=
-	resetflag.end();
+	return resetflag_set.count(url) != 0;
+}
+
+bool RssIgnores::matches_stopatknown(const std::string& url)
+{
+	return stopatknown_set.count(url) != 0;
 }
 
 } // namespace newsboat
@@ -3,14 +3,22 @@
 #include <algorithm>
 #include <cinttypes>
 #include <langinfo.h>
+#include <limits>
 
 #include "cache.h"
 #include "dbexception.h"
+#include "matcherprofiler.h"
 #include "rssfeed.h"
 #include "scopemeasure.h"
 #include "strprintf.h"
 #include "utils.h"
 
+namespace {
+
+std::atomic<uint64_t> next_version(0);
+
+} // namespace
+
 namespace newsboat {
 
 RssItem::RssItem(Cache* c)
@@ -22,39 +30,55 @@ RssItem::RssItem(Cache* c)
 	, enqueued_(false)
 	, deleted_(0)
 	, override_unread_(false)
+	, version_(++next_version)
 {
 }
 
 RssItem::~RssItem() {}
 
+uint64_t RssItem::latest_version()
+{
+	return next_version;
+}
+
+void RssItem::changed()
+{
+	version_ = ++next_version;
+}
+
 // RssItem setters
 
-void RssItem::set_title(const std::string& t)
+void RssItem::set_title(std::string t)
 {
-	title_ = t;
+	title_ = std::move(t);
 	utils::trim(title_);
+	changed();
 }
 
-void RssItem::set_link(const std::string& l)
+void RssItem::set_link(std::string l)
 {
-	link_ = l;
+	link_ = std::move(l);
 	utils::trim(link_);
+	changed();
 }
 
-void RssItem::set_author(const std::string& a)
+void RssItem::set_author(std::string a)
 {
-	author_ = a;
+	author_ = std::move(a);
+	changed();
 }
 
-void RssItem::set_description(const std::string& d)
+void RssItem::set_description(std::string d)
 {
 	std::lock_guard<std::mutex> guard(description_mutex);
-	description_ = d;
+	description_ = std::move(d);
+	changed();
 }
 
 void RssItem::set_size(unsigned int size)
 {
 	size_ = size;
+	changed();
 }
 
 std::string RssItem::length() const
@@ -76,21 +100,35 @@ std::string RssItem::length() const
 void RssItem::set_pubDate(time_t t)
 {
 	pubDate_ = t;
+	changed();
 }
 
-void RssItem::set_guid(const std::string& g)
+void RssItem::set_guid(std::string g)
 {
-	guid_ = g;
+	{
+		// Feed containers count unread items by GUID
+		std::lock_guard<std::mutex> guard(unread_mutex);
+		if (unread_) {
+			for (const auto& counter : unread_counters) {
+				counter->item_changed(guid_, false);
+				counter->item_changed(g, true);
+			}
+		}
+		guid_ = std::move(g);
+	}
+	changed();
 }
 
 void RssItem::set_unread_nowrite(bool u)
 {
-	unread_ = u;
+	store_unread(u);
+	changed();
 }
 
 void RssItem::set_unread_nowrite_notify(bool u, bool notify)
 {
-	unread_ = u;
+	store_unread(u);
+	changed();
 	std::shared_ptr<RssFeed> feedptr = feedptr_.lock();
 	if (feedptr && notify) {
 		feedptr->get_item_by_guid(guid_)->set_unread_nowrite(
@@ -102,7 +140,8 @@ void RssItem::set_unread(bool u)
 {
 	if (unread_ != u) {
 		bool old_u = unread_;
-		unread_ = u;
+		store_unread(u);
+		changed();
 		std::shared_ptr<RssFeed> feedptr = feedptr_.lock();
 		if (feedptr)
 			feedptr->get_item_by_guid(guid_)->set_unread_nowrite(
@@ -115,25 +154,65 @@ void RssItem::set_unread(bool u)
 		} catch (const DbException& e) {
 			// if the update failed, restore the old unread flag and
 			// rethrow the exception
-			unread_ = old_u;
+			store_unread(old_u);
+			changed();
 			throw;
 		}
 	}
 }
 
+void RssItem::add_unread_counter(const std::shared_ptr<UnreadCounter>&
+	counter)
+{
+	std::lock_guard<std::mutex> guard(unread_mutex);
+	unread_counters.push_back(counter);
+	if (unread_) {
+		counter->item_changed(guid_, true);
+	}
+}
+
+void RssItem::remove_unread_counter(const std::shared_ptr<UnreadCounter>&
+	counter)
+{
+	std::lock_guard<std::mutex> guard(unread_mutex);
+	const auto it = std::find(unread_counters.begin(), unread_counters.end(),
+			counter);
+	if (it == unread_counters.end()) {
+		return;
+	}
+	unread_counters.erase(it);
+	if (unread_) {
+		counter->item_changed(guid_, false);
+	}
+}
+
+void RssItem::store_unread(bool u)
+{
+	std::lock_guard<std::mutex> guard(unread_mutex);
+	if (unread_ == u) {
+		return;
+	}
+	unread_ = u;
+	for (const auto& counter : unread_counters) {
+		counter->item_changed(guid_, u);
+	}
+}
+
 std::string RssItem::pubDate() const
 {
 	return utils::mt_strf_localtime(_("%a, %d %b %Y %T %z"), pubDate_);
 }
 
-void RssItem::set_enclosure_url(const std::string& url)
+void RssItem::set_enclosure_url(std::string url)
 {
-	enclosure_url_ = url;
+	enclosure_url_ = std::move(url);
+	changed();
 }
 
-void RssItem::set_enclosure_type(const std::string& type)
+void RssItem::set_enclosure_type(std::string type)
 {
-	enclosure_type_ = type;
+	enclosure_type_ = std::move(type);
+	changed();
 }
 
 nonstd::optional<std::string> RssItem::attribute_value(const std::string&
@@ -151,6 +230,7 @@ nonstd::optional<std::string> RssItem::attribute_value(const std::string&
 		if (description_.has_value()) {
 			return utils::utf8_to_locale(description_.value());
 		} else if (ch) {
+			MatcherProfiler::description_fetched();
 			std::string description = ch->fetch_description(*this);
 			return utils::utf8_to_locale(description);
 		}
@@ -183,6 +263,54 @@ nonstd::optional<std::string> RssItem::attribute_value(const std::string&
 	return nonstd::nullopt;
 }
 
+const std::string* RssItem::attribute_ref(MatchAttribute attr) const
+{
+	static const std::string yes = "yes";
+	static const std::string no = "no";
+
+	switch (attr) {
+	case MatchAttribute::LINK:
+		return &link_;
+	case MatchAttribute::GUID:
+		return &guid_;
+	case MatchAttribute::UNREAD:
+		return unread_ ? &yes : &no;
+	case MatchAttribute::ENCLOSURE_URL:
+		return &enclosure_url_;
+	case MatchAttribute::ENCLOSURE_TYPE:
+		return &enclosure_type_;
+	case MatchAttribute::FLAGS:
+		return &flags_;
+	default:
+		return nullptr;
+	}
+}
+
+bool RssItem::attribute_number(MatchAttribute attr, int& value) const
+{
+	switch (attr) {
+	case MatchAttribute::AGE: {
+		const time_t age = (time(nullptr) - pubDate_timestamp()) / 86400;
+		value = static_cast<int>(std::max<time_t>(
+					std::numeric_limits<int>::min(),
+					std::min<time_t>(age, std::numeric_limits<int>::max())));
+		return true;
+	}
+	case MatchAttribute::ARTICLEINDEX:
+		value = static_cast<int>(std::min<unsigned int>(idx,
+					std::numeric_limits<int>::max()));
+		return true;
+	case MatchAttribute::UNREAD_COUNT:
+	case MatchAttribute::TOTAL_COUNT:
+	case MatchAttribute::FEEDINDEX: {
+		std::shared_ptr<RssFeed> feedptr = feedptr_.lock();
+		return feedptr && feedptr->RssFeed::attribute_number(attr, value);
+	}
+	default:
+		return false;
+	}
+}
+
 void RssItem::update_flags()
 {
 	if (ch) {
@@ -211,16 +339,23 @@ void RssItem::sort_flags()
 
 	// Erase doubled characters
 	flags_.erase(std::unique(flags_.begin(), flags_.end()), flags_.end());
+	changed();
 }
 
 void RssItem::set_feedptr(std::shared_ptr<RssFeed> ptr)
 {
-	feedptr_ = std::weak_ptr<RssFeed>(ptr);
+	set_feedptr(std::weak_ptr<RssFeed>(ptr));
 }
 
 void RssItem::set_feedptr(const std::weak_ptr<RssFeed>& ptr)
 {
+	// Query feeds set the pointer of every item they match, so only an
+	// actual move counts as a change
+	const bool moved = feedptr_.owner_before(ptr) || ptr.owner_before(feedptr_);
 	feedptr_ = ptr;
+	if (moved) {
+		changed();
+	}
 }
 
 } // namespace newsboat
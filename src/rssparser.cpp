@@ -11,7 +11,9 @@
 #include "config.h"
 #include "configcontainer.h"
 #include "curlhandle.h"
+#include "fetchcoalescer.h"
 #include "htmlrenderer.h"
+#include "knownitems.h"
 #include "logger.h"
 #include "minifluxapi.h"
 #include "newsblurapi.h"
@@ -38,6 +40,11 @@ RssParser::RssParser(const std::string& uri,
 	, ign(ii)
 	, api(a)
 	, easyhandle(0)
+	, fetch_coalescer(nullptr)
+	, known_items(nullptr)
+	, early_stop_allowed(false)
+	, stopped_early(false)
+	, materialized_items(0)
 {
 	is_ttrss = cfgcont->get_configvalue("urls-source") == "ttrss";
 	is_newsblur = cfgcont->get_configvalue("urls-source") == "newsblur";
@@ -49,6 +56,12 @@ RssParser::~RssParser() {}
 
 std::shared_ptr<RssFeed> RssParser::parse()
 {
+	const time_t now = ::time(nullptr);
+	early_stop_allowed = known_items != nullptr &&
+		known_items->allows_early_stop(my_uri, now);
+	stopped_early = false;
+	materialized_items = 0;
+
 	retrieve_uri(my_uri);
 
 	if (f.rss_version == rsspp::Feed::Version::UNKNOWN) {
@@ -69,25 +82,90 @@ std::shared_ptr<RssFeed> RssParser::parse()
 	 */
 
 	fill_feed_fields(feed);
+
+	// fill_feed_items() moves the strings out of `f`, so the items have to
+	// be fingerprinted first
+	std::vector<std::pair<std::string, std::uint64_t>> fingerprints;
+	if (known_items) {
+		fingerprints.reserve(f.items.size());
+		for (const auto& item : f.items) {
+			fingerprints.emplace_back(get_guid(item),
+				KnownItems::fingerprint(item));
+		}
+	}
+
 	fill_feed_items(feed);
+	materialized_items = f.items.size();
 
-	ch->remove_old_deleted_items(feed.get());
+	LOG(Level::INFO,
+		"RssParser::parse: materialized %u items of %s%s",
+		materialized_items,
+		my_uri,
+		stopped_early ? " (stopped at known items)" : "");
+
+	// Items that weren't parsed aren't gone from the feed, so the deleted
+	// ones must stay in the cache too
+	if (!stopped_early) {
+		ch->remove_old_deleted_items(feed.get());
+	}
+
+	if (known_items) {
+		update_known_items(feed, fingerprints, now);
+	}
 
 	return feed;
 }
 
-time_t RssParser::parse_date(const std::string& datestr)
+rsspp::StreamParser::ItemHandler RssParser::make_item_handler()
 {
-	time_t t = curl_getdate(datestr.c_str(), nullptr);
-	if (t == -1) {
+	if (!early_stop_allowed) {
+		return nullptr;
+	}
+
+	unsigned int run = 0;
+	return [this, run](const rsspp::Item& item) mutable {
+		if (known_items->is_known(my_uri,
+				get_guid(item),
+				KnownItems::fingerprint(item))) {
+			run++;
+		} else {
+			run = 0;
+		}
+		if (run >= KnownItems::RUN_LENGTH) {
+			stopped_early = true;
+			return false;
+		}
+		return true;
+	};
+}
+
+void RssParser::update_known_items(std::shared_ptr<RssFeed> feed,
+	const std::vector<std::pair<std::string, std::uint64_t>>& items,
+	time_t now)
+{
+	// Stopping at known items only makes sense if new items come first
+	bool ordered = true;
+	const auto& feed_items = feed->items();
+	for (size_t i = 1; i < feed_items.size(); ++i) {
+		if (feed_items[i]->pubDate_timestamp() >
+			feed_items[i - 1]->pubDate_timestamp()) {
+			ordered = false;
+			break;
+		}
+	}
+	if (!ordered) {
 		LOG(Level::INFO,
-			"RssParser::parse_date: encountered t == -1, trying "
-			"out "
-			"W3CDTF parser...");
-		t = curl_getdate(
-				rsspp::RssParser::w3cdtf_to_rfc822(datestr).c_str(),
-				nullptr);
+			"RssParser::parse: items of %s aren't sorted newest "
+			"first, will parse the whole feed next time",
+			my_uri);
 	}
+
+	known_items->update(my_uri, items, !early_stop_allowed, ordered, now);
+}
+
+time_t RssParser::parse_date(const std::string& datestr)
+{
+	time_t t = date_parser.parse(datestr);
 	if (t == -1) {
 		LOG(Level::INFO,
 			"RssParser::parse_date: still t == -1, setting to "
@@ -165,7 +243,11 @@ void RssParser::retrieve_uri(const std::string& uri)
 	} else if (is_miniflux) {
 		fetch_miniflux(uri);
 	} else if (utils::is_http_url(uri)) {
-		download_http(uri);
+		if (is_shared_fetch(uri)) {
+			download_shared(uri);
+		} else {
+			download_http(uri);
+		}
 	} else if (utils::is_exec_url(uri)) {
 		get_execplugin(uri.substr(5, uri.length() - 5));
 	} else if (utils::is_filter_url(uri)) {
@@ -209,6 +291,9 @@ void RssParser::download_http(const std::string& uri)
 			utils::get_proxy_type(proxy_type),
 			cfgcont->get_configvalue_as_bool(
 				"ssl-verifypeer"));
+		p.set_parse_while_downloading(cfgcont->get_configvalue_as_bool(
+				"parse-while-downloading"));
+		p.set_item_handler(make_item_handler());
 		time_t lm = 0;
 		std::string etag;
 		if (!ign || !ign->matches_lastmodified(uri)) {
@@ -220,6 +305,7 @@ void RssParser::download_http(const std::string& uri)
 				api,
 				cfgcont->get_configvalue("cookie-cache"),
 				easyhandle ? easyhandle->ptr() : 0);
+		transfer_stats = p.get_transfer_stats();
 		LOG(Level::DEBUG,
 			"RssParser::download_http: lm = %" PRId64 " etag = %s",
 			// On GCC, `time_t` is `long int`, which is at least 32 bits
@@ -260,10 +346,46 @@ void RssParser::download_http(const std::string& uri)
 		(f.rss_version != rsspp::Feed::Version::UNKNOWN) ? "true" : "false");
 }
 
+void RssParser::download_shared(const std::string& uri)
+{
+	// Other feeds are going to use the same body, so we can't make the
+	// request conditional on this feed's Last-Modified and ETag.
+	const std::string buf = retrieve_shared(uri);
+	transfer_stats = rsspp::TransferStats();
+	transfer_stats.size = buf.length();
+	rsspp::Parser p;
+	p.set_item_handler(make_item_handler());
+	f = p.parse_buffer(buf, uri);
+	LOG(Level::DEBUG,
+		"RssParser::parse: shared http URL %s, valid: %s",
+		uri,
+		(f.rss_version != rsspp::Feed::Version::UNKNOWN) ? "true" : "false");
+}
+
+bool RssParser::is_shared_fetch(const std::string& uri) const
+{
+	// Remote APIs add their own authentication to requests, so their
+	// responses can't be handed to other feeds.
+	return fetch_coalescer != nullptr && api == nullptr &&
+		fetch_coalescer->is_shared(uri);
+}
+
+std::string RssParser::retrieve_shared(const std::string& uri)
+{
+	if (!is_shared_fetch(uri)) {
+		return utils::retrieve_url(uri, cfgcont);
+	}
+	ConfigContainer* cfg = cfgcont;
+	return *fetch_coalescer->fetch(uri, [&uri, cfg]() {
+		return FetchCoalescer::download(uri, cfg);
+	});
+}
+
 void RssParser::get_execplugin(const std::string& plugin)
 {
 	std::string buf = utils::get_command_output(plugin);
 	rsspp::Parser p;
+	p.set_item_handler(make_item_handler());
 	f = p.parse_buffer(buf);
 	LOG(Level::DEBUG,
 		"RssParser::parse: execplugin %s, valid = %s",
@@ -274,6 +396,7 @@ void RssParser::get_execplugin(const std::string& plugin)
 void RssParser::parse_file(const std::string& file)
 {
 	rsspp::Parser p;
+	p.set_item_handler(make_item_handler());
 	f = p.parse_file(file);
 	LOG(Level::DEBUG,
 		"RssParser::parse: parsed file %s, valid = %s",
@@ -284,7 +407,7 @@ void RssParser::parse_file(const std::string& file)
 void RssParser::download_filterplugin(const std::string& filter,
 	const std::string& uri)
 {
-	std::string buf = utils::retrieve_url(uri, cfgcont);
+	std::string buf = retrieve_shared(uri);
 
 	const char* argv[4] = {"/bin/sh",
 			"-c",
@@ -297,6 +420,7 @@ void RssParser::download_filterplugin(const std::string& filter,
 		filter,
 		result);
 	rsspp::Parser p;
+	p.set_item_handler(make_item_handler());
 	f = p.parse_buffer(result);
 	LOG(Level::DEBUG,
 		"RssParser::parse: filterplugin %s, valid = %s",
@@ -339,11 +463,15 @@ void RssParser::fill_feed_items(std::shared_ptr<RssFeed> feed)
 	/*
 	 * we iterate over all items of a feed, create an RssItem object for
 	 * each item, and fill it with the appropriate values from the data
-	 * structure.
+	 * structure. The strings are moved out of the rsspp items, which
+	 * aren't needed afterwards.
 	 */
-	for (const auto& item : f.items) {
+	for (auto& item : f.items) {
 		std::shared_ptr<RssItem> x(new RssItem(ch));
 
+		// The GUID may be made up of fields that are moved out below
+		std::string guid = get_guid(item);
+
 		set_item_title(feed, x, item);
 
 		if (!item.link.empty()) {
@@ -352,7 +480,7 @@ void RssParser::fill_feed_items(std::shared_ptr<RssFeed> feed)
 		}
 
 		if (x->link().empty() && item.guid_isPermaLink) {
-			x->set_link(item.guid);
+			x->set_link(guid);
 		}
 
 		set_item_author(x, item);
@@ -430,16 +558,17 @@ void RssParser::fill_feed_items(std::shared_ptr<RssFeed> feed)
 			x->set_pubDate(::time(nullptr));
 		}
 
-		x->set_guid(get_guid(item));
+		x->set_guid(std::move(guid));
 
-		x->set_base(item.base);
+		x->set_base(std::move(item.base));
 
 		set_item_enclosure(x, item);
 
+		// The description was logged by set_item_content()
 		LOG(Level::DEBUG,
 			"RssParser::parse: item title = `%s' link = `%s' "
 			"pubDate "
-			"= `%s' (%" PRId64 ") description = `%s'",
+			"= `%s' (%" PRId64 ")",
 			x->title(),
 			x->link(),
 			x->pubDate(),
@@ -447,8 +576,7 @@ void RssParser::fill_feed_items(std::shared_ptr<RssFeed> feed)
 			// according to the spec. On x86_64, it's actually 64 bits. Thus,
 			// casting to int64_t is either a no-op, or an up-cast which are
 			// always safe.
-			static_cast<int64_t>(x->pubDate_timestamp()),
-			x->description());
+			static_cast<int64_t>(x->pubDate_timestamp()));
 
 		add_item_to_feed(feed, x);
 	}
@@ -456,11 +584,11 @@ void RssParser::fill_feed_items(std::shared_ptr<RssFeed> feed)
 
 void RssParser::set_item_title(std::shared_ptr<RssFeed> feed,
 	std::shared_ptr<RssItem> x,
-	const rsspp::Item& item)
+	rsspp::Item& item)
 {
-	std::string title = item.title;
+	std::string title = std::move(item.title);
 
-	if (item.title.empty()) {
+	if (title.empty()) {
 		title = utils::make_title(item.link);
 	}
 
@@ -468,12 +596,12 @@ void RssParser::set_item_title(std::shared_ptr<RssFeed> feed,
 		x->set_title(render_xhtml_title(title, feed->link()));
 	} else {
 		replace_newline_characters(title);
-		x->set_title(title);
+		x->set_title(std::move(title));
 	}
 }
 
 void RssParser::set_item_author(std::shared_ptr<RssItem> x,
-	const rsspp::Item& item)
+	rsspp::Item& item)
 {
 	/*
 	 * some feeds only have a feed-wide managingEditor, which we use as an
@@ -486,38 +614,45 @@ void RssParser::set_item_author(std::shared_ptr<RssItem> x,
 			x->set_author(f.dc_creator);
 		}
 	} else {
-		x->set_author(item.author);
+		x->set_author(std::move(item.author));
 	}
 }
 
 void RssParser::set_item_content(std::shared_ptr<RssItem> x,
-	const rsspp::Item& item)
+	rsspp::Item& item)
 {
-	handle_content_encoded(x, item);
+	// The description is put together here and handed to the item once,
+	// as RssItem::description() returns a copy
+	std::string description;
+
+	handle_content_encoded(description, item);
 
-	handle_itunes_summary(x, item);
+	handle_itunes_summary(description, item);
 
-	if (x->description().empty()) {
-		x->set_description(item.description);
+	if (description.empty()) {
+		description = std::move(item.description);
 	} else {
 		if (cfgcont->get_configvalue_as_bool(
 				"always-display-description") &&
-			!item.description.empty())
-			x->set_description(
-				x->description() + "<hr>" + item.description);
+			!item.description.empty()) {
+			description.append("<hr>");
+			description.append(item.description);
+		}
 	}
 
 	/* if it's still empty and we shall download the full page, then we do
 	 * so. */
-	if (x->description().empty() &&
+	if (description.empty() &&
 		cfgcont->get_configvalue_as_bool("download-full-page") &&
 		!x->link().empty()) {
-		x->set_description(utils::retrieve_url(x->link(), cfgcont));
+		description = utils::retrieve_url(x->link(), cfgcont);
 	}
 
 	LOG(Level::DEBUG,
 		"RssParser::set_item_content: content = %s",
-		x->description());
+		description);
+
+	x->set_description(std::move(description));
 }
 
 std::string RssParser::get_guid(const rsspp::Item& item) const
@@ -543,16 +678,16 @@ std::string RssParser::get_guid(const rsspp::Item& item) const
 }
 
 void RssParser::set_item_enclosure(std::shared_ptr<RssItem> x,
-	const rsspp::Item& item)
+	rsspp::Item& item)
 {
-	x->set_enclosure_url(item.enclosure_url);
-	x->set_enclosure_type(item.enclosure_type);
 	LOG(Level::DEBUG,
 		"RssParser::parse: found enclosure_url: %s",
 		item.enclosure_url);
 	LOG(Level::DEBUG,
 		"RssParser::parse: found enclosure_type: %s",
 		item.enclosure_type);
+	x->set_enclosure_url(std::move(item.enclosure_url));
+	x->set_enclosure_type(std::move(item.enclosure_type));
 }
 
 void RssParser::add_item_to_feed(std::shared_ptr<RssFeed> feed,
@@ -579,36 +714,36 @@ void RssParser::add_item_to_feed(std::shared_ptr<RssFeed> feed,
 	}
 }
 
-void RssParser::handle_content_encoded(std::shared_ptr<RssItem> x,
-	const rsspp::Item& item) const
+void RssParser::handle_content_encoded(std::string& description,
+	rsspp::Item& item) const
 {
-	if (!x->description().empty()) {
+	if (!description.empty()) {
 		return;
 	}
 
 	/* here we handle content:encoded tags that are an extension but very
 	 * widespread */
 	if (!item.content_encoded.empty()) {
-		x->set_description(item.content_encoded);
+		description = std::move(item.content_encoded);
 	} else {
 		LOG(Level::DEBUG,
 			"RssParser::parse: found no content:encoded");
 	}
 }
 
-void RssParser::handle_itunes_summary(std::shared_ptr<RssItem> x,
+void RssParser::handle_itunes_summary(std::string& description,
 	const rsspp::Item& item)
 {
-	if (!x->description().empty()) {
+	if (!description.empty()) {
 		return;
 	}
 
-	std::string summary = item.itunes_summary;
+	const std::string& summary = item.itunes_summary;
 	if (!summary.empty()) {
-		std::string desc = "<ituneshack>";
-		desc.append(summary);
-		desc.append("</ituneshack>");
-		x->set_description(desc);
+		description.reserve(summary.length() + 25);
+		description.append("<ituneshack>");
+		description.append(summary);
+		description.append("</ituneshack>");
 	}
 }
 
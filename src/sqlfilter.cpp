@@ -0,0 +1,259 @@
+#include "sqlfilter.h"
+
+#include <cinttypes>
+#include <regex.h>
+#include <vector>
+
+#include "dbexception.h"
+#include "FilterParser.h"
+#include "matcher.h"
+#include "strprintf.h"
+#include "utils.h"
+
+namespace {
+
+// Same as in Matcher
+const int REGEX_FLAGS = REG_EXTENDED | REG_ICASE | REG_NOSUB;
+
+std::string quote(const std::string& literal)
+{
+	return "'" + newsboat::utils::replace_all(literal, "'", "''") + "'";
+}
+
+std::string age(time_t now)
+{
+	return newsboat::strprintf::fmt("((%" PRId64 " - pubDate) / 86400)",
+			static_cast<int64_t>(now));
+}
+
+/// Returns the SQL for an attribute that Matcher compares as a string, or an
+/// empty string if the attribute isn't stored in `rss_item` the way
+/// RssItem::attribute_value() returns it.
+std::string string_value(const std::string& name, time_t now)
+{
+	if (name == "title" || name == "author" || name == "content") {
+		// RssItem converts these to the locale's encoding
+		return newsboat::utils::locale_is_utf8() ? name : "";
+	} else if (name == "link") {
+		return "url";
+	} else if (name == "guid") {
+		return "guid";
+	} else if (name == "enclosure_url" || name == "enclosure_type" ||
+		name == "flags") {
+		return "IFNULL(" + name + ", '')";
+	} else if (name == "unread") {
+		return "(CASE WHEN unread THEN 'yes' ELSE 'no' END)";
+	} else if (name == "age") {
+		return "CAST(" + age(now) + " AS TEXT)";
+	}
+	return "";
+}
+
+/// Like string_value(), but for attributes that Matcher compares as numbers.
+std::string number_value(const std::string& name, time_t now)
+{
+	if (name == "age") {
+		// RssItem clamps the age to an int
+		return "MAX(-2147483648, MIN(2147483647, " + age(now) + "))";
+	}
+	return "";
+}
+
+bool translate_r(const expression* e, time_t now, std::string& sql)
+{
+	if (e == nullptr) {
+		return false;
+	}
+
+	switch (e->op) {
+	case LOGOP_AND:
+	case LOGOP_OR: {
+		std::string left;
+		std::string right;
+		if (!translate_r(e->l, now, left) || !translate_r(e->r, now, right)) {
+			return false;
+		}
+		sql = "(" + left + (e->op == LOGOP_AND ? " AND " : " OR ") + right +
+			")";
+		return true;
+	}
+
+	case MATCHOP_EQ:
+	case MATCHOP_NE: {
+		const std::string value = string_value(e->name, now);
+		if (value.empty()) {
+			return false;
+		}
+		sql = "(" + value + (e->op == MATCHOP_EQ ? " = " : " != ") +
+			quote(e->literal) + ")";
+		return true;
+	}
+
+	case MATCHOP_RXEQ:
+	case MATCHOP_RXNE: {
+		const std::string value = string_value(e->name, now);
+		if (value.empty()) {
+			return false;
+		}
+		// Invalid regexes are left to Matcher, which reports them
+		regex_t regex;
+		if (regcomp(&regex, e->literal.c_str(), REGEX_FLAGS) != 0) {
+			return false;
+		}
+		regfree(&regex);
+		sql = std::string("(") + (e->op == MATCHOP_RXNE ? "NOT " : "") +
+			value + " REGEXP " + quote(e->literal) + ")";
+		return true;
+	}
+
+	case MATCHOP_CONTAINS:
+	case MATCHOP_CONTAINSNOT: {
+		const std::string value = string_value(e->name, now);
+		// Matcher looks for a space-separated word equal to the literal,
+		// which a literal with spaces never is
+		if (value.empty() || e->literal.empty() ||
+			e->literal.find(' ') != std::string::npos) {
+			return false;
+		}
+		sql = "(instr(' ' || " + value + " || ' ', " +
+			quote(" " + e->literal + " ") + ")" +
+			(e->op == MATCHOP_CONTAINS ? " > 0)" : " = 0)");
+		return true;
+	}
+
+	case MATCHOP_LT:
+	case MATCHOP_GT:
+	case MATCHOP_LE:
+	case MATCHOP_GE: {
+		const std::string value = number_value(e->name, now);
+		if (value.empty()) {
+			return false;
+		}
+		const char* op = "";
+		switch (e->op) {
+		case MATCHOP_LT:
+			op = " < ";
+			break;
+		case MATCHOP_GT:
+			op = " > ";
+			break;
+		case MATCHOP_LE:
+			op = " <= ";
+			break;
+		default:
+			op = " >= ";
+			break;
+		}
+		sql = "(" + value + op +
+			std::to_string(newsboat::Matcher::string_to_num(e->literal)) + ")";
+		return true;
+	}
+
+	case MATCHOP_BETWEEN: {
+		const std::string value = number_value(e->name, now);
+		if (value.empty()) {
+			return false;
+		}
+		const std::vector<std::string> lit =
+			newsboat::utils::tokenize(e->literal, ":");
+		if (lit.size() < 2) {
+			sql = "0";
+			return true;
+		}
+		int lower = newsboat::Matcher::string_to_num(lit[0]);
+		int upper = newsboat::Matcher::string_to_num(lit[1]);
+		if (lower > upper) {
+			std::swap(lower, upper);
+		}
+		sql = "(" + value + " BETWEEN " + std::to_string(lower) + " AND " +
+			std::to_string(upper) + ")";
+		return true;
+	}
+	}
+
+	return false;
+}
+
+bool reads_content_r(const expression* e)
+{
+	if (e == nullptr) {
+		return false;
+	}
+	if (e->op == LOGOP_AND || e->op == LOGOP_OR) {
+		return reads_content_r(e->l) || reads_content_r(e->r);
+	}
+	return e->name == "content";
+}
+
+void free_regex(void* regex)
+{
+	regfree(static_cast<regex_t*>(regex));
+	delete static_cast<regex_t*>(regex);
+}
+
+/// Implements `X REGEXP Y`, which SQLite turns into `regexp(Y, X)`.
+void regexp(sqlite3_context* context, int /* argc */, sqlite3_value** argv)
+{
+	// SQLite keeps the compiled pattern around while the statement runs
+	regex_t* regex = static_cast<regex_t*>(sqlite3_get_auxdata(context, 0));
+	const bool compiled = (regex == nullptr);
+	if (compiled) {
+		const unsigned char* pattern = sqlite3_value_text(argv[0]);
+		regex = new regex_t;
+		if (pattern == nullptr ||
+			regcomp(regex, reinterpret_cast<const char*>(pattern),
+				REGEX_FLAGS) != 0) {
+			delete regex;
+			sqlite3_result_error(context, "invalid regular expression", -1);
+			return;
+		}
+	}
+
+	const unsigned char* text = sqlite3_value_text(argv[1]);
+	const int result = regexec(regex,
+			text ? reinterpret_cast<const char*>(text) : "",
+			0,
+			nullptr,
+			0);
+
+	if (compiled) {
+		sqlite3_set_auxdata(context, 0, regex, free_regex);
+	}
+	sqlite3_result_int(context, result == 0);
+}
+
+} // namespace
+
+namespace newsboat {
+
+nonstd::optional<std::string> SqlFilter::translate(const Matcher& m,
+	time_t now)
+{
+	std::string sql;
+	if (!translate_r(m.get_syntax_tree(), now, sql)) {
+		return nonstd::nullopt;
+	}
+	return sql;
+}
+
+bool SqlFilter::reads_content(const Matcher& m)
+{
+	return reads_content_r(m.get_syntax_tree());
+}
+
+void SqlFilter::register_functions(sqlite3* db)
+{
+	const int rc = sqlite3_create_function(db,
+			"regexp",
+			2,
+			SQLITE_UTF8,
+			nullptr,
+			regexp,
+			nullptr,
+			nullptr);
+	if (rc != SQLITE_OK) {
+		throw DbException(db);
+	}
+}
+
+} // namespace newsboat
@@ -500,7 +500,7 @@ std::string TagSoupPullParser::decode_entity(std::string s)
 			"'%s'",
 			wc,
 			pos,
-			mbc);
+			static_cast<const char*>(mbc));
 		return result;
 	} else {
 		for (unsigned int i = 0; entity_table[i].entity; ++i) {
@@ -0,0 +1,32 @@
+#include "unreadcounter.h"
+
+#include "feedcontainer.h"
+
+namespace newsboat {
+
+UnreadCounter::UnreadCounter()
+	: count(0)
+	, container(nullptr)
+{
+}
+
+void UnreadCounter::set_container(FeedContainer* c)
+{
+	container = c;
+}
+
+void UnreadCounter::item_changed(const std::string& guid, bool unread)
+{
+	if (unread) {
+		count++;
+	} else {
+		count--;
+	}
+
+	FeedContainer* const c = container;
+	if (c != nullptr) {
+		c->unread_item_changed(guid, unread);
+	}
+}
+
+} // namespace newsboat
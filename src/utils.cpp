@@ -4,6 +4,7 @@
 #include <cinttypes>
 #include <cmath>
 #include <cstdarg>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -15,6 +16,7 @@
 #include <langinfo.h>
 #include <libxml/uri.h>
 #include <locale>
+#include <map>
 #include <mutex>
 #include <pwd.h>
 #include <regex>
@@ -25,9 +27,11 @@
 #include <sys/utsname.h>
 #include <unistd.h>
 #include <unordered_set>
+#include <utility>
 
 #include "config.h"
 #include "htmlrenderer.h"
+#include "localtimeformatter.h"
 #include "logger.h"
 #include "ruststring.h"
 #include "strprintf.h"
@@ -312,6 +316,120 @@ std::string utils::translit(const std::string& tocode,
 			: (tocode));
 }
 
+/*
+ * of all the Unix-like systems around there, only Linux/glibc seems to
+ * come with a SuSv3-conforming iconv implementation.
+ */
+#if !defined(__linux__) && !defined(__GLIBC__) && !defined(__APPLE__) && \
+	!defined(__OpenBSD__) && !defined(__FreeBSD__) &&                \
+	!defined(__DragonFly__)
+#define ICONV_INBUF(p) const_cast<const char**>(p)
+#else
+#define ICONV_INBUF(p) (p)
+#endif
+
+namespace {
+
+/// An open iconv descriptor, and whether it leaves ASCII text unchanged.
+struct Converter {
+	iconv_t cd;
+	bool ascii_transparent;
+};
+
+/// Opening an iconv descriptor means loading conversion tables, which
+/// costs much more than converting a title. Each thread keeps the
+/// descriptors it has opened, since they aren't safe to share.
+class ConverterCache {
+public:
+	~ConverterCache()
+	{
+		for (const auto& entry : converters) {
+			if (entry.second.cd != reinterpret_cast<iconv_t>(-1)) {
+				iconv_close(entry.second.cd);
+			}
+		}
+	}
+
+	/// Returns a converter with cd == (iconv_t)-1 if iconv doesn't support
+	/// the conversion.
+	const Converter& get(const std::string& tocode,
+		const std::string& fromcode)
+	{
+		const auto key = std::make_pair(tocode, fromcode);
+		auto it = converters.find(key);
+		if (it == converters.end()) {
+			it = converters.emplace(key, open(tocode, fromcode)).first;
+		}
+		return it->second;
+	}
+
+private:
+	static Converter open(const std::string& tocode,
+		const std::string& fromcode)
+	{
+		Converter converter;
+		converter.cd = ::iconv_open(
+				utils::translit(tocode, fromcode).c_str(), fromcode.c_str());
+		converter.ascii_transparent = false;
+		if (converter.cd == reinterpret_cast<iconv_t>(-1)) {
+			return converter;
+		}
+
+		// Most charsets are supersets of ASCII, but not all (UTF-16,
+		// WCHAR_T), so ask iconv rather than keep a list.
+		char ascii[127];
+		for (size_t i = 0; i < sizeof(ascii); ++i) {
+			ascii[i] = static_cast<char>(i + 1);
+		}
+		char out[sizeof(ascii) * 4];
+		char* inbufp = ascii;
+		char* outbufp = out;
+		size_t inbytesleft = sizeof(ascii);
+		size_t outbytesleft = sizeof(out);
+		::iconv(converter.cd, nullptr, nullptr, nullptr, nullptr);
+		const size_t rc = ::iconv(converter.cd, ICONV_INBUF(&inbufp),
+				&inbytesleft, &outbufp, &outbytesleft);
+		converter.ascii_transparent = rc == 0 && inbytesleft == 0 &&
+			outbufp - out == sizeof(ascii) &&
+			memcmp(ascii, out, sizeof(ascii)) == 0;
+
+		return converter;
+	}
+
+	std::map<std::pair<std::string, std::string>, Converter> converters;
+};
+
+thread_local ConverterCache converter_cache;
+
+/// Checks eight bytes at a time whether any of the first \a length bytes
+/// of \a text has its high bit set.
+bool is_ascii(const char* text, size_t length)
+{
+	const uint64_t high_bits = 0x8080808080808080ULL;
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+		uint64_t chunk;
+		memcpy(&chunk, text + i, sizeof(chunk));
+		if (chunk & high_bits) {
+			return false;
+		}
+	}
+	for (; i < length; ++i) {
+		if (text[i] & 0x80) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool is_utf8(const char* charset)
+{
+	return strcasecmp(charset, "utf-8") == 0 ||
+		strcasecmp(charset, "utf8") == 0;
+}
+
+} // namespace
+
 std::string utils::convert_text(const std::string& text,
 	const std::string& tocode,
 	const std::string& fromcode)
@@ -322,67 +440,54 @@ std::string utils::convert_text(const std::string& text,
 		return text;
 	}
 
-	iconv_t cd = ::iconv_open(
-			translit(tocode, fromcode).c_str(), fromcode.c_str());
-
-	if (cd == reinterpret_cast<iconv_t>(-1)) {
+	const Converter& converter = converter_cache.get(tocode, fromcode);
+	if (converter.cd == reinterpret_cast<iconv_t>(-1)) {
 		return result;
 	}
 
-	size_t inbytesleft;
-	size_t outbytesleft;
+	// Like strlen(), conversion stops at the first NUL
+	const size_t length = strlen(text.c_str());
 
-	/*
-	 * of all the Unix-like systems around there, only Linux/glibc seems to
-	 * come with a SuSv3-conforming iconv implementation.
-	 */
-#if !defined(__linux__) && !defined(__GLIBC__) && !defined(__APPLE__) && \
-	!defined(__OpenBSD__) && !defined(__FreeBSD__) &&                \
-	!defined(__DragonFly__)
-	const char* inbufp;
-#else
-	char* inbufp;
-#endif
-	char outbuf[16];
-	char* outbufp = outbuf;
+	if (converter.ascii_transparent && is_ascii(text.c_str(), length)) {
+		return length == text.length() ? text : text.substr(0, length);
+	}
 
-	outbytesleft = sizeof(outbuf);
-	inbufp = const_cast<char*>(
+	char* inbufp = const_cast<char*>(
 			text.c_str()); // evil, but spares us some trouble
-	inbytesleft = strlen(inbufp);
-
-	do {
-		char* old_outbufp = outbufp;
-		int rc = ::iconv(
-				cd, &inbufp, &inbytesleft, &outbufp, &outbytesleft);
-		if (-1 == rc) {
-			switch (errno) {
-			case E2BIG:
-				result.append(
-					old_outbufp, outbufp - old_outbufp);
-				outbufp = outbuf;
-				outbytesleft = sizeof(outbuf);
-				inbufp += strlen(inbufp) - inbytesleft;
-				inbytesleft = strlen(inbufp);
-				break;
-			case EILSEQ:
-			case EINVAL:
-				result.append(
-					old_outbufp, outbufp - old_outbufp);
-				result.append("?");
-				inbufp += strlen(inbufp) - inbytesleft + 1;
-				inbytesleft = strlen(inbufp);
-				break;
-			default:
-				break;
+	size_t inbytesleft = length;
+
+	// Most text converts to about as many bytes as it started with
+	result.resize(length + 16);
+	size_t used = 0;
+
+	// The descriptor may be left in a shift state by an earlier call
+	::iconv(converter.cd, nullptr, nullptr, nullptr, nullptr);
+
+	while (inbytesleft > 0) {
+		char* outbufp = &result[used];
+		size_t outbytesleft = result.length() - used;
+		const size_t rc = ::iconv(converter.cd, ICONV_INBUF(&inbufp),
+				&inbytesleft, &outbufp, &outbytesleft);
+		used = outbufp - &result[0];
+		if (rc != static_cast<size_t>(-1)) {
+			break;
+		}
+
+		if (errno == E2BIG) {
+			result.resize(result.length() * 2);
+		} else if (errno == EILSEQ || errno == EINVAL) {
+			if (used == result.length()) {
+				result.resize(result.length() * 2);
 			}
+			result[used++] = '?';
+			inbufp++;
+			inbytesleft--;
 		} else {
-			result.append(old_outbufp, outbufp - old_outbufp);
+			break;
 		}
-	} while (inbytesleft > 0);
-
-	iconv_close(cd);
+	}
 
+	result.resize(used);
 	return result;
 }
 
@@ -392,7 +497,17 @@ std::string utils::utf8_to_locale(const std::string& text)
 		return {};
 	}
 
-	return utils::convert_text(text, nl_langinfo(CODESET), "utf-8");
+	const char* codeset = nl_langinfo(CODESET);
+	if (is_utf8(codeset)) {
+		return text;
+	}
+
+	return utils::convert_text(text, codeset, "utf-8");
+}
+
+bool utils::locale_is_utf8()
+{
+	return is_utf8(nl_langinfo(CODESET));
 }
 
 std::string utils::get_command_output(const std::string& cmd)
@@ -1003,22 +1118,10 @@ unsigned int utils::newsboat_version_major()
 
 std::string utils::mt_strf_localtime(const std::string& format, time_t t)
 {
-	// localtime() returns a pointer to static memory, so we need to protect
-	// its caller with a mutex to ensure that no two threads concurrently
-	// access that static memory. In Newsboat, the only caller for localtime()
-	// is strftime(), that's why this function bakes the two together.
-
-	static std::mutex mtx;
-	std::lock_guard<std::mutex> guard(mtx);
-
-	const size_t BUFFER_SIZE = 4096;
-	char buffer[BUFFER_SIZE];
-	const size_t written = strftime(buffer,
-			BUFFER_SIZE,
-			format.c_str(),
-			localtime(&t));
-
-	return std::string(buffer, written);
+	// Each thread has a formatter of its own, so that reload threads and the
+	// UI don't have to wait for each other.
+	thread_local LocalTimeFormatter formatter;
+	return formatter.format(format, t);
 }
 
 } // namespace newsboat
@@ -30,6 +30,7 @@ extern "C" {
 #include "exception.h"
 #include "feedlist.h"
 #include "filebrowser.h"
+#include "filterstatsformaction.h"
 #include "fmtstrformatter.h"
 #include "formaction.h"
 #include "help.h"
@@ -42,7 +43,10 @@ extern "C" {
 #include "keymap.h"
 #include "logger.h"
 #include "matcherexception.h"
+#include "matcherprofiler.h"
 #include "regexmanager.h"
+#include "reloader.h"
+#include "reloadstatsformaction.h"
 #include "reloadthread.h"
 #include "rssfeed.h"
 #include "selectformaction.h"
@@ -64,6 +68,7 @@ View::View(Controller* c)
 	, keys(0)
 	, current_formaction(0)
 	, rxman(c->get_regexmanager())
+	, article_line_cache("articlelist")
 	, is_inside_qna(false)
 	, is_inside_cmdline(false)
 	, tab_count(0)
@@ -78,6 +83,7 @@ View::View(Controller* c)
 
 View::~View()
 {
+	article_line_cache.log_stats();
 	Stfl::reset();
 }
 
@@ -168,6 +174,8 @@ int View::run()
 		// we signal "oh, you will receive an operation soon"
 		fa->prepare();
 
+		update_reload_priorities();
+
 		// we then receive the event and ignore timeouts.
 		const char* event = fa->get_form().run(60000);
 
@@ -524,6 +532,60 @@ void View::view_dialogs()
 	}
 }
 
+void View::view_reload_stats()
+{
+	auto fa = get_current_formaction();
+	if (fa != nullptr && fa->id() != "reloadstats") {
+		std::shared_ptr<ReloadStatsFormAction> reloadstats(
+			new ReloadStatsFormAction(this, dialogs_str, cfg));
+		reloadstats->set_parent_formaction(fa);
+		apply_colors(reloadstats);
+		reloadstats->init();
+		reloadstats->set_stats(rsscache->fetch_reload_stats());
+		formaction_stack.push_back(reloadstats);
+		current_formaction = formaction_stack_size() - 1;
+	}
+}
+
+void View::update_reload_priorities()
+{
+	Reloader* reloader = ctrl->get_reloader();
+
+	std::vector<unsigned int> open_feed;
+	auto fa = get_current_formaction();
+	if (fa != nullptr && fa->id() == "article") {
+		fa = fa->get_parent_formaction();
+	}
+	if (fa != nullptr && fa->id() == "articlelist") {
+		auto itemlist =
+			std::dynamic_pointer_cast<ItemListFormAction, FormAction>(fa);
+		if (itemlist != nullptr && !itemlist->get_show_searchresult()) {
+			open_feed.push_back(itemlist->get_pos());
+		}
+	}
+	reloader->prioritize(ReloadPriority::OPEN_FEED, open_feed);
+
+	if (feedlist_form != nullptr) {
+		reloader->prioritize(ReloadPriority::VISIBLE,
+			feedlist_form->get_positions_on_screen());
+	}
+}
+
+void View::view_filter_stats()
+{
+	auto fa = get_current_formaction();
+	if (fa != nullptr && fa->id() != "filterstats") {
+		std::shared_ptr<FilterStatsFormAction> filterstats(
+			new FilterStatsFormAction(this, dialogs_str, cfg));
+		filterstats->set_parent_formaction(fa);
+		apply_colors(filterstats);
+		filterstats->init();
+		filterstats->set_stats(MatcherProfiler::get_instance().get_profiles());
+		formaction_stack.push_back(filterstats);
+		current_formaction = formaction_stack_size() - 1;
+	}
+}
+
 void View::push_help()
 {
 	auto fa = get_current_formaction();
@@ -892,13 +954,38 @@ void View::prepare_query_feed(std::shared_ptr<RssFeed> feed)
 			feed->rssurl());
 
 		set_status(_("Updating query feed..."));
-		feed->update_items(ctrl->get_feedcontainer()->get_all_feeds());
+		const auto feedcontainer = ctrl->get_feedcontainer();
+		const auto columns = feedcontainer->get_item_columns();
+		feed->update_items(feedcontainer->get_all_feeds(), columns.get());
 		feed->sort(cfg->get_article_sort_strategy());
 		notify_itemlist_change(feed);
 		set_status("");
 	}
 }
 
+void View::update_query_feed(std::shared_ptr<RssFeed> feed,
+	const std::vector<std::shared_ptr<RssFeed>>& replaced)
+{
+	if (!feed->is_query_feed()) {
+		return;
+	}
+	if (!feed->is_query_populated() || !feed->can_update_incrementally()) {
+		prepare_query_feed(feed);
+		return;
+	}
+
+	LOG(Level::DEBUG,
+		"View::update_query_feed: %s",
+		feed->rssurl());
+
+	set_status(_("Updating query feed..."));
+	feed->update_items(ctrl->get_feedcontainer()->get_all_feeds(),
+		replaced,
+		cfg->get_article_sort_strategy());
+	notify_itemlist_change(feed);
+	set_status("");
+}
+
 void View::force_redraw()
 {
 	std::shared_ptr<FormAction> fa = get_current_formaction();
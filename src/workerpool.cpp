@@ -0,0 +1,63 @@
+#include "workerpool.h"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace newsboat {
+
+const size_t WorkerPool::MIN_SHARD_SIZE;
+
+WorkerPool::WorkerPool(unsigned int w)
+	: workers(w)
+{
+	if (workers == 0) {
+		workers = std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+size_t WorkerPool::shard_count(size_t count) const
+{
+	return std::max<size_t>(1,
+			std::min<size_t>(workers, count / MIN_SHARD_SIZE));
+}
+
+void WorkerPool::run(size_t count,
+	const std::function<void(size_t, size_t, size_t)>& f) const
+{
+	const size_t shards = shard_count(count);
+	if (shards == 1) {
+		f(0, 0, count);
+		return;
+	}
+
+	const size_t shard_size = (count + shards - 1) / shards;
+	std::vector<std::exception_ptr> errors(shards);
+	const auto process = [&](size_t shard) {
+		const size_t begin = std::min(count, shard * shard_size);
+		const size_t end = std::min(count, begin + shard_size);
+		try {
+			f(shard, begin, end);
+		} catch (...) {
+			errors[shard] = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t shard = 1; shard < shards; ++shard) {
+		threads.push_back(std::thread(process, shard));
+	}
+	process(0);
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	for (const auto& error : errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+}
+
+} // namespace newsboat
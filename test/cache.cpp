@@ -7,6 +7,7 @@
 #include "rssfeed.h"
 #include "rssignores.h"
 #include "rssparser.h"
+#include "test-helpers/envvar.h"
 #include "test-helpers/tempfile.h"
 
 using namespace newsboat;
@@ -791,6 +792,41 @@ TEST_CASE("internalize_rssfeed doesn't return items that are ignored",
 	REQUIRE(feed->total_item_count() == 2);
 }
 
+TEST_CASE("internalize_rssfeed applies ignore rules that SQLite can't evaluate "
+	"in memory", "[Cache]")
+{
+	// Titles are only compared in SQLite if the locale uses UTF-8
+	TestHelpers::EnvVar lc_ctype("LC_CTYPE");
+	lc_ctype.on_change([](nonstd::optional<std::string> new_charset) {
+		if (new_charset.has_value()) {
+			::setlocale(LC_CTYPE, new_charset.value().c_str());
+		} else {
+			::setlocale(LC_CTYPE, "");
+		}
+	});
+	lc_ctype.set("C.UTF-8");
+
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+
+	const std::string feedurl("file://data/rss092_1.xml");
+	RssParser parser(feedurl, &rsscache, &cfg, nullptr);
+	auto feed = parser.parse();
+	REQUIRE(feed->total_item_count() == 3);
+	rsscache.externalize_rssfeed(feed, false);
+
+	RssIgnores ign;
+	ign.handle_action("ignore-article", {"*", "title =~ \"third\""});
+	// `date` is formatted by RssItem, so this one is matched in memory
+	ign.handle_action("ignore-article", {feedurl, "title =~ \"second\" and date =~ \".\""});
+	REQUIRE_FALSE(ign.sql_condition(feedurl, time(nullptr)).has_value());
+	REQUIRE(ign.sql_condition("http://example.com/other.xml",
+			time(nullptr)).has_value());
+
+	feed = rsscache.internalize_rssfeed(feedurl, &ign);
+	REQUIRE(feed->total_item_count() == 1);
+}
+
 TEST_CASE(
 	"externalize_rssfeed resets \"unread\" field if item's content "
 	"changed and reset_unread = \"yes\"",
@@ -999,3 +1035,50 @@ TEST_CASE("search_in_items returns empty set if input set is empty", "[Cache]")
 	const guids result = rsscache.search_in_items("Botox", empty);
 	REQUIRE(result.empty());
 }
+
+TEST_CASE("fetch_reload_stats returns last and averaged timings, slowest "
+	"feed first",
+	"[Cache]")
+{
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+
+	REQUIRE(rsscache.fetch_reload_stats().empty());
+
+	ReloadTimings fast;
+	fast.namelookup = 1;
+	fast.transfer = 2;
+	fast.size = 100;
+	rsscache.update_reload_stats("http://example.com/fast.xml", fast);
+
+	ReloadTimings slow;
+	slow.connect = 100;
+	slow.parse = 20;
+	slow.size = 1000;
+	rsscache.update_reload_stats("http://example.com/slow.xml", slow);
+
+	slow.connect = 300;
+	slow.parse = 40;
+	slow.size = 3000;
+	rsscache.update_reload_stats("http://example.com/slow.xml", slow);
+
+	const auto stats = rsscache.fetch_reload_stats();
+	REQUIRE(stats.size() == 2);
+
+	REQUIRE(stats[0].rssurl == "http://example.com/slow.xml");
+	REQUIRE(stats[0].reload_count == 2);
+	REQUIRE(stats[0].last_reload > 0);
+	REQUIRE(stats[0].last.connect == Approx(300));
+	REQUIRE(stats[0].last.parse == Approx(40));
+	REQUIRE(stats[0].last.size == 3000);
+	REQUIRE(stats[0].average.connect == Approx(200));
+	REQUIRE(stats[0].average.parse == Approx(30));
+	REQUIRE(stats[0].average.size == 2000);
+	REQUIRE(stats[0].average.total() == Approx(230));
+
+	REQUIRE(stats[1].rssurl == "http://example.com/fast.xml");
+	REQUIRE(stats[1].reload_count == 1);
+	REQUIRE(stats[1].average.namelookup == Approx(1));
+	REQUIRE(stats[1].average.transfer == Approx(2));
+	REQUIRE(stats[1].average.size == 100);
+}
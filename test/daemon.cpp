@@ -0,0 +1,219 @@
+#include "daemon.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+#include "cache.h"
+#include "configcontainer.h"
+#include "configpaths.h"
+#include "controller.h"
+#include "feedcontainer.h"
+#include "matcher.h"
+#include "matcherprofiler.h"
+#include "rssfeed.h"
+#include "rssitem.h"
+
+using namespace newsboat;
+
+namespace {
+
+/// A daemon serving two feeds and a query feed, without a socket.
+class TestDaemon {
+public:
+	TestDaemon()
+		: c(paths)
+		, rsscache(":memory:", &cfg)
+		, daemon(&c, &rsscache, "")
+	{
+		std::vector<std::shared_ptr<RssFeed>> feeds;
+		for (unsigned int f = 0; f < 2; ++f) {
+			const auto feed = std::make_shared<RssFeed>(&rsscache);
+			feed->set_rssurl("http://example.com/feed" + std::to_string(f));
+			feed->set_title("Feed\t" + std::to_string(f));
+			for (unsigned int i = 0; i < 3; ++i) {
+				const auto item = std::make_shared<RssItem>(&rsscache);
+				item->set_guid(feed->rssurl() + "/" + std::to_string(i));
+				item->set_title("Item " + std::to_string(i));
+				item->set_link(feed->rssurl() + "/article" + std::to_string(i));
+				item->set_pubDate(1000 + i);
+				item->set_unread_nowrite(i != 1);
+				item->set_feedptr(feed);
+				feed->add_item(item);
+			}
+			rsscache.externalize_rssfeed(feed, false);
+			feeds.push_back(feed);
+		}
+		feeds[1]->items()[2]->set_deleted(true);
+
+		const auto query = std::make_shared<RssFeed>(&rsscache);
+		query->set_rssurl("query:Unread:unread = \"yes\"");
+		feeds.push_back(query);
+
+		c.get_feedcontainer()->set_feeds(feeds);
+	}
+
+	IpcResponse request(const std::string& request)
+	{
+		return daemon.handle_request(request);
+	}
+
+	ConfigPaths paths;
+	Controller c;
+	ConfigContainer cfg;
+	Cache rsscache;
+	Daemon daemon;
+};
+
+} // namespace
+
+TEST_CASE("Daemon rejects unknown commands", "[Daemon]")
+{
+	TestDaemon d;
+
+	const IpcResponse response = d.request("frobnicate feeds");
+	REQUIRE_FALSE(response.ok);
+	REQUIRE(response.error == "unknown command: frobnicate");
+
+	// The command is only the first word of the request
+	REQUIRE_FALSE(d.request("feedsx").ok);
+	REQUIRE_FALSE(d.request("").ok);
+}
+
+TEST_CASE("`feeds` lists feeds that aren't query feeds", "[Daemon]")
+{
+	TestDaemon d;
+
+	const IpcResponse response = d.request("feeds");
+	REQUIRE(response.ok);
+	REQUIRE(response.lines == std::vector<std::string>({
+		"2\t3\thttp://example.com/feed0\tFeed 0",
+		"2\t3\thttp://example.com/feed1\tFeed 1",
+	}));
+}
+
+TEST_CASE("`items` lists articles of a feed that aren't deleted",
+	"[Daemon]")
+{
+	TestDaemon d;
+
+	SECTION("Known feed") {
+		const IpcResponse response = d.request("items http://example.com/feed1");
+		REQUIRE(response.ok);
+		REQUIRE(response.lines == std::vector<std::string>({
+			"1\t1000\thttp://example.com/feed1/0\tItem 0\t"
+			"http://example.com/feed1/article0",
+			"0\t1001\thttp://example.com/feed1/1\tItem 1\t"
+			"http://example.com/feed1/article1",
+		}));
+	}
+
+	SECTION("Unknown feeds and query feeds") {
+		for (const std::string url : {
+					"http://example.com/feed2",
+					"query:Unread:unread = \"yes\"",
+					""
+				}) {
+			const IpcResponse response = d.request("items " + url);
+			REQUIRE_FALSE(response.ok);
+			REQUIRE(response.error == "no such feed: " + url);
+		}
+	}
+}
+
+TEST_CASE("`unread` returns the number of unread articles", "[Daemon]")
+{
+	TestDaemon d;
+
+	const IpcResponse response = d.request("unread");
+	REQUIRE(response.ok);
+	REQUIRE(response.lines == std::vector<std::string>({
+		std::to_string(d.c.get_feedcontainer()->unread_item_count())
+	}));
+}
+
+TEST_CASE("`mark-read` marks an article read", "[Daemon]")
+{
+	TestDaemon d;
+	const auto feed = d.c.get_feedcontainer()->get_feed_by_url(
+			"http://example.com/feed0");
+	const auto item = feed->items()[2];
+	REQUIRE(item->unread());
+
+	SECTION("Known article") {
+		REQUIRE(d.request("mark-read http://example.com/feed0/2").ok);
+		REQUIRE_FALSE(item->unread());
+		REQUIRE(d.request("items http://example.com/feed0").lines[2][0] == '0');
+	}
+
+	SECTION("Unknown article") {
+		const IpcResponse response = d.request("mark-read no such guid");
+		REQUIRE_FALSE(response.ok);
+		REQUIRE(response.error == "no such article: no such guid");
+		REQUIRE(item->unread());
+	}
+}
+
+TEST_CASE("`mark-feed-read` and `reload` reject unknown feeds", "[Daemon]")
+{
+	TestDaemon d;
+
+	for (const std::string cmd : {
+				"mark-feed-read", "reload"
+			}) {
+		const IpcResponse response = d.request(cmd + " http://example.com/feed2");
+		REQUIRE_FALSE(response.ok);
+		REQUIRE(response.error == "no such feed: http://example.com/feed2");
+
+		REQUIRE_FALSE(d.request(cmd + " query:Unread:unread = \"yes\"").ok);
+	}
+}
+
+TEST_CASE("`reload-stats` and `filter-stats` return the same lines as "
+	"-x print-reload-stats and -x print-filter-stats", "[Daemon]")
+{
+	TestDaemon d;
+
+	SECTION("reload-stats") {
+		REQUIRE(d.request("reload-stats").lines.empty());
+
+		ReloadTimings timings;
+		timings.transfer = 12.5;
+		timings.size = 2048;
+		d.rsscache.update_reload_stats("http://example.com/feed0", timings);
+		timings.transfer = 100;
+		d.rsscache.update_reload_stats("http://example.com/feed1", timings);
+
+		const auto stats = d.rsscache.fetch_reload_stats();
+		REQUIRE(stats.size() == 2);
+		const IpcResponse response = d.request("reload-stats");
+		REQUIRE(response.ok);
+		REQUIRE(response.lines == std::vector<std::string>({
+			Controller::format_reload_stats(stats[0]),
+			Controller::format_reload_stats(stats[1]),
+		}));
+	}
+
+	SECTION("filter-stats") {
+		Matcher m("title =~ \"Item\"");
+		m.matches(d.c.get_feedcontainer()->get_feed(0)->items()[0].get());
+
+		std::vector<std::string> expected;
+		for (const auto& profile :
+			MatcherProfiler::get_instance().get_profiles()) {
+			expected.push_back(Controller::format_filter_stats(profile));
+		}
+		REQUIRE_FALSE(expected.empty());
+
+		const IpcResponse response = d.request("filter-stats");
+		REQUIRE(response.ok);
+		REQUIRE(response.lines == expected);
+	}
+}
+
+TEST_CASE("`stop` succeeds", "[Daemon]")
+{
+	TestDaemon d;
+	REQUIRE(d.request("stop").ok);
+}
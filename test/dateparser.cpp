@@ -0,0 +1,336 @@
+#include "dateparser.h"
+
+#include <cstdio>
+#include <curl/curl.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+#include "rss/rssparser.h"
+#include "test-helpers/envvar.h"
+
+using namespace newsboat;
+
+namespace {
+
+// Dates as they appear in real-world feeds
+const std::vector<std::string> CORPUS = {
+	"Sun, 06 Nov 1994 08:49:37 GMT",
+	"Mon, 02 Jan 2006 15:04:05 -0700",
+	"Tue, 10 Mar 2020 12:00:00 +0000",
+	"Wed, 4 Jul 2018 09:30:00 EDT",
+	"Thu, 21 Dec 2000 16:01:07 +0200",
+	"Fri, 13 Sep 2019 23:59:59 PST",
+	"Sat, 29 Feb 2020 00:00:00 UT",
+	"Sun, 01 Nov 2020 10:00 +0100",
+	"01 Nov 2020 10:00:00 GMT",
+	"sun, 01 nov 2020 10:00:00 utc",
+	"Sun, 01 Nov 2020 10:00:00 Z",
+	"  Sun, 01 Nov 2020 10:00:00 GMT\n",
+	"2003-12-13T18:30:02Z",
+	"2003-12-13T18:30:02.25Z",
+	"2003-12-13T18:30:02+01:00",
+	"2003-12-13T18:30:02.25-05:00",
+	"2003-12-13T18:30Z",
+	"2003-12-13",
+	"2003-12",
+	"2003",
+	"Sunday, 06-Nov-94 08:49:37 GMT",
+	"Sun Nov  6 08:49:37 1994",
+	"Sun, 06 Nov 1994 08:49:37 CET",
+	"Sun, 06 Nov 94 08:49:37 GMT",
+	"not a date",
+	"",
+};
+
+/// The way RssParser::parse_date() worked before DateParser existed.
+time_t parse_with_curl(const std::string& date)
+{
+	time_t t = curl_getdate(date.c_str(), nullptr);
+	if (t == -1) {
+		t = curl_getdate(
+				rsspp::RssParser::w3cdtf_to_rfc822(date).c_str(),
+				nullptr);
+	}
+	return t;
+}
+
+std::string format(const char* fmt, int a, int b, int c, int d, int e,
+	int f)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), fmt, a, b, c, d, e, f);
+	return buf;
+}
+
+} // namespace
+
+TEST_CASE("parse_rfc822() parses RFC 822 dates", "[DateParser]")
+{
+	time_t t = 0;
+
+	REQUIRE(DateParser::parse_rfc822("Sun, 06 Nov 1994 08:49:37 GMT", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_rfc822("6 Nov 1994 08:49:37 GMT", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_rfc822("Sun, 06 Nov 1994 09:49:37 +0100", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_rfc822("Sun, 06 Nov 1994 03:49:37 EST", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_rfc822("Sun, 06 Nov 1994 08:49 GMT", t));
+	REQUIRE(t == 784111740);
+
+	REQUIRE(DateParser::parse_rfc822("Sun, 06 Nov 1994 08:49:37", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_rfc822("SUN, 06 NOV 1994 08:49:37 gmt", t));
+	REQUIRE(t == 784111777);
+}
+
+TEST_CASE("parse_rfc822() leaves unusual dates to curl_getdate()",
+	"[DateParser]")
+{
+	const std::vector<std::string> dates = {
+		"",
+		"Sunday, 06-Nov-94 08:49:37 GMT",
+		"Sun Nov  6 08:49:37 1994",
+		"Sun, 06 Nov 94 08:49:37 GMT",
+		"Sun, 06 Nov 1994 08:49:37 CET",
+		"Sun, 06 Nov 1994 08:49:37 +0000 (UTC)",
+		"Sun, 06 Nov 1994 08:49:37 +0199",
+		"Sun, 06 Nov 1994 24:00:00 GMT",
+		"Sun, 06 Nov 1960 08:49:37 GMT",
+		"Foo, 06 Nov 1994 08:49:37 GMT",
+		"2003-12-13T18:30:02Z",
+	};
+
+	for (const auto& date : dates) {
+		INFO("date: " << date);
+		time_t t = 42;
+		REQUIRE_FALSE(DateParser::parse_rfc822(date.c_str(), t));
+		REQUIRE(t == 42);
+	}
+}
+
+TEST_CASE("parse_iso8601() parses W3CDTF dates", "[DateParser]")
+{
+	time_t t = 0;
+
+	REQUIRE(DateParser::parse_iso8601("1994-11-06T08:49:37Z", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_iso8601("1994-11-06T08:49:37", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_iso8601("1994-11-06T08:49:37.123Z", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_iso8601("1994-11-06T10:49:37+02:00", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_iso8601("1994-11-06T10:49:37.5+0200", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_iso8601("1994-11-06T03:49:37-05", t));
+	REQUIRE(t == 784111777);
+
+	REQUIRE(DateParser::parse_iso8601("1994-11-06T08:49Z", t));
+	REQUIRE(t == 784111740);
+
+	REQUIRE(DateParser::parse_iso8601("1994-11-06", t));
+	REQUIRE(t == 784080000);
+
+	REQUIRE(DateParser::parse_iso8601("1994-11", t));
+	REQUIRE(t == 783648000);
+
+	REQUIRE(DateParser::parse_iso8601("1994", t));
+	REQUIRE(t == 757382400);
+
+	const std::vector<std::string> invalid = {
+		"",
+		"94-11-06",
+		"19941106T084937Z",
+		"1994-11-06 08:49:37",
+		"1994-13-06T08:49:37Z",
+		"1994-11-06T08:49:37+15:00",
+		"1994-11-06T08:49:37Z trailing",
+		"Sun, 06 Nov 1994 08:49:37 GMT",
+	};
+	for (const auto& date : invalid) {
+		INFO("date: " << date);
+		time_t t = 42;
+		REQUIRE_FALSE(DateParser::parse_iso8601(date.c_str(), t));
+		REQUIRE(t == 42);
+	}
+}
+
+TEST_CASE("DateParser agrees with curl_getdate()", "[DateParser]")
+{
+	TestHelpers::EnvVar tzEnv("TZ");
+	tzEnv.on_change([](nonstd::optional<std::string>) {
+		::tzset();
+	});
+	// w3cdtf_to_rfc822() goes through local time
+	tzEnv.set("UTC");
+
+	std::mt19937 rng(42);
+	const auto random = [&rng](int min, int max) {
+		return std::uniform_int_distribution<int>(min, max)(rng);
+	};
+	const char* const weekdays[] = {
+		"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+	};
+	const char* const months[] = {
+		"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+		"Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+	};
+	const char* const zones[] = {
+		"GMT", "UT", "UTC", "Z", "EST", "EDT", "CST", "CDT", "MST", "MDT",
+		"PST", "PDT"
+	};
+
+	for (int i = 0; i < 20000; ++i) {
+		const int year = random(1970, 2037);
+		const int month = random(1, 12);
+		const int day = random(1, 31);
+		const int hour = random(0, 23);
+		const int minute = random(0, 59);
+		const int second = random(0, 59);
+		const int offset_hours = random(0, 13);
+		const int offset_minutes = random(0, 3) * 15;
+		const char sign = random(0, 1) ? '+' : '-';
+
+		std::string rfc822 = std::string(weekdays[random(0, 6)]) + ", " +
+			format("%02d ", day, 0, 0, 0, 0, 0) + months[month - 1] +
+			format(" %04d %02d:%02d:%02d ", year, hour, minute, second, 0, 0);
+		switch (random(0, 3)) {
+		case 0:
+			rfc822 += zones[random(0, 11)];
+			break;
+		case 1:
+			rfc822 += sign + format("%02d%02d", offset_hours,
+					offset_minutes, 0, 0, 0, 0);
+			break;
+		case 2:
+			// No weekday, no seconds
+			rfc822 = format("%d ", day, 0, 0, 0, 0, 0) + months[month - 1] +
+				format(" %04d %02d:%02d +0000", year, hour, minute, 0, 0, 0);
+			break;
+		default:
+			// No zone
+			rfc822.pop_back();
+			break;
+		}
+
+		INFO("date: " << rfc822);
+		time_t t = 0;
+		REQUIRE(DateParser::parse_rfc822(rfc822.c_str(), t));
+		REQUIRE(t == curl_getdate(rfc822.c_str(), nullptr));
+
+		const std::string iso = format("%04d-%02d-%02dT%02d:%02d:%02d",
+				year, month, day, hour, minute, second) +
+			sign + format("%02d:%02d", offset_hours, offset_minutes,
+				0, 0, 0, 0);
+		INFO("date: " << iso);
+		REQUIRE(DateParser::parse_iso8601(iso.c_str(), t));
+		REQUIRE(t == parse_with_curl(iso));
+	}
+
+	for (const auto& date : CORPUS) {
+		// w3cdtf_to_rfc822() ignores the zone if seconds have a fraction
+		if (date == "2003-12-13T18:30:02.25-05:00") {
+			continue;
+		}
+		INFO("date: " << date);
+		DateParser parser;
+		REQUIRE(parser.parse(date) == parse_with_curl(date));
+	}
+}
+
+TEST_CASE("DateParser::parse() remembers recent dates", "[DateParser]")
+{
+	DateParser parser;
+
+	for (int round = 0; round < 3; ++round) {
+		for (const auto& date : CORPUS) {
+			INFO("date: " << date);
+			time_t expected = -1;
+			if (!DateParser::parse_rfc822(date.c_str(), expected) &&
+				!DateParser::parse_iso8601(date.c_str(), expected)) {
+				expected = parse_with_curl(date);
+			}
+			REQUIRE(parser.parse(date) == expected);
+			REQUIRE(parser.parse(date) == expected);
+		}
+	}
+}
+
+TEST_CASE("DateParser throughput", "[DateParser][.][benchmark]")
+{
+	// A feed's worth of dates: most of them distinct, some repeated
+	std::vector<std::string> rfc822;
+	std::vector<std::string> iso8601;
+	for (int i = 0; i < 100; ++i) {
+		const int minute = (i / 4) % 60;
+		rfc822.push_back(format("Tue, 10 Mar 2020 12:%02d:00 +0000",
+				minute, 0, 0, 0, 0, 0));
+		iso8601.push_back(format("2020-03-10T12:%02d:00Z",
+				minute, 0, 0, 0, 0, 0));
+	}
+
+	BENCHMARK("curl_getdate(), RFC 822") {
+		time_t sum = 0;
+		for (const auto& date : rfc822) {
+			sum += parse_with_curl(date);
+		}
+		return sum;
+	};
+
+	BENCHMARK("DateParser, RFC 822") {
+		DateParser parser;
+		time_t sum = 0;
+		for (const auto& date : rfc822) {
+			sum += parser.parse(date);
+		}
+		return sum;
+	};
+
+	BENCHMARK("curl_getdate() and W3CDTF conversion, ISO 8601") {
+		time_t sum = 0;
+		for (const auto& date : iso8601) {
+			sum += parse_with_curl(date);
+		}
+		return sum;
+	};
+
+	BENCHMARK("DateParser, ISO 8601") {
+		DateParser parser;
+		time_t sum = 0;
+		for (const auto& date : iso8601) {
+			sum += parser.parse(date);
+		}
+		return sum;
+	};
+
+	BENCHMARK("curl_getdate(), real-world corpus") {
+		time_t sum = 0;
+		for (const auto& date : CORPUS) {
+			sum += parse_with_curl(date);
+		}
+		return sum;
+	};
+
+	BENCHMARK("DateParser, real-world corpus") {
+		DateParser parser;
+		time_t sum = 0;
+		for (const auto& date : CORPUS) {
+			sum += parser.parse(date);
+		}
+		return sum;
+	};
+}
@@ -1,6 +1,12 @@
 #include "3rd-party/catch.hpp"
 
+#include <algorithm>
 #include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "cache.h"
 #include "configcontainer.h"
@@ -23,6 +29,33 @@ std::vector<std::shared_ptr<RssFeed>> get_five_empty_feeds(Cache* rsscache)
 	return feeds;
 }
 
+/// Counts distinct unread GUIDs in feeds that aren't hidden by walking all
+/// items, like FeedContainer::unread_item_count() used to.
+unsigned int count_unread_guids(const std::vector<std::shared_ptr<RssFeed>>&
+	feeds)
+{
+	std::unordered_set<std::string> guids;
+	for (const auto& feed : feeds) {
+		if (feed->hidden()) {
+			continue;
+		}
+		for (const auto& item : feed->items()) {
+			if (item->unread()) {
+				guids.insert(item->guid());
+			}
+		}
+	}
+	return guids.size();
+}
+
+unsigned int count_unread_items(const std::shared_ptr<RssFeed>& feed)
+{
+	return std::count_if(feed->items().begin(), feed->items().end(),
+	[](const std::shared_ptr<RssItem>& item) {
+		return item->unread();
+	});
+}
+
 } // anonymous namespace
 
 TEST_CASE("get_feed() returns feed by its position number", "[FeedContainer]")
@@ -1128,3 +1161,161 @@ TEST_CASE("replace_feed() puts given feed into the specified position",
 	REQUIRE(feed_before_replacement != feed_after_replacement);
 	REQUIRE(feed_after_replacement == first_feed);
 }
+
+TEST_CASE("Unread counts are kept up to date as feeds and items change",
+	"[FeedContainer]")
+{
+	FeedContainer feedcontainer;
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+	auto feeds = get_five_empty_feeds(&rsscache);
+	feedcontainer.set_feeds(feeds);
+
+	std::mt19937 rng(42);
+	const auto random = [&rng](size_t n) {
+		return std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+	};
+
+	const auto require_consistent_counts = [&]() {
+		REQUIRE(feedcontainer.unread_item_count() == count_unread_guids(feeds));
+		for (const auto& feed : feeds) {
+			REQUIRE(feed->unread_item_count() == count_unread_items(feed));
+		}
+	};
+
+	const auto change_something = [&](std::shared_ptr<RssFeed> feed) {
+		auto& items = feed->items();
+		switch (random(6)) {
+		case 0:
+		case 1: {
+			// Few distinct GUIDs, so that feeds have some in common
+			const auto item = std::make_shared<RssItem>(&rsscache);
+			item->set_guid("guid" + std::to_string(random(50)));
+			item->set_unread_nowrite(random(2) == 0);
+			feed->add_item(item);
+			break;
+		}
+		case 2:
+			if (!items.empty()) {
+				feed->erase_item(items.begin() + random(items.size()));
+			}
+			break;
+		case 3:
+		case 4:
+			if (!items.empty()) {
+				const auto& item = items[random(items.size())];
+				item->set_unread_nowrite(!item->unread());
+			}
+			break;
+		case 5:
+			if (feed->hidden()) {
+				feed->set_tags({});
+			} else {
+				feed->set_tags({"!hidden"});
+			}
+			break;
+		}
+	};
+
+	for (int step = 0; step < 2000; ++step) {
+		INFO("step " << step);
+		change_something(feeds[random(feeds.size())]);
+		require_consistent_counts();
+	}
+
+	SECTION("Feeds that leave the container aren't counted anymore") {
+		const auto replaced = feeds[0];
+		const auto replacement = std::make_shared<RssFeed>(&rsscache);
+		feedcontainer.replace_feed(0, replacement);
+		feeds[0] = replacement;
+		require_consistent_counts();
+
+		const auto removed = feeds.back();
+		feeds.pop_back();
+		feedcontainer.set_feeds(feeds);
+		require_consistent_counts();
+
+		for (const auto& item : replaced->items()) {
+			item->set_unread_nowrite(!item->unread());
+		}
+		for (const auto& item : removed->items()) {
+			item->set_unread_nowrite(!item->unread());
+		}
+		require_consistent_counts();
+		REQUIRE(replaced->unread_item_count() == count_unread_items(replaced));
+		REQUIRE(removed->unread_item_count() == count_unread_items(removed));
+	}
+
+	SECTION("Items shared with query feeds are counted once") {
+		const auto query = std::make_shared<RssFeed>(&rsscache);
+		query->set_rssurl("query:Some GUIDs:guid =~ \"guid1\"");
+		feeds.push_back(query);
+		feedcontainer.set_feeds(feeds);
+		feedcontainer.populate_query_feeds();
+		REQUIRE(query->total_item_count() > 0);
+		require_consistent_counts();
+
+		for (int step = 0; step < 500; ++step) {
+			INFO("step " << step);
+			const auto& items = query->items();
+			const auto& item = items[random(items.size())];
+			item->set_unread_nowrite(!item->unread());
+			require_consistent_counts();
+		}
+	}
+}
+
+TEST_CASE("Counting 200k unread items", "[FeedContainer][.][benchmark]")
+{
+	FeedContainer feedcontainer;
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+
+	std::vector<std::shared_ptr<RssFeed>> feeds;
+	for (int i = 0; i < 200; ++i) {
+		const auto feed = std::make_shared<RssFeed>(&rsscache);
+		feed->set_rssurl("https://example.com/" + std::to_string(i));
+		for (int j = 0; j < 1000; ++j) {
+			const auto item = std::make_shared<RssItem>(&rsscache);
+			item->set_guid(feed->rssurl() + "/" + std::to_string(j));
+			feed->add_item(item);
+		}
+		feeds.push_back(feed);
+	}
+	feedcontainer.set_feeds(feeds);
+	REQUIRE(feedcontainer.unread_item_count() == 200000);
+
+	BENCHMARK("Walking all items, copying the GUID set for every feed") {
+		using guid_set = std::unordered_set<std::string>;
+		return std::accumulate(feeds.begin(), feeds.end(), guid_set(),
+		[](guid_set guids, const std::shared_ptr<RssFeed>& feed) {
+			for (const auto& item : feed->items()) {
+				if (item->unread()) {
+					guids.insert(item->guid());
+				}
+			}
+			return guids;
+		}).size();
+	};
+
+	BENCHMARK("Walking all items once") {
+		return count_unread_guids(feeds);
+	};
+
+	BENCHMARK("unread_item_count()") {
+		return feedcontainer.unread_item_count();
+	};
+
+	BENCHMARK("unread_feed_count()") {
+		return feedcontainer.unread_feed_count();
+	};
+
+	BENCHMARK("Marking an item read and unread, counting after each") {
+		const auto& item = feeds[100]->items()[500];
+		item->set_unread_nowrite(false);
+		auto count = feedcontainer.unread_item_count();
+		item->set_unread_nowrite(true);
+		count += feedcontainer.unread_item_count();
+		return count;
+	};
+}
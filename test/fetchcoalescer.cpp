@@ -0,0 +1,182 @@
+#include "fetchcoalescer.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#include "3rd-party/catch.hpp"
+#include "configcontainer.h"
+#include "test-helpers/tempfile.h"
+
+using namespace newsboat;
+
+TEST_CASE("normalize_url() lowercases scheme and host, drops default ports "
+	"and fragments",
+	"[FetchCoalescer]")
+{
+	REQUIRE(FetchCoalescer::normalize_url("HTTP://Example.COM/Feed.xml") ==
+		"http://example.com/Feed.xml");
+	REQUIRE(FetchCoalescer::normalize_url("http://example.com:80/a") ==
+		"http://example.com/a");
+	REQUIRE(FetchCoalescer::normalize_url("https://example.com:443/a") ==
+		"https://example.com/a");
+	REQUIRE(FetchCoalescer::normalize_url("https://example.com:80/a") ==
+		"https://example.com:80/a");
+	REQUIRE(FetchCoalescer::normalize_url("http://example.com/a#top") ==
+		"http://example.com/a");
+	REQUIRE(FetchCoalescer::normalize_url("http://example.com") ==
+		"http://example.com/");
+	REQUIRE(FetchCoalescer::normalize_url("http://example.com?q=A") ==
+		"http://example.com?q=A");
+}
+
+TEST_CASE("upstream_url() returns the URL that is actually downloaded",
+	"[FetchCoalescer]")
+{
+	REQUIRE(FetchCoalescer::upstream_url("https://example.com/feed") ==
+		"https://example.com/feed");
+	REQUIRE(FetchCoalescer::upstream_url(
+			"filter:~/fix.sh:https://example.com/feed") ==
+		"https://example.com/feed");
+	REQUIRE(FetchCoalescer::upstream_url("exec:~/feed.sh").empty());
+	REQUIRE(FetchCoalescer::upstream_url("query:Unread:unread = \"yes\"")
+		.empty());
+	REQUIRE(FetchCoalescer::upstream_url("file:///tmp/feed.xml").empty());
+}
+
+TEST_CASE("Only URLs used by several feeds are shared", "[FetchCoalescer]")
+{
+	FetchCoalescer coalescer;
+	coalescer.reset({
+		"https://example.com/feed",
+		"filter:~/fix.sh:https://EXAMPLE.com/feed",
+		"https://example.com/other",
+		"exec:~/feed.sh",
+		"exec:~/feed.sh",
+	});
+
+	REQUIRE(coalescer.is_shared("https://example.com/feed"));
+	REQUIRE_FALSE(coalescer.is_shared("https://example.com/other"));
+	REQUIRE_FALSE(coalescer.is_shared("exec:~/feed.sh"));
+
+	coalescer.clear();
+	REQUIRE_FALSE(coalescer.is_shared("https://example.com/feed"));
+}
+
+TEST_CASE("fetch() downloads each URL once and counts saved transfers",
+	"[FetchCoalescer]")
+{
+	FetchCoalescer coalescer;
+	const std::string url = "https://example.com/feed";
+	coalescer.reset({url, "filter:cat:" + url});
+
+	int downloads = 0;
+	const auto download = [&downloads]() {
+		downloads++;
+		return std::string("<rss/>");
+	};
+
+	const auto first = coalescer.fetch(url, download);
+	const auto second = coalescer.fetch("HTTPS://example.com/feed", download);
+	REQUIRE(downloads == 1);
+	REQUIRE(*first == "<rss/>");
+	REQUIRE(first == second);
+	REQUIRE(coalescer.saved_transfers() == 1);
+
+	SECTION("reset() forgets downloaded bodies and the counter") {
+		coalescer.reset({url, url});
+		coalescer.fetch(url, download);
+		REQUIRE(downloads == 2);
+		REQUIRE(coalescer.saved_transfers() == 0);
+	}
+}
+
+TEST_CASE("fetch() makes concurrent callers wait for the first download",
+	"[FetchCoalescer]")
+{
+	FetchCoalescer coalescer;
+	const std::string url = "https://example.com/feed";
+	coalescer.reset({url, url, url, url});
+
+	std::atomic<int> downloads(0);
+	const auto download = [&downloads]() {
+		downloads++;
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		return std::string("body");
+	};
+
+	std::vector<std::thread> threads;
+	std::vector<std::string> bodies(4);
+	for (unsigned int i = 0; i < bodies.size(); ++i) {
+		threads.emplace_back([&, i]() {
+			bodies[i] = *coalescer.fetch(url, download);
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	REQUIRE(downloads == 1);
+	REQUIRE(coalescer.saved_transfers() == 3);
+	for (const auto& body : bodies) {
+		REQUIRE(body == "body");
+	}
+}
+
+TEST_CASE("fetch() lets callers retry if the first download failed",
+	"[FetchCoalescer]")
+{
+	FetchCoalescer coalescer;
+	const std::string url = "https://example.com/feed";
+	coalescer.reset({url, url});
+
+	SECTION("Download threw an exception") {
+		REQUIRE_THROWS(coalescer.fetch(url, []() -> std::string {
+			throw std::runtime_error("connection refused");
+		}));
+	}
+
+	SECTION("Download returned nothing") {
+		REQUIRE(coalescer.fetch(url, []() {
+			return std::string();
+		})->empty());
+	}
+
+	const auto body = coalescer.fetch(url, []() {
+		return std::string("second try");
+	});
+	REQUIRE(*body == "second try");
+	REQUIRE(coalescer.saved_transfers() == 0);
+}
+
+TEST_CASE("download() returns nothing unless an attempt succeeded",
+	"[FetchCoalescer]")
+{
+	ConfigContainer cfg;
+	cfg.set_configvalue("download-retries", "3");
+	TestHelpers::TempFile file;
+	const std::string url = "file://" + file.get_path();
+
+	SECTION("All attempts failed") {
+		REQUIRE(FetchCoalescer::download(url, &cfg).empty());
+	}
+
+	SECTION("The document was downloaded") {
+		{
+			std::ofstream out(file.get_path());
+			out << "<rss/>";
+		}
+		REQUIRE(FetchCoalescer::download(url, &cfg) == "<rss/>");
+	}
+
+	SECTION("No attempts are made if `download-retries` is zero") {
+		{
+			std::ofstream out(file.get_path());
+			out << "<rss/>";
+		}
+		cfg.set_configvalue("download-retries", "0");
+		REQUIRE(FetchCoalescer::download(url, &cfg).empty());
+	}
+}
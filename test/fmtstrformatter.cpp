@@ -1,5 +1,8 @@
 #include "fmtstrformatter.h"
 
+#include <string>
+#include <vector>
+
 #include "3rd-party/catch.hpp"
 
 using namespace newsboat;
@@ -406,3 +409,113 @@ TEST_CASE("Center Text formatting",
 	REQUIRE(fmt.do_format("%=3T", 0) == "wha");
 	REQUIRE(fmt.do_format("%=0T", 20) == "      whatever      ");
 }
+
+TEST_CASE("FmtStrTemplate::uses() tells which variables the format refers to",
+	"[FmtStrTemplate]")
+{
+	const FmtStrTemplate tmpl("%4i %f %?T?|%-17T| &?%t%>-%L");
+
+	REQUIRE(tmpl.get_format() == "%4i %f %?T?|%-17T| &?%t%>-%L");
+	REQUIRE(tmpl.uses('i'));
+	REQUIRE(tmpl.uses('f'));
+	REQUIRE(tmpl.uses('T'));
+	REQUIRE(tmpl.uses('t'));
+	REQUIRE(tmpl.uses('L'));
+	REQUIRE_FALSE(tmpl.uses('a'));
+	REQUIRE_FALSE(tmpl.uses('D'));
+
+	SECTION("Escaped percent signs and spacing don't count as variables") {
+		const FmtStrTemplate other("%% %>x%a");
+		REQUIRE(other.uses('a'));
+		REQUIRE_FALSE(other.uses('%'));
+		REQUIRE_FALSE(other.uses('x'));
+	}
+}
+
+TEST_CASE("do_format() with a template gives the same result as with "
+	"the format string", "[FmtStrFormatter]")
+{
+	const std::vector<std::string> formats = {
+		"%4i %f %D %6L  %?T?|%-17T|  &?%t",
+		"%?a?%a&no?",
+		"%-10t|%=9a|%>.%L",
+		"100%% %t %%",
+	};
+
+	FmtStrFormatter fmt;
+	fmt.register_fmt('i', "7");
+	fmt.register_fmt('f', "N");
+	fmt.register_fmt('D', "Mar 10");
+	fmt.register_fmt('L', "42KB");
+	fmt.register_fmt('T', "Some feed");
+	fmt.register_fmt('t', "An article's title");
+	fmt.register_fmt('a', "Joe");
+
+	for (const auto& format : formats) {
+		const FmtStrTemplate tmpl(format);
+		for (const unsigned int width : {
+					0, 20, 80
+				}) {
+			INFO("format: " << format << ", width: " << width);
+			REQUIRE(fmt.do_format(tmpl, width) == fmt.do_format(format, width));
+		}
+	}
+}
+
+TEST_CASE("Formatting 100k article list lines",
+	"[FmtStrFormatter][.][benchmark]")
+{
+	const std::string format = "%4i %f %D %6L  %?T?|%-17T|  &?%t";
+	const unsigned int lines = 100000;
+
+	std::vector<std::string> titles;
+	for (unsigned int i = 0; i < lines; ++i) {
+		titles.push_back("Article number " + std::to_string(i));
+	}
+
+	BENCHMARK("Registering all variables, parsing the format for every line") {
+		size_t length = 0;
+		for (unsigned int i = 0; i < lines; ++i) {
+			FmtStrFormatter fmt;
+			fmt.register_fmt('i', std::to_string(i + 1));
+			fmt.register_fmt('f', "N");
+			fmt.register_fmt('n', "N");
+			fmt.register_fmt('d', " ");
+			fmt.register_fmt('F', "");
+			fmt.register_fmt('D', "Mar 10");
+			fmt.register_fmt('t', titles[i]);
+			fmt.register_fmt('a', "Joe");
+			fmt.register_fmt('L', "42KB");
+			length += fmt.do_format(format, 80).length();
+		}
+		return length;
+	};
+
+	BENCHMARK("Registering used variables, pre-compiled template") {
+		const FmtStrTemplate tmpl(format);
+		size_t length = 0;
+		for (unsigned int i = 0; i < lines; ++i) {
+			FmtStrFormatter fmt;
+			if (tmpl.uses('i')) {
+				fmt.register_fmt('i', std::to_string(i + 1));
+			}
+			if (tmpl.uses('f')) {
+				fmt.register_fmt('f', "N");
+			}
+			if (tmpl.uses('D')) {
+				fmt.register_fmt('D', "Mar 10");
+			}
+			if (tmpl.uses('t')) {
+				fmt.register_fmt('t', titles[i]);
+			}
+			if (tmpl.uses('a')) {
+				fmt.register_fmt('a', "Joe");
+			}
+			if (tmpl.uses('L')) {
+				fmt.register_fmt('L', "42KB");
+			}
+			length += fmt.do_format(tmpl, 80).length();
+		}
+		return length;
+	};
+}
@@ -0,0 +1,106 @@
+#include "formattedlinecache.h"
+
+#include <string>
+
+#include "3rd-party/catch.hpp"
+
+using namespace newsboat;
+
+namespace {
+
+FormattedLineCache::Stamp make_stamp(std::uint64_t version,
+	unsigned int width = 80)
+{
+	FormattedLineCache::Stamp stamp;
+	stamp.version = version;
+	stamp.context = 0;
+	stamp.position = 0;
+	stamp.width = width;
+	return stamp;
+}
+
+} // namespace
+
+TEST_CASE("FormattedLineCache::get() only formats lines it doesn't know",
+	"[FormattedLineCache]")
+{
+	FormattedLineCache cache("test");
+	cache.set_format("%t");
+	const int entry = 0;
+	const int other_entry = 0;
+
+	unsigned int calls = 0;
+	const auto format = [&]() {
+		calls++;
+		return std::string("line ") + std::to_string(calls);
+	};
+
+	REQUIRE(cache.get(&entry, make_stamp(1), format) == "line 1");
+	REQUIRE(cache.get(&entry, make_stamp(1), format) == "line 1");
+	REQUIRE(calls == 1);
+
+	SECTION("Other entries have lines of their own") {
+		REQUIRE(cache.get(&other_entry, make_stamp(1), format) == "line 2");
+		REQUIRE(cache.get(&entry, make_stamp(1), format) == "line 1");
+		REQUIRE(calls == 2);
+	}
+
+	SECTION("The line is formatted again when the entry changes") {
+		REQUIRE(cache.get(&entry, make_stamp(2), format) == "line 2");
+		REQUIRE(calls == 2);
+	}
+
+	SECTION("The line is formatted again when the width changes") {
+		REQUIRE(cache.get(&entry, make_stamp(1, 100), format) == "line 2");
+		REQUIRE(calls == 2);
+	}
+
+	SECTION("The line is formatted again when the context changes") {
+		auto stamp = make_stamp(1);
+		stamp.context = 7;
+		REQUIRE(cache.get(&entry, stamp, format) == "line 2");
+		REQUIRE(calls == 2);
+	}
+
+	SECTION("The line is formatted again when the position changes") {
+		auto stamp = make_stamp(1);
+		stamp.position = 3;
+		REQUIRE(cache.get(&entry, stamp, format) == "line 2");
+		REQUIRE(calls == 2);
+	}
+
+	SECTION("All lines are formatted again when the format changes") {
+		cache.set_format("%t");
+		REQUIRE(cache.get(&entry, make_stamp(1), format) == "line 1");
+		REQUIRE(calls == 1);
+
+		cache.set_format("%a");
+		REQUIRE(cache.get(&entry, make_stamp(1), format) == "line 2");
+		REQUIRE(calls == 2);
+	}
+}
+
+TEST_CASE("FormattedLineCache::get_stats() counts hits and misses",
+	"[FormattedLineCache]")
+{
+	FormattedLineCache cache("test");
+	REQUIRE(cache.get_stats().hits == 0);
+	REQUIRE(cache.get_stats().misses == 0);
+	REQUIRE(cache.get_stats().hit_rate() == 0);
+
+	const int entry = 0;
+	const auto format = []() {
+		return std::string("line");
+	};
+	cache.get(&entry, make_stamp(1), format);
+	cache.get(&entry, make_stamp(1), format);
+	cache.get(&entry, make_stamp(1), format);
+	cache.get(&entry, make_stamp(2), format);
+
+	const auto stats = cache.get_stats();
+	REQUIRE(stats.hits == 2);
+	REQUIRE(stats.misses == 2);
+	REQUIRE(stats.hit_rate() == Approx(0.5));
+	REQUIRE(stats.formatting_time >= 0);
+	REQUIRE(stats.saved_time == Approx(stats.formatting_time));
+}
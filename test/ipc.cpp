@@ -0,0 +1,80 @@
+#include "ipc.h"
+
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "3rd-party/catch.hpp"
+#include "test-helpers/tempfile.h"
+
+using namespace newsboat;
+
+TEST_CASE("format_response() puts the number of lines in the status line",
+	"[Ipc]")
+{
+	IpcResponse response;
+	REQUIRE(ipc::format_response(response) == "OK 0\n");
+
+	response.lines = {"first", "second"};
+	REQUIRE(ipc::format_response(response) == "OK 2\nfirst\nsecond\n");
+
+	response.ok = false;
+	response.error = "no such\nfeed";
+	REQUIRE(ipc::format_response(response) == "ERR no such feed\n");
+}
+
+TEST_CASE("sanitize_field() replaces tabs and newlines with spaces", "[Ipc]")
+{
+	REQUIRE(ipc::sanitize_field("") == "");
+	REQUIRE(ipc::sanitize_field("a\tb\nc\r\nd") == "a b c  d");
+	REQUIRE(ipc::sanitize_field("nothing to do") == "nothing to do");
+}
+
+TEST_CASE("IpcClient::connect() fails if nobody listens on the socket",
+	"[Ipc]")
+{
+	TestHelpers::TempFile socket;
+	IpcClient client(socket.get_path());
+	REQUIRE_FALSE(client.connect());
+	REQUIRE_FALSE(client.request("feeds").ok);
+}
+
+TEST_CASE("IpcClient receives replies sent by the server", "[Ipc]")
+{
+	TestHelpers::TempFile socket;
+	const int listen_fd = ipc::listen_on(socket.get_path());
+	REQUIRE(listen_fd >= 0);
+
+	std::thread server([listen_fd]() {
+		const int fd = ::accept(listen_fd, nullptr, nullptr);
+		std::string request;
+		while (ipc::read_line(fd, request)) {
+			IpcResponse response;
+			if (request == "feeds") {
+				response.lines = {"1\t2\thttp://example.com/\tExample"};
+			} else {
+				response.ok = false;
+				response.error = "unknown command: " + request;
+			}
+			ipc::write_all(fd, ipc::format_response(response));
+		}
+		::close(fd);
+	});
+
+	{
+		IpcClient client(socket.get_path());
+		REQUIRE(client.connect());
+
+		const auto feeds = client.request("feeds");
+		REQUIRE(feeds.ok);
+		REQUIRE(feeds.lines ==
+			std::vector<std::string>({"1\t2\thttp://example.com/\tExample"}));
+
+		const auto bogus = client.request("bogus");
+		REQUIRE_FALSE(bogus.ok);
+		REQUIRE(bogus.error == "unknown command: bogus");
+	}
+
+	server.join();
+	::close(listen_fd);
+}
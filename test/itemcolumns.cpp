@@ -0,0 +1,337 @@
+#include "itemcolumns.h"
+
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+
+#include "feedcontainer.h"
+#include "matcher.h"
+#include "rssfeed.h"
+#include "rssitem.h"
+
+using namespace newsboat;
+
+namespace {
+
+/// Items are published in the middle of a day, so that their age doesn't
+/// change while a test runs.
+time_t days_ago(time_t now, unsigned int days)
+{
+	return now - days * 86400 - 43200;
+}
+
+std::vector<std::shared_ptr<RssFeed>> make_feeds(time_t now)
+{
+	std::vector<std::shared_ptr<RssFeed>> feeds;
+	for (unsigned int f = 0; f < 3; ++f) {
+		const auto feed = std::make_shared<RssFeed>(nullptr);
+		feed->set_title("Feed " + std::to_string(f));
+		feed->set_rssurl("http://example.com/feed" + std::to_string(f));
+		feed->set_tags({"tag" + std::to_string(f % 2)});
+		feed->set_index(f + 1);
+		for (unsigned int i = 0; i < 10; ++i) {
+			const auto item = std::make_shared<RssItem>(nullptr);
+			item->set_title("Item " + std::to_string(i));
+			item->set_guid(feed->rssurl() + "/" + std::to_string(i));
+			item->set_author(i % 2 == 0 ? "Alice" : "Bob");
+			item->set_unread_nowrite(i % 3 == 0);
+			item->set_flags(i % 4 == 0 ? "sx" : (i % 4 == 1 ? "a" : ""));
+			item->set_pubDate(days_ago(now, i));
+			item->set_feedptr(feed);
+			feed->add_item(item);
+		}
+		feeds.push_back(feed);
+	}
+	feeds[1]->items()[5]->set_deleted(true);
+
+	const auto query = std::make_shared<RssFeed>(nullptr);
+	query->set_rssurl("query:Unread:unread = \"yes\"");
+	feeds.push_back(query);
+
+	return feeds;
+}
+
+/// What matching the items one by one gives.
+std::vector<uint8_t> match_items(const std::vector<std::shared_ptr<RssFeed>>&
+	feeds, const Matcher& m)
+{
+	std::vector<uint8_t> rows;
+	for (const auto& feed : feeds) {
+		if (feed->is_query_feed()) {
+			continue;
+		}
+		for (const auto& item : feed->items()) {
+			rows.push_back(!item->deleted() && m.matches(item.get()));
+		}
+	}
+	return rows;
+}
+
+} // namespace
+
+TEST_CASE("ItemColumns takes a snapshot of the items of all non-query feeds",
+	"[ItemColumns]")
+{
+	const time_t now = time(nullptr);
+	const auto feeds = make_feeds(now);
+	const ItemColumns columns(feeds);
+
+	REQUIRE(columns.size() == 30);
+	REQUIRE(columns.item(0) == feeds[0]->items()[0].get());
+	REQUIRE(columns.item(29) == feeds[2]->items()[9].get());
+	for (size_t row = 0; row < columns.size(); ++row) {
+		REQUIRE(columns.describes(row, *columns.item(row)));
+	}
+}
+
+TEST_CASE("ItemColumns::evaluate() gives the same results as matching items "
+	"one by one", "[ItemColumns]")
+{
+	const time_t now = time(nullptr);
+	const auto feeds = make_feeds(now);
+	const ItemColumns columns(feeds);
+
+	for (const std::string expr : {
+				"unread = \"yes\"",
+				"unread != \"yes\"",
+				"flags # \"s\"",
+				"flags !# \"x\"",
+				"flags =~ \"^a\"",
+				"flags = \"\"",
+				"author = \"Alice\"",
+				"author =~ \"^b\" or unread = \"yes\"",
+				"age < 3",
+				"age > 7",
+				"age <= 3",
+				"age >= 8",
+				"age between 2:4",
+				"age between 4:2",
+				"age between 3",
+				"age < -2",
+				"feedtitle = \"Feed 1\"",
+				"feedtitle =~ \"[02]$\" and unread = \"no\"",
+				"tags # \"tag1\"",
+				"feedindex > 1",
+				"rssurl =~ \"feed2\"",
+				"unread_count > 3",
+				"total_count = \"10\"",
+				"(unread = \"yes\" or flags # \"a\") and (age < 5 or "
+				"feedtitle != \"Feed 0\")",
+			}) {
+		INFO("expression: " << expr);
+		Matcher m(expr);
+		const auto rows = columns.evaluate(m, now);
+		REQUIRE(rows.has_value());
+		REQUIRE(rows.value() == match_items(feeds, m));
+	}
+}
+
+TEST_CASE("ItemColumns::evaluate() returns nothing for expressions that "
+	"have to be matched one by one", "[ItemColumns]")
+{
+	const time_t now = time(nullptr);
+	auto feeds = make_feeds(now);
+	const ItemColumns columns(feeds);
+
+	SECTION("Attributes that aren't in the snapshot") {
+		for (const std::string expr : {
+					"title = \"Item 1\"",
+					"unread = \"yes\" and content =~ \"rust\"",
+					"articleindex > 3",
+					"age = \"3\"",
+					"age =~ \"3\"",
+					"nonexistent = \"x\"",
+				}) {
+			INFO("expression: " << expr);
+			REQUIRE_FALSE(columns.evaluate(Matcher(expr), now).has_value());
+		}
+	}
+
+	SECTION("Invalid regexes") {
+		REQUIRE_FALSE(columns.evaluate(Matcher("flags =~ \"(\""),
+				now).has_value());
+	}
+
+	SECTION("Feed attributes of items without a feed") {
+		feeds[1]->items()[0]->set_feedptr(std::shared_ptr<RssFeed>());
+		const ItemColumns orphaned(feeds);
+		REQUIRE_FALSE(orphaned.evaluate(Matcher("feedtitle = \"Feed 1\""),
+				now).has_value());
+		REQUIRE(orphaned.evaluate(Matcher("unread = \"yes\""),
+				now).has_value());
+	}
+}
+
+TEST_CASE("ItemColumns::update() picks up changes to the items",
+	"[ItemColumns]")
+{
+	const time_t now = time(nullptr);
+	auto feeds = make_feeds(now);
+	ItemColumns columns(feeds);
+
+	const Matcher m("unread = \"yes\" and flags # \"s\" and age < 20");
+	const auto check = [&]() {
+		columns.update(feeds);
+		for (size_t row = 0; row < columns.size(); ++row) {
+			REQUIRE(columns.describes(row, *columns.item(row)));
+		}
+		const auto rows = columns.evaluate(m, now);
+		REQUIRE(rows.has_value());
+		REQUIRE(rows.value() == match_items(feeds, m));
+	};
+
+	SECTION("Changed attributes") {
+		const auto item = feeds[0]->items()[1];
+		REQUIRE(columns.describes(1, *item));
+		item->set_unread_nowrite(true);
+		item->set_flags("s");
+		REQUIRE_FALSE(columns.describes(1, *item));
+		check();
+
+		feeds[2]->items()[0]->set_deleted(true);
+		feeds[2]->items()[4]->set_pubDate(days_ago(now, 100));
+		check();
+	}
+
+	SECTION("Added and removed items") {
+		const auto item = std::make_shared<RssItem>(nullptr);
+		item->set_guid("new");
+		item->set_unread_nowrite(true);
+		item->set_flags("s");
+		item->set_pubDate(now);
+		item->set_feedptr(feeds[0]);
+		feeds[0]->add_item(item);
+		check();
+		REQUIRE(columns.size() == 31);
+
+		feeds[1]->items().clear();
+		check();
+		REQUIRE(columns.size() == 21);
+	}
+
+	SECTION("Items moved to another feed") {
+		const Matcher by_feed("feedtitle = \"Feed 2\"");
+		feeds[0]->items()[3]->set_feedptr(feeds[2]);
+		columns.update(feeds);
+		REQUIRE(columns.evaluate(by_feed, now).value() ==
+			match_items(feeds, by_feed));
+	}
+}
+
+TEST_CASE("ItemColumns::update() forgets feeds and values that no item "
+	"refers to any more", "[ItemColumns]")
+{
+	const time_t now = time(nullptr);
+	auto feeds = make_feeds(now);
+	ItemColumns columns(feeds);
+
+	const Matcher m("feedtitle =~ \"[01]$\" and author != \"Bob\"");
+	for (unsigned int reload = 0; reload < 20; ++reload) {
+		// Reloading a feed replaces it with a new one
+		for (auto& feed : feeds) {
+			if (feed->is_query_feed()) {
+				continue;
+			}
+			const auto reloaded = std::make_shared<RssFeed>(nullptr);
+			reloaded->set_title(feed->title());
+			reloaded->set_rssurl(feed->rssurl());
+			for (const auto& item : feed->items()) {
+				item->set_author("Author " + std::to_string(reload));
+				item->set_feedptr(reloaded);
+				reloaded->add_item(item);
+			}
+			feed = reloaded;
+		}
+		columns.update(feeds);
+
+		// No table holds more than twice the values in use
+		const ItemColumns fresh(feeds);
+		REQUIRE(columns.interned_value_count() <=
+			2 * fresh.interned_value_count());
+		REQUIRE(columns.evaluate(m, now).value() == match_items(feeds, m));
+	}
+}
+
+TEST_CASE("FeedContainer::get_item_columns() doesn't modify snapshots that "
+	"were handed out", "[ItemColumns][FeedContainer]")
+{
+	const time_t now = time(nullptr);
+	const auto feeds = make_feeds(now);
+	FeedContainer feedcontainer;
+	feedcontainer.set_feeds(feeds);
+
+	const auto first = feedcontainer.get_item_columns();
+	REQUIRE(first->size() == 30);
+
+	const auto item = std::make_shared<RssItem>(nullptr);
+	item->set_guid("new");
+	feeds[0]->add_item(item);
+
+	const auto second = feedcontainer.get_item_columns();
+	REQUIRE(first->size() == 30);
+	REQUIRE(second->size() == 31);
+
+	feedcontainer.populate_query_feeds();
+	REQUIRE(feeds[3]->total_item_count() ==
+		static_cast<unsigned int>(feeds[0]->unread_item_count() +
+			feeds[1]->unread_item_count() + feeds[2]->unread_item_count()));
+}
+
+TEST_CASE("Evaluating filters on 1M items", "[ItemColumns][.][benchmark]")
+{
+	const time_t now = time(nullptr);
+	const unsigned int feed_count = 100;
+	const unsigned int items_per_feed = 10000;
+
+	std::vector<std::shared_ptr<RssFeed>> feeds;
+	for (unsigned int f = 0; f < feed_count; ++f) {
+		const auto feed = std::make_shared<RssFeed>(nullptr);
+		feed->set_title("Feed " + std::to_string(f));
+		feed->set_rssurl("http://example.com/" + std::to_string(f));
+		for (unsigned int i = 0; i < items_per_feed; ++i) {
+			const auto item = std::make_shared<RssItem>(nullptr);
+			item->set_author("Author " + std::to_string(i % 50));
+			item->set_unread_nowrite(i % 3 == 0);
+			item->set_flags(i % 7 == 0 ? "s" : "");
+			item->set_pubDate(days_ago(now, i % 30));
+			item->set_feedptr(feed);
+			feed->add_item(item);
+		}
+		feeds.push_back(feed);
+	}
+
+	const ItemColumns columns(feeds);
+
+	for (const std::string expr : {
+				"unread = \"yes\" and age < 3",
+				"flags # \"s\"",
+				"feedtitle = \"Feed 7\"",
+			}) {
+		const Matcher m(expr);
+
+		BENCHMARK("Per item: " + expr) {
+			unsigned int matched = 0;
+			for (const auto& feed : feeds) {
+				for (const auto& item : feed->items()) {
+					matched += m.matches(item.get());
+				}
+			}
+			return matched;
+		};
+
+		BENCHMARK("Columns: " + expr) {
+			return columns.evaluate(m, now)->size();
+		};
+	}
+
+	ItemColumns updated(feeds);
+	unsigned int changes = 0;
+	BENCHMARK("Updating the columns after one change") {
+		feeds[50]->items()[5000]->set_flags(++changes % 2 ? "a" : "s");
+		updated.update(feeds);
+		return updated.size();
+	};
+}
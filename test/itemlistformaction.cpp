@@ -765,6 +765,59 @@ TEST_CASE("OP_TOGGLESHOWREAD switches the value of show-read-articles",
 	}
 }
 
+TEST_CASE("Lines of the article list are reused when the list is rebuilt "
+	"without its items changing", "[ItemListFormAction]")
+{
+	ConfigPaths paths;
+	Controller c(paths);
+	newsboat::View v(&c);
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+
+	KeyMap k(KM_NEWSBOAT);
+	v.set_keymap(&k);
+
+	v.set_config_container(&cfg);
+	c.set_view(&v);
+
+	std::shared_ptr<RssFeed> feed = std::make_shared<RssFeed>(&rsscache);
+	const unsigned int item_count = 5;
+	for (unsigned int i = 0; i < item_count; ++i) {
+		auto item = std::make_shared<RssItem>(&rsscache);
+		item->set_title("Article " + std::to_string(i));
+		item->set_unread_nowrite(true);
+		feed->add_item(item);
+	}
+
+	std::shared_ptr<ItemListFormAction> itemlist = v.push_itemlist(feed);
+	REQUIRE(itemlist != nullptr);
+	itemlist->prepare();
+
+	auto& line_cache = v.get_article_line_cache();
+	const auto before = line_cache.get_stats();
+	REQUIRE(before.misses == item_count);
+
+	SECTION("Redrawing everything, e.g. when returning from an article") {
+		itemlist->set_redraw(true);
+		itemlist->prepare();
+	}
+
+	SECTION("Toggling show-read-articles") {
+		REQUIRE_NOTHROW(itemlist->process_op(OP_TOGGLESHOWREAD));
+		itemlist->prepare();
+	}
+
+	SECTION("Opening the feed again") {
+		itemlist = v.push_itemlist(feed);
+		REQUIRE(itemlist != nullptr);
+		itemlist->prepare();
+	}
+
+	const auto after = line_cache.get_stats();
+	REQUIRE(after.misses == before.misses);
+	REQUIRE(after.hits == before.hits + item_count);
+}
+
 TEST_CASE("OP_PIPE_TO pipes an article's content to an external command",
 	"[ItemListFormAction]")
 {
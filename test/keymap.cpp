@@ -11,7 +11,7 @@ using namespace newsboat;
 
 static const auto contexts = { "feedlist", "filebrowser", "help", "articlelist",
 	"article", "tagselection", "filterselection", "urlview", "podboat",
-	"dialogs", "dirbrowser"
+	"dialogs", "dirbrowser", "reloadstats", "filterstats"
 };
 
 TEST_CASE("get_operation()", "[KeyMap]")
@@ -59,7 +59,8 @@ TEST_CASE(
 			if (i == OP_OPENALLUNREADINBROWSER ||
 				i == OP_MARKALLABOVEASREAD ||
 				i == OP_OPENALLUNREADINBROWSER_AND_MARK ||
-				i == OP_SAVEALL) {
+				i == OP_SAVEALL ||
+				i == OP_CANCELRELOAD) {
 				continue;
 			}
 			bool used_in_some_context = false;
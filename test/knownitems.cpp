@@ -0,0 +1,294 @@
+#include "knownitems.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+#include "cache.h"
+#include "configcontainer.h"
+#include "rss/item.h"
+#include "rssparser.h"
+#include "test-helpers/tempfile.h"
+
+using namespace newsboat;
+
+namespace {
+
+rsspp::Item make_item(const std::string& guid, const std::string& title)
+{
+	rsspp::Item item;
+	item.guid = guid;
+	item.title = title;
+	return item;
+}
+
+/// Generates an RSS feed with \a item_count items, numbered from
+/// \a newest down, one minute apart. Without GUIDs, RssParser identifies
+/// items by their link and date.
+std::string generate_rss(unsigned int newest, unsigned int item_count,
+	bool with_guids = true, bool newest_first = true)
+{
+	std::string feed =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<rss version=\"2.0\"><channel><title>Generated feed</title>\n";
+	const std::string body(2000, 'x');
+	for (unsigned int i = 0; i < item_count; ++i) {
+		const unsigned int number = newest_first
+			? newest - i
+			: newest - item_count + 1 + i;
+		const auto n = std::to_string(number);
+		char date[64];
+		snprintf(date, sizeof(date), "Sun, 01 Nov 2020 %02u:%02u:00 +0000",
+			number / 60, number % 60);
+		feed += "<item><title>Item " + n + "</title>"
+			"<link>http://example.com/" + n + "</link>"
+			"<pubDate>" + date + "</pubDate>";
+		if (with_guids) {
+			feed += "<guid>item-" + n + "</guid>";
+		}
+		feed += "<description>" + body + "</description></item>\n";
+	}
+	feed += "</channel></rss>\n";
+	return feed;
+}
+
+/// A feed in a local file that is reloaded with RssParser, the way the
+/// reloader does it.
+class LocalFeed {
+public:
+	LocalFeed()
+		: rsscache(":memory:", &cfg)
+	{
+	}
+
+	std::string url() const
+	{
+		return "file://" + file.get_path();
+	}
+
+	/// \brief Parses \a contents, stopping at items that \a known remembers
+	/// if \a stop_at_known is set. Returns the number of items parsed.
+	unsigned int reload(KnownItems& known, const std::string& contents,
+		bool stop_at_known = true)
+	{
+		{
+			std::ofstream out(file.get_path());
+			out << contents;
+		}
+		RssParser parser(url(), &rsscache, &cfg, nullptr);
+		if (stop_at_known) {
+			parser.set_known_items(&known);
+		}
+		REQUIRE(parser.parse() != nullptr);
+		return parser.get_materialized_items();
+	}
+
+private:
+	TestHelpers::TempFile file;
+	ConfigContainer cfg;
+	Cache rsscache;
+};
+
+} // namespace
+
+TEST_CASE("KnownItems doesn't allow stopping early before a full pass",
+	"[KnownItems]")
+{
+	KnownItems known;
+	REQUIRE_FALSE(known.allows_early_stop("http://example.com/feed", 1000));
+
+	known.update("http://example.com/feed", {}, true, true, 1000);
+	REQUIRE(known.allows_early_stop("http://example.com/feed", 1000));
+	REQUIRE_FALSE(known.allows_early_stop("http://example.com/other", 1000));
+}
+
+TEST_CASE("KnownItems asks for a full pass once in a while",
+	"[KnownItems]")
+{
+	KnownItems known;
+	const std::string url = "http://example.com/feed";
+	known.update(url, {}, true, true, 1000);
+
+	const time_t later = 1000 + KnownItems::FULL_PASS_INTERVAL;
+	REQUIRE(known.allows_early_stop(url, later - 1));
+	REQUIRE_FALSE(known.allows_early_stop(url, later));
+
+	// A partial pass doesn't reset the interval
+	known.update(url, {}, false, true, later - 1);
+	REQUIRE_FALSE(known.allows_early_stop(url, later));
+
+	known.update(url, {}, true, true, later);
+	REQUIRE(known.allows_early_stop(url, later));
+}
+
+TEST_CASE("KnownItems asks for a full pass if items weren't sorted",
+	"[KnownItems]")
+{
+	KnownItems known;
+	const std::string url = "http://example.com/feed";
+
+	known.update(url, {}, true, false, 1000);
+	REQUIRE_FALSE(known.allows_early_stop(url, 1000));
+
+	known.update(url, {}, true, true, 1000);
+	REQUIRE(known.allows_early_stop(url, 1000));
+}
+
+TEST_CASE("KnownItems recognizes items by GUID and content", "[KnownItems]")
+{
+	KnownItems known;
+	const std::string url = "http://example.com/feed";
+	const auto first = make_item("1", "First");
+	const auto second = make_item("2", "Second");
+
+	known.update(url, {
+		{"1", KnownItems::fingerprint(first)},
+		{"2", KnownItems::fingerprint(second)},
+	}, true, true, 1000);
+
+	REQUIRE(known.is_known(url, "1", KnownItems::fingerprint(first)));
+	REQUIRE(known.is_known(url, "2", KnownItems::fingerprint(second)));
+	REQUIRE_FALSE(known.is_known(url, "3", KnownItems::fingerprint(first)));
+	REQUIRE_FALSE(known.is_known("http://example.com/other", "1",
+			KnownItems::fingerprint(first)));
+
+	SECTION("Updated items aren't known") {
+		auto updated = first;
+		updated.description = "Now with a description";
+		REQUIRE_FALSE(known.is_known(url, "1",
+				KnownItems::fingerprint(updated)));
+	}
+
+	SECTION("Partial passes add items") {
+		const auto third = make_item("3", "Third");
+		known.update(url, {{"3", KnownItems::fingerprint(third)}},
+			false, true, 1000);
+		REQUIRE(known.is_known(url, "1", KnownItems::fingerprint(first)));
+		REQUIRE(known.is_known(url, "3", KnownItems::fingerprint(third)));
+	}
+
+	SECTION("Full passes replace items") {
+		const auto third = make_item("3", "Third");
+		known.update(url, {{"3", KnownItems::fingerprint(third)}},
+			true, true, 1000);
+		REQUIRE_FALSE(known.is_known(url, "1",
+				KnownItems::fingerprint(first)));
+		REQUIRE(known.is_known(url, "3", KnownItems::fingerprint(third)));
+	}
+}
+
+TEST_CASE("fingerprint() changes if any of the item's fields change",
+	"[KnownItems]")
+{
+	const auto item = make_item("1", "Title");
+	const auto fingerprint = KnownItems::fingerprint(item);
+
+	auto changed = item;
+	changed.title = "Other title";
+	REQUIRE(KnownItems::fingerprint(changed) != fingerprint);
+
+	changed = item;
+	changed.pubDate = "Sun, 01 Nov 2020 10:00:00 +0000";
+	REQUIRE(KnownItems::fingerprint(changed) != fingerprint);
+
+	changed = item;
+	changed.labels.push_back("read");
+	REQUIRE(KnownItems::fingerprint(changed) != fingerprint);
+
+	// Moving text from one field to another
+	const auto a = make_item("12", "3");
+	const auto b = make_item("1", "23");
+	REQUIRE(KnownItems::fingerprint(a) != KnownItems::fingerprint(b));
+}
+
+TEST_CASE("RssParser stops parsing after a run of known items",
+	"[KnownItems]")
+{
+	KnownItems known;
+	LocalFeed feed;
+
+	// The first reload parses everything
+	REQUIRE(feed.reload(known, generate_rss(100, 100)) == 100);
+
+	// Three new items, then RUN_LENGTH known ones
+	REQUIRE(feed.reload(known, generate_rss(103, 100)) ==
+		3 + KnownItems::RUN_LENGTH);
+
+	// An updated item resets the run: 103 and 102 are known, 101 isn't,
+	// then parsing stops at 96
+	auto contents = generate_rss(103, 100);
+	const std::string title = "<title>Item 101</title>";
+	contents.replace(contents.find(title), title.length(),
+		"<title>Item 101, updated</title>");
+	REQUIRE(feed.reload(known, contents) == 8);
+
+	// The parser only stops early for feeds that opted in
+	REQUIRE(feed.reload(known, generate_rss(103, 100), false) == 100);
+}
+
+TEST_CASE("RssParser recognizes known items without GUIDs by their link "
+	"and date", "[KnownItems]")
+{
+	KnownItems known;
+	LocalFeed feed;
+
+	REQUIRE(feed.reload(known, generate_rss(100, 100, false)) == 100);
+	REQUIRE(feed.reload(known, generate_rss(102, 100, false)) ==
+		2 + KnownItems::RUN_LENGTH);
+}
+
+TEST_CASE("RssParser parses all of a feed whose items aren't sorted "
+	"newest first", "[KnownItems]")
+{
+	KnownItems known;
+	LocalFeed feed;
+
+	REQUIRE(feed.reload(known, generate_rss(100, 100, true, false)) == 100);
+	REQUIRE(feed.reload(known, generate_rss(100, 100, true, false)) == 100);
+
+	// Once the order is right, the next reload may stop early
+	REQUIRE(feed.reload(known, generate_rss(100, 100)) == 100);
+	REQUIRE(feed.reload(known, generate_rss(100, 100)) ==
+		KnownItems::RUN_LENGTH);
+}
+TEST_CASE("Parsing known items: materialized items per reload",
+	"[KnownItems][.][benchmark]")
+{
+	const unsigned int feed_count = 50;
+	const unsigned int items_per_feed = 100;
+	const unsigned int reloads = 20;
+
+	for (const bool stop_at_known : {false, true}) {
+		KnownItems known;
+		std::vector<LocalFeed> feeds(feed_count);
+		size_t parsed = 0;
+		for (unsigned int r = 0; r < reloads; ++r) {
+			for (unsigned int f = 0; f < feed_count; ++f) {
+				// Every feed gets zero to two new items per reload
+				const unsigned int newest = items_per_feed + r * (f % 3);
+				parsed += feeds[f].reload(known,
+						generate_rss(newest, items_per_feed),
+						stop_at_known);
+			}
+		}
+		WARN((stop_at_known ? "With" : "Without")
+			<< " stop-at-known-articles: " << parsed << " items over "
+			<< reloads << " reloads of " << feed_count << " feeds");
+	}
+
+	const auto contents = generate_rss(items_per_feed + 2, items_per_feed);
+	KnownItems known;
+	LocalFeed feed;
+	feed.reload(known, generate_rss(items_per_feed, items_per_feed));
+
+	BENCHMARK("Reload without stopping at known items") {
+		return feed.reload(known, contents, false);
+	};
+
+	BENCHMARK("Reload stopping at known items") {
+		return feed.reload(known, contents);
+	};
+}
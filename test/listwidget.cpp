@@ -0,0 +1,140 @@
+#include "listwidget.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+
+#include "listformatter.h"
+#include "stflpp.h"
+
+using namespace newsboat;
+
+namespace {
+
+const std::string LIST_STFL =
+	"{list[items] pos[items_pos]:0 offset[items_offset]:0}";
+
+/// Renders lines as their indices, and remembers which ranges were asked
+/// for.
+class RenderedRanges {
+public:
+	std::string render(std::uint32_t begin, std::uint32_t end)
+	{
+		ranges.emplace_back(begin, end);
+		ListFormatter listfmt;
+		for (std::uint32_t i = begin; i < end; ++i) {
+			listfmt.add_line(std::to_string(i));
+		}
+		return listfmt.format_list();
+	}
+
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> ranges;
+};
+
+} // namespace
+
+TEST_CASE("stfl_replace_lines() with a renderer only renders lines around "
+	"the visible ones", "[ListWidget]")
+{
+	Stfl::Form form(LIST_STFL);
+	ListWidget list("items", form, 0);
+	RenderedRanges rendered;
+
+	list.stfl_replace_lines(100000,
+	[&](std::uint32_t begin, std::uint32_t end) {
+		return rendered.render(begin, end);
+	});
+
+	REQUIRE(rendered.ranges.size() == 1);
+	REQUIRE(rendered.ranges[0].first == 0);
+	REQUIRE(rendered.ranges[0].second > 0);
+	REQUIRE(rendered.ranges[0].second < 1000);
+	REQUIRE(list.get_position() == 0);
+	REQUIRE(list.get_scroll_offset() == 0);
+}
+
+TEST_CASE("Positions of a partially rendered list refer to the whole list",
+	"[ListWidget]")
+{
+	Stfl::Form form(LIST_STFL);
+	ListWidget list("items", form, 0);
+	RenderedRanges rendered;
+
+	list.stfl_replace_lines(100000,
+	[&](std::uint32_t begin, std::uint32_t end) {
+		return rendered.render(begin, end);
+	});
+
+	list.set_position(50000);
+	REQUIRE(list.get_position() == 50000);
+	REQUIRE(list.get_scroll_offset() == 50000);
+	REQUIRE(rendered.ranges.size() == 2);
+	REQUIRE(rendered.ranges[1].first <= 50000);
+	REQUIRE(rendered.ranges[1].second > 50000);
+	REQUIRE(rendered.ranges[1].second - rendered.ranges[1].first < 1000);
+
+	// STFL only knows about the rendered lines
+	REQUIRE(std::stoul(form.get("items_pos")) < 1000);
+
+	// Moving within the rendered lines doesn't render anything
+	REQUIRE(list.move_down(false));
+	REQUIRE(list.get_position() == 50001);
+	REQUIRE(rendered.ranges.size() == 2);
+
+	REQUIRE(list.move_up(false));
+	REQUIRE(list.move_up(false));
+	REQUIRE(list.get_position() == 49999);
+	REQUIRE(rendered.ranges.size() == 2);
+
+	list.move_to_last();
+	REQUIRE(list.get_position() == 99999);
+	REQUIRE(rendered.ranges.size() == 3);
+	REQUIRE(rendered.ranges[2].second == 100000);
+
+	REQUIRE(list.move_down(true));
+	REQUIRE(list.get_position() == 0);
+	REQUIRE(list.get_scroll_offset() == 0);
+	REQUIRE(rendered.ranges.size() == 4);
+	REQUIRE(rendered.ranges[3].first == 0);
+}
+
+TEST_CASE("stfl_replace_lines() keeps the position, as long as it's still "
+	"in the list", "[ListWidget]")
+{
+	Stfl::Form form(LIST_STFL);
+	ListWidget list("items", form, 0);
+	RenderedRanges rendered;
+	const auto render = [&](std::uint32_t begin, std::uint32_t end) {
+		return rendered.render(begin, end);
+	};
+
+	list.stfl_replace_lines(100000, render);
+	list.set_position(70000);
+
+	SECTION("Re-rendering the same number of lines") {
+		list.stfl_replace_lines(100000, render);
+		REQUIRE(list.get_position() == 70000);
+		REQUIRE(list.get_scroll_offset() == 70000);
+	}
+
+	SECTION("The list got shorter than the position") {
+		list.stfl_replace_lines(10, render);
+		REQUIRE(list.get_position() == 9);
+		REQUIRE(rendered.ranges.back().first == 0);
+		REQUIRE(rendered.ranges.back().second == 10);
+	}
+
+	SECTION("Rendering all lines at once") {
+		ListFormatter listfmt;
+		for (std::uint32_t i = 0; i < 100000; ++i) {
+			listfmt.add_line(std::to_string(i));
+		}
+		list.stfl_replace_lines(listfmt);
+		REQUIRE(list.get_position() == 70000);
+		REQUIRE(list.get_scroll_offset() == 70000);
+		REQUIRE(form.get("items_pos") == "70000");
+	}
+}
@@ -0,0 +1,193 @@
+#include "literalprefilter.h"
+
+#include <random>
+#include <regex.h>
+#include <string>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+
+using namespace newsboat;
+
+TEST_CASE("LiteralPrefilter::required_literal() returns the longest literal "
+	"that every match contains", "[LiteralPrefilter]")
+{
+	REQUIRE(LiteralPrefilter::required_literal("hello") == "hello");
+	REQUIRE(LiteralPrefilter::required_literal("Hello World") == "hello world");
+	REQUIRE(LiteralPrefilter::required_literal("^foo.*barbaz$") == "barbaz");
+	REQUIRE(LiteralPrefilter::required_literal("[0-9]+ comment") == " comment");
+	REQUIRE(LiteralPrefilter::required_literal("a\\.b\\(c") == "a.b(c");
+	REQUIRE(LiteralPrefilter::required_literal("(new|old) rel") == " rel");
+	REQUIRE(LiteralPrefilter::required_literal("[[:alpha:]]]x") == "]x");
+
+	SECTION("Quantified characters aren't part of the literal") {
+		REQUIRE(LiteralPrefilter::required_literal("abc*def") == "def");
+		REQUIRE(LiteralPrefilter::required_literal("abcd?ef") == "abc");
+		REQUIRE(LiteralPrefilter::required_literal("abc{0,2}de") == "ab");
+		REQUIRE(LiteralPrefilter::required_literal("abc+de") == "abc");
+	}
+
+	SECTION("Expressions without a required literal") {
+		REQUIRE(LiteralPrefilter::required_literal("") == "");
+		REQUIRE(LiteralPrefilter::required_literal("foo|bar") == "");
+		REQUIRE(LiteralPrefilter::required_literal("(foo)*") == "");
+		REQUIRE(LiteralPrefilter::required_literal("\\w+") == "");
+		REQUIRE(LiteralPrefilter::required_literal("[abc]") == "");
+	}
+
+	SECTION("Letters that might match non-ASCII characters are left out") {
+		REQUIRE(LiteralPrefilter::required_literal("kubernetes") == "ubernete");
+		REQUIRE(LiteralPrefilter::required_literal("I like it") == " l");
+		REQUIRE(LiteralPrefilter::required_literal("caf\xc3\xa9 au lait") ==
+			" au la");
+	}
+}
+
+TEST_CASE("LiteralPrefilter::required_literals() returns every literal "
+	"that all matches contain", "[LiteralPrefilter]")
+{
+	using Literals = std::vector<std::string>;
+
+	REQUIRE(LiteralPrefilter::required_literals("CVE-[0-9]+") ==
+		Literals({"cve-"}));
+	REQUIRE(LiteralPrefilter::required_literals("^foo.*bar(baz)?$") ==
+		Literals({"foo", "bar"}));
+	REQUIRE(LiteralPrefilter::required_literals("a+b*c") == Literals({"a", "c"}));
+	REQUIRE(LiteralPrefilter::required_literals("rust|go").empty());
+	REQUIRE(LiteralPrefilter::required_literals("[0-9]*").empty());
+}
+
+TEST_CASE("LiteralPrefilter::contains() looks for a literal ignoring ASCII "
+	"case", "[LiteralPrefilter]")
+{
+	const std::string text = "Fixed in CVE-2021-1234, written in Rust.";
+
+	REQUIRE(LiteralPrefilter::contains(text.data(), text.size(), "cve-"));
+	REQUIRE(LiteralPrefilter::contains(text.data(), text.size(), "rust."));
+	REQUIRE(LiteralPrefilter::contains(text.data(), text.size(), "fixed"));
+	REQUIRE(LiteralPrefilter::contains(text.data(), text.size(), ""));
+	REQUIRE_FALSE(LiteralPrefilter::contains(text.data(), text.size(),
+			"cve-2022"));
+	REQUIRE_FALSE(LiteralPrefilter::contains(text.data(), text.size(),
+			"rust. "));
+	REQUIRE_FALSE(LiteralPrefilter::contains(text.data(), 3, "fixed"));
+	REQUIRE_FALSE(LiteralPrefilter::contains("", 0, "a"));
+
+	SECTION("Overlapping candidates are all checked") {
+		REQUIRE(LiteralPrefilter::contains("aaAab", 5, "aab"));
+		REQUIRE(LiteralPrefilter::contains("xyxyXYz", 7, "xyz"));
+	}
+}
+
+TEST_CASE("LiteralPrefilter::find() reports the expressions whose literal "
+	"occurs in the text", "[LiteralPrefilter]")
+{
+	const LiteralPrefilter prefilter({"he", "she", "", "hers", "his", "x"});
+	std::vector<char> candidates;
+
+	const std::string text = "uSHErs";
+	prefilter.find(text.data(), text.size(), candidates);
+	REQUIRE(candidates == std::vector<char>({1, 1, 1, 1, 0, 0}));
+
+	prefilter.find("", 0, candidates);
+	REQUIRE(candidates == std::vector<char>({0, 0, 1, 0, 0, 0}));
+
+	SECTION("Works without any literals") {
+		const LiteralPrefilter empty({});
+		empty.find(text.data(), text.size(), candidates);
+		REQUIRE(candidates.empty());
+	}
+}
+
+TEST_CASE("LiteralPrefilter never rules out an expression that matches",
+	"[LiteralPrefilter]")
+{
+	const std::vector<std::string> patterns = {
+		"ab", "a+b", "(ab)+c", "ab*c", "a.c", "^ba", "c$", "[ab]c{2}",
+		"abc|bca", "a?bc", "b{2,}a", "\\(a\\)", "ca(b|c)a", "[^a]bb",
+		"AB.*CA", "a\\.b", "(a|b)*cc", "[[:upper:]]ab",
+	};
+	std::vector<regex_t> regexes(patterns.size());
+	std::vector<std::string> literals;
+	for (size_t i = 0; i < patterns.size(); ++i) {
+		INFO("pattern: " << patterns[i]);
+		REQUIRE(regcomp(&regexes[i], patterns[i].c_str(),
+				REG_EXTENDED | REG_ICASE | REG_NOSUB) == 0);
+		literals.push_back(LiteralPrefilter::required_literal(patterns[i]));
+	}
+	const LiteralPrefilter prefilter(literals);
+
+	std::mt19937 rng(42);
+	const std::string alphabet = "abcABC.()x";
+	std::uniform_int_distribution<size_t> letter(0, alphabet.size() - 1);
+	std::uniform_int_distribution<size_t> length(0, 12);
+	std::vector<char> candidates;
+	for (unsigned int n = 0; n < 5000; ++n) {
+		std::string text;
+		const size_t len = length(rng);
+		for (size_t c = 0; c < len; ++c) {
+			text.push_back(alphabet[letter(rng)]);
+		}
+
+		prefilter.find(text.data(), text.size(), candidates);
+		for (size_t i = 0; i < patterns.size(); ++i) {
+			if (regexec(&regexes[i], text.c_str(), 0, nullptr, 0) == 0) {
+				INFO("pattern: " << patterns[i] << ", text: " << text);
+				REQUIRE(candidates[i]);
+			}
+		}
+	}
+
+	for (auto& regex : regexes) {
+		regfree(&regex);
+	}
+}
+
+TEST_CASE("Texts without the required literals of a random regex never "
+	"match it", "[LiteralPrefilter]")
+{
+	const std::vector<std::string> pieces = {
+		"a", "b", "c", "A", "B", "-", ".", "*", "+", "?", "{1,2}", "{0}", "|",
+		"^", "$", "(", ")", "[ab]", "[^a]", "[]a]", "\\.", "\\*", "\\(",
+		"\\w", "\\<", "(a|bc)",
+	};
+	const std::string alphabet = "abcABC-.*(x ";
+
+	std::mt19937 rng(43);
+	std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+	std::uniform_int_distribution<size_t> letter(0, alphabet.size() - 1);
+	std::uniform_int_distribution<size_t> length(0, 8);
+
+	unsigned int valid_patterns = 0;
+	for (unsigned int n = 0; n < 3000; ++n) {
+		std::string pattern;
+		const size_t pattern_length = length(rng);
+		for (size_t i = 0; i < pattern_length; ++i) {
+			pattern += pieces[piece(rng)];
+		}
+		regex_t regex;
+		if (regcomp(&regex, pattern.c_str(),
+				REG_EXTENDED | REG_ICASE | REG_NOSUB) != 0) {
+			continue;
+		}
+		valid_patterns++;
+
+		const auto literals = LiteralPrefilter::required_literals(pattern);
+		for (unsigned int t = 0; t < 30; ++t) {
+			std::string text;
+			const size_t text_length = 2 * length(rng);
+			for (size_t i = 0; i < text_length; ++i) {
+				text.push_back(alphabet[letter(rng)]);
+			}
+			if (regexec(&regex, text.c_str(), 0, nullptr, 0) == 0) {
+				INFO("pattern: " << pattern << ", text: " << text);
+				for (const auto& literal : literals) {
+					REQUIRE(LiteralPrefilter::contains(text.data(), text.size(),
+							literal));
+				}
+			}
+		}
+		regfree(&regex);
+	}
+	REQUIRE(valid_patterns > 1000);
+}
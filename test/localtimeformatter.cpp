@@ -0,0 +1,227 @@
+#include "localtimeformatter.h"
+
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+#include "test-helpers/envvar.h"
+#include "utils.h"
+
+using namespace newsboat;
+
+namespace {
+
+/// What utils::mt_strf_localtime() used to do.
+std::string strftime_localtime(const std::string& format, time_t t)
+{
+	static std::mutex mtx;
+	std::lock_guard<std::mutex> guard(mtx);
+
+	char buffer[4096];
+	const size_t written = strftime(buffer, sizeof(buffer), format.c_str(),
+			localtime(&t));
+	return std::string(buffer, written);
+}
+
+void format_on_threads(const std::vector<time_t>& dates,
+	unsigned int thread_count,
+	std::string (*format)(const std::string&, time_t))
+{
+	std::vector<std::thread> threads;
+	for (unsigned int i = 0; i < thread_count; ++i) {
+		threads.emplace_back([&, i]() {
+			for (size_t j = i; j < dates.size(); j += thread_count) {
+				format("%a, %d %b %Y %T %z", dates[j]);
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+struct TimeRange {
+	time_t begin;
+	time_t end;
+};
+
+// Each of these contains a change of the UTC offset in at least one of the
+// zones that are tested below
+const std::vector<TimeRange> TRANSITIONS = {
+	// 2021-03-12 to 2021-04-06: New York, Berlin and Lord Howe Island
+	{1615507200, 1617667200},
+	// 2021-10-29 to 2021-11-09: Berlin and New York
+	{1635465600, 1636416000},
+	// 2020-10-02 to 2020-10-06: Lord Howe Island, where it's only 30 minutes
+	{1601596800, 1601942400},
+	// 2011-12-28 to 2012-01-01: Samoa, which skipped December 30th
+	{1325030400, 1325376000},
+};
+
+} // namespace
+
+TEST_CASE("resolution() is the smallest unit of time a format shows",
+	"[LocalTimeFormatter]")
+{
+	REQUIRE(LocalTimeFormatter::resolution("") == 86400);
+	REQUIRE(LocalTimeFormatter::resolution("%b %d") == 86400);
+	REQUIRE(LocalTimeFormatter::resolution("%Y-%m-%d %z (%Z)") == 86400);
+	REQUIRE(LocalTimeFormatter::resolution("%-d%% of %Ey") == 86400);
+
+	REQUIRE(LocalTimeFormatter::resolution("%b %d %H:%M") == 60);
+	REQUIRE(LocalTimeFormatter::resolution("%R") == 60);
+	REQUIRE(LocalTimeFormatter::resolution("%_I %p") == 60);
+
+	REQUIRE(LocalTimeFormatter::resolution("%a, %d %b %Y %T %z") == 1);
+	REQUIRE(LocalTimeFormatter::resolution("%H:%M:%S") == 1);
+	REQUIRE(LocalTimeFormatter::resolution("%s") == 1);
+	REQUIRE(LocalTimeFormatter::resolution("%c") == 1);
+	REQUIRE(LocalTimeFormatter::resolution("%Q") == 1);
+}
+
+TEST_CASE("format() agrees with strftime() and localtime() across changes "
+	"of the UTC offset", "[LocalTimeFormatter]")
+{
+	TestHelpers::EnvVar tzEnv("TZ");
+	tzEnv.on_change([](nonstd::optional<std::string>) {
+		::tzset();
+	});
+
+	const std::vector<std::string> zones = {
+		"UTC",
+		"Europe/Berlin",
+		"America/New_York",
+		"Australia/Lord_Howe",
+		"Pacific/Apia",
+		"Asia/Kolkata",
+	};
+	const std::vector<std::string> formats = {
+		"%b %d",
+		"%a, %d %b %Y %z %Z",
+		"%b %d %H:%M",
+		"%a, %d %b %Y %T %z",
+		"%Y-%m-%d %H:%M:%S %Z (%j, %U)",
+	};
+
+	for (const auto& zone : zones) {
+		tzEnv.set(zone);
+		LocalTimeFormatter formatter;
+
+		for (const auto& range : TRANSITIONS) {
+			for (const auto& format : formats) {
+				INFO("TZ=" << zone << ", format: " << format);
+
+				// Forwards, with steps that don't line up with minutes
+				for (time_t t = range.begin; t < range.end; t += 421) {
+					INFO("t = " << t);
+					REQUIRE(formatter.format(format, t) == strftime_localtime(format, t));
+				}
+
+				// Backwards, as lines of a list sorted by date would be
+				for (time_t t = range.end; t > range.begin; t -= 3599) {
+					INFO("t = " << t);
+					REQUIRE(formatter.format(format, t) == strftime_localtime(format, t));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("format() notices changes of TZ", "[LocalTimeFormatter]")
+{
+	// Changed without calling tzset() on purpose
+	TestHelpers::EnvVar tzEnv("TZ");
+	LocalTimeFormatter formatter;
+
+	tzEnv.set("UTC");
+	REQUIRE(formatter.format("%H:%M %Z", 0) == "00:00 UTC");
+
+	tzEnv.set("Asia/Tokyo");
+	REQUIRE(formatter.format("%H:%M %Z", 0) == "09:00 JST");
+
+	tzEnv.set("UTC");
+	REQUIRE(formatter.format("%H:%M %Z", 0) == "00:00 UTC");
+}
+
+TEST_CASE("mt_strf_localtime() can be used from several threads at once",
+	"[LocalTimeFormatter]")
+{
+	TestHelpers::EnvVar tzEnv("TZ");
+	tzEnv.on_change([](nonstd::optional<std::string>) {
+		::tzset();
+	});
+	tzEnv.set("Europe/Berlin");
+
+	const std::string format = "%a, %d %b %Y %T %z";
+	const auto& range = TRANSITIONS[0];
+
+	std::vector<std::string> expected;
+	for (time_t t = range.begin; t < range.end; t += 977) {
+		expected.push_back(strftime_localtime(format, t));
+	}
+
+	std::vector<std::vector<std::string>> results(4);
+	std::vector<std::thread> threads;
+	for (auto& result : results) {
+		threads.emplace_back([&]() {
+			for (time_t t = range.begin; t < range.end; t += 977) {
+				result.push_back(utils::mt_strf_localtime(format, t));
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	for (const auto& result : results) {
+		REQUIRE(result == expected);
+	}
+}
+
+TEST_CASE("Formatting the dates of 100k articles",
+	"[LocalTimeFormatter][.][benchmark]")
+{
+	TestHelpers::EnvVar tzEnv("TZ");
+	tzEnv.on_change([](nonstd::optional<std::string>) {
+		::tzset();
+	});
+	tzEnv.set("Europe/Berlin");
+
+	// A year's worth of articles, newest first
+	std::vector<time_t> dates;
+	const time_t newest = 1635465600;
+	for (time_t i = 0; i < 100000; ++i) {
+		dates.push_back(newest - i * 313);
+	}
+
+	for (const std::string format : {
+				"%b %d", "%a, %d %b %Y %T %z"
+			}) {
+		BENCHMARK("strftime() and localtime() with a mutex: " + format) {
+			size_t length = 0;
+			for (const auto t : dates) {
+				length += strftime_localtime(format, t).length();
+			}
+			return length;
+		};
+
+		BENCHMARK("mt_strf_localtime(): " + format) {
+			size_t length = 0;
+			for (const auto t : dates) {
+				length += utils::mt_strf_localtime(format, t).length();
+			}
+			return length;
+		};
+	}
+
+	BENCHMARK("strftime() and localtime() with a mutex, 4 threads") {
+		format_on_threads(dates, 4, strftime_localtime);
+	};
+
+	BENCHMARK("mt_strf_localtime(), 4 threads") {
+		format_on_threads(dates, 4, utils::mt_strf_localtime);
+	};
+}
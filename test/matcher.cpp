@@ -3,10 +3,16 @@
 #include "3rd-party/catch.hpp"
 
 #include <map>
+#include <memory>
+#include <random>
+#include <regex.h>
+#include <vector>
 
 #include "matchable.h"
 #include "matcherexception.h"
+#include "rssitem.h"
 #include "test-helpers/stringmaker/optional.h"
+#include "workerpool.h"
 
 using namespace newsboat;
 
@@ -35,6 +41,40 @@ private:
 	std::map<std::string, std::string> m_data;
 };
 
+/// Provides "flags" and "age" only through typed accessors, so that
+/// Matcher falling back to attribute_value() shows up as an exception.
+class TypedMockMatchable : public Matchable {
+public:
+	TypedMockMatchable(const std::string& flags, int age)
+		: m_flags(flags)
+		, m_age(age)
+	{}
+
+	nonstd::optional<std::string> attribute_value(const std::string&)
+	const override
+	{
+		return nonstd::nullopt;
+	}
+
+	const std::string* attribute_ref(MatchAttribute attr) const override
+	{
+		return attr == MatchAttribute::FLAGS ? &m_flags : nullptr;
+	}
+
+	bool attribute_number(MatchAttribute attr, int& value) const override
+	{
+		if (attr == MatchAttribute::AGE) {
+			value = m_age;
+			return true;
+		}
+		return false;
+	}
+
+private:
+	std::string m_flags;
+	int m_age;
+};
+
 TEST_CASE("Operator `=` checks if field has given value", "[Matcher]")
 {
 	Matcher m;
@@ -239,6 +279,19 @@ TEST_CASE("Matcher throws if regex passed to `=~` or `!~` is invalid",
 	REQUIRE_THROWS_AS(m.matches(&mock), MatcherException);
 }
 
+TEST_CASE("Invalid regexes are only reported when they're evaluated",
+	"[Matcher]")
+{
+	MatcherMockMatchable mock({{"AAAA", "12345"}});
+	Matcher m;
+
+	REQUIRE(m.parse("AAAA = \"12345\" or AAAA =~ \"[[\""));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("AAAA = \"0\" or AAAA =~ \"[[\""));
+	REQUIRE_THROWS_AS(m.matches(&mock), MatcherException);
+}
+
 TEST_CASE("Operator `!~` checks if field doesn't match given regex",
 	"[Matcher]")
 {
@@ -828,3 +881,269 @@ TEST_CASE("string_to_num() returns 0 if there is no numeric prefix",
 	REQUIRE(Matcher::string_to_num("hello") == 0);
 	REQUIRE(Matcher::string_to_num("") == 0);
 }
+
+TEST_CASE("Matcher uses typed attributes if the Matchable provides them",
+	"[Matcher]")
+{
+	TypedMockMatchable mock("abc", 5);
+	Matcher m;
+
+	REQUIRE(m.parse("flags = \"abc\""));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("flags =~ \"^ab\""));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("flags # \"abc\""));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("flags < 1"));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("age = 5"));
+	REQUIRE_THROWS_AS(m.matches(&mock), MatcherException);
+
+	REQUIRE(m.parse("age > 4 and age < 6"));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("age >= 6 or age <= 4"));
+	REQUIRE_FALSE(m.matches(&mock));
+
+	REQUIRE(m.parse("age between 7:3"));
+	REQUIRE(m.matches(&mock));
+
+	REQUIRE(m.parse("age between 7"));
+	REQUIRE_FALSE(m.matches(&mock));
+
+	REQUIRE(m.parse("title = \"abc\""));
+	REQUIRE_THROWS_AS(m.matches(&mock), MatcherException);
+}
+
+TEST_CASE("matching_indices() returns matching items in order, whichever "
+	"the number of threads", "[Matcher]")
+{
+	const size_t count = 10 * WorkerPool::MIN_SHARD_SIZE + 7;
+	std::vector<MatcherMockMatchable> items;
+	for (size_t i = 0; i < count; ++i) {
+		items.push_back(MatcherMockMatchable({
+			{"title", "Item " + std::to_string(i)},
+			{"number", std::to_string(i % 100)},
+		}));
+	}
+	const auto item_at = [&](size_t i) -> Matchable* {
+		// Every tenth item is skipped
+		return (i % 10 == 9) ? nullptr : &items[i];
+	};
+
+	const std::vector<std::string> expressions = {
+		"number < 30",
+		"title =~ \"Item [0-9]*7$\" or number between 50:52",
+		"title # \"nope\"",
+		"title != \"\"",
+	};
+	for (const auto& expr : expressions) {
+		INFO("expression: " << expr);
+		Matcher m(expr);
+
+		std::vector<size_t> expected;
+		for (size_t i = 0; i < count; ++i) {
+			if (m.matches(item_at(i))) {
+				expected.push_back(i);
+			}
+		}
+
+		for (const unsigned int workers : {
+					1u, 2u, 3u, 8u
+				}) {
+			INFO("workers: " << workers);
+			REQUIRE(m.matching_indices(count, item_at, WorkerPool(workers))
+				== expected);
+		}
+	}
+}
+
+TEST_CASE("matching_indices() rethrows matching errors", "[Matcher]")
+{
+	const size_t count = 4 * WorkerPool::MIN_SHARD_SIZE;
+	std::vector<MatcherMockMatchable> items(count);
+	// Only the last item has the attribute, so all others throw
+	items.back() = MatcherMockMatchable({{"title", "Last"}});
+	const auto item_at = [&](size_t i) -> Matchable* {
+		return &items[i];
+	};
+
+	Matcher unavailable("title = \"Last\"");
+	REQUIRE_THROWS_AS(unavailable.matching_indices(count, item_at,
+			WorkerPool(4)), MatcherException);
+
+	Matcher invalid("title =~ \"[[\"");
+	REQUIRE_THROWS_AS(invalid.matching_indices(count, item_at, WorkerPool(4)),
+		MatcherException);
+
+	const auto skip_all = [](size_t) -> Matchable* {
+		return nullptr;
+	};
+	REQUIRE(invalid.matching_indices(count, skip_all, WorkerPool(4)).empty());
+}
+
+TEST_CASE("=~ and !~ give the same results as regexec() for random regexes",
+	"[Matcher]")
+{
+	const std::vector<std::string> pieces = {
+		"a", "b", "c", "A", "B", "-", ".", "*", "+", "?", "{1,2}", "|", "^",
+		"$", "(", ")", "[ab]", "[^a]", "(a|bc)", "[[:upper:]]", "x",
+	};
+	const std::string alphabet = "abcABC-x ";
+
+	std::mt19937 rng(44);
+	std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+	std::uniform_int_distribution<size_t> letter(0, alphabet.size() - 1);
+	std::uniform_int_distribution<size_t> length(0, 8);
+
+	for (unsigned int n = 0; n < 1000; ++n) {
+		std::string pattern;
+		const size_t pattern_length = length(rng);
+		for (size_t i = 0; i < pattern_length; ++i) {
+			pattern += pieces[piece(rng)];
+		}
+		regex_t regex;
+		if (regcomp(&regex, pattern.c_str(),
+				REG_EXTENDED | REG_ICASE | REG_NOSUB) != 0) {
+			continue;
+		}
+
+		Matcher rxeq;
+		Matcher rxne;
+		REQUIRE(rxeq.parse("attr =~ \"" + pattern + "\""));
+		REQUIRE(rxne.parse("attr !~ \"" + pattern + "\""));
+		for (unsigned int t = 0; t < 20; ++t) {
+			std::string text;
+			const size_t text_length = 2 * length(rng);
+			for (size_t i = 0; i < text_length; ++i) {
+				text.push_back(alphabet[letter(rng)]);
+			}
+			MatcherMockMatchable mock({{"attr", text}});
+
+			const bool expected =
+				regexec(&regex, text.c_str(), 0, nullptr, 0) == 0;
+			INFO("pattern: " << pattern << ", text: " << text);
+			REQUIRE(rxeq.matches(&mock) == expected);
+			REQUIRE(rxne.matches(&mock) != expected);
+		}
+		regfree(&regex);
+	}
+}
+
+TEST_CASE("Matching regexes against long contents",
+	"[Matcher][.][benchmark]")
+{
+	std::vector<std::shared_ptr<RssItem>> items;
+	for (unsigned int i = 0; i < 1000; ++i) {
+		std::string content;
+		while (content.size() < 10000) {
+			content += "<p>Lorem ipsum dolor sit amet, consectetur adipiscing "
+				"elit, sed do eiusmod tempor incididunt ut labore.</p>\n";
+		}
+		if (i % 50 == 0) {
+			content += "<p>Fixed in CVE-2021-" + std::to_string(i) +
+				", written in Rust.</p>";
+		}
+		auto item = std::make_shared<RssItem>(nullptr);
+		item->set_title("Release notes " + std::to_string(i));
+		item->set_description(content);
+		items.push_back(item);
+	}
+
+	const auto run = [&](const std::string& expr) {
+		Matcher m(expr);
+		unsigned int matched = 0;
+		for (const auto& item : items) {
+			matched += m.matches(item.get());
+		}
+		return matched;
+	};
+
+	for (const std::string expr : {
+				"content =~ \"rust\"",
+				"content =~ \"CVE-[0-9]+\"",
+				"content =~ \"written in (rust|go)\"",
+				"content !~ \"^<p>Lorem\" or content =~ \"fixed.*rust\"",
+			}) {
+		BENCHMARK("Filter " + expr) {
+			return run(expr);
+		};
+	}
+}
+
+TEST_CASE("Matching 1M items", "[Matcher][.][benchmark]")
+{
+	const unsigned int distinct_items = 1000;
+	const unsigned int passes = 1000;
+
+	std::vector<std::shared_ptr<RssItem>> items;
+	for (unsigned int i = 0; i < distinct_items; ++i) {
+		auto item = std::make_shared<RssItem>(nullptr);
+		item->set_title("Item number " + std::to_string(i));
+		item->set_link("http://example.com/" + std::to_string(i));
+		item->set_author("Some One");
+		item->set_description("Description of item " + std::to_string(i));
+		item->set_unread_nowrite(i % 3 == 0);
+		item->set_flags(i % 7 == 0 ? "s" : "");
+		item->set_pubDate(::time(nullptr) - (i % 30) * 86400);
+		item->set_index(i);
+		items.push_back(item);
+	}
+
+	const auto run = [&](const std::string& expr) {
+		Matcher m(expr);
+		unsigned int matched = 0;
+		for (unsigned int pass = 0; pass < passes; ++pass) {
+			for (const auto& item : items) {
+				matched += m.matches(item.get());
+			}
+		}
+		return matched;
+	};
+
+	BENCHMARK("unread = \"yes\" and age between 0:7") {
+		return run("unread = \"yes\" and age between 0:7");
+	};
+
+	BENCHMARK("flags # \"s\" or articleindex > 900") {
+		return run("flags # \"s\" or articleindex > 900");
+	};
+
+	BENCHMARK("title =~ \"number 1\" and link =~ \"example\"") {
+		return run("title =~ \"number 1\" and link =~ \"example\"");
+	};
+
+	std::vector<RssItem*> all_items;
+	for (unsigned int pass = 0; pass < passes; ++pass) {
+		for (const auto& item : items) {
+			all_items.push_back(item.get());
+		}
+	}
+	const auto run_sharded = [&](const std::string& expr,
+	unsigned int workers) {
+		Matcher m(expr);
+		return m.matching_indices(all_items.size(), [&](size_t i) {
+			return all_items[i];
+		}, WorkerPool(workers)).size();
+	};
+
+	for (const unsigned int workers : {
+				1u, 2u, 4u, 8u
+			}) {
+		BENCHMARK("unread = \"yes\" and age between 0:7, " +
+			std::to_string(workers) + " threads") {
+			return run_sharded("unread = \"yes\" and age between 0:7",
+					workers);
+		};
+
+		BENCHMARK("title =~ \"number 1\" and link =~ \"example\", " +
+			std::to_string(workers) + " threads") {
+			return run_sharded("title =~ \"number 1\" and link =~ \"example\"",
+					workers);
+		};
+	}
+}
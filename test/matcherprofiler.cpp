@@ -0,0 +1,152 @@
+#include "matcherprofiler.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+
+#include "cache.h"
+#include "configcontainer.h"
+#include "matcher.h"
+#include "rssitem.h"
+#include "workerpool.h"
+
+using namespace newsboat;
+
+namespace {
+
+/// Returns the profile of \a expression, or one without any evaluations
+/// if there is none.
+ExpressionProfile find_profile(const std::string& expression)
+{
+	for (const auto& profile : MatcherProfiler::get_instance().get_profiles()) {
+		if (profile.expression == expression) {
+			return profile;
+		}
+	}
+	return ExpressionProfile();
+}
+
+std::shared_ptr<RssItem> make_item(const std::string& title, Cache* cache)
+{
+	auto item = std::make_shared<RssItem>(cache);
+	item->set_title(title);
+	item->set_unread_nowrite(true);
+	return item;
+}
+
+} // namespace
+
+TEST_CASE("Matcher::matches() adds to the profile of its expression",
+	"[MatcherProfiler]")
+{
+	const std::string expr = "title = \"profiled\" and unread = \"yes\"";
+	REQUIRE(find_profile(expr).evaluations == 0);
+
+	const auto hit = make_item("profiled", nullptr);
+	const auto miss = make_item("other", nullptr);
+
+	Matcher m(expr);
+	REQUIRE(m.matches(hit.get()));
+	REQUIRE_FALSE(m.matches(miss.get()));
+	REQUIRE_FALSE(m.matches(nullptr));
+
+	auto profile = find_profile(expr);
+	REQUIRE(profile.evaluations == 2);
+	REQUIRE(profile.matches == 1);
+	REQUIRE(profile.description_fetches == 0);
+	REQUIRE(profile.time >= 0);
+	REQUIRE(profile.attributes ==
+		std::vector<std::string>({"title", "unread"}));
+
+	// Matchers of the same expression share a profile
+	const Matcher other(expr);
+	REQUIRE(other.matches(hit.get()));
+	profile = find_profile(expr);
+	REQUIRE(profile.evaluations == 3);
+	REQUIRE(profile.matches == 2);
+}
+
+TEST_CASE("Matcher::matching_indices() adds up all shards",
+	"[MatcherProfiler]")
+{
+	const std::string expr = "title =~ \"^sharded [0-9]*7$\"";
+
+	std::vector<std::shared_ptr<RssItem>> items;
+	for (unsigned int i = 0; i < 10000; ++i) {
+		items.push_back(make_item("sharded " + std::to_string(i), nullptr));
+	}
+
+	const Matcher m(expr);
+	const auto indices = m.matching_indices(items.size(),
+	[&](size_t i) -> Matchable* {
+		// Items that are skipped aren't evaluated
+		return i % 2 == 0 ? nullptr : items[i].get();
+	}, WorkerPool(4));
+	REQUIRE(indices.size() == 1000);
+
+	const auto profile = find_profile(expr);
+	REQUIRE(profile.evaluations == 5000);
+	REQUIRE(profile.matches == 1000);
+	REQUIRE(profile.attributes == std::vector<std::string>({"title"}));
+}
+
+TEST_CASE("Fetching descriptions from the cache is counted",
+	"[MatcherProfiler]")
+{
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+
+	const std::string expr = "content =~ \"profiled content\"";
+	const auto item = make_item("title", &rsscache);
+	item->set_description("Some profiled content");
+
+	const Matcher m(expr);
+	REQUIRE(m.matches(item.get()));
+	REQUIRE(find_profile(expr).description_fetches == 0);
+
+	item->unload();
+	m.matches(item.get());
+	m.matches(item.get());
+	const auto profile = find_profile(expr);
+	REQUIRE(profile.evaluations == 3);
+	REQUIRE(profile.description_fetches == 2);
+}
+
+TEST_CASE("Matcher::add_to_profile() records matching done elsewhere",
+	"[MatcherProfiler]")
+{
+	const std::string expr = "content # \"elsewhere\"";
+	const Matcher m(expr);
+	m.add_to_profile(100, 7, std::chrono::milliseconds(250));
+	m.add_to_profile(50, 3, std::chrono::milliseconds(250), 4);
+
+	const auto profile = find_profile(expr);
+	REQUIRE(profile.evaluations == 150);
+	REQUIRE(profile.matches == 10);
+	REQUIRE(profile.time == Approx(500));
+	REQUIRE(profile.description_fetches == 4);
+}
+
+TEST_CASE("MatcherProfiler::get_profiles() lists the most expensive "
+	"expressions first", "[MatcherProfiler]")
+{
+	const Matcher cheap("feedtitle = \"cheap\"");
+	const Matcher expensive("feedtitle = \"expensive\"");
+	const Matcher unused("feedtitle = \"unused\"");
+	cheap.add_to_profile(1, 0, std::chrono::hours(1000));
+	expensive.add_to_profile(1, 0, std::chrono::hours(2000));
+
+	const auto profiles = MatcherProfiler::get_instance().get_profiles();
+	REQUIRE(profiles.size() >= 2);
+	REQUIRE(profiles[0].expression == "feedtitle = \"expensive\"");
+	REQUIRE(profiles[1].expression == "feedtitle = \"cheap\"");
+	for (size_t i = 1; i < profiles.size(); ++i) {
+		REQUIRE(profiles[i - 1].time >= profiles[i].time);
+	}
+
+	// Expressions that were never evaluated aren't listed
+	REQUIRE(find_profile("feedtitle = \"unused\"").expression.empty());
+}
@@ -4,6 +4,8 @@
 
 #include "confighandlerexception.h"
 #include "matchable.h"
+#include "rssfeed.h"
+#include "rssitem.h"
 
 using namespace newsboat;
 
@@ -474,6 +476,47 @@ TEST_CASE("RegexManager::article_matches returns -1 if there are no Matcher "
 	}
 }
 
+TEST_CASE("RegexManager::article_matches remembers results for an RssItem "
+	"until the item or the rules change",
+	"[RegexManager]")
+{
+	RegexManager rxman;
+	RssItem item(nullptr);
+	item.set_title("Hello");
+	item.set_unread_nowrite(true);
+
+	const auto cmd = std::string("highlight-article");
+	rxman.handle_action(cmd, {"title = \"Hello\" and unread = \"no\"", "red",
+		"green"
+	});
+	REQUIRE(rxman.article_matches(&item) == -1);
+	REQUIRE(rxman.article_matches(&item) == -1);
+
+	item.set_unread_nowrite(false);
+	REQUIRE(rxman.article_matches(&item) == 0);
+
+	item.set_title("Goodbye");
+	REQUIRE(rxman.article_matches(&item) == -1);
+
+	rxman.handle_action(cmd, {"title =~ \"bye\"", "red", "green"});
+	REQUIRE(rxman.article_matches(&item) == 1);
+
+	SECTION("Rules that read attributes of the feed are evaluated every time") {
+		auto feed = std::make_shared<RssFeed>(nullptr);
+		feed->set_title("Old");
+		item.set_feedptr(feed);
+		rxman.handle_action(cmd, {"feedtitle = \"New\"", "red", "green"});
+		item.set_title("Hello");
+		REQUIRE(rxman.article_matches(&item) == 0);
+
+		item.set_unread_nowrite(true);
+		REQUIRE(rxman.article_matches(&item) == -1);
+
+		feed->set_title("New");
+		REQUIRE(rxman.article_matches(&item) == 2);
+	}
+}
+
 TEST_CASE("RegexManager::remove_last_regex removes last added `highlight` rule",
 	"[RegexManager]")
 {
@@ -975,3 +1018,44 @@ TEST_CASE("merge_style_tag() does not crash on invalid input",
 		REQUIRE(tags.size() == 0);
 	}
 }
+
+TEST_CASE("quote_and_highlight() with 50 rules over a large article",
+	"[RegexManager][.][benchmark]")
+{
+	RegexManager rxman;
+	for (unsigned int i = 0; i < 40; ++i) {
+		const std::string pattern = "release-" + std::to_string(i) + "\\b";
+		rxman.handle_action("highlight", {"article", pattern, "red"});
+	}
+	for (const auto& pattern : {
+			"https?://[^ ]+", "[0-9]{4}-[0-9]{2}-[0-9]{2}", "^>.*",
+			"\\*\\*[^*]+\\*\\*", "CVE-[0-9]+-[0-9]+", "TODO", "FIXME",
+			"v[0-9]+\\.[0-9]+", "@[a-z]+", "#[0-9]+"
+		}) {
+		rxman.handle_action("highlight", {"article", pattern, "red"});
+	}
+
+	std::vector<std::string> lines;
+	for (unsigned int i = 0; i < 5000; ++i) {
+		std::string line = "Lorem ipsum dolor sit amet, consectetur adipiscing "
+			"elit, sed do eiusmod tempor incididunt ut labore et dolore";
+		if (i % 10 == 0) {
+			line += " see release-" + std::to_string(i % 50) + " at "
+				"https://example.com/" + std::to_string(i);
+		}
+		if (i % 25 == 0) {
+			line = "> " + line + " TODO";
+		}
+		lines.push_back(line);
+	}
+
+	BENCHMARK("Highlighting 5000 lines") {
+		size_t length = 0;
+		for (const auto& line : lines) {
+			std::string text = line;
+			rxman.quote_and_highlight(text, "article");
+			length += text.length();
+		}
+		return length;
+	};
+}
@@ -0,0 +1,23 @@
+#include "reloader.h"
+
+#include "3rd-party/catch.hpp"
+#include "cache.h"
+#include "configcontainer.h"
+#include "configpaths.h"
+#include "controller.h"
+
+using namespace newsboat;
+
+TEST_CASE("start_reload_all_thread() returns false if another reload is "
+	"in progress", "[Reloader]")
+{
+	ConfigPaths paths;
+	Controller c(paths);
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+	Reloader reloader(&c, &rsscache, &cfg);
+
+	REQUIRE(reloader.trylock_reload_mutex());
+	REQUIRE_FALSE(reloader.start_reload_all_thread());
+	reloader.unlock_reload_mutex();
+}
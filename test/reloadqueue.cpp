@@ -0,0 +1,104 @@
+#include "reloadqueue.h"
+
+#include "3rd-party/catch.hpp"
+
+using namespace newsboat;
+
+TEST_CASE("pop() returns feeds in order of priority, then in order they "
+	"were queued",
+	"[ReloadQueue]")
+{
+	ReloadQueue queue;
+	queue.reset({
+		{0, ReloadPriority::OTHER},
+		{1, ReloadPriority::RECENT_ACTIVITY},
+		{2, ReloadPriority::OTHER},
+		{3, ReloadPriority::RECENT_ACTIVITY},
+	});
+	REQUIRE(queue.size() == 4);
+
+	REQUIRE(queue.pop() == 1u);
+	REQUIRE(queue.pop() == 3u);
+	REQUIRE(queue.pop() == 0u);
+	REQUIRE(queue.pop() == 2u);
+	REQUIRE_FALSE(queue.pop());
+	REQUIRE(queue.size() == 0);
+}
+
+TEST_CASE("set_boosted() moves feeds ahead, and back when they're no longer "
+	"boosted",
+	"[ReloadQueue]")
+{
+	ReloadQueue queue;
+	queue.reset({
+		{0, ReloadPriority::OTHER},
+		{1, ReloadPriority::RECENT_ACTIVITY},
+		{2, ReloadPriority::OTHER},
+		{3, ReloadPriority::OTHER},
+	});
+
+	queue.set_boosted(ReloadPriority::VISIBLE, {2, 3});
+	queue.set_boosted(ReloadPriority::OPEN_FEED, {3});
+	REQUIRE(queue.pop() == 3u);
+
+	SECTION("boosted feeds go first") {
+		REQUIRE(queue.pop() == 2u);
+		REQUIRE(queue.pop() == 1u);
+		REQUIRE(queue.pop() == 0u);
+	}
+
+	SECTION("feeds fall back to their base priority") {
+		queue.set_boosted(ReloadPriority::VISIBLE, {0});
+		REQUIRE(queue.pop() == 0u);
+		REQUIRE(queue.pop() == 1u);
+		REQUIRE(queue.pop() == 2u);
+	}
+
+	SECTION("boosts survive reset()") {
+		queue.reset({
+			{0, ReloadPriority::OTHER},
+			{2, ReloadPriority::RECENT_ACTIVITY},
+			{3, ReloadPriority::OTHER},
+		});
+		REQUIRE(queue.pop() == 3u);
+		REQUIRE(queue.pop() == 2u);
+		REQUIRE(queue.pop() == 0u);
+	}
+}
+
+TEST_CASE("remove() takes a feed out of the queue", "[ReloadQueue]")
+{
+	ReloadQueue queue;
+	queue.reset({
+		{0, ReloadPriority::OTHER},
+		{1, ReloadPriority::OTHER},
+	});
+
+	REQUIRE(queue.remove(0));
+	REQUIRE_FALSE(queue.remove(0));
+	REQUIRE_FALSE(queue.remove(42));
+	REQUIRE(queue.pop() == 1u);
+	REQUIRE_FALSE(queue.pop());
+}
+
+TEST_CASE("cancel() drops all queued feeds until the next reset()",
+	"[ReloadQueue]")
+{
+	ReloadQueue queue;
+	queue.reset({
+		{0, ReloadPriority::OTHER},
+		{1, ReloadPriority::OTHER},
+		{2, ReloadPriority::RECENT_ACTIVITY},
+	});
+	REQUIRE(queue.pop() == 2u);
+	REQUIRE_FALSE(queue.cancelled());
+
+	const auto dropped = queue.cancel();
+	REQUIRE(dropped == std::vector<unsigned int>({0, 1}));
+	REQUIRE(queue.cancelled());
+	REQUIRE_FALSE(queue.pop());
+
+	queue.reset({{5, ReloadPriority::OTHER}});
+	REQUIRE_FALSE(queue.cancelled());
+	REQUIRE(queue.pop() == 5u);
+}
@@ -1,5 +1,13 @@
 #include "rssfeed.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <vector>
+
 #include "3rd-party/catch.hpp"
 #include "cache.h"
 #include "configcontainer.h"
@@ -7,9 +15,63 @@
 
 #include "test-helpers/envvar.h"
 #include "test-helpers/stringmaker/optional.h"
+#include "test-helpers/tempfile.h"
 
 using namespace newsboat;
 
+namespace {
+
+std::atomic<unsigned long> allocation_count(0);
+
+/// Creates a feed with \a item_count items; every third one is unread.
+std::shared_ptr<RssFeed> make_feed(const std::string& url,
+	unsigned int item_count, time_t newest)
+{
+	auto feed = std::make_shared<RssFeed>(nullptr);
+	feed->set_rssurl(url);
+	for (unsigned int i = 0; i < item_count; ++i) {
+		auto item = std::make_shared<RssItem>(nullptr);
+		item->set_feedurl(url);
+		item->set_guid(url + "#" + std::to_string(i));
+		item->set_title("Item " + std::to_string(i));
+		item->set_pubDate(newest - i);
+		item->set_unread_nowrite(i % 3 == 0);
+		feed->add_item(item);
+	}
+	feed->set_feedptrs(feed);
+	return feed;
+}
+
+std::shared_ptr<RssFeed> make_query_feed(const std::string& query)
+{
+	auto feed = std::make_shared<RssFeed>(nullptr);
+	feed->set_rssurl("query:Query feed:" + query);
+	return feed;
+}
+
+} // namespace
+
+// Counts allocations for the "allocations per item" benchmark below
+void* operator new(std::size_t size)
+{
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	void* p = std::malloc(size ? size : 1);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
 TEST_CASE("RssFeed::set_rssurl() checks if query feed has a valid query",
 	"[RssFeed]")
 {
@@ -31,6 +93,31 @@ TEST_CASE("RssFeed::set_rssurl() checks if query feed has a valid query",
 	}
 }
 
+TEST_CASE("RssFeed::version() changes whenever an attribute shown in the "
+	"feed list does", "[RssFeed]")
+{
+	RssFeed feed(nullptr);
+	RssFeed other(nullptr);
+	REQUIRE(feed.version() != other.version());
+
+	const std::vector<std::function<void()>> changes = {
+		[&]() { feed.set_title("title"); },
+		[&]() { feed.set_description("description"); },
+		[&]() { feed.set_link("http://example.com"); },
+		[&]() { feed.set_rssurl("http://example.com/feed.xml"); },
+		[&]() { feed.set_tags({"tag"}); },
+		[&]() { feed.set_status(DlStatus::DURING_DOWNLOAD); },
+		[&]() { feed.reset_status(); },
+	};
+	for (size_t i = 0; i < changes.size(); ++i) {
+		INFO("change #" << i);
+		const auto before = feed.version();
+		changes[i]();
+		REQUIRE(feed.version() != before);
+		REQUIRE(feed.version() != other.version());
+	}
+}
+
 TEST_CASE("RssFeed::sort() correctly sorts articles", "[RssFeed]")
 {
 	ConfigContainer cfg;
@@ -240,6 +327,97 @@ TEST_CASE("RssFeed::unread_item_count() returns number of unread articles",
 	REQUIRE(f.unread_item_count() == 0);
 }
 
+TEST_CASE("RssFeed::unread_item_count() follows items as they are added, "
+	"removed, and marked read or unread", "[RssFeed]")
+{
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+	RssFeed f(&rsscache);
+
+	std::vector<std::shared_ptr<RssItem>> items;
+	for (int i = 0; i < 6; ++i) {
+		const auto item = std::make_shared<RssItem>(&rsscache);
+		item->set_guid(std::to_string(i));
+		item->set_unread_nowrite(i % 2 == 0);
+		items.push_back(item);
+	}
+
+	f.add_item(items[0]);
+	f.add_item(items[1]);
+	REQUIRE(f.unread_item_count() == 1);
+
+	f.add_items({items[2], items[3], items[4], items[5]});
+	REQUIRE(f.unread_item_count() == 3);
+
+	SECTION("Marking items read or unread") {
+		items[1]->set_unread_nowrite(true);
+		REQUIRE(f.unread_item_count() == 4);
+
+		// Items that don't change don't count twice
+		items[1]->set_unread_nowrite(true);
+		REQUIRE(f.unread_item_count() == 4);
+
+		items[0]->set_unread_nowrite_notify(false, true);
+		REQUIRE(f.unread_item_count() == 3);
+
+		items[3]->set_unread(true);
+		REQUIRE(f.unread_item_count() == 4);
+
+		f.mark_all_items_read();
+		REQUIRE(f.unread_item_count() == 0);
+	}
+
+	SECTION("Removing items") {
+		f.erase_item(f.items().begin());
+		REQUIRE(f.unread_item_count() == 2);
+
+		f.erase_items(f.items().begin(), f.items().begin() + 2);
+		REQUIRE(f.unread_item_count() == 1);
+
+		// Removed items aren't counted anymore
+		items[0]->set_unread_nowrite(true);
+		items[1]->set_unread_nowrite(true);
+		REQUIRE(f.unread_item_count() == 1);
+	}
+
+	SECTION("Replacing items") {
+		std::vector<std::shared_ptr<RssItem>> unread = {items[0], items[2]};
+		f.set_items(unread);
+		REQUIRE(f.unread_item_count() == 2);
+	}
+
+	SECTION("Purging deleted items") {
+		items[0]->set_deleted(true);
+		items[1]->set_deleted(true);
+		f.purge_deleted_items();
+		REQUIRE(f.total_item_count() == 4);
+		REQUIRE(f.unread_item_count() == 2);
+	}
+
+	SECTION("Items shared with a query feed are counted by both feeds") {
+		const auto feed = std::make_shared<RssFeed>(&rsscache);
+		feed->set_rssurl("https://example.com/feed.xml");
+		feed->add_items(items);
+
+		RssFeed query(&rsscache);
+		query.set_rssurl("query:Even:guid =~ \"[024]\"");
+		query.update_items({feed});
+		REQUIRE(query.total_item_count() == 3);
+		REQUIRE(query.unread_item_count() == 3);
+
+		items[2]->set_unread_nowrite(false);
+		REQUIRE(query.unread_item_count() == 2);
+		REQUIRE(feed->unread_item_count() == 2);
+		REQUIRE(f.unread_item_count() == 2);
+
+		query.update_items({});
+		REQUIRE(query.unread_item_count() == 0);
+		items[0]->set_unread_nowrite(false);
+		REQUIRE(query.unread_item_count() == 0);
+		REQUIRE(feed->unread_item_count() == 1);
+	}
+}
+
 TEST_CASE("RssFeed::matches_tag() returns true if article has a specified tag",
 	"[RssFeed]")
 {
@@ -586,3 +764,187 @@ TEST_CASE("RssFeed contains a number of matchable attributes", "[RssFeed]")
 		check(100500);
 	}
 }
+
+TEST_CASE("RssParser::parse() allocations per item on a large feed",
+	"[RssParser][.][benchmark]")
+{
+	const unsigned int item_count = 5000;
+
+	TestHelpers::TempFile feed_file;
+	{
+		std::ofstream out(feed_file.get_path());
+		out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+			"<rss version=\"2.0\" "
+			"xmlns:content=\"http://purl.org/rss/1.0/modules/content/\">"
+			"<channel><title>Large feed</title>"
+			"<link>http://example.com/</link>\n";
+		const std::string content(2000, 'x');
+		const std::string summary(200, 'y');
+		for (unsigned int i = 0; i < item_count; ++i) {
+			const auto n = std::to_string(i);
+			out << "<item><title>Item " << n << "</title>"
+				"<link>http://example.com/" << n << "</link>"
+				"<guid>http://example.com/" << n << "</guid>"
+				"<author>someone@example.com (Some One)</author>"
+				"<pubDate>Sun, 01 Nov 2020 10:00:00 +0000</pubDate>"
+				"<description>" << summary << "</description>"
+				"<content:encoded><![CDATA[<p>" << content <<
+				"</p>]]></content:encoded>"
+				"<enclosure url=\"http://example.com/" << n << ".mp3\" "
+				"type=\"audio/mpeg\" length=\"1\"/></item>\n";
+		}
+		out << "</channel></rss>\n";
+	}
+
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+	const std::string url = "file://" + feed_file.get_path();
+
+	{
+		RssParser p(url, &rsscache, &cfg, nullptr, nullptr);
+		const auto before = allocation_count.load();
+		const auto feed = p.parse();
+		const auto allocations = allocation_count.load() - before;
+		REQUIRE(feed->items().size() == item_count);
+		WARN("RssParser::parse(): " << double(allocations) / item_count
+			<< " allocations per item");
+	}
+
+	BENCHMARK("RssParser::parse() of " + std::to_string(item_count) +
+		" items") {
+		RssParser p(url, &rsscache, &cfg, nullptr, nullptr);
+		return p.parse();
+	};
+}
+
+TEST_CASE("RssFeed::update_items() can update a query feed incrementally",
+	"[RssFeed]")
+{
+	ArticleSortStrategy sort_strategy;
+	sort_strategy.sm = ArtSortMethod::DATE;
+	sort_strategy.sd = SortDirection::DESC;
+
+	std::vector<std::shared_ptr<RssFeed>> feeds = {
+		make_feed("http://example.com/a", 30, 1000000),
+		make_feed("http://example.com/b", 30, 1000050),
+		make_feed("http://example.com/c", 30, 1000100),
+	};
+
+	auto query_feed = make_query_feed("unread = \"yes\"");
+	REQUIRE_FALSE(query_feed->is_query_populated());
+	query_feed->update_items(feeds);
+	query_feed->sort(sort_strategy);
+	REQUIRE(query_feed->is_query_populated());
+	REQUIRE(query_feed->total_item_count() == 30);
+
+	// A reload of "b" retires some items, adds new ones, and brings back
+	// some of the old ones with a different read state
+	auto reloaded = make_feed("http://example.com/b", 40, 1000070);
+	reloaded->items()[25]->set_unread_nowrite(true);
+	reloaded->items()[27]->set_unread_nowrite(false);
+	feeds[1] = reloaded;
+
+	query_feed->update_items(feeds, {reloaded}, sort_strategy);
+
+	auto expected = make_query_feed("unread = \"yes\"");
+	expected->update_items(feeds);
+	expected->sort(sort_strategy);
+
+	REQUIRE(query_feed->items() == expected->items());
+	for (const auto& item : query_feed->items()) {
+		REQUIRE(query_feed->get_item_by_guid(item->guid()) == item);
+	}
+
+	SECTION("Items of other feeds that changed since are matched again") {
+		feeds[0]->items()[0]->set_unread_nowrite(false);
+		feeds[0]->items()[1]->set_unread_nowrite(false);
+		feeds[0]->items()[1]->set_unread_nowrite(true);
+		feeds[2]->items()[3]->set_deleted(true);
+		feeds[2]->items()[4]->set_unread_nowrite(true);
+		query_feed->update_items(feeds, {}, sort_strategy);
+
+		expected->update_items(feeds);
+		expected->sort(sort_strategy);
+		REQUIRE(query_feed->items() == expected->items());
+		REQUIRE(query_feed->unread_item_count() == expected->unread_item_count());
+		for (const auto& item : query_feed->items()) {
+			REQUIRE(query_feed->get_item_by_guid(item->guid()) == item);
+		}
+	}
+
+	SECTION("Items that didn't change aren't matched again") {
+		const auto item = feeds[0]->items()[0];
+		item->set_unread_nowrite(false);
+		query_feed->update_items(feeds, {}, sort_strategy);
+		auto& items = query_feed->items();
+		REQUIRE(std::find(items.begin(), items.end(), item) == items.end());
+
+		// Bypasses the query, so only a full update would drop it again
+		items.push_back(item);
+		query_feed->update_items(feeds, {}, sort_strategy);
+		const auto it = std::find(items.begin(), items.end(), item);
+		REQUIRE(it != items.end());
+		items.erase(it);
+	}
+
+	SECTION("Queries whose results change over time need a full update") {
+		REQUIRE(query_feed->can_update_incrementally());
+		REQUIRE_FALSE(make_query_feed("age < 7")->can_update_incrementally());
+		REQUIRE_FALSE(make_query_feed("unread = \"yes\" and "
+				"feedtitle = \"a\"")->can_update_incrementally());
+	}
+
+	SECTION("Changing the query requires a full update") {
+		query_feed->set_query("unread = \"no\"");
+		REQUIRE_FALSE(query_feed->is_query_populated());
+	}
+}
+
+TEST_CASE("Updating query feeds after a reload", "[RssFeed][.][benchmark]")
+{
+	const unsigned int feed_count = 200;
+	const unsigned int items_per_feed = 500;
+	const unsigned int query_feed_count = 40;
+	const unsigned int reloaded_feeds = 10;
+
+	ArticleSortStrategy sort_strategy;
+	sort_strategy.sm = ArtSortMethod::DATE;
+	sort_strategy.sd = SortDirection::DESC;
+
+	std::vector<std::shared_ptr<RssFeed>> feeds;
+	for (unsigned int i = 0; i < feed_count; ++i) {
+		feeds.push_back(make_feed("http://example.com/" + std::to_string(i),
+				items_per_feed, 1000000 + i * items_per_feed));
+	}
+
+	std::vector<std::shared_ptr<RssFeed>> query_feeds;
+	for (unsigned int i = 0; i < query_feed_count; ++i) {
+		query_feeds.push_back(make_query_feed("unread = \"yes\" and "
+				"title =~ \"" + std::to_string(i % 10) + "$\""));
+		query_feeds.back()->update_items(feeds);
+		query_feeds.back()->sort(sort_strategy);
+	}
+
+	std::vector<std::shared_ptr<RssFeed>> replaced;
+	for (unsigned int i = 0; i < reloaded_feeds; ++i) {
+		replaced.push_back(make_feed(feeds[i]->rssurl(), items_per_feed,
+				2000000 + i * items_per_feed));
+		feeds[i] = replaced.back();
+	}
+
+	BENCHMARK("Rebuilding " + std::to_string(query_feed_count) +
+		" query feeds over " + std::to_string(feed_count * items_per_feed) +
+		" items") {
+		for (const auto& query_feed : query_feeds) {
+			query_feed->update_items(feeds);
+			query_feed->sort(sort_strategy);
+		}
+	};
+
+	BENCHMARK("Updating them after " + std::to_string(reloaded_feeds) +
+		" feeds were reloaded") {
+		for (const auto& query_feed : query_feeds) {
+			query_feed->update_items(feeds, replaced, sort_strategy);
+		}
+	};
+}
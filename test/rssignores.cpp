@@ -4,7 +4,9 @@
 
 #include "cache.h"
 #include "confighandlerexception.h"
+#include "matcherexception.h"
 #include "rssitem.h"
+#include "workerpool.h"
 
 using namespace newsboat;
 
@@ -44,6 +46,22 @@ TEST_CASE(
 	REQUIRE_FALSE(ignores.matches_resetunread("www.smth.com"));
 }
 
+TEST_CASE(
+	"RssIgnores::matches_stopatknown() returns true if given url "
+	"may stop parsing at known articles",
+	"[RssIgnores]")
+{
+	RssIgnores ignores;
+	ignores.handle_action("stop-at-known-articles", {
+		"http://newsboat.org",
+		"www.example.com"
+	});
+
+	REQUIRE(ignores.matches_stopatknown("www.example.com"));
+	REQUIRE(ignores.matches_stopatknown("http://newsboat.org"));
+	REQUIRE_FALSE(ignores.matches_stopatknown("www.smth.com"));
+}
+
 TEST_CASE("RssIgnores::handle_action() handles `ignore-article`",
 	"[RssIgnores]")
 {
@@ -104,6 +122,24 @@ TEST_CASE("RssIgnores::handle_action() handles `reset-unread-on-update`",
 	}
 }
 
+TEST_CASE("RssIgnores::handle_action() handles `stop-at-known-articles`",
+	"[RssIgnores]")
+{
+	RssIgnores ignores;
+
+	const std::string action = "stop-at-known-articles";
+
+	SECTION("Throws ConfigHandlerException if given zero parameters") {
+		REQUIRE_THROWS_AS(ignores.handle_action(action, {}), ConfigHandlerException);
+	}
+
+	SECTION("Doesn't throw if given one or more parameters") {
+		REQUIRE_NOTHROW(ignores.handle_action(action, {"url1"}));
+		REQUIRE_NOTHROW(ignores.handle_action(action, {"url1", "url2"}));
+		REQUIRE_NOTHROW(ignores.handle_action(action, {"url1", "url2", "url3", "url4", "url5"}));
+	}
+}
+
 TEST_CASE("RssIgnores::handle_action() throws ConfigHandlerException "
 	"on unknown command",
 	"[RssIgnores]")
@@ -189,6 +225,27 @@ TEST_CASE("RssIgnores::dump_config() writes out all configured settings "
 		REQUIRE(config[4] == R"#(reset-unread-on-update "url4")#");
 	}
 
+	SECTION("`stop-at-known-articles`") {
+		const std::string action = "stop-at-known-articles";
+
+		ignores.handle_action(action, {"url1"});
+		ignores.handle_action(action, {"url2", "url3", "url4"});
+
+		std::vector<std::string> config;
+		const auto comment =
+			"# Comment to check that RssIgnores::dump_config() doesn't clear the vector";
+		config.push_back(comment);
+
+		ignores.dump_config(config);
+
+		REQUIRE(config.size() == 5); // four URLs plus one comment
+		REQUIRE(config[0] == comment);
+		REQUIRE(config[1] == R"#(stop-at-known-articles "url1")#");
+		REQUIRE(config[2] == R"#(stop-at-known-articles "url2")#");
+		REQUIRE(config[3] == R"#(stop-at-known-articles "url3")#");
+		REQUIRE(config[4] == R"#(stop-at-known-articles "url4")#");
+	}
+
 	SECTION("Mix of all supported commands") {
 		ignores.handle_action("reset-unread-on-update", {"url1"});
 		ignores.handle_action("ignore-article", {"*", "title # \"interesting\""});
@@ -196,6 +253,7 @@ TEST_CASE("RssIgnores::dump_config() writes out all configured settings "
 		ignores.handle_action("ignore-article", {"https://blog.example.com/joe/posts.xml", "guid # 123"});
 		ignores.handle_action("reset-unread-on-update", {"url2", "url3"});
 		ignores.handle_action("always-download", {"url2", "url3", "url4"});
+		ignores.handle_action("stop-at-known-articles", {"url5"});
 
 		std::vector<std::string> config;
 		const auto comment =
@@ -204,7 +262,7 @@ TEST_CASE("RssIgnores::dump_config() writes out all configured settings "
 
 		ignores.dump_config(config);
 
-		REQUIRE(config.size() == 10);
+		REQUIRE(config.size() == 11);
 		REQUIRE(config[0] == comment);
 		REQUIRE(config[1] == R"#(ignore-article * "title # \"interesting\"")#");
 		REQUIRE(config[2] ==
@@ -216,6 +274,7 @@ TEST_CASE("RssIgnores::dump_config() writes out all configured settings "
 		REQUIRE(config[7] == R"#(reset-unread-on-update "url1")#");
 		REQUIRE(config[8] == R"#(reset-unread-on-update "url2")#");
 		REQUIRE(config[9] == R"#(reset-unread-on-update "url3")#");
+		REQUIRE(config[10] == R"#(stop-at-known-articles "url5")#");
 	}
 }
 
@@ -268,3 +327,108 @@ TEST_CASE("RssIgnores::matches() returns true if given RssItem matches any "
 		REQUIRE(ignores.matches(&item));
 	}
 }
+
+TEST_CASE("RssIgnores::matching_indices() agrees with RssIgnores::matches()",
+	"[RssIgnores]")
+{
+	RssIgnores ignores;
+	ignores.handle_action("ignore-article", {"*", "title =~ \"7$\""});
+	ignores.handle_action("ignore-article", {"https://example.com/feed.xml", "author = \"Spammer\""});
+	ignores.handle_action("ignore-article", {"*", "title =~ \"[[\""});
+
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+
+	std::vector<std::shared_ptr<RssItem>> items;
+	for (size_t i = 0; i < 3 * WorkerPool::MIN_SHARD_SIZE; ++i) {
+		auto item = std::make_shared<RssItem>(&rsscache);
+		item->set_title("Item " + std::to_string(i));
+		item->set_author(i % 5 == 0 ? "Spammer" : "John Doe");
+		item->set_feedurl(i % 2 == 0
+			? "https://example.com/feed.xml"
+			: "https://example.org/feed.xml");
+		items.push_back(item);
+	}
+
+	// The invalid regex ignores nothing, but the other rules still apply
+	const auto ignored = ignores.matching_indices(items);
+	std::vector<size_t> expected;
+	for (size_t i = 0; i < items.size(); ++i) {
+		const bool spam = (i % 5 == 0 && i % 2 == 0);
+		if (spam || i % 10 == 7) {
+			expected.push_back(i);
+		}
+	}
+	REQUIRE(ignored == expected);
+}
+
+TEST_CASE("RssIgnores applies wildcard and per-feed rules in the order they "
+	"were configured", "[RssIgnores]")
+{
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+	RssItem item(&rsscache);
+	item.set_title("Updates");
+	item.set_feedurl("https://example.com/feed.xml");
+
+	SECTION("A matching rule stops the search") {
+		RssIgnores ignores;
+		ignores.handle_action("ignore-article", {"*", "title = \"Updates\""});
+		ignores.handle_action("ignore-article", {"https://example.com/feed.xml", "title =~ \"[[\""});
+
+		REQUIRE(ignores.matches(&item));
+	}
+
+	SECTION("Rules before the matching one are evaluated") {
+		RssIgnores ignores;
+		ignores.handle_action("ignore-article", {"https://example.com/feed.xml", "title =~ \"[[\""});
+		ignores.handle_action("ignore-article", {"*", "title = \"Updates\""});
+
+		REQUIRE_THROWS_AS(ignores.matches(&item), MatcherException);
+	}
+
+	SECTION("Rules of other feeds aren't evaluated") {
+		RssIgnores ignores;
+		ignores.handle_action("ignore-article", {"https://example.org/feed.xml", "title =~ \"[[\""});
+		ignores.handle_action("ignore-article", {"*", "title = \"News\""});
+		ignores.handle_action("ignore-article", {"https://example.com/feed.xml", "title = \"Updates\""});
+
+		REQUIRE(ignores.matches(&item));
+	}
+}
+
+TEST_CASE("RssIgnores::matches() with rules for many feeds",
+	"[RssIgnores][.][benchmark]")
+{
+	const unsigned int feed_count = 3000;
+
+	std::vector<std::shared_ptr<RssItem>> items;
+	for (unsigned int i = 0; i < feed_count; ++i) {
+		auto item = std::make_shared<RssItem>(nullptr);
+		item->set_title("Item " + std::to_string(i));
+		item->set_feedurl("https://example.com/" + std::to_string(i) + ".xml");
+		items.push_back(item);
+	}
+
+	for (const unsigned int rule_count : {
+				10u, 100u, 400u, 1000u
+			}) {
+		RssIgnores ignores;
+		for (unsigned int i = 0; i < rule_count; ++i) {
+			// Spread the rules over the feeds, with a few wildcards
+			const std::string feedurl = (i % 100 == 0)
+				? std::string("*")
+				: "https://example.com/" + std::to_string(i * 7 % feed_count) + ".xml";
+			ignores.handle_action("ignore-article", {feedurl, "title =~ \"spam\""});
+		}
+
+		BENCHMARK("Matching one item per feed against " +
+			std::to_string(rule_count) + " rules") {
+			unsigned int ignored = 0;
+			for (const auto& item : items) {
+				ignored += ignores.matches(item.get());
+			}
+			return ignored;
+		};
+	}
+}
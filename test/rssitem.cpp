@@ -1,6 +1,8 @@
 #include "rssitem.h"
 
+#include <functional>
 #include <unistd.h>
+#include <vector>
 
 #include "3rd-party/catch.hpp"
 #include "cache.h"
@@ -32,6 +34,52 @@ TEST_CASE("RssItem::sort_flags() cleans up flags", "[RssItem]")
 	}
 }
 
+TEST_CASE("RssItem::version() changes whenever a matchable attribute does",
+	"[RssItem]")
+{
+	RssItem item(nullptr);
+	RssItem other(nullptr);
+	REQUIRE(item.version() != other.version());
+
+	const std::vector<std::function<void()>> changes = {
+		[&]() { item.set_title("title"); },
+		[&]() { item.set_link("http://example.com"); },
+		[&]() { item.set_author("author"); },
+		[&]() { item.set_description("content"); },
+		[&]() { item.set_pubDate(42); },
+		[&]() { item.set_guid("guid"); },
+		[&]() { item.set_unread_nowrite(false); },
+		[&]() { item.set_unread_nowrite_notify(true, false); },
+		[&]() { item.set_unread(false); },
+		[&]() { item.set_enclosure_url("http://example.com/a.mp3"); },
+		[&]() { item.set_enclosure_type("audio/mpeg"); },
+		[&]() { item.set_flags("ab"); },
+		[&]() { item.set_index(3); },
+		[&]() { item.set_size(1024); },
+		[&]() { item.set_feedurl("http://example.com/feed.xml"); },
+	};
+	for (size_t i = 0; i < changes.size(); ++i) {
+		INFO("change #" << i);
+		const auto before = item.version();
+		changes[i]();
+		REQUIRE(item.version() != before);
+		REQUIRE(item.version() != other.version());
+	}
+
+	SECTION("Unloading the content doesn't change it") {
+		const auto before = item.version();
+		item.unload();
+		REQUIRE(item.version() == before);
+	}
+
+	SECTION("Setting the index it already has doesn't change it") {
+		item.set_index(7);
+		const auto before = item.version();
+		item.set_index(7);
+		REQUIRE(item.version() == before);
+	}
+}
+
 TEST_CASE("RssItem contains a number of matchable attributes", "[RssItem]")
 {
 	ConfigContainer cfg;
@@ -274,3 +322,67 @@ TEST_CASE("RssItem contains a number of matchable attributes", "[RssItem]")
 		}
 	}
 }
+
+TEST_CASE("RssItem's typed attributes agree with attribute_value()",
+	"[RssItem]")
+{
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+	auto feed = std::make_shared<RssFeed>(&rsscache);
+	auto item = std::make_shared<RssItem>(&rsscache);
+	feed->add_item(item);
+	item->set_feedptr(feed);
+
+	item->set_link("http://example.com/newest-update.html");
+	item->set_guid("unique-identifier-of-this-item");
+	item->set_enclosure_url("https://example.com/podcast-ep-01.mp3");
+	item->set_enclosure_type("audio/ogg");
+	item->set_flags("abc");
+	item->set_index(42);
+	feed->set_index(7);
+
+	const auto check_ref = [&item](MatchAttribute attr,
+	const std::string& name) {
+		INFO("attribute: " << name);
+		const std::string* ref = item->attribute_ref(attr);
+		REQUIRE(ref != nullptr);
+		REQUIRE(item->attribute_value(name) == *ref);
+	};
+
+	const auto check_number = [&item](MatchAttribute attr,
+	const std::string& name) {
+		INFO("attribute: " << name);
+		int value = 0;
+		REQUIRE(item->attribute_number(attr, value));
+		REQUIRE(item->attribute_value(name) == std::to_string(value));
+	};
+
+	check_ref(MatchAttribute::LINK, "link");
+	check_ref(MatchAttribute::GUID, "guid");
+	check_ref(MatchAttribute::ENCLOSURE_URL, "enclosure_url");
+	check_ref(MatchAttribute::ENCLOSURE_TYPE, "enclosure_type");
+	check_ref(MatchAttribute::FLAGS, "flags");
+	check_number(MatchAttribute::ARTICLEINDEX, "articleindex");
+	check_number(MatchAttribute::UNREAD_COUNT, "unread_count");
+	check_number(MatchAttribute::TOTAL_COUNT, "total_count");
+	check_number(MatchAttribute::FEEDINDEX, "feedindex");
+
+	item->set_unread_nowrite(true);
+	check_ref(MatchAttribute::UNREAD, "unread");
+	item->set_unread_nowrite(false);
+	check_ref(MatchAttribute::UNREAD, "unread");
+
+	// Three days and an hour ago
+	item->set_pubDate(::time(nullptr) - 3 * 86400 - 3600);
+	int age = 0;
+	REQUIRE(item->attribute_number(MatchAttribute::AGE, age));
+	REQUIRE(age == 3);
+
+	SECTION("Attributes that have to be formatted aren't typed") {
+		int value = 0;
+		REQUIRE(item->attribute_ref(MatchAttribute::TITLE) == nullptr);
+		REQUIRE(item->attribute_ref(MatchAttribute::DATE) == nullptr);
+		REQUIRE(item->attribute_ref(MatchAttribute::UNKNOWN) == nullptr);
+		REQUIRE_FALSE(item->attribute_number(MatchAttribute::TITLE, value));
+	}
+}
@@ -1,5 +1,8 @@
 #include "rss/parser.h"
 
+#include <climits>
+#include <unistd.h>
+
 #include "3rd-party/catch.hpp"
 #include "rss/exception.h"
 #include "test-helpers/exceptionwithmsg.h"
@@ -217,3 +220,58 @@ TEST_CASE("Extracts data from Atom 1.0", "[rsspp::Parser]")
 		"http://example.com/content/atom_testing.html");
 	REQUIRE(f.items[2].author == "Person A, Person B");
 }
+
+TEST_CASE("parse_url() returns the same feed whether it parses while "
+	"downloading or after that",
+	"[rsspp::Parser]")
+{
+	char cwd[PATH_MAX];
+	REQUIRE(getcwd(cwd, sizeof(cwd)) != nullptr);
+
+	for (const std::string file : {
+			"data/atom10_1.xml", "data/rss.xml", "data/rss10_1.xml"
+		}) {
+		INFO("file: " << file);
+		const std::string url = std::string("file://") + cwd + "/" + file;
+
+		rsspp::Parser buffering;
+		const auto expected = buffering.parse_url(url);
+
+		rsspp::Parser streaming;
+		streaming.set_parse_while_downloading(true);
+		const auto actual = streaming.parse_url(url);
+
+		REQUIRE(actual.rss_version == expected.rss_version);
+		REQUIRE(actual.encoding == expected.encoding);
+		REQUIRE(actual.title == expected.title);
+		REQUIRE(actual.link == expected.link);
+		REQUIRE(actual.items.size() == expected.items.size());
+		for (size_t i = 0; i < actual.items.size(); ++i) {
+			REQUIRE(actual.items[i].guid == expected.items[i].guid);
+			REQUIRE(actual.items[i].title == expected.items[i].title);
+			REQUIRE(actual.items[i].description ==
+				expected.items[i].description);
+		}
+
+		REQUIRE(streaming.get_transfer_stats().size ==
+			buffering.get_transfer_stats().size);
+	}
+}
+
+TEST_CASE("parse_url() reports parse errors rather than the aborted transfer "
+	"when parsing while downloading",
+	"[rsspp::Parser]")
+{
+	using TestHelpers::ExceptionWithMsg;
+
+	char cwd[PATH_MAX];
+	REQUIRE(getcwd(cwd, sizeof(cwd)) != nullptr);
+	const std::string url = std::string("file://") + cwd +
+		"/data/example.opml";
+
+	rsspp::Parser p;
+	p.set_parse_while_downloading(true);
+	REQUIRE_THROWS_MATCHES(p.parse_url(url),
+		rsspp::Exception,
+		ExceptionWithMsg<rsspp::Exception>("unsupported feed format"));
+}
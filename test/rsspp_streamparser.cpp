@@ -0,0 +1,335 @@
+#include "rss/streamparser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <libxml/xmlmemory.h>
+#include <string>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "3rd-party/catch.hpp"
+#include "rss/exception.h"
+#include "rss/parser.h"
+#include "test-helpers/exceptionwithmsg.h"
+#include "test-helpers/misc.h"
+
+namespace {
+
+void require_same_feed(const rsspp::Feed& actual, const rsspp::Feed& expected)
+{
+	REQUIRE(actual.encoding == expected.encoding);
+	REQUIRE(actual.rss_version == expected.rss_version);
+	REQUIRE(actual.title == expected.title);
+	REQUIRE(actual.title_type == expected.title_type);
+	REQUIRE(actual.description == expected.description);
+	REQUIRE(actual.link == expected.link);
+	REQUIRE(actual.language == expected.language);
+	REQUIRE(actual.managingeditor == expected.managingeditor);
+	REQUIRE(actual.dc_creator == expected.dc_creator);
+	REQUIRE(actual.pubDate == expected.pubDate);
+
+	REQUIRE(actual.items.size() == expected.items.size());
+	for (size_t i = 0; i < actual.items.size(); ++i) {
+		const auto& a = actual.items[i];
+		const auto& e = expected.items[i];
+		INFO("item #" << i);
+		REQUIRE(a.title == e.title);
+		REQUIRE(a.title_type == e.title_type);
+		REQUIRE(a.link == e.link);
+		REQUIRE(a.description == e.description);
+		REQUIRE(a.description_type == e.description_type);
+		REQUIRE(a.author == e.author);
+		REQUIRE(a.author_email == e.author_email);
+		REQUIRE(a.pubDate == e.pubDate);
+		REQUIRE(a.guid == e.guid);
+		REQUIRE(a.guid_isPermaLink == e.guid_isPermaLink);
+		REQUIRE(a.enclosure_url == e.enclosure_url);
+		REQUIRE(a.enclosure_type == e.enclosure_type);
+		REQUIRE(a.content_encoded == e.content_encoded);
+		REQUIRE(a.itunes_summary == e.itunes_summary);
+		REQUIRE(a.base == e.base);
+		REQUIRE(a.labels == e.labels);
+		REQUIRE(a.pubDate_ts == e.pubDate_ts);
+	}
+}
+
+rsspp::Feed parse_in_chunks(const std::string& buffer, size_t chunk_size)
+{
+	rsspp::StreamParser parser;
+	for (size_t pos = 0; pos < buffer.length(); pos += chunk_size) {
+		const auto chunk = buffer.substr(pos, chunk_size);
+		parser.parse_chunk(chunk.c_str(), chunk.length());
+	}
+	return parser.finish();
+}
+
+std::string generate_rss(unsigned int item_count)
+{
+	std::string feed =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<rss version=\"2.0\" "
+		"xmlns:content=\"http://purl.org/rss/1.0/modules/content/\">\n"
+		"<channel>\n"
+		"<title>Generated feed</title>\n"
+		"<link>http://example.com/</link>\n"
+		"<description>A lot of items</description>\n";
+	const std::string body(2000, 'x');
+	for (unsigned int i = 0; i < item_count; ++i) {
+		const auto n = std::to_string(i);
+		feed += "<item>\n"
+			"<title>Item " + n + "</title>\n"
+			"<link>http://example.com/" + n + "</link>\n"
+			"<guid>http://example.com/" + n + "</guid>\n"
+			"<pubDate>Sun, 01 Nov 2020 10:00:00 +0000</pubDate>\n"
+			"<description>Summary of item " + n + "</description>\n"
+			"<content:encoded><![CDATA[<p>" + body + "</p>]]>"
+			"</content:encoded>\n"
+			"</item>\n";
+	}
+	feed += "</channel>\n</rss>\n";
+	return feed;
+}
+
+} // namespace
+
+TEST_CASE("StreamParser produces the same feeds as the DOM parser",
+	"[rsspp::StreamParser]")
+{
+	const std::vector<std::string> files = {
+		"data/atom10_1.xml",
+		"data/items_without_titles.xml",
+		"data/rss.xml",
+		"data/rss091_1.xml",
+		"data/rss092_1.xml",
+		"data/rss10_1.xml",
+		"data/rss20_1.xml",
+		"data/rss_091_with_empty_author.xml",
+		"data/rss_092_with_empty_author.xml",
+		"data/rss_094_with_empty_author.xml",
+	};
+
+	for (const auto& file : files) {
+		INFO("file: " << file);
+		const auto contents = TestHelpers::read_file(file);
+
+		rsspp::Parser dom;
+		const auto expected = dom.parse_buffer_dom(contents);
+
+		rsspp::Parser streaming;
+		require_same_feed(streaming.parse_buffer(contents), expected);
+
+		rsspp::Parser file_parser;
+		require_same_feed(file_parser.parse_file(file), expected);
+
+		// Chunk boundaries may fall in the middle of tags, entities or
+		// multi-byte characters
+		require_same_feed(parse_in_chunks(contents, 1), expected);
+		require_same_feed(parse_in_chunks(contents, 7), expected);
+	}
+}
+
+TEST_CASE("StreamParser ignores elements outside of the RSS channel",
+	"[rsspp::StreamParser]")
+{
+	const std::string contents =
+		"<rss version=\"2.0\">"
+		"<item><title>Outside</title></item>"
+		"<channel><title>Inside</title>"
+		"<item><title>First</title></item></channel>"
+		"<channel><title>Second channel</title>"
+		"<item><title>Second</title></item></channel>"
+		"</rss>";
+
+	rsspp::Parser dom;
+	const auto expected = dom.parse_buffer_dom(contents);
+	REQUIRE(expected.title == "Inside");
+
+	rsspp::Parser streaming;
+	require_same_feed(streaming.parse_buffer(contents), expected);
+}
+
+TEST_CASE("StreamParser passes items to the handler as soon as they're parsed",
+	"[rsspp::StreamParser]")
+{
+	const auto contents = generate_rss(10);
+
+	rsspp::StreamParser parser;
+	std::vector<std::string> titles;
+
+	SECTION("All items are passed if the handler returns true") {
+		parser.set_item_handler([&titles](const rsspp::Item& item) {
+			titles.push_back(item.title);
+			return true;
+		});
+		parser.parse_chunk(contents.c_str(), contents.length());
+		const auto feed = parser.finish();
+
+		REQUIRE_FALSE(parser.stopped());
+		REQUIRE(titles.size() == 10);
+		REQUIRE(titles.front() == "Item 0");
+		REQUIRE(titles.back() == "Item 9");
+		REQUIRE(feed.items.size() == 10);
+	}
+
+	SECTION("Parsing stops once the handler returns false") {
+		parser.set_item_handler([&titles](const rsspp::Item& item) {
+			titles.push_back(item.title);
+			return titles.size() < 3;
+		});
+		parser.parse_chunk(contents.c_str(), contents.length());
+		const auto feed = parser.finish();
+
+		REQUIRE(parser.stopped());
+		REQUIRE(titles.size() == 3);
+		REQUIRE(feed.title == "Generated feed");
+		REQUIRE(feed.items.size() == 3);
+		REQUIRE(feed.items.back().title == "Item 2");
+	}
+}
+
+TEST_CASE("StreamParser throws on invalid or unsupported feeds",
+	"[rsspp::StreamParser]")
+{
+	using TestHelpers::ExceptionWithMsg;
+
+	const auto parse = [](const std::string& contents) {
+		rsspp::StreamParser parser;
+		parser.parse_chunk(contents.c_str(), contents.length());
+		return parser.finish();
+	};
+
+	REQUIRE_THROWS_MATCHES(parse(""),
+		rsspp::Exception,
+		ExceptionWithMsg<rsspp::Exception>("could not parse buffer"));
+	REQUIRE_THROWS_MATCHES(parse("<html><body>Hi!</body></html>"),
+		rsspp::Exception,
+		ExceptionWithMsg<rsspp::Exception>("unsupported feed format"));
+	REQUIRE_THROWS_MATCHES(parse("<rss version=\"3.0\"></rss>"),
+		rsspp::Exception,
+		ExceptionWithMsg<rsspp::Exception>("invalid RSS version"));
+	REQUIRE_THROWS_MATCHES(parse("<rss version=\"2.0\"><item/></rss>"),
+		rsspp::Exception,
+		ExceptionWithMsg<rsspp::Exception>("no RSS channel found"));
+}
+
+#ifdef __GLIBC__
+namespace {
+
+size_t allocated = 0;
+size_t peak_allocated = 0;
+
+void count_allocation(void* ptr)
+{
+	if (ptr != nullptr) {
+		allocated += malloc_usable_size(ptr);
+		peak_allocated = std::max(peak_allocated, allocated);
+	}
+}
+
+void counting_free(void* ptr)
+{
+	if (ptr != nullptr) {
+		allocated -= std::min(allocated, malloc_usable_size(ptr));
+	}
+	free(ptr);
+}
+
+void* counting_malloc(size_t size)
+{
+	void* ptr = malloc(size);
+	count_allocation(ptr);
+	return ptr;
+}
+
+void* counting_realloc(void* ptr, size_t size)
+{
+	if (ptr != nullptr) {
+		allocated -= std::min(allocated, malloc_usable_size(ptr));
+	}
+	void* result = realloc(ptr, size);
+	count_allocation(result);
+	return result;
+}
+
+char* counting_strdup(const char* str)
+{
+	char* result = strdup(str);
+	count_allocation(result);
+	return result;
+}
+
+/// Returns the peak amount of memory allocated by libxml2 while running
+/// \a func.
+template<typename Func>
+size_t libxml2_peak_memory(Func func)
+{
+	xmlFreeFunc old_free;
+	xmlMallocFunc old_malloc;
+	xmlReallocFunc old_realloc;
+	xmlStrdupFunc old_strdup;
+	xmlMemGet(&old_free, &old_malloc, &old_realloc, &old_strdup);
+
+	allocated = 0;
+	peak_allocated = 0;
+	xmlMemSetup(counting_free, counting_malloc, counting_realloc,
+		counting_strdup);
+	func();
+	xmlMemSetup(old_free, old_malloc, old_realloc, old_strdup);
+
+	return peak_allocated;
+}
+
+} // namespace
+
+TEST_CASE("StreamParser memory usage doesn't grow with the size of the feed",
+	"[rsspp::StreamParser][.][benchmark]")
+{
+	for (const unsigned int item_count : {100u, 1000u, 5000u}) {
+		const auto contents = generate_rss(item_count);
+
+		const auto dom_peak = libxml2_peak_memory([&]() {
+			rsspp::Parser p;
+			p.parse_buffer_dom(contents);
+		});
+		const auto streaming_peak = libxml2_peak_memory([&]() {
+			rsspp::Parser p;
+			p.parse_buffer(contents);
+		});
+
+		WARN(item_count << " items, " << contents.length() / 1024
+			<< " KiB: DOM parser peaked at " << dom_peak / 1024
+			<< " KiB, streaming parser at " << streaming_peak / 1024
+			<< " KiB");
+		REQUIRE(streaming_peak < dom_peak);
+	}
+}
+#endif
+
+TEST_CASE("StreamParser throughput", "[rsspp::StreamParser][.][benchmark]")
+{
+	const auto small = TestHelpers::read_file("data/rss.xml");
+	const auto large = generate_rss(5000);
+
+	BENCHMARK("DOM parser, small feed") {
+		rsspp::Parser p;
+		return p.parse_buffer_dom(small);
+	};
+
+	BENCHMARK("Streaming parser, small feed") {
+		rsspp::Parser p;
+		return p.parse_buffer(small);
+	};
+
+	BENCHMARK("DOM parser, 5000 items") {
+		rsspp::Parser p;
+		return p.parse_buffer_dom(large);
+	};
+
+	BENCHMARK("Streaming parser, 5000 items") {
+		rsspp::Parser p;
+		return p.parse_buffer(large);
+	};
+}
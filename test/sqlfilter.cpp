@@ -0,0 +1,231 @@
+#include "sqlfilter.h"
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+#include "cache.h"
+#include "configcontainer.h"
+#include "matcher.h"
+#include "rssfeed.h"
+#include "rssitem.h"
+#include "test-helpers/envvar.h"
+#include "test-helpers/tempfile.h"
+
+using namespace newsboat;
+
+namespace {
+
+void set_lc_ctype(TestHelpers::EnvVar& lc_ctype, const std::string& locale)
+{
+	lc_ctype.on_change([](nonstd::optional<std::string> new_charset) {
+		if (new_charset.has_value()) {
+			::setlocale(LC_CTYPE, new_charset.value().c_str());
+		} else {
+			::setlocale(LC_CTYPE, "");
+		}
+	});
+	lc_ctype.set(locale);
+}
+
+} // namespace
+
+TEST_CASE("SqlFilter::translate() only translates attributes that are stored "
+	"in the cache", "[SqlFilter]")
+{
+	TestHelpers::EnvVar lc_ctype("LC_CTYPE");
+	set_lc_ctype(lc_ctype, "C.UTF-8");
+	const time_t now = 1600000000;
+
+	const std::vector<std::string> translatable = {
+		"title = \"Hello\"",
+		"content =~ \"kubernetes\" and unread = \"yes\"",
+		"link != \"http://example.com\" or guid # \"abc\"",
+		"enclosure_url =~ \"mp3$\" and enclosure_type !~ \"video\"",
+		"flags # \"s\" and age between 0:7",
+		"age > 3 or age <= 1 or age = \"2\"",
+	};
+	for (const auto& expr : translatable) {
+		INFO("expression: " << expr);
+		REQUIRE(SqlFilter::translate(Matcher(expr), now).has_value());
+	}
+
+	const std::vector<std::string> untranslatable = {
+		"feedtitle = \"Some feed\"",
+		"unread_count > 0",
+		"articleindex < 10",
+		"date =~ \"2020\"",
+		"title < 5",
+		"content =~ \"[[\"",
+		"content # \"two words\"",
+		"title = \"Hello\" and tags # \"news\"",
+	};
+	for (const auto& expr : untranslatable) {
+		INFO("expression: " << expr);
+		REQUIRE_FALSE(SqlFilter::translate(Matcher(expr), now).has_value());
+	}
+
+	SECTION("Texts that RssItem converts to the locale's encoding are only "
+		"translated if that is UTF-8") {
+		set_lc_ctype(lc_ctype, "C");
+
+		REQUIRE(SqlFilter::translate(Matcher("link = \"a\""), now).has_value());
+		REQUIRE_FALSE(SqlFilter::translate(Matcher("title = \"a\""),
+				now).has_value());
+		REQUIRE_FALSE(SqlFilter::translate(Matcher("content =~ \"a\""),
+				now).has_value());
+	}
+}
+
+TEST_CASE("SqlFilter::reads_content() checks if the expression mentions "
+	"`content`", "[SqlFilter]")
+{
+	REQUIRE(SqlFilter::reads_content(Matcher("content =~ \"x\"")));
+	REQUIRE(SqlFilter::reads_content(
+			Matcher("title = \"a\" or (unread = \"yes\" and content # \"x\")")));
+	REQUIRE_FALSE(SqlFilter::reads_content(Matcher("title =~ \"content\"")));
+}
+
+TEST_CASE("Filter expressions give the same results in memory and in SQLite",
+	"[SqlFilter]")
+{
+	TestHelpers::EnvVar lc_ctype("LC_CTYPE");
+	set_lc_ctype(lc_ctype, "C.UTF-8");
+
+	ConfigContainer cfg;
+	Cache rsscache(":memory:", &cfg);
+	const std::string feedurl = "http://example.com/feed.xml";
+	const time_t now = ::time(nullptr);
+
+	auto feed = std::make_shared<RssFeed>(&rsscache);
+	feed->set_rssurl(feedurl);
+	const std::vector<std::string> words = {
+		"kubernetes", "Kubernetes", "docker", "it's", "50%", "a_b", ""
+	};
+	for (unsigned int i = 0; i < 200; ++i) {
+		const std::string word = words[i % words.size()];
+		auto item = std::make_shared<RssItem>(&rsscache);
+		item->set_guid("guid-" + std::to_string(i));
+		item->set_title("Item " + std::to_string(i) + " " + word);
+		item->set_link("http://example.com/" + std::to_string(i % 13));
+		item->set_author(i % 3 == 0 ? "Jane Doe" : "");
+		item->set_description("<p>Talking about " + word + " today</p>");
+		item->set_pubDate(now - (i % 20) * 86400 - 3600);
+		item->set_unread_nowrite(i % 2 == 0);
+		item->set_enclosure_url(i % 4 == 0 ? "http://example.com/a.mp3" : "");
+		item->set_enclosure_type(i % 4 == 0 ? "audio/mpeg" : "");
+		item->set_flags(i % 5 == 0 ? "ab" : (i % 5 == 1 ? "s" : ""));
+		item->set_feedurl(feedurl);
+		feed->add_item(item);
+	}
+	rsscache.externalize_rssfeed(feed, false);
+
+	// Items loaded from the cache fetch their contents when matched
+	feed = rsscache.internalize_rssfeed(feedurl, nullptr);
+	REQUIRE(feed->total_item_count() == 200);
+
+	const std::vector<std::string> expressions = {
+		"content =~ \"kubernetes\"",
+		"content !~ \"KUBERNETES\"",
+		"content =~ \"^<p>talking about (docker|it's)\"",
+		"content = \"<p>Talking about docker today</p>\"",
+		"content # \"about\" and content !# \"today</p>\"",
+		"title =~ \"50%\" or title =~ \"a_b$\"",
+		"title # \"it's\"",
+		"title = \"Item 3 it's\"",
+		"author = \"\" and unread = \"yes\"",
+		"author != \"Jane Doe\" or unread != \"no\"",
+		"unread =~ \"^y\"",
+		"link = \"http://example.com/7\"",
+		"link =~ \"/1[0-2]$\"",
+		"guid # \"guid-42\"",
+		"enclosure_url =~ \"mp3$\" and enclosure_type = \"audio/mpeg\"",
+		"enclosure_type = \"\"",
+		"flags # \"s\"",
+		"flags =~ \"b\" or flags = \"\"",
+		"age < 5",
+		"age >= 15 and age <= 17",
+		"age between 12:8",
+		"age between 3",
+		"age > 3 and age = \"4\"",
+		"age # \"1\"",
+	};
+
+	for (const auto& expr : expressions) {
+		INFO("expression: " << expr);
+		Matcher m(expr);
+
+		std::unordered_set<std::string> in_memory;
+		for (const auto& item : feed->items()) {
+			if (m.matches(item.get())) {
+				in_memory.insert(item->guid());
+			}
+		}
+
+		const auto condition = SqlFilter::translate(m, now);
+		REQUIRE(condition.has_value());
+		const auto in_sqlite = rsscache.fetch_matching_guids(condition.value(),
+		{feedurl});
+		const auto guids = in_sqlite.find(feedurl);
+
+		if (in_memory.empty()) {
+			REQUIRE(guids == in_sqlite.end());
+		} else {
+			REQUIRE(guids != in_sqlite.end());
+			REQUIRE(guids->second == in_memory);
+		}
+	}
+}
+
+TEST_CASE("Query feed on `content` over 20000 cached items",
+	"[SqlFilter][.][benchmark]")
+{
+	TestHelpers::EnvVar lc_ctype("LC_CTYPE");
+	set_lc_ctype(lc_ctype, "C.UTF-8");
+
+	TestHelpers::TempFile dbfile;
+	ConfigContainer cfg;
+	Cache rsscache(dbfile.get_path(), &cfg);
+
+	const std::string body(2000, 'x');
+	std::vector<std::shared_ptr<RssFeed>> feeds;
+	for (unsigned int f = 0; f < 20; ++f) {
+		const std::string feedurl = "http://example.com/" + std::to_string(f);
+		auto feed = std::make_shared<RssFeed>(&rsscache);
+		feed->set_rssurl(feedurl);
+		for (unsigned int i = 0; i < 1000; ++i) {
+			auto item = std::make_shared<RssItem>(&rsscache);
+			item->set_guid(feedurl + "/" + std::to_string(i));
+			item->set_title("Item " + std::to_string(i));
+			item->set_description(body + (i % 50 == 0 ? " kubernetes" : ""));
+			item->set_pubDate(::time(nullptr));
+			item->set_feedurl(feedurl);
+			feed->add_item(item);
+		}
+		rsscache.externalize_rssfeed(feed, false);
+		// Like at startup, contents stay in the cache until they're needed
+		feeds.push_back(rsscache.internalize_rssfeed(feedurl, nullptr));
+	}
+
+	const std::string query = "content =~ \"kubernetes\"";
+
+	BENCHMARK("Matching in memory") {
+		Matcher m(query);
+		unsigned int matched = 0;
+		for (const auto& feed : feeds) {
+			for (const auto& item : feed->items()) {
+				matched += m.matches(item.get());
+			}
+		}
+		return matched;
+	};
+
+	BENCHMARK("Populating a query feed") {
+		auto query_feed = std::make_shared<RssFeed>(&rsscache);
+		query_feed->set_rssurl("query:Kubernetes:" + query);
+		query_feed->update_items(feeds);
+		return query_feed->total_item_count();
+	};
+}
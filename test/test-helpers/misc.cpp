@@ -1,6 +1,7 @@
 #include "misc.h"
 
 #include <fstream>
+#include <iterator>
 
 #include "3rd-party/catch.hpp"
 
@@ -51,3 +52,12 @@ void TestHelpers::copy_file(const std::string& source,
 
 	dst << src.rdbuf();
 }
+
+std::string TestHelpers::read_file(const std::string& path)
+{
+	std::ifstream src(path, std::ios::binary);
+	REQUIRE(src.is_open());
+
+	return std::string(std::istreambuf_iterator<char>(src),
+			std::istreambuf_iterator<char>());
+}
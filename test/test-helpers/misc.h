@@ -22,6 +22,10 @@ void assert_article_file_content(const std::string& path,
  */
 void copy_file(const std::string& source, const std::string& destination);
 
+/* \brief Returns the contents of a file
+ */
+std::string read_file(const std::string& path);
+
 } // namespace TestHelpers
 
 #endif /* NEWSBOAT_TEST_HELPERS_MISC_H_ */
@@ -1570,3 +1570,95 @@ TEST_CASE("mkdir_parents() doesn't care if the path ends in a slash or not",
 		check(path + "/");
 	}
 }
+
+TEST_CASE("convert_text() converts text between charsets", "[utils]")
+{
+	const std::string utf8 = "Gr\xc3\xbc\xc3\x9f" "e";
+	const std::string latin1 = "Gr\xfc\xdf" "e";
+
+	REQUIRE(utils::convert_text(utf8, "iso-8859-1", "utf-8") == latin1);
+	REQUIRE(utils::convert_text(latin1, "utf-8", "iso-8859-1") == utf8);
+
+	SECTION("Text is returned as-is if both charsets are the same") {
+		REQUIRE(utils::convert_text(latin1, "UTF-8", "utf-8") == latin1);
+	}
+
+	SECTION("Invalid sequences are replaced by question marks") {
+		REQUIRE(utils::convert_text("a\xff" "b\xc3", "iso-8859-1", "utf-8") ==
+			"a?b?");
+	}
+
+	SECTION("Conversion stops at the first NUL") {
+		const std::string text("a\xc3\xbc\0b", 5);
+		REQUIRE(utils::convert_text(text, "iso-8859-1", "utf-8") ==
+			"a\xfc");
+		REQUIRE(utils::convert_text("ab\0cd", "iso-8859-1", "utf-8") == "ab");
+	}
+
+	SECTION("ASCII is converted into charsets that aren't ASCII-compatible") {
+		REQUIRE(utils::convert_text("ab", "utf-16le", "utf-8") ==
+			std::string("a\0b\0", 4));
+	}
+
+	SECTION("Unsupported charsets result in an empty string") {
+		REQUIRE(utils::convert_text("ab", "no-such-charset", "utf-8") == "");
+	}
+
+	SECTION("Long texts are converted completely") {
+		std::string long_utf8;
+		std::string long_latin1;
+		for (int i = 0; i < 20000; ++i) {
+			long_utf8 += utf8;
+			long_latin1 += latin1;
+		}
+		REQUIRE(utils::convert_text(long_utf8, "iso-8859-1", "utf-8") ==
+			long_latin1);
+		REQUIRE(utils::convert_text(long_latin1, "utf-8", "iso-8859-1") ==
+			long_utf8);
+		REQUIRE(utils::convert_text(long_utf8, "utf-16le", "utf-8").length() ==
+			long_latin1.length() * 2);
+	}
+}
+
+TEST_CASE("locale_is_utf8() checks the charset of LC_CTYPE", "[utils]")
+{
+	TestHelpers::EnvVar lc_ctype("LC_CTYPE");
+	lc_ctype.on_change([](nonstd::optional<std::string> new_charset) {
+		if (new_charset.has_value()) {
+			::setlocale(LC_CTYPE, new_charset.value().c_str());
+		} else {
+			::setlocale(LC_CTYPE, "");
+		}
+	});
+
+	lc_ctype.set("C.UTF-8");
+	REQUIRE(utils::locale_is_utf8());
+	REQUIRE(utils::utf8_to_locale("\xc3\xa4") == "\xc3\xa4");
+
+	lc_ctype.set("C");
+	REQUIRE_FALSE(utils::locale_is_utf8());
+}
+
+TEST_CASE("convert_text() throughput on 100 KB article bodies",
+	"[utils][.][benchmark]")
+{
+	std::string ascii;
+	std::string non_ascii;
+	while (ascii.length() < 100 * 1024) {
+		ascii += "<p>The quick brown fox jumps over the lazy dog.</p>\n";
+		non_ascii += "<p>Portez ce vieux whisky au juge blond qui "
+			"fume \xc3\xa0 la f\xc3\xaate.</p>\n";
+	}
+
+	BENCHMARK("ASCII, UTF-8 to ISO-8859-1") {
+		return utils::convert_text(ascii, "iso-8859-1", "utf-8");
+	};
+
+	BENCHMARK("Non-ASCII, UTF-8 to ISO-8859-1") {
+		return utils::convert_text(non_ascii, "iso-8859-1", "utf-8");
+	};
+
+	BENCHMARK("Non-ASCII, UTF-8 to UTF-8") {
+		return utils::convert_text(non_ascii, "UTF-8", "utf-8");
+	};
+}
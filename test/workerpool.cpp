@@ -0,0 +1,69 @@
+#include "workerpool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "3rd-party/catch.hpp"
+
+using namespace newsboat;
+
+TEST_CASE("WorkerPool doesn't split short ranges", "[WorkerPool]")
+{
+	const WorkerPool pool(8);
+
+	REQUIRE(pool.shard_count(0) == 1);
+	REQUIRE(pool.shard_count(1) == 1);
+	REQUIRE(pool.shard_count(2 * WorkerPool::MIN_SHARD_SIZE - 1) == 1);
+	REQUIRE(pool.shard_count(2 * WorkerPool::MIN_SHARD_SIZE) == 2);
+	REQUIRE(pool.shard_count(100 * WorkerPool::MIN_SHARD_SIZE) == 8);
+
+	REQUIRE(WorkerPool(1).shard_count(100 * WorkerPool::MIN_SHARD_SIZE) == 1);
+	REQUIRE(WorkerPool().shard_count(0) == 1);
+}
+
+TEST_CASE("WorkerPool::run() processes each index exactly once",
+	"[WorkerPool]")
+{
+	for (const size_t count : {
+				size_t(0), size_t(10), 5 * WorkerPool::MIN_SHARD_SIZE + 3
+			}) {
+		INFO("count: " << count);
+		const WorkerPool pool(4);
+		std::vector<std::atomic<int>> seen(count);
+		std::vector<char> shard_used(pool.shard_count(count), 0);
+
+		pool.run(count, [&](size_t shard, size_t begin, size_t end) {
+			shard_used[shard] = 1;
+			for (size_t i = begin; i < end; ++i) {
+				seen[i]++;
+			}
+		});
+
+		for (size_t i = 0; i < count; ++i) {
+			REQUIRE(seen[i] == 1);
+		}
+		for (const char used : shard_used) {
+			REQUIRE(used);
+		}
+	}
+}
+
+TEST_CASE("WorkerPool::run() rethrows the exception of the lowest shard",
+	"[WorkerPool]")
+{
+	const WorkerPool pool(4);
+	const size_t count = 4 * WorkerPool::MIN_SHARD_SIZE;
+	REQUIRE(pool.shard_count(count) == 4);
+
+	try {
+		pool.run(count, [](size_t shard, size_t, size_t) {
+			if (shard >= 1) {
+				throw std::runtime_error(std::to_string(shard));
+			}
+		});
+		FAIL("run() didn't throw");
+	} catch (const std::runtime_error& e) {
+		REQUIRE(std::string(e.what()) == "1");
+	}
+}